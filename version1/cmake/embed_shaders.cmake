@@ -0,0 +1,46 @@
+# embed_shaders(<source dir> <header>)
+#
+# Writes <header>, holding every *.glsl in <source dir> as a constexpr
+# string (looked up by ShaderGenerator). Runs at configure time; the
+# templates are configure dependencies, so editing or adding one re-runs
+# CMake and regenerates the header on the next build.
+function(embed_shaders source_dir output)
+    file(GLOB templates RELATIVE "${source_dir}" "${source_dir}/*.glsl")
+    list(SORT templates)
+
+    set(delimiter "ode_glsl")
+    set(body "")
+    foreach(name IN LISTS templates)
+        file(READ "${source_dir}/${name}" source)
+        string(FIND "${source}" ")${delimiter}\"" clash)
+        if(NOT clash EQUAL -1)
+            message(FATAL_ERROR "${name} contains the raw-string delimiter ')${delimiter}\"'")
+        endif()
+        string(APPEND body "    {\"${name}\", R\"${delimiter}(${source})${delimiter}\"},\n")
+        set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${source_dir}/${name}")
+    endforeach()
+    # A new template only changes the glob
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${source_dir}")
+
+    file(RELATIVE_PATH source_name "${CMAKE_SOURCE_DIR}" "${source_dir}")
+    set(header "// Generated from ${source_name} by cmake/embed_shaders.cmake; do not edit.
+#pragma once
+#include <string_view>
+
+struct EmbeddedShader {
+    std::string_view name;
+    std::string_view source;
+};
+
+inline constexpr EmbeddedShader kEmbeddedShaders[] = {
+${body}};
+")
+    # Rewrite only on change, so a re-configure does not rebuild every GL target
+    if(EXISTS "${output}")
+        file(READ "${output}" previous)
+        if(previous STREQUAL header)
+            return()
+        endif()
+    endif()
+    file(WRITE "${output}" "${header}")
+endfunction()
@@ -0,0 +1,87 @@
+// Runs a parameter sweep described by a job file (see include/job_file.h)
+// and streams the results to a binary trajectory file. Rerunning the same
+// command after an interruption resumes where the sweep stopped.
+//
+//   ./batch_runner JOBFILE [--output PATH] [--workers N] [--max-in-flight N]
+//                          [--fresh] [--list]
+
+#include "../include/batch_runner.h"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+
+struct CliOptions {
+    std::string job_file;
+    std::string output;
+    bool list = false;
+    BatchOptions batch;
+};
+
+bool parse_options(int argc, char** argv, CliOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--output" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (arg == "--workers" && i + 1 < argc) {
+            options.batch.cpu_workers = std::atoi(argv[++i]);
+        } else if (arg == "--max-in-flight" && i + 1 < argc) {
+            options.batch.max_in_flight = static_cast<size_t>(std::atol(argv[++i]));
+        } else if (arg == "--fresh") {
+            options.batch.fresh = true;
+        } else if (arg == "--list") {
+            options.list = true;
+        } else if (options.job_file.empty() && arg.rfind("--", 0) != 0) {
+            options.job_file = arg;
+        } else {
+            options.job_file.clear();
+            break;
+        }
+    }
+    if (options.job_file.empty()) {
+        std::cerr << "Usage: " << argv[0]
+                  << " JOBFILE [--output PATH] [--workers N] [--max-in-flight N] [--fresh] [--list]"
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    CliOptions options;
+    if (!parse_options(argc, argv, options)) {
+        return 1;
+    }
+
+    try {
+        JobSpec spec = JobSpec::parse_file(options.job_file);
+        if (!options.output.empty()) {
+            spec.set_output_path(options.output);
+        }
+
+        if (options.list) {
+            for (std::uint64_t i = 0; i < spec.size(); ++i) {
+                std::cout << JobSpec::describe(spec.job(i)) << std::endl;
+            }
+            return 0;
+        }
+
+        // Same calibration file as the benchmark and the daemon
+        CostCalibration calibration;
+        if (!calibration.load("cost_calibration.txt")) {
+            calibration = CostCalibration::defaults();
+        }
+
+        BatchRunner runner(spec, options.batch, calibration);
+        BatchStats stats = runner.run();
+        std::cout << "Done: " << stats.completed << " solved, " << stats.skipped << " resumed, "
+                  << stats.failed << " failed in " << stats.seconds << " s" << std::endl;
+        return stats.failed > 0 ? 2 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -5,6 +5,8 @@
 #include "timer.h"
 #include "test_problems.h"
 #include "cpu_solver.h"
+#include "steppers.h"
+#include "profiler.h"
 
 void analyze_cpu_performance() {
     std::cout << "=== CPU Performance Analysis ===" << std::endl;
@@ -40,6 +42,32 @@ void analyze_cpu_performance() {
     }
 }
 
+void analyze_step_latency() {
+    std::cout << "\n=== CPU Step Latency Distribution ===" << std::endl;
+    
+    // Per-step p50/p99 instead of a single mean: tail latency is what
+    // matters for real-time loops
+    const double dt = 0.01;
+    const int n_steps = 2000;
+    
+    for (int N : {100, 10000}) {
+        auto system = TestProblems::create_scalability_test(N);
+        
+        for (const char* method : {"euler", "rk45"}) {
+            auto stepper = create_stepper(method);
+            std::vector<double> y = system.initial_conditions;
+            
+            ScopedTimer run_timer(method);
+            for (int i = 0; i < n_steps; ++i) {
+                ScopedTimer step_timer(N == 100 ? "step_N100" : "step_N10000");
+                stepper->step(system, i * dt, dt, y);
+            }
+        }
+    }
+    
+    Profiler::instance().print_report(std::cout);
+}
+
 void analyze_gpu_overhead() {
     std::cout << "\n=== GPU Overhead Analysis ===" << std::endl;
     
@@ -66,6 +94,7 @@ void analyze_gpu_overhead() {
 
 int main() {
     analyze_cpu_performance();
+    analyze_step_latency();
     analyze_gpu_overhead();
     return 0;
 } 
\ No newline at end of file
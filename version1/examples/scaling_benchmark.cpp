@@ -0,0 +1,264 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <unistd.h>
+#include "timer.h"
+#include "test_problems.h"
+#include "thread_pool.h"
+#include "threaded_cpu_backend.h"
+#include "ensemble.h"
+#include "scaling_table.h"
+
+// Strong and weak scaling of the threaded CPU paths.
+//
+//   strong  - one create_scalability_test(N) system, N = 1e2 .. 1e7,
+//             fixed work per N, varying thread count
+//   weak    - N grows with the thread count (fixed N per thread)
+//   ensemble- N independent Van der Pol members, N = 1e2 .. 1e6
+//
+// For every size the fastest thread count is written to a ScalingTable
+// (default scaling_table.txt) that ThreadedCPUBackend / CPUEnsembleBackend
+// load at runtime. The fewest threads within kMinGain of the fastest count
+// are chosen, so the table stays on one thread below the crossover.
+//
+// Usage: scaling_benchmark [--quick] [--max-threads N] [--no-pin] [--output FILE]
+
+namespace {
+
+constexpr double kMinGain = 1.05;
+
+struct Options {
+    bool quick = false;
+    bool pin = true;
+    int max_threads = 0;
+    std::string output = "scaling_table.txt";
+};
+
+std::vector<int> thread_counts(int max_threads) {
+    std::vector<int> counts;
+    for (int t = 1; t < max_threads; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(max_threads);
+    return counts;
+}
+
+// Physical memory, used to skip sizes whose workspaces would not fit
+double physical_memory_bytes() {
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long page_size = sysconf(_SC_PAGE_SIZE);
+    if (pages <= 0 || page_size <= 0) return 1e18;
+    return static_cast<double>(pages) * page_size;
+}
+
+// Best-of-reps wall time for one solve
+template <typename Fn>
+double best_time(int reps, Fn&& fn) {
+    Timer timer;
+    double best = 1e30;
+    for (int r = 0; r < reps; ++r) {
+        timer.start();
+        fn();
+        best = std::min(best, timer.elapsed());
+    }
+    return best;
+}
+
+// Fewest threads within kMinGain of the fastest measurement (counts ascend)
+int pick_threads(const std::vector<int>& counts, const std::vector<double>& times) {
+    const double fastest = *std::min_element(times.begin(), times.end());
+    size_t best = 0;
+    while (times[best] > fastest * kMinGain) ++best;
+    return counts[best];
+}
+
+void print_header(const std::vector<int>& counts) {
+    std::cout << std::setw(10) << "N";
+    for (int t : counts) {
+        std::cout << " | " << std::setw(3) << t << "T time   eff";
+    }
+    std::cout << " | best" << std::endl;
+}
+
+void print_row(long long n, const std::vector<int>& counts,
+               const std::vector<double>& times, int best) {
+    std::cout << std::setw(10) << n;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        double efficiency = times[0] / (counts[i] * times[i]);
+        std::cout << " | " << std::setw(9) << std::scientific << std::setprecision(2) << times[i]
+                  << std::fixed << std::setprecision(2) << std::setw(6) << efficiency;
+    }
+    std::cout << " | " << std::setw(4) << best << std::endl;
+}
+
+void strong_scaling(ThreadPool& pool, const Options& options, ScalingTable& table) {
+    std::cout << "\n=== Strong Scaling: one system, RK45 ===" << std::endl;
+    std::cout << "(eff = T1 / (threads * Tthreads))" << std::endl;
+
+    std::vector<int> counts = thread_counts(pool.size());
+    long long max_n = options.quick ? 1000000 : 10000000;
+    double memory_budget = physical_memory_bytes() / 2;
+
+    ThreadedCPUBackend backend("rk45", pool);
+    const double dt = 0.001;
+
+    print_header(counts);
+    for (long long n = 100; n <= max_n; n *= 10) {
+        // ~2e7 equation-steps per measurement, at least 2 and at most 2000 steps
+        int steps = static_cast<int>(std::max(2LL, std::min(2000LL, 20000000LL / n)));
+        if (options.quick) steps = std::max(2, steps / 10);
+
+        // 9 RK45 workspaces plus the stored trajectory
+        double footprint = (9.0 + steps + 1) * n * sizeof(double);
+        if (footprint > memory_budget) {
+            std::cout << std::setw(10) << n << " | skipped: needs "
+                      << footprint / 1e9 << " GB" << std::endl;
+            continue;
+        }
+
+        auto system = TestProblems::create_scalability_test(static_cast<int>(n));
+        std::vector<std::vector<double>> solution;
+        int reps = n < 1000000 ? 3 : 1;
+
+        std::vector<double> times;
+        for (int t : counts) {
+            backend.set_max_threads(t);
+            times.push_back(best_time(reps, [&]() {
+                backend.solve(system, 0.0, steps * dt, dt, system.initial_conditions, solution);
+            }));
+        }
+
+        int best = pick_threads(counts, times);
+        table.set("system", n, best);
+        print_row(n, counts, times, best);
+    }
+}
+
+void weak_scaling(ThreadPool& pool, const Options& options) {
+    std::cout << "\n=== Weak Scaling: N per thread fixed, RK45 ===" << std::endl;
+    std::cout << "(eff = T1 / Tthreads)" << std::endl;
+
+    const int n_per_thread = options.quick ? 10000 : 100000;
+    const int steps = options.quick ? 20 : 100;
+    const double dt = 0.001;
+
+    ThreadedCPUBackend backend("rk45", pool);
+    double t1 = 0.0;
+
+    for (int t : thread_counts(pool.size())) {
+        int n = n_per_thread * t;
+        auto system = TestProblems::create_scalability_test(n);
+        std::vector<std::vector<double>> solution;
+
+        backend.set_max_threads(t);
+        double time = best_time(3, [&]() {
+            backend.solve(system, 0.0, steps * dt, dt, system.initial_conditions, solution);
+        });
+        if (t == 1) t1 = time;
+
+        std::cout << std::fixed << std::setprecision(4)
+                  << "threads=" << std::setw(3) << t
+                  << " | N=" << std::setw(9) << n
+                  << " | time=" << std::setw(8) << time << "s"
+                  << " | eff=" << std::setprecision(2) << t1 / time << std::endl;
+    }
+}
+
+void ensemble_scaling(ThreadPool& pool, const Options& options, ScalingTable& table) {
+    std::cout << "\n=== Ensemble Scaling: Van der Pol members, RK45 ===" << std::endl;
+    std::cout << "(eff = T1 / (threads * Tthreads))" << std::endl;
+
+    std::vector<int> counts = thread_counts(pool.size());
+    long long max_members = options.quick ? 100000 : 1000000;
+
+    auto system = TestProblems::create_van_der_pol();
+    CPUEnsembleBackend backend("rk45", pool);
+    const double dt = 0.01;
+
+    print_header(counts);
+    for (long long members = 100; members <= max_members; members *= 10) {
+        int steps = static_cast<int>(std::max(10LL, std::min(1000LL, 10000000LL / members)));
+        if (options.quick) steps = std::max(2, steps / 10);
+
+        std::vector<double> y0;
+        y0.reserve(members * system.dimension);
+        for (long long m = 0; m < members; ++m) {
+            // Spread the initial amplitudes so members do not share a trajectory
+            y0.push_back(0.5 + 2.0 * m / members);
+            y0.push_back(0.0);
+        }
+        std::vector<double> final_states;
+        int reps = members < 100000 ? 3 : 1;
+
+        std::vector<double> times;
+        for (int t : counts) {
+            backend.set_max_threads(t);
+            times.push_back(best_time(reps, [&]() {
+                backend.solve_ensemble(system, 0.0, steps * dt, dt, y0,
+                                       static_cast<int>(members), final_states);
+            }));
+        }
+
+        int best = pick_threads(counts, times);
+        table.set("ensemble", members, best);
+        print_row(members, counts, times, best);
+    }
+}
+
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quick") {
+            options.quick = true;
+        } else if (arg == "--no-pin") {
+            options.pin = false;
+        } else if (arg == "--max-threads" && i + 1 < argc) {
+            options.max_threads = std::atoi(argv[++i]);
+        } else if (arg == "--output" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--quick] [--max-threads N] [--no-pin] [--output FILE]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        return 1;
+    }
+
+    int threads = options.max_threads > 0 ? options.max_threads : ThreadPool::hardware_threads();
+    ThreadPool pool(threads, options.pin);
+    std::cout << "Thread pool: " << pool.size() << " threads"
+              << (pool.pinned() ? " (pinned)" : "") << std::endl;
+
+    ScalingTable table;
+    strong_scaling(pool, options, table);
+    weak_scaling(pool, options);
+    ensemble_scaling(pool, options, table);
+
+    std::cout << "\n=== Crossovers ===" << std::endl;
+    for (const auto& kind : table.kinds()) {
+        long long crossover = table.crossover(kind);
+        std::cout << kind << ": ";
+        if (crossover < 0) {
+            std::cout << "threading never paid off" << std::endl;
+        } else {
+            std::cout << "multi-threaded from N=" << crossover << std::endl;
+        }
+    }
+
+    if (table.save(options.output)) {
+        std::cout << "Scaling table written to " << options.output << std::endl;
+    }
+    return 0;
+}
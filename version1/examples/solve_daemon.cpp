@@ -0,0 +1,85 @@
+// Long-running solver daemon: keeps the GPU context, compiled programs and
+// thread pools warm and serves solve_protocol requests on a Unix socket.
+//
+//   ./solve_daemon [--socket PATH] [--workers N] [--window-ms MS] [--max-batch N]
+//
+// SIGINT / SIGTERM shut it down cleanly (queued work finishes first).
+
+#include "../include/solve_daemon.h"
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+
+SolveDaemon* g_daemon = nullptr;
+
+void handle_signal(int) {
+    if (g_daemon) {
+        g_daemon->stop();
+    }
+}
+
+bool parse_options(int argc, char** argv, DaemonOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            options.socket_path = argv[++i];
+        } else if (arg == "--workers" && i + 1 < argc) {
+            options.cpu_workers = std::atoi(argv[++i]);
+        } else if (arg == "--window-ms" && i + 1 < argc) {
+            options.coalescing.window_seconds = std::max(0.0, std::atof(argv[++i]) * 1e-3);
+        } else if (arg == "--max-batch" && i + 1 < argc) {
+            options.coalescing.max_batch = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--socket PATH] [--workers N] [--window-ms MS] [--max-batch N]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    DaemonOptions options;
+    if (!parse_options(argc, argv, options)) {
+        return 1;
+    }
+
+    // Same calibration file as the benchmark; measured once if missing
+    CostCalibration calibration;
+    if (!calibration.load("cost_calibration.txt")) {
+        std::cout << "Calibrating cost model..." << std::endl;
+        ThreadPool pool;
+        calibration = CostCalibration::measure(pool, true);
+        calibration.save("cost_calibration.txt");
+    }
+
+    SolveDaemon daemon(options, calibration);
+    if (!daemon.start()) {
+        return 1;
+    }
+    g_daemon = &daemon;
+    std::signal(SIGINT, handle_signal);
+    std::signal(SIGTERM, handle_signal);
+
+    std::cout << "Solve daemon listening on " << options.socket_path << std::endl;
+    daemon.run();
+    g_daemon = nullptr;
+
+    auto stats = daemon.stats();
+    std::cout << "Served " << stats.requests << " requests (" << stats.errors << " errors), "
+              << stats.batched_requests << " of them in " << stats.batches
+              << " ensemble batches" << std::endl;
+    if (stats.batches > 0) {
+        std::cout << "Coalescing: mean batch " << static_cast<double>(stats.batched_requests) / stats.batches
+                  << " (" << stats.full_flushes << " full, " << stats.window_flushes << " by window), "
+                  << "added latency mean " << stats.mean_wait_us << " us, p99 "
+                  << stats.p99_wait_us << " us" << std::endl;
+    }
+    return 0;
+}
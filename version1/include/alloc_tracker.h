@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Heap allocation counters fed by the global operator new/delete
+// replacements in src/instrumentation/alloc_hooks.cpp.
+//
+// Tracking is opt-in: only executables that link alloc_hooks.cpp count
+// anything (see ALLOC_HOOK_SOURCES / ENABLE_ALLOC_TRACKING in CMakeLists.txt).
+// Everywhere else the counters stay at zero and hooks_installed() is false.
+struct AllocStats {
+    std::uint64_t allocations = 0;
+    std::uint64_t deallocations = 0;
+    std::uint64_t bytes_allocated = 0;
+};
+
+class AllocTracker {
+public:
+    static bool hooks_installed();
+
+    // Counters for the calling thread only
+    static AllocStats thread_stats();
+
+    // Counters summed over all threads
+    static AllocStats global_stats();
+
+    // Called from the operator new/delete hooks - must not allocate
+    static void record_allocation(std::size_t bytes);
+    static void record_deallocation();
+    static void mark_hooks_installed();
+};
+
+// Counts allocations made by the current thread while the region is alive.
+// Typical use in a benchmark or test:
+//
+//     stepper->step(system, t, dt, y);      // warmup sizes the workspaces
+//     AllocRegion region("rk45 loop");
+//     for (...) stepper->step(system, t, dt, y);
+//     assert(region.stats().allocations == 0);
+class AllocRegion {
+public:
+    explicit AllocRegion(const char* name = "");
+
+    AllocStats stats() const;  // Delta since construction (or last reset)
+    void reset();
+    const char* name() const { return name_; }
+
+private:
+    const char* name_;
+    AllocStats start_;
+};
@@ -0,0 +1,136 @@
+#pragma once
+#include "solver_base.h"
+#include "ensemble.h"
+#include "thread_pool.h"
+#include "threaded_cpu_backend.h"
+#include "gpu_euler_backend.h"
+#include "gpu_ensemble_backend.h"
+#include "hybrid_ensemble.h"
+#include "vm_ensemble_backend.h"
+#include <memory>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Machine constants the cost model is built from. defaults() are rough
+// Orange Pi Zero 2W figures; measure() replaces them with numbers from
+// this machine, and save()/load() keep them between runs.
+struct CostCalibration {
+    // CPU, single thread, on the reference system (create_scalability_test)
+    double cpu_euler_ns_per_eq_step;
+    double cpu_rk45_ns_per_eq_step;
+    double cpu_ref_rhs_ns_per_eq;      // One RHS evaluation of the reference system
+    double thread_fork_us;             // One parallel_for round trip on the pool
+    double thread_efficiency;          // Parallel efficiency above the fork cost
+
+    // GPU (GPUEulerBackend)
+    bool gpu_available;
+    double gpu_setup_ms;               // Context + shader compile, paid once per RHS
+    double gpu_dispatch_overhead_us;   // Fixed per-step cost: uniforms, dispatch, barrier
+    double gpu_ns_per_eq_step;         // Kernel time per equation
+    double gpu_readback_bytes_per_s;   // Map + copy + float->double of the state
+
+    static CostCalibration defaults();
+    static CostCalibration measure(ThreadPool& pool, bool include_gpu);
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+};
+
+// One routing decision and, once the solve has run, how good it was
+struct DispatchDecision {
+    std::string system_name;
+    long long n_equations = 0;
+    int n_steps = 0;
+    std::string backend;                       // Chosen backend name
+    double predicted_seconds = 0.0;
+    double actual_seconds = -1.0;              // -1 until the solve finished
+    std::vector<std::pair<std::string, double>> candidates;  // name, predicted seconds
+
+    // (actual - predicted) / predicted
+    double prediction_error() const {
+        return predicted_seconds > 0 && actual_seconds >= 0
+            ? (actual_seconds - predicted_seconds) / predicted_seconds : 0.0;
+    }
+};
+
+// SolverBase that routes each solve to the backend with the lowest
+// predicted wall time:
+//
+//   CPU_Single_<m>    ThreadedCPUBackend limited to one thread
+//   CPU_Threaded_<m>  ThreadedCPUBackend (needs rhs_range)
+//   GPU_Euler         GPUEulerBackend (euler only, builtin GLSL RHS)
+//
+// and, through solve_ensemble(), between CPUEnsembleBackend (one or many
+// threads), GPUEnsembleBackend and HybridEnsembleExecutor (GPU plus the
+// remaining cores). Systems whose RHS program is interpreted
+// (ODESystem::rhs_interpreted: no JIT) run on VMEnsembleBackend instead of
+// CPUEnsembleBackend's per-member tape.
+//
+// The model is steps x (per-step fixed cost + N x per-equation cost). The
+// per-equation CPU cost is scaled by the RHS cost of the actual system,
+// measured once on a slice of it. Each backend keeps a running correction
+// factor learned from actual/predicted, so repeated workloads converge.
+// GPUInfo::force_cpu_fallback still excludes the GPU outright.
+class AutoDispatcher : public SolverBase, public EnsembleSolverBase {
+public:
+    // method: "euler" or "rk45"
+    AutoDispatcher(const std::string& method, ThreadPool& pool,
+                   const CostCalibration& calibration = CostCalibration::defaults());
+
+    void solve(const ODESystem& system,
+              double t0, double tf, double dt,
+              const std::vector<double>& y0,
+              std::vector<std::vector<double>>& solution) override;
+
+    void solve_ensemble(const ODESystem& system,
+                        double t0, double tf, double dt,
+                        const std::vector<double>& y0,
+                        int n_members,
+                        std::vector<double>& final_states) override;
+
+    std::string name() const override { return "Auto_" + method_; }
+
+    // Cost predictions without running anything
+    DispatchDecision plan(const ODESystem& system, double t0, double tf, double dt);
+    DispatchDecision plan_ensemble(const ODESystem& system, double t0, double tf, double dt,
+                                   int n_members);
+
+    void set_scaling_table(const ScalingTable* table);
+    void set_verbose(bool verbose) { verbose_ = verbose; }
+
+    const CostCalibration& calibration() const { return calibration_; }
+    // Most recent decisions (bounded, oldest dropped first)
+    const std::vector<DispatchDecision>& history() const { return history_; }
+    double correction(const std::string& backend) const;
+
+private:
+    double rhs_ns_per_eq(const ODESystem& system);
+    bool gpu_eligible(const ODESystem& system) const;
+    bool gpu_ensemble_eligible(const ODESystem& system) const;
+    bool vm_eligible(const ODESystem& system) const;
+    double predict_cpu(const ODESystem& system, long long n, int n_steps, int threads);
+    double predict_gpu(const ODESystem& system, long long n, int n_steps,
+                       bool readback_every_step = true) const;
+    DispatchDecision choose(DispatchDecision decision) const;
+    void record(DispatchDecision& decision, double actual_seconds);
+
+    std::string method_;
+    ThreadPool& pool_;
+    CostCalibration calibration_;
+    bool verbose_;
+
+    ThreadedCPUBackend cpu_single_;
+    ThreadedCPUBackend cpu_threaded_;
+    CPUEnsembleBackend cpu_ensemble_;
+    GPUEulerBackend gpu_euler_;
+    GPUEnsembleBackend gpu_ensemble_;
+    HybridEnsembleExecutor hybrid_;
+    std::unique_ptr<VMEnsembleBackend> vm_ensemble_;  // euler and rk45 only
+
+    std::map<std::string, double> rhs_cost_cache_;  // system name -> ns per equation
+    std::map<std::string, double> correction_;      // backend -> actual/predicted
+    std::set<std::string> gpu_shaders_ready_;       // RHS names already compiled
+    std::vector<DispatchDecision> history_;
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include "job_file.h"
+#include "request_coalescer.h"
+#include "solve_service.h"
+#include "trajectory_io.h"
+#include <cstdint>
+
+struct BatchOptions {
+    int cpu_workers = 0;          // SolveService workers, 0 = hardware_threads()
+    // Submitted but not yet written jobs; bounds memory to this many
+    // solutions whatever the sweep size. 0 = 4 per worker.
+    size_t max_in_flight = 0;
+    bool fresh = false;           // Overwrite the output instead of resuming it
+    bool verbose = true;          // Progress and per-job failures on stdout/stderr
+};
+
+struct BatchStats {
+    std::uint64_t total = 0;      // Jobs in the sweep
+    std::uint64_t skipped = 0;    // Already in the output file
+    std::uint64_t completed = 0;  // Solved and written by this run
+    std::uint64_t coalesced = 0;  // Of completed: solved in RequestCoalescer batches
+    std::uint64_t failed = 0;     // Not written; a later resume retries them
+    double seconds = 0.0;
+};
+
+// Runs a JobSpec sweep through a SolveService and streams every result to
+// the spec's trajectory file as it finishes.
+//
+// Jobs are generated from their index while the sweep advances, so memory
+// stays at max_in_flight solutions. Without `fresh`, an existing output
+// file from the same sweep (matching fingerprint) is resumed: jobs already
+// on disk are skipped and a record torn by a crash is trimmed and rerun.
+//
+// Final-only sweeps over an interpreted RHS program (no JIT) bypass the
+// service for a RequestCoalescer, so jobs sharing parameters and time grid
+// run as VMEnsembleBackend batches instead of one tape solve each.
+class BatchRunner {
+public:
+    explicit BatchRunner(const JobSpec& spec, const BatchOptions& options = BatchOptions(),
+                         const CostCalibration& calibration = CostCalibration::defaults());
+
+    // Throws std::runtime_error when the output cannot be created or
+    // belongs to a different sweep
+    BatchStats run();
+
+private:
+    struct Pending {
+        JobInstance job;
+        SolveHandle handle;
+        std::future<CoalescedResult> batched;   // Instead of handle when coalesced
+    };
+
+    bool write_result(Pending& pending, TrajectoryWriter& writer, BatchStats& stats);
+
+    const JobSpec& spec_;
+    BatchOptions options_;
+    CostCalibration calibration_;
+};
@@ -1,29 +1,48 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
+#include "rhs_definition.h"
+#include "builtin_rhs_table.h"   // Generated, see src/rhs/gen_builtin_rhs_table.cpp
 
-struct RHSDefinition {
-    std::string glsl_code;
-    std::vector<std::string> uniform_names;
-    int problem_type_id;
-    std::string description;
+// Builtin GPU right-hand sides: the constexpr table in builtin_rhs_table.h,
+// followed by systems added at static initialization through
+// BuiltinRHSRegistration (ids from kBuiltinRHSCount up). Lookups return
+// references into static storage.
+class BuiltinRHSRegistry {
+public:
+    // Compile-time lookup in the builtin table; -1 if absent
+    static constexpr int find_builtin(std::string_view name) {
+        for (const BuiltinRHS& rhs : kBuiltinRHS) {
+            if (rhs.name == name) return rhs.id;
+        }
+        return -1;
+    }
+    static constexpr const BuiltinRHS& builtin(BuiltinRHSId id) {
+        return kBuiltinRHS[static_cast<int>(id)];
+    }
+
+    // Builtin or registered; throw std::invalid_argument when unknown
+    static const BuiltinRHS& get_rhs(std::string_view name);
+    static const BuiltinRHS& get_rhs(int id);
+    static bool has_rhs(std::string_view name);
+    static std::vector<std::string_view> list_available();
+
+private:
+    friend class BuiltinRHSRegistration;
+    static const BuiltinRHS* find(std::string_view name);
+    static int register_rhs(std::string name, RHSDefinition definition);
 };
 
-class BuiltinRHSRegistry {
+// Adds a system under `name` when constructed; meant for namespace-scope
+// statics, e.g.
+//   static BuiltinRHSRegistration duffing("duffing", to_rhs_definition(program, 0, "Duffing"));
+// The definition's problem_type_id is replaced by the assigned id.
+class BuiltinRHSRegistration {
 public:
-    static BuiltinRHSRegistry& instance();
-    
-    void register_rhs(const std::string& name, 
-                      const RHSDefinition& definition);
-    
-    RHSDefinition get_rhs(const std::string& name);
-    std::vector<std::string> list_available();
-    bool has_rhs(const std::string& name);
-    
+    BuiltinRHSRegistration(std::string name, RHSDefinition definition);
+    int id() const { return id_; }
+
 private:
-    BuiltinRHSRegistry();  // Private constructor for singleton
-    std::map<std::string, RHSDefinition> registry_;
-    
-    void register_builtin_systems();  // Register standard systems
-}; 
\ No newline at end of file
+    int id_;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// Compensated state updates for the steppers' `_compensated` variants.
+//
+// y += increment rounds away everything of the increment below half an ulp
+// of y. Over many small steps that loss is systematic and dominates the
+// drift of float runs. CompensatedUpdate keeps each component's rounding
+// error (Neumaier's exact two-sum error, valid whichever operand is
+// larger) and feeds it into that component's next increment, so the state
+// behaves as if it carried about twice the precision. Needs strict IEEE
+// evaluation: do not build with -ffast-math.
+
+// Rounding error of s = a + b, so that a + b == s + error exactly
+template <typename Scalar>
+inline Scalar two_sum_error(Scalar a, Scalar b, Scalar s) {
+    return std::abs(a) >= std::abs(b) ? (a - s) + b : (b - s) + a;
+}
+
+template <typename Scalar>
+class CompensatedUpdate {
+public:
+    // The carried errors belong to one trajectory. They are dropped unless
+    // this step continues the previous one: the same state vector, at the
+    // time the previous step ended (to within half a step, as callers
+    // recompute t = t0 + i * dt).
+    void begin(const std::vector<Scalar>& y, double t, double dt) {
+        if (y.data() != state_ || y.size() != carry_.size() || !(std::abs(t - t_next_) <= 0.5 * std::abs(dt))) {
+            carry_.assign(y.size(), Scalar(0));
+            state_ = y.data();
+        }
+        t_next_ = t + dt;
+    }
+
+    // y[i] += increment, carrying the rounding error into the next add for i
+    void add(std::vector<Scalar>& y, size_t i, Scalar increment) {
+        const Scalar corrected = increment + carry_[i];
+        const Scalar sum = y[i] + corrected;
+        carry_[i] = two_sum_error(y[i], corrected, sum);
+        y[i] = sum;
+    }
+
+private:
+    std::vector<Scalar> carry_;
+    const Scalar* state_ = nullptr;
+    double t_next_ = std::numeric_limits<double>::quiet_NaN();
+};
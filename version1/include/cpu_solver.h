@@ -11,6 +11,11 @@ public:
     std::string name() const override { return "CPU_RK45"; }
 
 private:
-    std::vector<double> rk45_step(const ODESystem& system, double t, 
-                                  const std::vector<double>& y, double h);
+    // Advances y in place; stage vectors live in the members below so the
+    // integration loop stays allocation-free after the first step
+    void rk45_step(const ODESystem& system, double t, 
+                   std::vector<double>& y, double h);
+    
+    std::vector<double> k1_, k2_, k3_, k4_, k5_, k6_;
+    std::vector<double> y_temp_;
 }; 
\ No newline at end of file
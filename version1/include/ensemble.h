@@ -0,0 +1,65 @@
+#pragma once
+#include "solver_base.h"
+#include "steppers.h"
+#include "thread_pool.h"
+#include "scaling_table.h"
+#include <memory>
+
+// Many independent copies of one small system (parameter sweeps, Monte
+// Carlo initial conditions). States are member-major: member m occupies
+// [m * dimension, (m + 1) * dimension) of the flat vectors.
+class EnsembleSolverBase {
+public:
+    virtual ~EnsembleSolverBase() = default;
+
+    // Integrates every member from t0 to tf and writes the final states
+    // (n_members * system.dimension values) into final_states.
+    virtual void solve_ensemble(const ODESystem& system,
+                                double t0, double tf, double dt,
+                                const std::vector<double>& y0,
+                                int n_members,
+                                std::vector<double>& final_states) = 0;
+
+    virtual std::string name() const = 0;
+};
+
+// Ensemble on the CPU: members are split into one contiguous block per
+// thread, and each thread integrates its block member by member with its
+// own stepper, so a member's state stays in cache for the whole run.
+// Concurrent solves are safe; they take turns on the pool.
+class CPUEnsembleBackend : public EnsembleSolverBase {
+public:
+    // method: any name accepted by create_stepper
+    CPUEnsembleBackend(const std::string& method, ThreadPool& pool);
+
+    void solve_ensemble(const ODESystem& system,
+                        double t0, double tf, double dt,
+                        const std::vector<double>& y0,
+                        int n_members,
+                        std::vector<double>& final_states) override;
+    // Same, on caller-owned contiguous buffers (no copies in or out)
+    void solve_ensemble(const ODESystem& system,
+                        double t0, double tf, double dt,
+                        const double* y0,
+                        int n_members,
+                        double* final_states);
+
+    std::string name() const override { return "CPU_Ensemble_" + method_; }
+
+    // Fixed thread count (0 = whole pool), or pick per member count from a
+    // table measured by scaling_benchmark (workload kind "ensemble")
+    void set_max_threads(int threads) { max_threads_ = threads; }
+    void set_scaling_table(const ScalingTable* table) { scaling_table_ = table; }
+    int threads_for(int n_members) const;
+
+private:
+    std::string method_;
+    ThreadPool& pool_;
+    int max_threads_;
+    const ScalingTable* scaling_table_;
+
+    // Per-worker stepper and member state, reused across solves; only used
+    // inside parallel_for
+    std::vector<std::unique_ptr<TimeStepper>> steppers_;
+    std::vector<std::vector<double>> member_y_;
+};
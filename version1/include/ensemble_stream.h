@@ -0,0 +1,151 @@
+#pragma once
+#include "ensemble.h"
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+// On-disk ensembles for runs that do not fit in RAM.
+//
+//   input  = 64-byte header, then per member: state (dimension doubles)
+//            followed by its parameters (n_params doubles)
+//   output = 64-byte header, then per member: width doubles, in member order
+//
+// Host byte order, like the trajectory files.
+
+struct EnsembleInputInfo {
+    std::uint32_t dimension = 0;
+    std::uint32_t n_params = 0;
+    std::uint64_t members = 0;
+};
+
+// Builds an input file member by member, without holding it in memory
+class EnsembleInputWriter {
+public:
+    bool create(const std::string& path, std::uint32_t dimension, std::uint32_t n_params = 0);
+    // y0: dimension values, params: n_params values (may be null if 0)
+    bool append(const double* y0, const double* params = nullptr);
+    // Writes the final member count into the header
+    bool close();
+
+    std::uint64_t members() const { return info_.members; }
+
+private:
+    std::ofstream out_;
+    EnsembleInputInfo info_;
+};
+
+// Read-only mapping of a result file; pages come in on demand, so even a
+// file larger than RAM can be inspected
+class EnsembleResultFile {
+public:
+    EnsembleResultFile() = default;
+    ~EnsembleResultFile();
+
+    bool open(const std::string& path);
+    std::uint64_t members() const { return members_; }
+    std::uint32_t width() const { return width_; }
+    const double* row(std::uint64_t member) const { return data_ + member * width_; }
+
+    EnsembleResultFile(const EnsembleResultFile&) = delete;
+    EnsembleResultFile& operator=(const EnsembleResultFile&) = delete;
+
+private:
+    void* mapping_ = nullptr;
+    size_t mapped_bytes_ = 0;
+    const double* data_ = nullptr;
+    std::uint64_t members_ = 0;
+    std::uint32_t width_ = 0;
+};
+
+// Turns one member's final state into the values written for it
+using EnsembleReducer = std::function<void(const double* final_state, double* out)>;
+// Builds the system for one parameter vector (input files with n_params > 0)
+using EnsembleSystemFactory = std::function<ODESystem(const std::vector<double>& params)>;
+
+struct StreamOptions {
+    int chunk_members = 65536;   // Members per chunk: the unit read, solved and written
+    int queue_depth = 2;         // Chunks buffered between adjacent stages
+    // Values written per member and how to compute them; width 0 writes
+    // the final state as is
+    std::uint32_t output_width = 0;
+    EnsembleReducer reduce;
+};
+
+struct StreamStats {
+    std::uint64_t members = 0;
+    std::uint64_t chunks = 0;
+    std::uint64_t sub_ensembles = 0;  // solve_ensemble() calls (one per parameter run)
+    double read_seconds = 0.0;        // Busy time per stage
+    double solve_seconds = 0.0;
+    double write_seconds = 0.0;
+    double wall_seconds = 0.0;
+    size_t buffer_bytes = 0;          // Every chunk buffer the pipeline owns
+
+    // > 1 when stages ran concurrently; 3 is perfect three-way overlap
+    double overlap() const {
+        return wall_seconds > 0.0 ? (read_seconds + solve_seconds + write_seconds) / wall_seconds : 0.0;
+    }
+};
+
+// Three-stage out-of-core ensemble pipeline:
+//
+//   reader thread  - maps the input one chunk window at a time
+//                    (MADV_SEQUENTIAL) and copies it into a free chunk
+//   calling thread - integrates the chunk with the given ensemble backend
+//                    (CPU ensemble, the hybrid executor for CPU + GPU, or
+//                    an AutoDispatcher choosing per run, which also sends
+//                    interpreted RHS programs to the VM)
+//   writer thread  - reduces each member and pwrite()s the chunk into its
+//                    slot of the preallocated output
+//
+// Stages hand chunks over through BoundedQueues and finished chunks go back
+// to a fixed free list, so memory is 2 * queue_depth + 3 chunks no matter
+// how many members the files hold, and reading, solving and writing of
+// neighbouring chunks overlap.
+//
+// With per-member parameters, each chunk is grouped into runs of equal
+// parameter vectors and every run is one solve_ensemble() call on the
+// system the factory builds for it; parameter grids with many initial
+// states per point batch well, fully random parameters degrade to one
+// member per call.
+class StreamingEnsemble {
+public:
+    StreamingEnsemble(EnsembleSolverBase& solver, const StreamOptions& options = StreamOptions());
+
+    // Input without parameters: every member uses `system`.
+    // Throws std::runtime_error on I/O errors and rethrows solver errors.
+    StreamStats run(const ODESystem& system, const std::string& input_path,
+                    const std::string& output_path, double t0, double tf, double dt);
+    // Input with parameters
+    StreamStats run(const EnsembleSystemFactory& factory, const std::string& input_path,
+                    const std::string& output_path, double t0, double tf, double dt);
+
+    static bool read_input_info(const std::string& path, EnsembleInputInfo& info);
+
+private:
+    struct Chunk {
+        std::uint64_t begin = 0;
+        int count = 0;
+        std::vector<double> records;   // count * (dimension + n_params), as on disk
+        std::vector<double> y0;        // count * dimension
+        std::vector<double> final_states;
+        std::vector<double> output;    // count * output width
+    };
+
+    StreamStats run_pipeline(const ODESystem* system, const EnsembleSystemFactory* factory,
+                             const std::string& input_path, const std::string& output_path,
+                             double t0, double tf, double dt);
+    void solve_chunk(Chunk& chunk, const EnsembleInputInfo& info, const ODESystem* system,
+                     const EnsembleSystemFactory* factory, double t0, double tf, double dt,
+                     StreamStats& stats);
+
+    EnsembleSolverBase& solver_;
+    StreamOptions options_;
+
+    // Solver-stage scratch for parameter runs, reused across chunks
+    std::vector<int> order_;
+    std::vector<double> run_y0_;
+    std::vector<double> run_final_;
+};
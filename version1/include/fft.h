@@ -0,0 +1,108 @@
+#pragma once
+#include <complex>
+#include <memory>
+#include <vector>
+
+// Power-of-two FFTs for the pseudo-spectral PDE solvers.
+//
+// Complex transforms run as Stockham autosort radix-4 passes (one radix-2
+// pass when log2 n is odd), so no bit-reversal permutation is needed.
+// Above kDirectMax points (1 MiB of data, 2 MiB with the scratch buffer)
+// the four-step algorithm splits n = n1 n2 into short transforms over
+// blocks of columns and rows plus one blocked transpose, so each pass works
+// inside L2 instead of streaming the whole array log4(n) times.
+//
+// Plans are immutable once built and safe to share between threads; the
+// transforms keep their scratch in thread-local buffers. get() returns
+// the process-wide cached plan for a size.
+//
+// Conventions: forward X[k] = sum_j x[j] exp(-2 pi i j k / n) unscaled,
+// inverse scaled by 1 / n, so inverse(forward(x)) == x.
+
+using Complex = std::complex<double>;
+
+// Product without the NaN/inf recovery path std::complex takes unless
+// built with -ffast-math (__muldc3); for finite operands it is the same
+inline Complex multiply(Complex a, Complex b) {
+    return Complex(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+}
+
+class FFTPlan {
+public:
+    // Complex transforms stay direct (Stockham) up to this many points
+    static constexpr int kDirectMax = 1 << 16;
+    static constexpr int kMaxSize = 1 << 26;
+
+    explicit FFTPlan(int n);
+    static std::shared_ptr<const FFTPlan> get(int n);
+
+    int size() const { return n_; }
+    // In place
+    void forward(Complex* data) const;
+    void inverse(Complex* data) const;
+
+private:
+    struct Pass {
+        int radix;
+        int length;           // Sub-transform length this pass splits
+        int stride;
+        size_t twiddle;       // Offset into twiddles_
+    };
+
+    void stockham(Complex* data) const;
+    void four_step(Complex* data) const;
+    Complex step_twiddle(long long m) const;
+
+    int n_;
+    std::vector<Pass> passes_;
+    std::vector<Complex> twiddles_;
+    // Four-step: n = n1_ * n2_, w_n^m = coarse_[m >> fine_bits_] * fine_[m & mask]
+    int n1_ = 0;
+    int n2_ = 0;
+    int fine_bits_ = 0;
+    std::vector<Complex> coarse_;
+    std::vector<Complex> fine_;
+    std::shared_ptr<const FFTPlan> n1_plan_;
+    std::shared_ptr<const FFTPlan> n2_plan_;
+};
+
+// Real-to-complex transform of n real points (n even) into the n / 2 + 1
+// non-negative frequencies, through one complex transform of n / 2 points
+class RealFFTPlan {
+public:
+    explicit RealFFTPlan(int n);
+    static std::shared_ptr<const RealFFTPlan> get(int n);
+
+    int size() const { return n_; }
+    int modes() const { return n_ / 2 + 1; }
+    void forward(const double* in, Complex* out) const;
+    // Reads modes() coefficients; the imaginary parts of the zero and
+    // Nyquist modes are ignored
+    void inverse(const Complex* in, double* out) const;
+
+private:
+    int n_;
+    std::shared_ptr<const FFTPlan> half_;
+    std::vector<Complex> twiddles_;   // exp(-2 pi i k / n), k < n / 2
+};
+
+// Real 2D transform of an ny x nx row-major field (x fastest) into
+// ny x (nx / 2 + 1) coefficients: real transforms along rows, then complex
+// transforms down the columns, gathered a cache line of columns at a time
+class RealFFT2D {
+public:
+    RealFFT2D(int nx, int ny);
+
+    int nx() const { return rows_->size(); }
+    int ny() const { return columns_->size(); }
+    int modes() const { return rows_->modes() * columns_->size(); }
+    void forward(const double* in, Complex* out) const;
+    void inverse(const Complex* in, double* out) const;
+
+private:
+    template <bool Forward>
+    void columns(Complex* data) const;
+
+    std::shared_ptr<const RealFFTPlan> rows_;
+    std::shared_ptr<const FFTPlan> columns_;
+};
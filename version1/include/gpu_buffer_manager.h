@@ -5,9 +5,13 @@
 
 // Standardized GPU buffer structure
 struct StandardGPUBuffers {
-    // Buffer 0: State vector (always present)
+    // Buffer 0: State vector read by the dispatch (always present)
     GLuint state_buffer;
     
+    // Buffer 5: State vector the dispatch writes; swapped with buffer 0
+    // after every step
+    GLuint next_state_buffer;
+    
     // Buffer 1: System parameters (standardized)
     GLuint param_buffer;
     
@@ -16,6 +20,9 @@ struct StandardGPUBuffers {
     
     // Buffer 3: Time control (for multi-step integration)
     GLuint time_control_buffer;
+    
+    // Buffer 4: Per-equation rounding carry of compensated shaders (optional)
+    GLuint compensation_buffer;
 };
 
 // System parameters structure matching shader layout
@@ -37,16 +44,21 @@ public:
     GPUBufferManager();
     ~GPUBufferManager();
     
-    // Buffer allocation and management
+    // Buffer allocation and management; n_timesteps <= 1 allocates no
+    // time-series buffer
     bool allocate_standard_buffers(int n_equations, int n_timesteps, 
-                                  const std::vector<float>& initial_state);
+                                  const std::vector<float>& initial_state,
+                                  bool compensated = false);
     void bind_buffers();
     void update_system_params(const SystemParams& params);
     void update_time_control(const TimeControl& time_ctrl);
+    // After a dispatch: the state it wrote becomes the one the next reads
+    void swap_state_buffers();
     void cleanup();
     
     // Data retrieval
     std::vector<float> read_state_buffer();
+    bool read_state_buffer(std::vector<float>& out);  // Reuses out's storage
     std::vector<float> read_timeseries_buffer(int n_equations, int n_steps);
     
     // Buffer access
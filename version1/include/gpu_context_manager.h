@@ -4,18 +4,30 @@
 #include <GLES3/gl3.h>
 #include <GLES3/gl31.h>
 #include <gbm.h>
+#include <atomic>
+#include <mutex>
 #include <string>
+#include <thread>
 
 // Singleton GPU context manager to avoid Panfrost driver issues
 class GPUContextManager {
 public:
     static GPUContextManager& instance();
     
+    // Creates the context and makes it current on the calling thread. Later
+    // calls from that thread are no-ops; calls from any other thread fail,
+    // since GL commands there would silently go nowhere. Multi-threaded code
+    // routes GL work through GPUExecutor instead.
     bool initialize();
-    bool is_initialized() const { return initialized_; }
+    bool is_initialized() const { return initialized_.load(std::memory_order_acquire); }
+    // True when the context is current on the calling thread
+    bool is_current_thread() const;
     
     GLuint compile_compute_shader(const std::string& source);
     
+    // Query GL_EXTENSIONS of the current context (e.g. "GL_EXT_disjoint_timer_query")
+    bool has_extension(const std::string& name) const;
+    
     // Prevent copying
     GPUContextManager(const GPUContextManager&) = delete;
     GPUContextManager& operator=(const GPUContextManager&) = delete;
@@ -24,7 +36,11 @@ private:
     GPUContextManager();
     ~GPUContextManager();
     
-    bool initialized_;
+    // Read from any thread (GPUExecutor, callers deciding where to run GL
+    // work); owner_ is written before initialized_ is published
+    std::atomic<bool> initialized_;
+    std::mutex init_mutex_;            // Serializes initialize() calls
+    std::thread::id owner_;
     int dri_fd_;
     struct gbm_device* gbm_;
     EGLDisplay display_;
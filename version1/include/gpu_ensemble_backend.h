@@ -0,0 +1,34 @@
+#pragma once
+#include "ensemble.h"
+#include "gpu_euler_backend.h"
+
+// Ensemble on the GPU: the member-major states are already the
+// concatenated layout the builtin Euler kernels expect, so all members
+// run as one GPU system. Only valid when the builtin RHS couples within
+// blocks that line up with member boundaries (see supports()).
+//
+// Like GPUEulerBackend, failures are reported on std::cerr; the final
+// states are left empty.
+class GPUEnsembleBackend : public EnsembleSolverBase {
+public:
+    void solve_ensemble(const ODESystem& system,
+                        double t0, double tf, double dt,
+                        const std::vector<double>& y0,
+                        int n_members,
+                        std::vector<double>& final_states) override;
+
+    std::string name() const override { return "GPU_Ensemble"; }
+
+    // Builtin GLSL RHS whose coupling_width divides system.dimension
+    bool supports(const ODESystem& system) const;
+
+    // Integrates members [0, n_members) of the raw arrays; used by the
+    // hybrid executor to hand the GPU one chunk at a time.
+    bool solve_members(const ODESystem& system, double t0, double tf, double dt,
+                       const double* y0, int n_members, double* final_states);
+
+    const GPUSolveStats& last_stats() const { return euler_.last_stats(); }
+
+private:
+    GPUEulerBackend euler_;
+};
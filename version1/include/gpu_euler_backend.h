@@ -4,13 +4,33 @@
 #include "gpu_buffer_manager.h"
 #include "builtin_rhs_registry.h"
 #include "gpu_context_manager.h"
+#include "gpu_timer_query.h"
 #include <GLES3/gl3.h>
 #include <GLES3/gl31.h>
 #include <unordered_map>
 
+// Statistics of the most recent solve() call
+struct GPUSolveStats {
+    int n_dispatches = 0;
+    double host_dispatch_seconds = 0.0;   // Inside glDispatchCompute (driver queueing)
+    double host_readback_seconds = 0.0;   // Map + copy of the state buffer
+    bool gpu_timing_available = false;    // GL_EXT_disjoint_timer_query results present
+    double gpu_dispatch_seconds = 0.0;    // Kernel execution time measured on the GPU
+    
+    double mean_gpu_dispatch_us() const {
+        return n_dispatches ? gpu_dispatch_seconds * 1e6 / n_dispatches : 0.0;
+    }
+    // Host-side cost per dispatch that is not GPU execution
+    double mean_driver_overhead_us() const {
+        return n_dispatches ? host_dispatch_seconds * 1e6 / n_dispatches : 0.0;
+    }
+};
+
+// compensated: float state updates carry their rounding error on the GPU
+// (ShaderGenerator's compensated Euler shader), at one extra buffer
 class GPUEulerBackend : public SolverBase {
 public:
-    GPUEulerBackend();
+    explicit GPUEulerBackend(bool compensated = false);
     ~GPUEulerBackend();
     
     void solve(const ODESystem& system, 
@@ -18,15 +38,38 @@ public:
               const std::vector<double>& y0,
               std::vector<std::vector<double>>& solution) override;
     
-    std::string name() const override { return "GPU_Euler"; }
+    // Same integration keeping only the state at the last grid point: no
+    // time-series buffer and one readback at the end. Failures are reported
+    // on std::cerr and return false.
+    bool solve_final(const ODESystem& system,
+                     double t0, double tf, double dt,
+                     const double* y0, size_t n_values,
+                     double* final_state);
+    
+    std::string name() const override { return compensated_ ? "GPU_Euler_Compensated" : "GPU_Euler"; }
+    
+    const GPUSolveStats& last_stats() const { return stats_; }
+    const GPUTimerQueries& timer_queries() const { return gpu_timer_; }
 
 protected:
     GLuint get_or_compile_shader(const ODESystem& system);
     void setup_uniforms(const ODESystem& system, SystemParams& params);
 
 private:
+    // Dispatches n_steps Euler steps from state. With rows, each step is read
+    // back into rows[step + 1]; without, state receives only the final values.
+    bool integrate(const ODESystem& system, double t0, double dt, int n_steps,
+                   std::vector<float>& state,
+                   std::vector<std::vector<double>>* rows);
+    
     // Shader and buffer management
     ShaderGenerator shader_gen_;
     GPUBufferManager buffer_mgr_;
     std::unordered_map<std::string, GLuint> shader_cache_;
+    
+    // Per-dispatch GPU timing (no-op when the extension is missing)
+    GPUTimerQueries gpu_timer_;
+    GPUSolveStats stats_;
+    std::vector<float> state_;  // Float staging of y0 and the readback
+    bool compensated_;
 }; 
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+#include "mpsc_queue.h"
+#include <GLES3/gl3.h>
+#include <GLES3/gl31.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// The one thread that talks to the GPU. GL contexts are current on a single
+// thread, so the executor thread initializes GPUContextManager and then runs
+// every GL command it is handed, in submission order.
+//
+// Any thread may submit: commands go through a lock-free MPSC queue and
+// complete through std::future. The thread starts on the first submission.
+// Typed commands follow the GPU code's error convention (false / 0 / empty
+// on failure, details on std::cerr); exceptions thrown by submit()ted
+// callables are delivered through their future.
+//
+// Blocking on a future from inside a command deadlocks; use
+// run_on_gpu_thread() in code that may already be on the executor.
+class GPUExecutor {
+public:
+    static GPUExecutor& instance();
+
+    // Run fn() on the GPU thread
+    template <typename Fn>
+    auto submit(Fn&& fn) -> std::future<typename std::invoke_result<Fn>::type> {
+        using Result = typename std::invoke_result<Fn>::type;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+        std::future<Result> future = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return future;
+    }
+
+    // Run fn() on the GPU thread and wait; runs inline when already there
+    template <typename Fn>
+    auto run_on_gpu_thread(Fn&& fn) -> typename std::invoke_result<Fn>::type {
+        if (on_executor_thread()) {
+            return fn();
+        }
+        return submit(std::forward<Fn>(fn)).get();
+    }
+
+    // Creates the EGL context on the executor thread (idempotent)
+    std::future<bool> initialize();
+
+    std::future<GLuint> compile(std::string source);
+    // Copy floats into an SSBO at a float offset
+    std::future<bool> upload(GLuint buffer, std::vector<float> data, int offset = 0);
+    // glUseProgram + glDispatchCompute (+ SSBO barrier)
+    std::future<bool> dispatch(GLuint program, GLuint groups_x, GLuint groups_y = 1,
+                               GLuint groups_z = 1, bool barrier = true);
+    std::future<std::vector<float>> readback(GLuint buffer, int count, int offset = 0);
+
+    bool on_executor_thread() const;
+    std::uint64_t commands_executed() const { return executed_.load(std::memory_order_relaxed); }
+
+    GPUExecutor(const GPUExecutor&) = delete;
+    GPUExecutor& operator=(const GPUExecutor&) = delete;
+
+private:
+    GPUExecutor();
+    ~GPUExecutor();
+
+    void enqueue(std::function<void()> command);
+    void thread_loop();
+    bool ensure_context();
+
+    MPSCQueue<std::function<void()>> queue_;
+    std::once_flag start_once_;
+    std::thread thread_;
+    std::atomic<std::thread::id> thread_id_;
+    std::atomic<bool> stop_;
+    std::atomic<std::uint64_t> executed_;
+
+    // Sleep/wake handshake; producers only take the mutex when the
+    // executor is actually asleep
+    std::atomic<bool> sleeping_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+};
@@ -0,0 +1,103 @@
+#pragma once
+#include <GLES3/gl3.h>
+#include <GLES3/gl31.h>
+#include <GLES2/gl2ext.h>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// GPU-side execution time of individual dispatches via
+// GL_EXT_disjoint_timer_query. Host timers around glDispatchCompute only see
+// driver queueing; these measure the kernel itself.
+//
+// Results are collected asynchronously: end() just queues the query and
+// poll() picks up whatever the GPU has finished, so timing never forces a
+// pipeline stall. Query objects live in a fixed ring created by
+// initialize() and labels are registered once as integer IDs, so timing a
+// dispatch inside a hot loop does not allocate; names are only looked up
+// when the summaries are read. When the extension is missing (or the driver reports a
+// disjoint event) the summaries stay empty - callers fall back to
+// host timing.
+struct GPUTimingSummary {
+    std::uint64_t count = 0;
+    std::uint64_t total_ns = 0;
+    std::uint64_t min_ns = 0;
+    std::uint64_t max_ns = 0;
+
+    double mean_ns() const { return count ? static_cast<double>(total_ns) / count : 0.0; }
+};
+
+class GPUTimerQueries {
+public:
+    GPUTimerQueries();
+    ~GPUTimerQueries();
+
+    // Detect the extension and load its entry points. Requires a current
+    // GL context (GPUContextManager::initialize()).
+    bool initialize();
+    bool is_supported() const { return supported_; }
+
+    // Register a label before the timed loop; the same label always gets
+    // the same ID
+    int label_id(const std::string& label);
+
+    // Time the GL commands issued between begin() and end(). GL allows only
+    // one active GL_TIME_ELAPSED_EXT query, so scopes must not nest. When
+    // every query of the ring is still in flight the scope is skipped and
+    // counted in dropped().
+    void begin(int label_id);
+    void end();
+
+    // Collect completed queries without blocking; returns how many landed
+    int poll();
+
+    // Block until every pending query has a result (call after the solve)
+    void finish();
+
+    std::map<std::string, GPUTimingSummary> summaries() const;
+    GPUTimingSummary summary(const std::string& label) const;
+    std::uint64_t disjoint_events() const { return disjoint_events_; }
+    std::uint64_t dropped() const { return dropped_; }
+
+    static constexpr int kRingSize = 64;
+
+    // Drop collected summaries (pending queries are kept)
+    void reset();
+
+    GPUTimerQueries(const GPUTimerQueries&) = delete;
+    GPUTimerQueries& operator=(const GPUTimerQueries&) = delete;
+
+private:
+    struct RingSlot {
+        GLuint query;
+        int label;
+    };
+
+    bool check_disjoint();
+    void collect(const RingSlot& slot);
+    void discard_pending();
+
+    bool supported_;
+    bool initialized_;
+    bool active_;
+    std::uint64_t disjoint_events_;
+    std::uint64_t dropped_;
+
+    // Pending queries are ring_[head_], ..., ring_[head_ + pending_ - 1]
+    // (mod kRingSize); the active one, if any, is the slot after them
+    std::vector<RingSlot> ring_;
+    int head_;
+    int pending_;
+
+    // Indexed by label ID
+    std::vector<std::string> labels_;
+    std::vector<GPUTimingSummary> totals_;
+
+    PFNGLGENQUERIESEXTPROC gen_queries_;
+    PFNGLDELETEQUERIESEXTPROC delete_queries_;
+    PFNGLBEGINQUERYEXTPROC begin_query_;
+    PFNGLENDQUERYEXTPROC end_query_;
+    PFNGLGETQUERYOBJECTUIVEXTPROC get_query_uiv_;
+    PFNGLGETQUERYOBJECTUI64VEXTPROC get_query_ui64v_;
+};
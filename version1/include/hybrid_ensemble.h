@@ -0,0 +1,98 @@
+#pragma once
+#include "ensemble.h"
+#include "gpu_ensemble_backend.h"
+#include <memory>
+#include <mutex>
+
+struct HybridOptions {
+    int cpu_chunk = 0;           // Members per CPU grab (0 = auto)
+    int gpu_min_chunk = 4096;    // Smallest GPU grab, amortises dispatch/readback
+    double initial_gpu_share = 0.5;  // GPU fraction before any throughput is measured
+};
+
+// How the last solve was shared out
+struct HybridStats {
+    long long gpu_members = 0;   // Members [0, gpu_members), solved in float
+    long long cpu_members = 0;
+    int gpu_chunks = 0;
+    int cpu_chunks = 0;
+    double gpu_rate = 0.0;       // Member-steps per second
+    double cpu_rate = 0.0;       // Member-steps per second, all CPU workers
+    bool gpu_failed = false;
+};
+
+// Co-schedules one ensemble on the GPU and the CPU cores at once.
+//
+// The member range is consumed from both ends: the GPU feeder (the calling
+// thread, which owns the GL context) takes large chunks from the front,
+// CPU workers take small chunks from the back. Each GPU chunk is sized from
+// the measured GPU/CPU throughput ratio over what is left (guided
+// scheduling), so both sides run out of work at about the same time; the
+// GPU stops taking chunks once the CPU would finish the rest sooner.
+// Throughput estimates carry over between solves.
+//
+// Every chunk writes straight into its members' slots, so the output is in
+// member order regardless of who ran what.
+//
+// Precision is mixed: GPU chunks integrate in float (the kernels' state
+// type) and CPU chunks in double with the given stepper. Members
+// [0, last_stats().gpu_members) come from the GPU and differ from
+// CPUEnsembleBackend by float rounding (about 1e-6 relative for short
+// runs); the rest match it bit for bit. How many members land on the GPU
+// depends on measured throughput, so use set_gpu_enabled(false) when every
+// member must be double precision. Falls back to CPU only when the
+// method is not "euler", the system has no packable GPU RHS, or a GPU chunk
+// fails (that chunk is then redone on the CPU).
+//
+// Not thread-safe: the work range, throughput estimates and last_stats()
+// belong to the executor, so run one solve at a time (or use one executor
+// per calling thread).
+class HybridEnsembleExecutor : public EnsembleSolverBase {
+public:
+    // method: any name accepted by create_stepper (GPU share needs "euler")
+    HybridEnsembleExecutor(const std::string& method, ThreadPool& pool,
+                           const HybridOptions& options = HybridOptions());
+
+    void solve_ensemble(const ODESystem& system,
+                        double t0, double tf, double dt,
+                        const std::vector<double>& y0,
+                        int n_members,
+                        std::vector<double>& final_states) override;
+
+    std::string name() const override { return "Hybrid_Ensemble_" + method_; }
+
+    void set_gpu_enabled(bool enabled) { gpu_enabled_ = enabled; }
+    bool gpu_usable(const ODESystem& system) const;
+
+    const HybridStats& last_stats() const { return stats_; }
+    const HybridOptions& options() const { return options_; }
+
+private:
+    // Claims the next chunk; false when no members are left
+    bool take_cpu_chunk(int chunk, long long& begin, long long& end);
+    bool take_gpu_chunk(int steps, long long& begin, long long& end);
+    void run_cpu_worker(int worker, const ODESystem& system, double t0, double dt, int steps,
+                        const std::vector<double>& y0, std::vector<double>& final_states,
+                        int chunk);
+
+    std::string method_;
+    ThreadPool& pool_;
+    HybridOptions options_;
+    bool gpu_enabled_;
+
+    std::vector<std::unique_ptr<TimeStepper>> steppers_;
+    std::vector<std::vector<double>> member_y_;
+    GPUEnsembleBackend gpu_;
+
+    // Work range shared by the GPU feeder and CPU workers: [front_, back_)
+    std::mutex range_mutex_;
+    long long front_;
+    long long back_;
+
+    // Throughput estimates, member-steps per second (0 = not measured yet)
+    double gpu_rate_;
+    double cpu_worker_rate_;
+    int cpu_workers_;
+
+    HybridStats stats_;
+};
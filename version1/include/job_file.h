@@ -0,0 +1,97 @@
+#pragma once
+#include "solver_base.h"
+#include "rhs_expr.h"
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// One concrete solve out of a job file's sweep
+struct JobInstance {
+    std::uint64_t index = 0;
+    std::string problem;
+    int dimension = 0;
+    std::map<std::string, double> parameters;
+    std::string method;
+    std::string backend;
+    double t0 = 0.0, tf = 1.0, dt = 0.01;
+    std::vector<double> y0;
+};
+
+// Declarative sweep description, one "key value..." line each, # comments:
+//
+//   problem   vanderpol            # TestProblems::create() name
+//   rhs       dy0 = y1; dy1 = -k*y0  # Or a custom RHS (RHSProgram text,
+//                                  # ';' between statements), JIT-compiled
+//   dimension 2                    # Optional for fixed-size problems
+//   param     mu linspace(0.5, 4, 8)
+//   y0        2.0 0.0              # Base state (default: the problem's own)
+//   y0[0]     1.0, 1.5, 2.0        # Sweep one component
+//   samples   16                   # Random draws per grid point ...
+//   perturb   0.05                 # ... each component +-0.05 uniform
+//   seed      42
+//   t0        0                    # Default: the problem's t_start ...
+//   tf        5, 10, 20            # ... and t_end
+//   dt        0.01
+//   method    euler, rk45
+//   backend   auto                 # Any SolveOptions::backend
+//   output    sweep.traj           # Default: <job file stem>.traj
+//   record    final                # final (last row only) or full
+//
+// Value lists are comma/space separated numbers or words, or
+// linspace(a, b, n) / logspace(a, b, n) (10^a .. 10^b). The sweep is the
+// cartesian product of every list-valued key in file order, the last one
+// varying fastest, times `samples`. Jobs are computed from their index on
+// demand, so a million-job sweep costs no memory until it runs.
+class JobSpec {
+public:
+    // Parse errors throw std::invalid_argument naming the file and line
+    static JobSpec parse_file(const std::string& path);
+    static JobSpec parse(std::istream& in, const std::string& source_name = "<job>");
+
+    std::uint64_t size() const;
+    JobInstance job(std::uint64_t index) const;
+    ODESystem system_for(const JobInstance& job) const;
+
+    // Hash of everything that determines the jobs (not the output path);
+    // a trajectory file only resumes against the sweep that started it
+    std::uint64_t fingerprint() const;
+
+    const std::string& problem() const { return problem_; }
+    int dimension() const { return dimension_; }
+    const std::string& output_path() const { return output_; }
+    void set_output_path(const std::string& path) { output_ = path; }
+    bool final_only() const { return final_only_; }
+
+    static std::string describe(const JobInstance& job);
+
+private:
+    enum class AxisKind { Parameter, State, T0, Tf, Dt, Method, Backend };
+
+    // One key of the file; single values are axes of length one
+    struct Axis {
+        AxisKind kind;
+        std::string key;                  // As written: "mu", "y0[2]", "method", ...
+        int component = -1;               // State axes
+        std::vector<double> numbers;      // Numeric keys
+        std::vector<std::string> words;   // method / backend
+        size_t size() const { return words.empty() ? numbers.size() : words.size(); }
+    };
+
+    const Axis* find_axis(AxisKind kind, const std::string& key) const;
+    void finish(const std::string& source_name);
+
+    std::string problem_;
+    std::string rhs_text_;
+    std::shared_ptr<const RHSProgram> rhs_;   // Parsed rhs_text_, if any
+    int dimension_ = 0;
+    std::vector<Axis> axes_;          // File order
+    std::vector<double> base_y0_;
+    std::uint64_t samples_ = 1;
+    double perturb_ = 0.0;
+    std::uint64_t seed_ = 0;
+    std::string output_;
+    bool final_only_ = true;
+};
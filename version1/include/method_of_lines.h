@@ -0,0 +1,130 @@
+#pragma once
+#include "solver_base.h"
+#include <array>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Method of lines on structured grids: a PDE u_t = R(u) + D lap(u) - v.grad(u)
+// is discretized in space with second-order finite differences and handed
+// to the ODE backends as one large ODESystem.
+//
+// State layout: component-major, then z-planes, then y-rows, x fastest.
+// Rows are padded to a multiple of 8 doubles (64 bytes), plus one more
+// cache line when that would make the row a multiple of 4 KiB, so every
+// row starts at the same alignment and vertically adjacent points do not
+// alias in the cache. Padding entries are part of the ODE state but have
+// a zero derivative, so they keep their initial value (0 from
+// initial_state()).
+
+// Grid points per boundary kind, on an axis of length L with n points:
+//   Periodic   x_i = i h,        h = L / n
+//   Dirichlet  x_i = (i + 1) h,  h = L / (n + 1); the end nodes 0 and L
+//              hold the boundary value and are not unknowns
+//   Neumann    x_i = i h,        h = L / (n - 1); zero flux, the ghost
+//              point mirrors the first interior one
+enum class Boundary { Periodic, Dirichlet, Neumann };
+
+// Point counts and extents; spacing depends on the boundary kind and is
+// reported by MethodOfLines
+class Grid {
+public:
+    Grid(int nx, double lx);
+    Grid(int nx, int ny, double lx, double ly);
+    Grid(int nx, int ny, int nz, double lx, double ly, double lz);
+
+    int dimensions() const { return dimensions_; }
+    int points(int axis) const { return n_[axis]; }
+    double length(int axis) const { return length_[axis]; }
+    int row_stride() const { return row_stride_; }
+    long long point_count() const { return static_cast<long long>(n_[0]) * n_[1] * n_[2]; }
+    // Doubles per component including row padding
+    long long field_size() const { return static_cast<long long>(row_stride_) * n_[1] * n_[2]; }
+    long long index(int i, int j = 0, int k = 0) const {
+        return (static_cast<long long>(k) * n_[1] + j) * row_stride_ + i;
+    }
+
+private:
+    int dimensions_;
+    std::array<int, 3> n_;
+    std::array<double, 3> length_;
+    int row_stride_;
+};
+
+// Nonzero pattern of the RHS Jacobian in compressed-row form, for implicit
+// steppers: row r depends on y[columns[row_start[r] .. row_start[r + 1])].
+// Bandwidths are max(r - c) and max(c - r) over the pattern (periodic
+// boundaries wrap, which widens them to the whole field).
+struct JacobianPattern {
+    std::vector<long long> row_start;
+    std::vector<long long> columns;
+    long long lower_bandwidth = 0;
+    long long upper_bandwidth = 0;
+    long long nonzeros() const { return static_cast<long long>(columns.size()); }
+};
+
+class MethodOfLines {
+public:
+    // Reaction term of one component over n consecutive points of a row:
+    // u[c] points at component c, out receives the rate of `component`.
+    // Called once per row, so a plain loop over n vectorizes.
+    using Reaction = std::function<void(double t, int component, const double* const* u, double* out, int n)>;
+    // Initial value of component c at (x, y, z)
+    using InitialValue = std::function<double(int component, double x, double y, double z)>;
+
+    MethodOfLines(const Grid& grid, int components);
+
+    // Same condition on both ends of an axis, for every component
+    void set_boundary(int axis, Boundary kind);
+    // Value a component takes outside Dirichlet boundaries (default 0)
+    void set_boundary_value(int component, double value);
+    void set_diffusion(int component, double coefficient);
+    // First-order upwind advection -velocity . grad(u)
+    void set_advection(int component, std::array<double, 3> velocity);
+    // Without one, R = 0. The reaction of a component is assumed to depend
+    // on every component at the same point (see jacobian_pattern()).
+    void set_reaction(Reaction reaction);
+
+    const Grid& grid() const { return grid_; }
+    int components() const { return components_; }
+    long long dimension() const { return grid_.field_size() * components_; }
+    double spacing(int axis) const;
+    double coordinate(int axis, int i) const;
+
+    // rhs_range writes whole padded rows' worth of entries and is what
+    // ThreadedCPUBackend splits across cores; rhs_inplace and rhs run it
+    // over the full range. The operator is copied into the system.
+    ODESystem system(const std::string& name = "method_of_lines") const;
+    std::vector<double> initial_state(const InitialValue& value) const;
+
+    // Writes dydt[begin, end) (any alignment to rows)
+    void evaluate(double t, const double* y, double* dydt, long long begin, long long end) const;
+
+    // Standalone stencils on one component field (field_size() doubles,
+    // with this operator's boundary conditions for `component`); out gets
+    // zeros in the padding
+    void laplacian(int component, const double* u, double* out) const;
+    void gradient(int component, int axis, const double* u, double* out) const;   // Central differences
+
+    JacobianPattern jacobian_pattern() const;
+
+    // 2D Brusselator reaction-diffusion on the periodic unit square:
+    //   u_t = a - (b + 1) u + u^2 v + alpha lap(u)
+    //   v_t = b u - u^2 v + alpha lap(v)
+    static MethodOfLines brusselator_2d(int n, double a = 1.0, double b = 3.4, double alpha = 0.002);
+    // Smooth perturbation of the homogeneous steady state (a, b / a)
+    static std::vector<double> brusselator_initial_state(const MethodOfLines& mol, double a = 1.0, double b = 3.4);
+
+private:
+    long long neighbour(int axis, int side, int i, int j, int k) const;
+    void row(double t, const double* y, double* dydt, int c, int j, int k, int i0, int i1) const;
+
+    Grid grid_;
+    int components_;
+    std::array<Boundary, 3> boundary_;
+    std::vector<double> boundary_value_;
+    std::vector<double> diffusion_;
+    std::vector<std::array<double, 3>> velocity_;
+    Reaction reaction_;
+    std::vector<double> ghost_rows_;   // Dirichlet value rows, one per component
+};
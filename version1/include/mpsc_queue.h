@@ -0,0 +1,90 @@
+#pragma once
+#include <atomic>
+#include <utility>
+
+// Unbounded multi-producer / single-consumer queue (Vyukov's intrusive
+// node queue). push() is wait-free: one atomic exchange plus one store, no
+// locks, so any thread can enqueue without contending with the consumer.
+// pop() must only be called from the single consumer thread.
+//
+// A push that is half-way done (exchange made, link not yet stored) makes
+// pop() report empty for that instant; the consumer simply retries.
+template <typename T>
+class MPSCQueue {
+public:
+    MPSCQueue() : head_(&stub_), tail_(&stub_) {
+        stub_.next.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~MPSCQueue() {
+        T discarded;
+        while (pop(discarded)) {}
+    }
+
+    void push(T value) {
+        push_node(new Node(std::move(value)));
+    }
+
+    // Consumer only. Returns false when the queue is (momentarily) empty.
+    bool pop(T& out) {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+
+        if (tail == &stub_) {
+            if (next == nullptr) return false;
+            tail_ = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next != nullptr) {
+            tail_ = next;
+            return take(tail, out);
+        }
+
+        // `tail` is the last linked node; only pop it if no push is racing
+        if (tail != head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        push_node(&stub_);
+
+        next = tail->next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            tail_ = next;
+            return take(tail, out);
+        }
+        return false;
+    }
+
+    // Consumer-side hint; may be stale by the time it returns
+    bool empty() const {
+        return tail_ == &stub_ && stub_.next.load(std::memory_order_acquire) == nullptr;
+    }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+private:
+    struct Node {
+        Node() = default;
+        explicit Node(T v) : value(std::move(v)) {}
+        std::atomic<Node*> next{nullptr};
+        T value;
+    };
+
+    void push_node(Node* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* previous = head_.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    static bool take(Node* node, T& out) {
+        out = std::move(node->value);
+        delete node;
+        return true;
+    }
+
+    std::atomic<Node*> head_;  // Producers append here
+    Node* tail_;               // Consumer pops here
+    Node stub_;
+};
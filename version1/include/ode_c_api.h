@@ -0,0 +1,95 @@
+#pragma once
+/*
+ * C interface to the CPU solvers (libode.so).
+ *
+ * Every array is caller-owned and contiguous: states are `dimension`
+ * doubles, trajectories are row-major (rows x dimension) with row k at
+ * t0 + k * dt, and ensembles are member-major (member m at
+ * [m * dimension, (m + 1) * dimension)). The library reads y0 and writes
+ * results in place; it never allocates trajectory- or ensemble-sized
+ * buffers of its own.
+ *
+ * Handles are opaque. A session holds the stepper workspaces and thread
+ * pool and is meant to be reused across solves; it must not be used from
+ * two threads at once (use one session per thread). Systems are immutable
+ * after creation and may be shared.
+ *
+ * No C++ exception crosses this interface: every call returns an
+ * ode_status, and ode_last_error() describes the last failure on the
+ * calling thread.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ODE_API __attribute__((visibility("default")))
+
+/* Bumped on any incompatible change to this header */
+#define ODE_API_VERSION 1
+
+typedef enum ode_status {
+    ODE_OK = 0,
+    ODE_ERR_INVALID_ARGUMENT = 1,   /* Null handle, bad sizes, dt <= 0, ... */
+    ODE_ERR_UNKNOWN_NAME = 2,       /* Problem, parameter or method name */
+    ODE_ERR_BUFFER_TOO_SMALL = 3,   /* Output smaller than ode_trajectory_rows() */
+    ODE_ERR_SOLVER = 4              /* Failure inside the solve */
+} ode_status;
+
+typedef struct ode_system ode_system;
+typedef struct ode_session ode_session;
+
+/* dydt = f(t, y); both arrays hold `dimension` doubles */
+typedef void (*ode_rhs_fn)(double t, const double* y, double* dydt, int dimension, void* user_data);
+
+typedef struct ode_session_config {
+    size_t struct_size;      /* sizeof(ode_session_config), for later extension */
+    const char* method;      /* "euler" or "rk45"; NULL = "rk45" */
+    int threads;             /* Ensemble worker threads; 0 = all hardware threads */
+} ode_session_config;
+
+ODE_API int ode_api_version(void);
+ODE_API const char* ode_status_string(ode_status status);
+/* Message for the last failed call on this thread; "" if none */
+ODE_API const char* ode_last_error(void);
+
+/* Systems ---------------------------------------------------------------- */
+
+/* Built-in test problem by name ("exponential", "vanderpol", "scalability"),
+ * with optional parameter overrides (may be NULL when n_params is 0) */
+ODE_API ode_status ode_system_create_builtin(const char* name, int dimension,
+                                             const char* const* param_names,
+                                             const double* param_values, int n_params,
+                                             ode_system** out);
+/* System whose right-hand side is a C callback; user_data is passed through */
+ODE_API ode_status ode_system_create_callback(int dimension, ode_rhs_fn rhs, void* user_data,
+                                              ode_system** out);
+ODE_API int ode_system_dimension(const ode_system* system);
+ODE_API void ode_system_destroy(ode_system* system);
+
+/* Sessions --------------------------------------------------------------- */
+
+ODE_API ode_status ode_session_create(const ode_session_config* config, ode_session** out);
+ODE_API void ode_session_destroy(ode_session* session);
+
+/* Rows a trajectory from t0 to tf with step dt has (0 for bad arguments) */
+ODE_API size_t ode_trajectory_rows(double t0, double tf, double dt);
+
+/* Full trajectory into out (capacity_rows x dimension doubles) */
+ODE_API ode_status ode_solve(ode_session* session, const ode_system* system,
+                             double t0, double tf, double dt, const double* y0,
+                             double* out, size_t capacity_rows);
+/* Final state only into y_final (dimension doubles); y_final may equal y0 */
+ODE_API ode_status ode_solve_final(ode_session* session, const ode_system* system,
+                                   double t0, double tf, double dt, const double* y0,
+                                   double* y_final);
+/* n_members independent copies of the system; final_states may equal y0 */
+ODE_API ode_status ode_solve_ensemble(ode_session* session, const ode_system* system,
+                                      double t0, double tf, double dt, const double* y0,
+                                      size_t n_members, double* final_states);
+
+#ifdef __cplusplus
+}
+#endif
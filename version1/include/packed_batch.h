@@ -0,0 +1,113 @@
+#pragma once
+#include "solver_base.h"
+#include "shader_generator.h"
+#include <GLES3/gl3.h>
+#include <GLES3/gl31.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Mixed batches: many small systems of different builtin types (exponential,
+// Van der Pol, Lorenz, harmonic, registered ones) that are each too small
+// to fill the GPU, integrated together in one dispatch per step.
+
+// One member of a batch. The system needs a builtin GPU RHS
+// (gpu_info->builtin_rhs_name) and must outlive the solve.
+struct PackedMember {
+    const ODESystem* system;
+    std::vector<double> y0;
+};
+
+// A run of members with the same RHS and dimension in the packed state
+struct PackedSegment {
+    int rhs_id;             // BuiltinRHS id
+    int first_equation;     // Multiple of the workgroup size and coupling width
+    int end_equation;       // first_equation + member_count * member_dimension
+    int member_dimension;
+    int first_member;       // Sorted position of the segment's first member
+    int member_count;
+    int param_base;         // parameters() offset of the first member
+    int param_count;        // Per member: the RHS's uniform count
+};
+
+// Where every member of a batch lives on the GPU. Members are sorted by
+// (RHS id, dimension), keeping their order otherwise, and each group
+// becomes a segment; segments start on a workgroup boundary so no
+// workgroup mixes types, and on a multiple of the coupling width so the
+// builtin RHS snippets index members correctly. Parameters follow
+// GPUEulerBackend: gpu_uniforms, or else the parameters named by the RHS.
+//
+// Throws std::invalid_argument for a member without a builtin GPU RHS,
+// a dimension the RHS cannot split into blocks, or a y0 of the wrong size.
+class PackedBatchLayout {
+public:
+    PackedBatchLayout(const std::vector<PackedMember>& members, int workgroup_size);
+
+    const std::vector<PackedSegment>& segments() const { return segments_; }
+    // Sorted position -> caller's member index
+    const std::vector<int>& order() const { return order_; }
+    // First equation of the caller's member `member`
+    int member_offset(int member) const { return offsets_[member]; }
+    // Total invocations, padding included: a multiple of the workgroup size
+    int padded_equations() const { return padded_equations_; }
+    int equations() const { return equations_; }
+    int workgroup_size() const { return workgroup_size_; }
+    // Distinct RHS ids, ascending
+    std::vector<int> rhs_ids() const;
+
+    const std::vector<float>& parameters() const { return parameters_; }
+    // Packed y0 of every member, zeros in the padding
+    const std::vector<float>& initial_state() const { return initial_state_; }
+    // Splits a packed state back into per-member states, in caller order
+    void unpack(const float* state, std::vector<std::vector<double>>& member_states) const;
+
+private:
+    int workgroup_size_;
+    int equations_;
+    int padded_equations_;
+    std::vector<PackedSegment> segments_;
+    std::vector<int> order_;
+    std::vector<int> offsets_;
+    std::vector<int> dimensions_;
+    std::vector<float> parameters_;
+    std::vector<float> initial_state_;
+};
+
+struct PackedBatchStats {
+    int members = 0;
+    int segments = 0;
+    int equations = 0;
+    int padded_equations = 0;
+    int n_dispatches = 0;
+    double seconds = 0.0;   // Upload, stepping and readback
+};
+
+// Explicit Euler over a packed batch on the GPU (float, like
+// GPUEulerBackend). The program for a set of RHS types is compiled once and
+// cached. Per step, only the time is uploaded; the state stays on the GPU
+// until the final readback.
+//
+// Like GPUEnsembleBackend, failures are reported on std::cerr and the final
+// states are left empty; invalid members throw (see PackedBatchLayout).
+class PackedBatchBackend {
+public:
+    static constexpr int kWorkgroupSize = 64;
+
+    ~PackedBatchBackend();
+
+    // Integrates every member from t0 to t0 + floor((tf - t0) / dt) * dt;
+    // final_states[m] is the state of members[m]
+    void solve_batch(const std::vector<PackedMember>& members,
+                     double t0, double tf, double dt,
+                     std::vector<std::vector<double>>& final_states);
+
+    std::string name() const { return "GPU_Packed_Batch"; }
+    const PackedBatchStats& last_stats() const { return stats_; }
+
+private:
+    GLuint get_or_compile_shader(const PackedBatchLayout& layout);
+
+    ShaderGenerator shader_gen_;
+    std::unordered_map<std::string, GLuint> shader_cache_;
+    PackedBatchStats stats_;
+};
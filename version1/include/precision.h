@@ -0,0 +1,65 @@
+#pragma once
+#include "solver_base.h"
+#include <algorithm>
+#include <memory>
+
+// Moving systems and states between precisions (see BasicODESystem).
+
+template <typename To, typename From>
+std::vector<To> convert_state(const std::vector<From>& state) {
+    return std::vector<To>(state.begin(), state.end());
+}
+
+// The same problem with state in To. The RHS still runs in From: each
+// evaluation converts y in and the rates out through per-thread buffers
+// (no allocation after the first call). rhs_range converts the whole of y,
+// since a range may read any of it. The RHS program is not carried over,
+// so batched evaluators fall back to the converted RHS.
+template <typename To, typename From>
+BasicODESystem<To> precision_cast(const BasicODESystem<From>& system) {
+    auto source = std::make_shared<const BasicODESystem<From>>(system);
+    BasicODESystem<To> cast;
+    cast.name = system.name;
+    cast.dimension = system.dimension;
+    cast.initial_conditions = convert_state<To>(system.initial_conditions);
+    cast.t_start = system.t_start;
+    cast.t_end = system.t_end;
+    cast.parameters = system.parameters;
+    cast.gpu_info = system.gpu_info;
+
+    if (system.rhs || system.rhs_inplace) {
+        cast.rhs_inplace = [source](double t, const std::vector<To>& y, std::vector<To>& dydt) {
+            thread_local std::vector<From> in, rate;
+            in.assign(y.begin(), y.end());
+            rate.resize(y.size());
+            source->evaluate_rhs(t, in, rate);
+            std::copy(rate.begin(), rate.end(), dydt.begin());
+        };
+        cast.rhs = [source](double t, const std::vector<To>& y) {
+            std::vector<From> in(y.begin(), y.end()), rate(y.size());
+            source->evaluate_rhs(t, in, rate);
+            return convert_state<To>(rate);
+        };
+    }
+    if (system.rhs_range) {
+        cast.rhs_range = [source](double t, const std::vector<To>& y, std::vector<To>& dydt, int begin, int end) {
+            thread_local std::vector<From> in, rate;
+            in.assign(y.begin(), y.end());
+            rate.resize(y.size());
+            source->rhs_range(t, in, rate, begin, end);
+            std::copy(rate.begin() + begin, rate.begin() + end, dydt.begin() + begin);
+        };
+    }
+    if (system.analytical_solution) {
+        cast.analytical_solution = [source](double t) { return convert_state<To>(source->analytical_solution(t)); };
+    }
+    return cast;
+}
+
+// Mixed mode: the steppers keep the state and every stage sum in double,
+// the RHS is evaluated in float. Rates carry float rounding (relative
+// 6e-8), but the O(dt) increments are no longer rounded away against the
+// state, which is what limits pure float runs over many small steps.
+inline ODESystem mixed_precision(const BasicODESystem<float>& system) {
+    return precision_cast<double>(system);
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Hot-path latency instrumentation: RAII scoped timers that nest into a
+// per-thread call tree, with an HDR-style histogram per tree node so reports
+// give p50/p99/max instead of a single mean.
+//
+//     void step() {
+//         ScopedTimer timer("step");
+//         { ScopedTimer rhs("rhs"); ... }
+//     }
+//     Profiler::instance().print_report(std::cout);
+//
+// Recording touches only the calling thread's tree; the first visit to a
+// new call path allocates its node, later visits do not allocate. Reports
+// merge all threads by call path and should be taken while the timed code
+// is quiescent. Timer names must be string literals.
+
+// Low-overhead monotonic clock. On AArch64 this reads the generic timer
+// (CNTVCT_EL0), which is constant-rate and synchronized across cores on the
+// Cortex-A53; elsewhere it uses clock_gettime(CLOCK_MONOTONIC_RAW), which is
+// not slewed by NTP.
+class ProfileClock {
+public:
+    static std::uint64_t now_ns();
+    static const char* source();  // "cntvct" or "monotonic_raw"
+};
+
+// Log-linear histogram of nanosecond latencies: 32 linear sub-buckets per
+// power of two, i.e. values are recorded with <= 3.2% relative error.
+// Covers 0 ns to ~2200 s in a fixed 9 KB array; no allocation on record().
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kMaxExponent = 40;
+    static constexpr int kBucketCount = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+    LatencyHistogram();
+
+    void record(std::uint64_t value_ns);
+    void merge(const LatencyHistogram& other);
+    void reset();
+
+    std::uint64_t count() const { return count_; }
+    std::uint64_t total_ns() const { return total_ns_; }
+    std::uint64_t min_ns() const { return count_ ? min_ns_ : 0; }
+    std::uint64_t max_ns() const { return max_ns_; }
+    double mean_ns() const { return count_ ? static_cast<double>(total_ns_) / count_ : 0.0; }
+
+    // Value at percentile p in [0, 100]
+    std::uint64_t percentile_ns(double p) const;
+
+private:
+    static int bucket_index(std::uint64_t value);
+    static std::uint64_t bucket_upper_value(int index);
+
+    std::uint64_t counts_[kBucketCount];
+    std::uint64_t count_;
+    std::uint64_t total_ns_;
+    std::uint64_t min_ns_;
+    std::uint64_t max_ns_;
+};
+
+struct ProfileReportEntry {
+    std::string path;   // e.g. "solve/step/rhs"
+    int depth;
+    std::uint64_t count;
+    std::uint64_t total_ns;
+    double mean_ns;
+    std::uint64_t p50_ns;
+    std::uint64_t p99_ns;
+    std::uint64_t max_ns;
+};
+
+class Profiler {
+public:
+    static Profiler& instance();
+
+    // Merged call tree of every thread, depth-first in first-seen order
+    std::vector<ProfileReportEntry> report() const;
+    void print_report(std::ostream& out) const;
+
+    // Histogram for one call path ("a/b/c"), merged over threads
+    LatencyHistogram histogram(const std::string& path) const;
+
+    // Zero every histogram (tree structure is kept)
+    void reset();
+
+    // Used by ScopedTimer
+    static int enter(const char* name);
+    static void exit(int node, std::uint64_t elapsed_ns);
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+private:
+    Profiler() = default;
+};
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char* name)
+        : node_(Profiler::enter(name)), start_ns_(ProfileClock::now_ns()) {}
+
+    ~ScopedTimer() {
+        Profiler::exit(node_, ProfileClock::now_ns() - start_ns_);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    int node_;
+    std::uint64_t start_ns_;
+};
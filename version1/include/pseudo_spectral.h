@@ -0,0 +1,134 @@
+#pragma once
+#include "fft.h"
+#include "solver_base.h"
+#include "steppers.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Pseudo-spectral discretization of scalar PDEs on periodic 1D and 2D
+// domains,
+//   u_t = L u + N(u),
+// with L diagonal in Fourier space (diffusion, hyperdiffusion, dispersion)
+// and N evaluated pointwise in physical space. Products are dealiased with
+// the 2/3 rule: the top third of modes on each axis is dropped from the
+// inputs and the result of every nonlinear evaluation.
+//
+// The stiff linear part is integrated exactly by the exponential steppers
+// below; the PseudoSpectral::system() form runs on the ordinary backends
+// (explicit steppers then need dt below the L-stability limit).
+//
+// Physical layout: ny rows of nx points, x fastest (ny = 1 in 1D).
+// Spectral layout: ny rows of nx / 2 + 1 coefficients (RealFFT2D).
+
+// u_t = laplacian lap(u) + biharmonic lap^2(u) + dispersion u_xxx
+//     + flux (d/dx + d/dy)(u^2) + gradient_squared |grad u|^2
+struct SpectralEquation {
+    double laplacian = 0.0;
+    double biharmonic = 0.0;
+    double dispersion = 0.0;
+    double flux = 0.0;
+    double gradient_squared = 0.0;
+
+    // u_t = nu u_xx - u u_x (in 2D: nu lap u - u (u_x + u_y))
+    static SpectralEquation burgers(double nu);
+    // u_t = -u_xxx - 6 u u_x
+    static SpectralEquation kdv();
+    // u_t = -u_xx - u_xxxx - u u_x
+    static SpectralEquation kuramoto_sivashinsky();
+    // u_t = -lap u - lap^2 u - |grad u|^2 / 2
+    static SpectralEquation kuramoto_sivashinsky_2d();
+};
+
+class PseudoSpectral {
+public:
+    using InitialValue = std::function<double(double x, double y)>;
+
+    // Point counts are powers of two
+    PseudoSpectral(int nx, double lx, const SpectralEquation& equation);
+    PseudoSpectral(int nx, int ny, double lx, double ly, const SpectralEquation& equation);
+
+    int dimensions() const { return ny_ > 1 ? 2 : 1; }
+    int points(int axis) const { return axis == 0 ? nx_ : ny_; }
+    double length(int axis) const { return axis == 0 ? lx_ : ly_; }
+    int size() const { return nx_ * ny_; }
+    int modes() const { return (nx_ / 2 + 1) * ny_; }
+    double coordinate(int axis, int i) const { return i * length(axis) / points(axis); }
+    const SpectralEquation& equation() const { return equation_; }
+    // L per mode
+    const std::vector<Complex>& linear() const { return linear_; }
+
+    void to_spectral(const double* u, Complex* u_hat) const;
+    void to_physical(const Complex* u_hat, double* u) const;
+    // Dealiased N(u) from the coefficients of u
+    void nonlinear(const Complex* u_hat, Complex* n_hat) const;
+    // u_t in physical space
+    void evaluate(const double* u, double* dudt) const;
+
+    // The operator is copied into the system
+    ODESystem system(const std::string& name = "pseudo_spectral") const;
+    std::vector<double> initial_state(const InitialValue& value) const;
+
+private:
+    int nx_;
+    int ny_;
+    double lx_;
+    double ly_;
+    SpectralEquation equation_;
+    RealFFT2D fft_;
+    std::vector<Complex> linear_;
+    std::vector<double> mask_;          // 2/3 rule, 1 kept / 0 dropped
+    std::vector<Complex> dx_;           // i kx, Nyquist zeroed
+    std::vector<Complex> dy_;           // i ky, Nyquist zeroed
+};
+
+// Exponential steppers in Fourier space. step() takes the physical state
+// (PseudoSpectral::size() values, the system argument is only checked for
+// size) and transforms around step_spectral(), which is the cheaper entry
+// point for long runs. Coefficients are rebuilt when dt changes.
+
+// Integrating-factor RK4: classical RK4 on v = exp(-L t) u_hat
+class IntegratingFactorRK4Stepper : public TimeStepper {
+public:
+    explicit IntegratingFactorRK4Stepper(std::shared_ptr<const PseudoSpectral> op);
+
+    void step(const ODESystem& system, double t, double dt, std::vector<double>& y) override;
+    void step_spectral(double dt, Complex* u_hat);
+
+    std::string name() const override { return "IF_RK4"; }
+    int order() const override { return 4; }
+
+private:
+    void prepare(double dt);
+
+    std::shared_ptr<const PseudoSpectral> op_;
+    double dt_ = 0.0;
+    std::vector<Complex> half_;         // exp(L dt / 2)
+    std::vector<Complex> full_;         // exp(L dt)
+    std::vector<Complex> u_hat_, a_, b_, c_, d_, stage_;
+};
+
+// Cox-Matthews ETDRK4, with the phi-function coefficients evaluated by
+// contour integrals around each h L (Kassam & Trefethen) so small and
+// purely imaginary h L lose no digits to cancellation
+class ETDRK4Stepper : public TimeStepper {
+public:
+    static constexpr int kContourPoints = 32;
+
+    explicit ETDRK4Stepper(std::shared_ptr<const PseudoSpectral> op);
+
+    void step(const ODESystem& system, double t, double dt, std::vector<double>& y) override;
+    void step_spectral(double dt, Complex* u_hat);
+
+    std::string name() const override { return "ETD_RK4"; }
+    int order() const override { return 4; }
+
+private:
+    void prepare(double dt);
+
+    std::shared_ptr<const PseudoSpectral> op_;
+    double dt_ = 0.0;
+    std::vector<Complex> e_, e2_, q_, f1_, f2_, f3_;
+    std::vector<Complex> u_hat_, a_, b_, c_, nv_, na_, nb_, nc_;
+};
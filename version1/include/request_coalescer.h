@@ -0,0 +1,120 @@
+#pragma once
+#include "solver_base.h"
+#include "auto_dispatcher.h"
+#include "profiler.h"
+#include "thread_pool.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct CoalescerOptions {
+    // How long the first request of a group waits for company. 0 still
+    // merges whatever queued up while the previous batch was running.
+    double window_seconds = 0.002;
+    int max_batch = 4096;           // A group this large is dispatched at once
+};
+
+struct CoalescedResult {
+    std::vector<double> final_state;
+    std::string backend;            // Ensemble backend that ran the batch
+    std::uint32_t batch_size = 1;
+    double wait_seconds = 0.0;      // Submit -> batch dispatch
+    double run_seconds = 0.0;       // Batch solve
+};
+
+struct CoalescerMetrics {
+    std::uint64_t requests = 0;
+    std::uint64_t batches = 0;
+    std::uint64_t full_flushes = 0;    // Dispatched on reaching max_batch
+    std::uint64_t window_flushes = 0;  // Dispatched when the window ran out
+    std::uint64_t largest_batch = 0;
+    LatencyHistogram wait;             // Per request: latency added by holding it
+    LatencyHistogram run;              // Per batch: ensemble solve time
+
+    // Batching efficiency: solves saved per dispatch
+    double mean_batch_size() const {
+        return batches ? static_cast<double>(requests) / batches : 0.0;
+    }
+};
+
+// Merges independent small solves into ensemble dispatches.
+//
+// Requests are grouped by batch_key(): same RHS (builtin_rhs_name, or the
+// same RHSProgram object; systems with any other callable are never
+// merged), parameter values and GPU uniforms, dimension, stepper and time
+// grid. A
+// group is held until its oldest request has waited window_seconds or it
+// reaches max_batch, then its initial states are packed member-major and
+// solved with one AutoDispatcher::solve_ensemble() call - CPU, GPU,
+// hybrid, or the RHS VM for interpreted programs, whichever the cost model
+// picks for that ensemble size - and the final states are split back to
+// the callers' futures.
+//
+// The window trades per-request latency for dispatch count; metrics()
+// reports both sides. Destruction dispatches what is still held.
+class RequestCoalescer {
+public:
+    RequestCoalescer(ThreadPool& pool,
+                     const CostCalibration& calibration = CostCalibration::defaults(),
+                     const CoalescerOptions& options = CoalescerOptions());
+    ~RequestCoalescer();
+
+    // Final state after integrating y0 from t0 to tf. Bad arguments throw
+    // std::invalid_argument here; solver failures arrive through the future.
+    std::future<CoalescedResult> submit(const ODESystem& system, const std::string& method,
+                                        double t0, double tf, double dt, std::vector<double> y0);
+
+    // Tunable while running; applies to groups opened afterwards
+    void set_options(const CoalescerOptions& options);
+    CoalescerOptions options() const;
+
+    CoalescerMetrics metrics() const;
+    void reset_metrics();
+
+    static std::string batch_key(const ODESystem& system, const std::string& method,
+                                 double t0, double tf, double dt);
+
+    RequestCoalescer(const RequestCoalescer&) = delete;
+    RequestCoalescer& operator=(const RequestCoalescer&) = delete;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Request {
+        std::vector<double> y0;
+        std::promise<CoalescedResult> promise;
+        Clock::time_point submitted;
+    };
+    struct Group {
+        ODESystem system;           // From the first request
+        std::string method;
+        double t0 = 0.0, tf = 0.0, dt = 0.0;
+        Clock::time_point deadline;
+        bool full = false;
+        std::vector<std::unique_ptr<Request>> requests;
+    };
+
+    void flush_loop();
+    void run_group(Group& group);
+
+    AutoDispatcher euler_;
+    AutoDispatcher rk45_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    CoalescerOptions options_;
+    std::map<std::string, std::unique_ptr<Group>> open_;   // Still collecting
+    std::deque<std::unique_ptr<Group>> ready_;             // Full, dispatch next
+    bool stopping_;
+    CoalescerMetrics metrics_;
+
+    std::thread thread_;
+};
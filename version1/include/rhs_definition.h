@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+// GLSL RHS code reads uniform `name` through this macro, which
+// ShaderGenerator defines; the prefix keeps parameter names from colliding
+// with GLSL keywords, builtins or the templates' own identifiers
+inline std::string glsl_uniform_macro(std::string_view name) {
+    return "p_" + std::string(name);
+}
+
+struct RHSDefinition {
+    std::string glsl_code;
+    std::vector<std::string> uniform_names;   // Read as glsl_uniform_macro(name)
+    int problem_type_id;
+    // Equations only couple within aligned blocks of this many entries
+    // (1 = fully independent), so concatenated members stay independent
+    int coupling_width = 1;
+    std::string description;
+};
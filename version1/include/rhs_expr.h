@@ -0,0 +1,202 @@
+#pragma once
+#include "solver_base.h"
+#include "rhs_definition.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Expression IR for right-hand sides, so one definition drives every
+// backend: GLSL for ShaderGenerator, C++ source for batched CPU kernels,
+// an interpreted tape for ODESystem, and a symbolic Jacobian.
+//
+// Nodes are hash-consed as they are built: an expression that already
+// exists (same op and operands, with + and * operands in canonical order)
+// is returned instead of a copy, so common subexpressions are shared by
+// construction. Constant operands are folded. Node ids are a topological
+// order: operands always have smaller ids than their users.
+
+enum class RHSOp : std::uint8_t {
+    Const, State, Param, Time,                // Leaves
+    Add, Sub, Mul, Div,                       // Binary
+    Neg, Sin, Cos, Exp, Log, Sqrt, Tanh       // Unary
+};
+
+struct RHSNode {
+    RHSOp op;
+    int a = -1, b = -1;     // Operand node ids
+    int index = 0;          // State or parameter index
+    double value = 0.0;     // Const
+};
+
+class RHSProgram;
+
+// Handle to a node of an RHSProgram; build with the usual operators. Handles
+// point at the program object, so do not move or copy a program while
+// building it.
+struct RHSExpr {
+    RHSProgram* program = nullptr;
+    int id = -1;
+};
+
+class RHSProgram {
+public:
+    RHSProgram(const std::string& name, int dimension);
+
+    // Text form, one statement per line ('#' starts a comment):
+    //   param mu = 1.0          parameter with its default
+    //   let r = y0*y0 + y1*y1   named subexpression
+    //   dy1 = mu*(1 - y0^2)*y1 - y0
+    // State is y0..y{n-1} (or y[i]), time is t; +, -, *, /, ^ with an
+    // integer exponent, and sin cos exp log sqrt tanh. The dimension is one
+    // past the highest dy index; every dy must be assigned. Throws
+    // std::invalid_argument naming the line on errors.
+    static RHSProgram parse(const std::string& text, const std::string& name = "parsed");
+
+    RHSExpr state(int i);
+    RHSExpr time();
+    RHSExpr constant(double value);
+    // Parameters are indexed in declaration order (the GLSL uniform order);
+    // redeclaring a name returns the existing parameter
+    RHSExpr param(const std::string& name, double default_value);
+    void set_output(int i, RHSExpr expr);
+
+    RHSExpr unary(RHSOp op, RHSExpr x);
+    RHSExpr binary(RHSOp op, RHSExpr x, RHSExpr y);
+
+    const std::string& name() const { return name_; }
+    int dimension() const { return dimension_; }
+    const std::vector<RHSNode>& nodes() const { return nodes_; }
+    // dimension() entries for an RHS; dimension()^2 for a jacobian()
+    const std::vector<int>& outputs() const { return outputs_; }
+    const std::vector<std::string>& param_names() const { return param_names_; }
+    const std::vector<double>& param_defaults() const { return param_defaults_; }
+    int param_index(const std::string& name) const;   // -1 if absent
+    bool complete() const;                            // Every output set
+    // Nodes that are not leaves, i.e. the arithmetic left after CSE
+    int operation_count() const;
+
+    // Node ids reachable from the outputs, ascending (evaluation order)
+    std::vector<int> live_nodes() const;
+
+    // Program with dimension * dimension outputs, J[i * dimension + j] =
+    // d f_i / d y_j, built symbolically in the same hash-consed graph so the
+    // Jacobian shares subexpressions with f and with itself
+    RHSProgram jacobian() const;
+
+    // Parameter values in index order: defaults, then overrides by name
+    // (unknown names throw std::invalid_argument)
+    std::vector<double> param_values(const std::map<std::string, double>& overrides = {}) const;
+
+private:
+    struct NodeKey {
+        RHSOp op;
+        int a, b, index;
+        std::uint64_t bits;
+        bool operator==(const NodeKey& other) const {
+            return op == other.op && a == other.a && b == other.b && index == other.index &&
+                   bits == other.bits;
+        }
+    };
+    struct NodeKeyHash {
+        std::size_t operator()(const NodeKey& key) const;
+    };
+
+    int intern(RHSNode node);
+    RHSExpr wrap(int id) { return RHSExpr{this, id}; }
+    void check_owner(RHSExpr expr) const;
+
+    std::string name_;
+    int dimension_;
+    std::vector<RHSNode> nodes_;
+    std::unordered_map<NodeKey, int, NodeKeyHash> interned_;
+    std::vector<int> outputs_;
+    std::vector<std::string> param_names_;
+    std::vector<double> param_defaults_;
+};
+
+RHSExpr operator+(RHSExpr x, RHSExpr y);
+RHSExpr operator-(RHSExpr x, RHSExpr y);
+RHSExpr operator*(RHSExpr x, RHSExpr y);
+RHSExpr operator/(RHSExpr x, RHSExpr y);
+RHSExpr operator-(RHSExpr x);
+RHSExpr operator+(RHSExpr x, double y);
+RHSExpr operator-(RHSExpr x, double y);
+RHSExpr operator*(RHSExpr x, double y);
+RHSExpr operator/(RHSExpr x, double y);
+RHSExpr operator+(double x, RHSExpr y);
+RHSExpr operator-(double x, RHSExpr y);
+RHSExpr operator*(double x, RHSExpr y);
+RHSExpr operator/(double x, RHSExpr y);
+RHSExpr sin(RHSExpr x);
+RHSExpr cos(RHSExpr x);
+RHSExpr exp(RHSExpr x);
+RHSExpr log(RHSExpr x);
+RHSExpr sqrt(RHSExpr x);
+RHSExpr tanh(RHSExpr x);
+
+// Emitters -----------------------------------------------------------------
+
+// `float evaluate_rhs(uint eq_idx, float y_val, float t)` for the shader
+// templates: equations are grouped in blocks of dimension entries (one
+// member each), and parameters are the uniform macros ShaderGenerator
+// defines, in param_names() order. Throws std::invalid_argument beyond
+// kMaxGLSLParameters (the templates' user_uniforms[16]).
+inline constexpr int kMaxGLSLParameters = 16;
+std::string emit_glsl(const RHSProgram& program);
+RHSDefinition to_rhs_definition(const RHSProgram& program, int problem_type_id,
+                                const std::string& description);
+
+// C++ source for a batched kernel over structure-of-arrays members:
+//   extern "C" void <function>(double t, const double* y, double* dydt,
+//                              const double* params, int lanes, int stride)
+// where state i of lane l is y[i * stride + l]. The body is one loop over
+// lanes in SSA form with no calls but libm, so the compiler vectorizes it
+// across members. With baked_params, parameters are inlined as constants
+// and `params` is unused.
+std::string emit_cpp(const RHSProgram& program, const std::string& function_name,
+                     const std::vector<double>* baked_params = nullptr);
+
+// Interpreted evaluation: the live nodes flattened into a linear tape over
+// a register per node, with parameters fixed at construction. Thread-safe;
+// scratch registers are per thread.
+class RHSTape {
+public:
+    RHSTape(const RHSProgram& program, std::vector<double> params);
+
+    void evaluate(double t, const double* y, double* dydt) const;
+    int dimension() const { return dimension_; }
+    int outputs() const { return static_cast<int>(output_regs_.size()); }
+    int instructions() const { return static_cast<int>(code_.size()); }
+
+private:
+    struct Instruction {
+        RHSOp op;
+        int dst, a, b;
+    };
+
+    int dimension_;
+    int registers_;
+    std::vector<std::pair<int, double>> constants_;   // (register, value), incl. parameters
+    std::vector<std::pair<int, int>> state_loads_;     // (register, state index)
+    std::vector<int> time_regs_;
+    std::vector<Instruction> code_;
+    std::vector<int> output_regs_;
+};
+
+// ODESystem whose rhs / rhs_inplace run the tape (evaluate a Jacobian with
+// RHSTape(program.jacobian(), ...)). gpu_info carries the generated GLSL and
+// the parameter values as uniforms, so the emit_glsl limits apply.
+ODESystem to_ode_system(const RHSProgram& program,
+                        const std::map<std::string, double>& parameters = {});
+
+// The builtin systems, defined once: the generated builtin_rhs_table.h
+// carries their GLSL, and test_rhs_expr checks them against TestProblems
+class RHSLibrary {
+public:
+    static RHSProgram exponential();
+    static RHSProgram vanderpol();
+    static RHSProgram lorenz();
+    static RHSProgram harmonic();
+};
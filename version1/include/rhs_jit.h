@@ -0,0 +1,100 @@
+#pragma once
+#include "rhs_expr.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Native RHS kernels at runtime: an RHSProgram is rendered with emit_cpp,
+// compiled by the system compiler into a shared object and loaded with
+// dlopen. Objects are cached on disk under a hash of the source, compiler,
+// flags and (for -march=native) the resolved target CPU, so a definition
+// is compiled once per machine; later runs (and other processes) just load
+// it. The cache directory must be owned by the user and not writable by
+// others; a cached object that fails to load is rebuilt.
+
+struct JitOptions {
+    std::string compiler;    // "" = $ODE_JIT_CXX, else "c++"
+    // -ffp-contract=off keeps results bit-identical to the RHSTape fallback
+    std::string flags = "-O3 -march=native -ffp-contract=off";
+    std::string cache_dir;   // "" = $ODE_JIT_CACHE, else $XDG_CACHE_HOME/ode_jit, else ~/.cache/ode_jit
+};
+
+struct JitStats {
+    int compiles = 0;          // Compiler runs that succeeded
+    int disk_hits = 0;         // Loaded from the cache directory
+    int memory_hits = 0;       // Already loaded in this process
+    int failures = 0;          // Compile or load errors
+    double compile_seconds = 0.0;
+};
+
+// A loaded kernel with its parameter values. Thread-safe; the shared
+// object stays loaded while any kernel using it is alive.
+class JitKernel {
+public:
+    using Function = void (*)(double t, const double* y, double* dydt, const double* params,
+                              int lanes, int stride);
+
+    // Structure-of-arrays batch: state i of lane l at y[i * stride + l]
+    void evaluate_batch(double t, const double* y, double* dydt, int lanes, int stride) const {
+        function_(t, y, dydt, params_.data(), lanes, stride);
+    }
+    void evaluate(double t, const double* y, double* dydt) const {
+        function_(t, y, dydt, params_.data(), 1, 1);
+    }
+
+    const std::string& object_path() const;
+    bool parameters_baked() const { return baked_; }
+
+private:
+    friend class RHSJit;
+    struct Module;
+
+    std::shared_ptr<Module> module_;
+    Function function_ = nullptr;
+    std::vector<double> params_;
+    bool baked_ = false;
+};
+
+class RHSJit {
+public:
+    // Shared instance with default options (job files use it)
+    static RHSJit& instance();
+
+    explicit RHSJit(JitOptions options = {});
+
+    // With bake_parameters the values are compiled in as constants (fastest,
+    // one object per parameter set); otherwise one object serves every value
+    // and params are passed at call time. Returns nullptr when the compiler
+    // is missing or fails; last_error() has its output.
+    std::shared_ptr<const JitKernel> compile(const RHSProgram& program, const std::vector<double>& params,
+                                             bool bake_parameters = true);
+
+    // to_ode_system() with rhs / rhs_inplace running the native kernel, or
+    // the interpreted tape if compilation fails (reported once on stderr;
+    // rhs_interpreted stays set, so ensembles go to the batched VM)
+    ODESystem system(const RHSProgram& program, const std::map<std::string, double>& parameters = {},
+                     bool bake_parameters = true);
+
+    JitStats stats() const;
+    std::string last_error() const;
+    const std::string& cache_dir() const { return cache_dir_; }
+
+private:
+    std::shared_ptr<JitKernel::Module> load_module(const std::string& source, std::uint64_t key);
+    // Compiles source into stem + ".so"
+    bool build_object(const std::string& source, const std::string& stem);
+
+    JitOptions options_;
+    std::string cache_dir_;
+    std::string compiler_id_;      // `compiler --version`, part of the cache key
+    std::string target_id_;        // What -march=native resolves to, part of the cache key
+    bool cache_dir_checked_ = false;
+    mutable std::mutex mutex_;     // Held across compiles: one compiler run per object
+    std::map<std::uint64_t, std::weak_ptr<JitKernel::Module>> loaded_;
+    JitStats stats_;
+    std::string last_error_;
+    bool warned_ = false;
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include "rhs_expr.h"
+#include <cstdint>
+#include <vector>
+
+// Bytecode interpreter for RHS programs when the JIT is unavailable. Each
+// instruction runs across a batch of `width` members held structure-of-
+// arrays in registers of `width` doubles, so decode and dispatch are paid
+// once per batch rather than once per member, and every arithmetic
+// instruction is a fixed-length loop the compiler turns into SIMD.
+//
+// Registers are allocated by linear scan over the live nodes (a register
+// is reused after its value's last use), which keeps the register file
+// small enough to stay in L1 at 64 lanes. Constants and parameters live in
+// pinned registers filled once per call.
+class RHSBytecode {
+public:
+    // width: members per batch, one of 8, 16, 32 or 64
+    RHSBytecode(const RHSProgram& program, std::vector<double> params, int width = 16);
+
+    // State i of lane l at y[i * stride + l], outputs likewise in dydt; any
+    // number of lanes (the last batch is padded). Thread-safe.
+    void evaluate_batch(double t, const double* y, double* dydt, int lanes, int stride) const;
+
+    int dimension() const { return dimension_; }
+    int outputs() const { return outputs_; }
+    int width() const { return width_; }
+    int registers() const { return registers_; }
+    int instructions() const { return static_cast<int>(code_.size()); }
+
+private:
+    enum class Op : std::uint8_t {
+        LoadState, LoadTime, Store,
+        Add, Sub, Mul, Div, Neg, Sin, Cos, Exp, Log, Sqrt, Tanh
+    };
+    struct Instruction {
+        Op op;
+        std::uint16_t dst;   // Register (Store: output index)
+        std::uint16_t a;     // Register (LoadState: state index)
+        std::uint16_t b;
+    };
+
+    template <int W>
+    void run(double t, const double* y, double* dydt, int lanes, int stride) const;
+
+    int dimension_;
+    int outputs_;
+    int width_;
+    int registers_;
+    std::vector<std::pair<std::uint16_t, double>> constants_;   // Pinned (register, value)
+    std::vector<Instruction> code_;
+};
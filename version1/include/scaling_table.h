@@ -0,0 +1,35 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+// Measured best thread count per workload size, produced by
+// examples/scaling_benchmark.cpp and consulted at runtime by the threaded
+// CPU backends. Workload kinds used in the tree:
+//   "system"    - one system of N equations (ThreadedCPUBackend)
+//   "ensemble"  - N independent members (CPUEnsembleBackend)
+//
+// File format, one entry per line ('#' starts a comment):
+//   <kind> <size> <threads>
+class ScalingTable {
+public:
+    void set(const std::string& kind, long long size, int threads);
+
+    // Thread count recorded for the largest size <= `size` (the smallest
+    // recorded size when `size` is below all of them). Returns
+    // `fallback` when nothing is recorded for `kind`.
+    int choose_threads(const std::string& kind, long long size, int fallback) const;
+
+    // Smallest recorded size at which more than one thread is chosen,
+    // or -1 if threading never paid off
+    long long crossover(const std::string& kind) const;
+
+    bool empty() const { return entries_.empty(); }
+    std::vector<std::string> kinds() const;
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+private:
+    std::map<std::string, std::map<long long, int>> entries_;
+};
@@ -4,21 +4,46 @@
 #include <map>
 #include "builtin_rhs_registry.h"
 
+// Templates come from shaders/templates, compiled into the binary at build
+// time (cmake/embed_shaders.cmake). For development, an override directory
+// (set_template_override_dir, or the ODE_SHADER_DIR environment variable)
+// is searched first, so a template can be edited without rebuilding.
 class ShaderGenerator {
 public:
     ShaderGenerator();
+
+    // "" disables the override; templates missing there fall back to the
+    // embedded copy
+    void set_template_override_dir(const std::string& dir);
     
-    std::string generate_euler_shader(const RHSDefinition& rhs);
+    // compensated: the update carries its rounding error in a per-equation
+    // buffer at binding 4 (float drift close to double over long runs)
+    std::string generate_euler_shader(const RHSDefinition& rhs, bool compensated = false);
+    std::string generate_euler_shader(const BuiltinRHS& rhs, bool compensated = false);
     std::string generate_rk45_shader(const RHSDefinition& rhs);
     
     // Generate shader from builtin RHS name
-    std::string generate_euler_shader_builtin(const std::string& rhs_name);
+    std::string generate_euler_shader_builtin(std::string_view rhs_name, bool compensated = false);
+
+    // Batched complex FFT of `size` points per row (fft_template.glsl), one
+    // workgroup per row; same sign and scaling conventions as FFTPlan.
+    // size is a power of two up to kMaxFFTShaderSize, whose two shared
+    // copies fill the 16 KiB GLES 3.1 guarantees.
+    static constexpr int kMaxFFTShaderSize = 1024;
+    std::string generate_fft_shader(int size, bool inverse = false);
+
+    // Euler over a packed batch of builtin systems (packed_euler_template.glsl,
+    // see PackedBatchLayout): each RHS is emitted once, renamed
+    // evaluate_rhs_<id>, with its uniform names reading the current member's
+    // parameters; main() switches on the segment's id. Throws
+    // std::invalid_argument for an unknown id.
+    std::string generate_packed_euler_shader(const std::vector<int>& rhs_ids, int workgroup_size);
     
 private:
     std::string load_template(const std::string& template_name);
-    std::string substitute_rhs(const std::string& template_code, 
-                              const RHSDefinition& rhs);
-    std::string generate_uniform_declarations(const std::vector<std::string>& uniform_names);
+    std::string substitute_rhs(const std::string& template_code, std::string_view glsl_code,
+                               const std::vector<std::string_view>& uniform_names);
+    std::string generate_uniform_declarations(const std::vector<std::string_view>& uniform_names);
     
-    std::string template_path_;
+    std::string override_dir_;
 }; 
\ No newline at end of file
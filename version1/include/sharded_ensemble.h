@@ -0,0 +1,113 @@
+#pragma once
+#include "solver_base.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ShardOptions {
+    int processes = 0;           // Concurrent worker processes, 0 = hardware_threads()
+    int shards = 0;              // Ensemble slices, 0 = 4 per process
+    int threads_per_process = 1; // CPUEnsembleBackend pool size inside each worker
+    int max_attempts = 3;        // Forks per shard before it is given up
+    // A worker still running after this long is killed and its shard
+    // retried; 0 waits forever, so one hung worker hangs the solve
+    double shard_timeout_seconds = 600.0;
+    // Keep the result region under this /dev/shm name until the result is
+    // destroyed, so other processes can attach; empty = anonymous (the
+    // name is unlinked as soon as it is mapped)
+    std::string shm_name;
+};
+
+enum class ShardState : std::uint32_t { Pending = 0, Running = 1, Done = 2, Failed = 3 };
+
+struct ShardStats {
+    int shards = 0;
+    int processes = 0;
+    int forks = 0;               // Worker processes started, retries included
+    int retries = 0;
+    int crashes = 0;             // Workers that died by a signal or exited without finishing
+    int timeouts = 0;
+    double seconds = 0.0;
+};
+
+// Final states of a sharded run, living in the shared memory the workers
+// wrote them to: nothing is copied back. Move-only; unmaps on destruction.
+class ShardedResult {
+public:
+    ShardedResult() = default;
+    ~ShardedResult();
+    ShardedResult(ShardedResult&& other) noexcept;
+    ShardedResult& operator=(ShardedResult&& other) noexcept;
+
+    // Member-major, n_members * dimension values
+    const double* final_states() const { return data_; }
+    std::uint64_t members() const { return members_; }
+    int dimension() const { return dimension_; }
+    const double* member(std::uint64_t m) const { return data_ + m * dimension_; }
+
+    int shards() const;
+    ShardState shard_state(int shard) const;
+    // Member range [begin, end) of a shard
+    std::uint64_t shard_begin(int shard) const;
+    std::uint64_t shard_end(int shard) const;
+    // True when every shard is Done; otherwise the Failed shards' members
+    // are left as NaN
+    bool complete() const;
+
+    const ShardStats& stats() const { return stats_; }
+
+    ShardedResult(const ShardedResult&) = delete;
+    ShardedResult& operator=(const ShardedResult&) = delete;
+
+private:
+    friend class ShardedEnsemble;
+    void release();
+
+    void* region_ = nullptr;
+    size_t region_bytes_ = 0;
+    const double* data_ = nullptr;
+    std::uint64_t members_ = 0;
+    int dimension_ = 0;
+    std::string shm_name_;
+    ShardStats stats_;
+};
+
+// Solves an ensemble in forked worker processes.
+//
+// The member range is cut into shards. The parent maps one POSIX shared
+// memory region - a header, a control block per shard and the result
+// array - then forks up to `processes` workers at a time, each solving one
+// shard with a CPUEnsembleBackend and writing straight into the shard's
+// slice of the region. A worker publishes its shard by storing Done into
+// the shard's (lock-free, process-shared) state word as its last act.
+//
+// A worker that crashes, exits without publishing, or overruns the timeout
+// leaves its shard un-Done; the parent forks a fresh worker for it, up to
+// max_attempts. The workers inherit the system and initial states through
+// fork(), so the parent's copy is shared copy-on-write, and each worker
+// only ever touches its own shard of the results.
+//
+// Workers never touch the GPU or any GL state inherited from the parent.
+//
+// The system's callbacks cannot be handed to an exec'd process, so workers
+// are plain forks and only the forking thread survives in them. Calling
+// solve() before the process starts other threads is always safe. From a
+// multithreaded process, the library's own locks (trace recorder,
+// profiler) are held across fork() and glibc resets malloc and stdio in
+// the child, but the callbacks must not take locks that other parent
+// threads can hold.
+class ShardedEnsemble {
+public:
+    // method: any name accepted by create_stepper
+    explicit ShardedEnsemble(const std::string& method, const ShardOptions& options = ShardOptions());
+
+    // Throws std::invalid_argument on bad arguments and std::runtime_error
+    // when the region cannot be set up; shards that exhaust their attempts
+    // are reported through ShardedResult::complete(), not thrown
+    ShardedResult solve(const ODESystem& system, double t0, double tf, double dt,
+                        const std::vector<double>& y0, std::uint64_t n_members);
+
+private:
+    std::string method_;
+    ShardOptions options_;
+};
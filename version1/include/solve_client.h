@@ -0,0 +1,59 @@
+#pragma once
+#include "solve_protocol.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Read-only mapping of a result memfd from SolveDaemon. The doubles are
+// used in place (no copy out of the daemon's buffer); the mapping is
+// released with the object. Movable, not copyable.
+class MappedResult {
+public:
+    MappedResult() = default;
+    MappedResult(const solve_protocol::ResultInfo& info, int fd);  // Maps, then closes fd
+    MappedResult(MappedResult&& other) noexcept;
+    MappedResult& operator=(MappedResult&& other) noexcept;
+    ~MappedResult();
+
+    size_t rows() const { return info_.rows; }
+    size_t cols() const { return info_.cols; }
+    const double* data() const { return data_; }
+    const double* row(size_t r) const { return data_ + r * info_.cols; }
+    const solve_protocol::ResultInfo& info() const { return info_; }
+
+    // Copies into the solution layout the in-process backends return
+    std::vector<std::vector<double>> to_rows() const;
+
+    MappedResult(const MappedResult&) = delete;
+    MappedResult& operator=(const MappedResult&) = delete;
+
+private:
+    void release();
+
+    solve_protocol::ResultInfo info_;
+    const double* data_ = nullptr;
+    size_t bytes_ = 0;
+};
+
+// Blocking client for one daemon connection. Not thread-safe: use one
+// client per thread (requests are served concurrently across connections).
+// Connection failures and daemon-side errors throw std::runtime_error.
+class SolveClient {
+public:
+    explicit SolveClient(const std::string& socket_path);
+    ~SolveClient();
+
+    MappedResult solve(const solve_protocol::SolveRequest& request);
+    solve_protocol::DaemonStats stats();
+
+    SolveClient(const SolveClient&) = delete;
+    SolveClient& operator=(const SolveClient&) = delete;
+
+private:
+    std::vector<std::uint8_t> round_trip(solve_protocol::MessageType type,
+                                         const std::vector<std::uint8_t>& payload,
+                                         solve_protocol::MessageType expected, int* received_fd);
+
+    int fd_;
+    std::uint64_t next_id_;
+};
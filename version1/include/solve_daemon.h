@@ -0,0 +1,76 @@
+#pragma once
+#include "solve_protocol.h"
+#include "solve_service.h"
+#include "auto_dispatcher.h"
+#include "request_coalescer.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct DaemonOptions {
+    std::string socket_path = "/tmp/ode_solver.sock";
+    int cpu_workers = 0;      // SolveService workers, 0 = hardware_threads()
+    CoalescerOptions coalescing;  // Hold window and batch cap for final-state requests
+    // Requests beyond these get an Error reply: (tf - t0) / dt steps, and
+    // steps x dimension values for anything that keeps the full trajectory
+    long long max_steps = 10000000;
+    long long max_trajectory_values = 64LL << 20;   // 512 MiB of doubles
+};
+
+// Long-running solver process. Keeps what a process-per-solve pipeline
+// pays for on every run warm: the EGL context and compiled programs (via
+// GPUExecutor), the thread pools, and the dispatcher's cost probes.
+//
+// Clients speak solve_protocol over a Unix stream socket, one thread per
+// connection, one request in flight per connection. Results come back as a
+// sealed memfd the client maps read-only.
+//
+// Requests with kFinalStateOnly and backend "auto" go through a
+// RequestCoalescer, which merges compatible ones arriving within its window
+// into one ensemble solve. Everything else runs as its own SolveService job.
+class SolveDaemon {
+public:
+    explicit SolveDaemon(const DaemonOptions& options = DaemonOptions(),
+                         const CostCalibration& calibration = CostCalibration::defaults());
+    ~SolveDaemon();
+
+    // Binds and listens (replacing a stale socket file); false on failure
+    bool start();
+    // Accepts and serves until stop(); call after start()
+    void run();
+    // Async-signal-safe: only flips a flag and writes to a pipe
+    void stop();
+
+    solve_protocol::DaemonStats stats() const;
+    // Window / batch-cap tuning and batching metrics
+    RequestCoalescer& coalescer() { return coalescer_; }
+
+    SolveDaemon(const SolveDaemon&) = delete;
+    SolveDaemon& operator=(const SolveDaemon&) = delete;
+
+private:
+    void serve_connection(int fd);
+    bool handle_solve(int fd, std::uint64_t request_id, const std::vector<std::uint8_t>& payload);
+    void reap_connections(bool all);
+
+    DaemonOptions options_;
+    SolveService service_;
+    ThreadPool batch_pool_;
+    RequestCoalescer coalescer_;
+
+    int listen_fd_;
+    int wake_pipe_[2];
+    std::atomic<bool> stopping_;
+
+    std::mutex connections_mutex_;
+    std::vector<std::thread> connection_threads_;
+    std::set<int> open_fds_;
+    std::vector<std::thread::id> finished_;
+
+    mutable std::mutex stats_mutex_;
+    solve_protocol::DaemonStats stats_;
+};
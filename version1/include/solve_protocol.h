@@ -0,0 +1,237 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Wire format between SolveDaemon and SolveClient.
+//
+// Every message is a fixed MessageHeader followed by payload_bytes of
+// payload. Integers and doubles are in host byte order: the transport is a
+// local Unix socket, so both ends are the same machine. Result matrices do
+// not travel in the stream at all; a Result message carries a sealed memfd
+// (SCM_RIGHTS) holding rows x cols doubles, row-major.
+namespace solve_protocol {
+
+constexpr std::uint32_t kMagic = 0x3145444F;  // "ODE1"
+constexpr std::uint16_t kVersion = 2;
+constexpr std::uint32_t kMaxPayloadBytes = 64u << 20;
+
+enum class MessageType : std::uint16_t {
+    Solve = 1,        // Client -> daemon: SolveRequest
+    Result = 2,       // Daemon -> client: ResultInfo (+ memfd when rows > 0)
+    Error = 3,        // Daemon -> client: UTF-8 message
+    Stats = 4,        // Client -> daemon: empty
+    StatsReply = 5,   // Daemon -> client: DaemonStats
+};
+
+// SolveRequest::flags
+constexpr std::uint32_t kFinalStateOnly = 1u << 0;  // Reply with the last row only (batchable)
+
+struct MessageHeader {
+    std::uint32_t magic = kMagic;
+    std::uint16_t version = kVersion;
+    std::uint16_t type = 0;
+    std::uint64_t request_id = 0;
+    std::uint32_t payload_bytes = 0;
+    std::uint32_t reserved = 0;
+};
+static_assert(sizeof(MessageHeader) == 24, "MessageHeader is part of the wire format");
+
+struct SolveRequest {
+    std::string problem;       // TestProblems::create() name
+    std::string method = "rk45";
+    std::string backend = "auto";
+    double t0 = 0.0;
+    double tf = 1.0;
+    double dt = 0.01;
+    std::int32_t priority = 0;
+    std::uint32_t flags = 0;
+    std::vector<double> y0;    // Its size is the system dimension
+};
+
+struct ResultInfo {
+    std::uint32_t rows = 0;
+    std::uint32_t cols = 0;
+    double queue_seconds = 0.0;
+    double run_seconds = 0.0;
+    std::uint32_t batch_size = 1;   // Requests solved together in one ensemble
+    std::string backend;
+};
+
+struct DaemonStats {
+    std::uint64_t requests = 0;
+    std::uint64_t errors = 0;
+    std::uint64_t batches = 0;          // Ensemble dispatches
+    std::uint64_t batched_requests = 0; // Requests served by those dispatches
+    std::uint64_t largest_batch = 0;
+    std::uint64_t full_flushes = 0;     // Batches dispatched on reaching max_batch
+    std::uint64_t window_flushes = 0;   // Batches dispatched when the window ran out
+    double mean_wait_us = 0.0;          // Latency added by coalescing
+    double p99_wait_us = 0.0;
+};
+
+// Append-only little serializer; fields are copied byte-wise, no padding
+class WireWriter {
+public:
+    template <typename T>
+    void put(T value) {
+        static_assert(std::is_trivially_copyable<T>::value, "put() takes plain values");
+        const auto* bytes = reinterpret_cast<const std::uint8_t*>(&value);
+        data_.insert(data_.end(), bytes, bytes + sizeof(T));
+    }
+    void put_string(const std::string& s) {
+        put<std::uint32_t>(static_cast<std::uint32_t>(s.size()));
+        data_.insert(data_.end(), s.begin(), s.end());
+    }
+    void put_doubles(const std::vector<double>& v) {
+        put<std::uint32_t>(static_cast<std::uint32_t>(v.size()));
+        const auto* bytes = reinterpret_cast<const std::uint8_t*>(v.data());
+        data_.insert(data_.end(), bytes, bytes + v.size() * sizeof(double));
+    }
+    const std::vector<std::uint8_t>& data() const { return data_; }
+
+private:
+    std::vector<std::uint8_t> data_;
+};
+
+// Bounds-checked reader; truncated or oversized fields throw std::runtime_error
+class WireReader {
+public:
+    WireReader(const std::uint8_t* data, size_t size) : data_(data), size_(size), pos_(0) {}
+
+    template <typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable<T>::value, "get() returns plain values");
+        require(sizeof(T));
+        T value;
+        std::memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+    std::string get_string() {
+        std::uint32_t n = get<std::uint32_t>();
+        require(n);
+        std::string s(reinterpret_cast<const char*>(data_ + pos_), n);
+        pos_ += n;
+        return s;
+    }
+    std::vector<double> get_doubles() {
+        std::uint32_t n = get<std::uint32_t>();
+        require(static_cast<size_t>(n) * sizeof(double));
+        std::vector<double> v(n);
+        std::memcpy(v.data(), data_ + pos_, n * sizeof(double));
+        pos_ += n * sizeof(double);
+        return v;
+    }
+    bool done() const { return pos_ == size_; }
+
+private:
+    void require(size_t n) const {
+        if (n > size_ - pos_) {
+            throw std::runtime_error("Truncated solve protocol message");
+        }
+    }
+
+    const std::uint8_t* data_;
+    size_t size_;
+    size_t pos_;
+};
+
+inline std::vector<std::uint8_t> encode(const SolveRequest& r) {
+    WireWriter w;
+    w.put(r.t0);
+    w.put(r.tf);
+    w.put(r.dt);
+    w.put(r.priority);
+    w.put(r.flags);
+    w.put_string(r.problem);
+    w.put_string(r.method);
+    w.put_string(r.backend);
+    w.put_doubles(r.y0);
+    return w.data();
+}
+
+inline SolveRequest decode_solve_request(const std::vector<std::uint8_t>& payload) {
+    WireReader in(payload.data(), payload.size());
+    SolveRequest r;
+    r.t0 = in.get<double>();
+    r.tf = in.get<double>();
+    r.dt = in.get<double>();
+    r.priority = in.get<std::int32_t>();
+    r.flags = in.get<std::uint32_t>();
+    r.problem = in.get_string();
+    r.method = in.get_string();
+    r.backend = in.get_string();
+    r.y0 = in.get_doubles();
+    return r;
+}
+
+inline std::vector<std::uint8_t> encode(const ResultInfo& r) {
+    WireWriter w;
+    w.put(r.rows);
+    w.put(r.cols);
+    w.put(r.queue_seconds);
+    w.put(r.run_seconds);
+    w.put(r.batch_size);
+    w.put_string(r.backend);
+    return w.data();
+}
+
+inline ResultInfo decode_result_info(const std::vector<std::uint8_t>& payload) {
+    WireReader in(payload.data(), payload.size());
+    ResultInfo r;
+    r.rows = in.get<std::uint32_t>();
+    r.cols = in.get<std::uint32_t>();
+    r.queue_seconds = in.get<double>();
+    r.run_seconds = in.get<double>();
+    r.batch_size = in.get<std::uint32_t>();
+    r.backend = in.get_string();
+    return r;
+}
+
+inline std::vector<std::uint8_t> encode(const DaemonStats& s) {
+    WireWriter w;
+    w.put(s.requests);
+    w.put(s.errors);
+    w.put(s.batches);
+    w.put(s.batched_requests);
+    w.put(s.largest_batch);
+    w.put(s.full_flushes);
+    w.put(s.window_flushes);
+    w.put(s.mean_wait_us);
+    w.put(s.p99_wait_us);
+    return w.data();
+}
+
+inline DaemonStats decode_daemon_stats(const std::vector<std::uint8_t>& payload) {
+    WireReader in(payload.data(), payload.size());
+    DaemonStats s;
+    s.requests = in.get<std::uint64_t>();
+    s.errors = in.get<std::uint64_t>();
+    s.batches = in.get<std::uint64_t>();
+    s.batched_requests = in.get<std::uint64_t>();
+    s.largest_batch = in.get<std::uint64_t>();
+    s.full_flushes = in.get<std::uint64_t>();
+    s.window_flushes = in.get<std::uint64_t>();
+    s.mean_wait_us = in.get<double>();
+    s.p99_wait_us = in.get<double>();
+    return s;
+}
+
+// Stream transport (src/daemon/solve_transport.cpp). All return false on
+// EOF or I/O error; EINTR is retried.
+bool read_full(int fd, void* buffer, size_t bytes);
+bool write_full(int fd, const void* buffer, size_t bytes);
+
+// One message in a single sendmsg(); pass_fd >= 0 rides along as SCM_RIGHTS
+bool send_message(int fd, MessageType type, std::uint64_t request_id,
+                  const std::vector<std::uint8_t>& payload, int pass_fd = -1);
+// Reads one message; a passed descriptor lands in *received_fd (else -1).
+// Bad magic/version or oversized payloads fail like I/O errors.
+bool recv_message(int fd, MessageHeader& header, std::vector<std::uint8_t>& payload,
+                  int* received_fd = nullptr);
+
+}  // namespace solve_protocol
@@ -0,0 +1,128 @@
+#pragma once
+#include "solver_base.h"
+#include "auto_dispatcher.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+struct SolveOptions {
+    double t0 = 0.0;
+    double tf = 1.0;
+    double dt = 0.01;
+    std::vector<double> y0;            // Empty = system.initial_conditions
+    std::string method = "rk45";       // "euler" or "rk45"
+    // "auto" (cost model), "cpu", "cpu_threaded" or "gpu"
+    std::string backend = "auto";
+    int priority = 0;                  // Higher runs first; FIFO within a priority
+};
+
+struct SolveResult {
+    std::vector<std::vector<double>> solution;
+    std::string backend;               // Backend that actually ran
+    double queue_seconds = 0.0;        // Submit -> start
+    double run_seconds = 0.0;          // Start -> finish
+};
+
+// Thrown from SolveHandle::get() for jobs cancelled before they started
+class SolveCancelled : public std::runtime_error {
+public:
+    SolveCancelled() : std::runtime_error("solve cancelled") {}
+};
+
+enum class JobStatus { Queued, Running, Done, Cancelled };
+
+namespace detail {
+struct SolveJob;
+}
+
+class GPUEulerBackend;
+
+// Caller's side of a submitted solve. Movable, not copyable.
+class SolveHandle {
+public:
+    SolveHandle() = default;
+
+    std::uint64_t id() const;
+    JobStatus status() const;
+
+    // Blocks until the job finished; rethrows backend errors and SolveCancelled
+    SolveResult get() { return future_.get(); }
+    void wait() const { future_.wait(); }
+    bool ready() const {
+        return future_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    // Succeeds only while the job is still queued; a running solve has no
+    // cancellation points and always completes
+    bool cancel();
+
+private:
+    friend class SolveService;
+    SolveHandle(std::shared_ptr<detail::SolveJob> job, std::future<SolveResult> future)
+        : job_(std::move(job)), future_(std::move(future)) {}
+
+    std::shared_ptr<detail::SolveJob> job_;
+    std::future<SolveResult> future_;
+};
+
+// Asynchronous front end for the blocking backends.
+//
+// submit() decides the lane immediately ("auto" asks the AutoDispatcher's
+// cost model) and queues the job:
+//   CPU lane - a pool of worker threads, each with its own backends
+//   GPU lane - jobs handed to GPUExecutor, the one thread that owns every
+//              GL call, since GL contexts are bound to a single thread
+// Both lanes are priority queues. Destroying the service cancels whatever
+// is still queued and waits for running jobs.
+class SolveService {
+public:
+    // cpu_workers 0 = hardware_threads()
+    explicit SolveService(int cpu_workers = 0,
+                          const CostCalibration& calibration = CostCalibration::defaults());
+    ~SolveService();
+
+    SolveHandle submit(const ODESystem& system, const SolveOptions& options = SolveOptions());
+
+    size_t queued_jobs() const;
+
+    SolveService(const SolveService&) = delete;
+    SolveService& operator=(const SolveService&) = delete;
+
+private:
+    using JobPtr = std::shared_ptr<detail::SolveJob>;
+    struct JobOrder {
+        bool operator()(const JobPtr& a, const JobPtr& b) const;
+    };
+    using JobQueue = std::priority_queue<JobPtr, std::vector<JobPtr>, JobOrder>;
+
+    void cpu_worker_loop(int index);
+    void run_next_gpu_job();   // On the GPUExecutor thread
+    JobPtr next_job(JobQueue& queue, std::condition_variable& cv);
+    static void run_job(const JobPtr& job, SolverBase& backend, const std::string& label);
+
+    CostCalibration calibration_;
+    ThreadPool shared_pool_;            // For "cpu_threaded" jobs
+    // Only plan() is used, under planner_mutex_
+    std::mutex planner_mutex_;
+    AutoDispatcher euler_planner_;
+    AutoDispatcher rk45_planner_;
+
+    mutable std::mutex queue_mutex_;
+    std::condition_variable cpu_cv_;
+    JobQueue cpu_queue_;
+    JobQueue gpu_queue_;
+    bool stopping_;
+    bool gpu_used_;                     // A GPU job was queued: the executor thread exists
+    std::uint64_t next_sequence_;
+
+    std::vector<std::thread> cpu_workers_;
+    // Created, used and destroyed on the GPUExecutor thread only
+    std::unique_ptr<GPUEulerBackend> gpu_;
+};
@@ -3,24 +3,51 @@
 #include <string>
 #include <functional>
 #include <map>
+#include <memory>
 #include <optional>
 
-struct ODESystem {
+class RHSProgram;
+
+// State precision is a template parameter: BasicODESystem<float> (the GPU's
+// precision, twice the SIMD width and half the bandwidth of double), double
+// (ODESystem, what the rest of the library runs on) and long double for
+// references. Time stays double in every precision: it is bookkeeping, and
+// a float clock stops advancing once t / dt passes 2^24.
+struct ODEGPUInfo {
+    std::string glsl_rhs_code;           // Custom GLSL snippet
+    std::vector<float> gpu_uniforms;     // Additional parameters
+    std::vector<std::string> uniform_names;  // gpu_uniforms in glsl_rhs_code, as glsl_uniform_macro(name)
+    std::string builtin_rhs_name;        // e.g., "exponential", "vanderpol"
+    bool force_cpu_fallback = false;    // Disable GPU for this problem
+};
+
+template <typename Scalar>
+struct BasicODESystem {
+    using State = std::vector<Scalar>;
+
     std::string name;
     int dimension;
-    std::function<std::vector<double>(double, const std::vector<double>&)> rhs;
-    std::function<std::vector<double>(double)> analytical_solution;
-    std::vector<double> initial_conditions;
+    std::function<State(double, const State&)> rhs;
+    // Optional allocation-free RHS: writes f(t, y) into a caller-sized dydt.
+    // Steppers prefer it over `rhs` so their step loops stay heap-free.
+    std::function<void(double, const State&, State&)> rhs_inplace;
+    // Optional partial RHS: writes dydt[begin, end) only, reading any of y.
+    // Lets ThreadedCPUBackend split one large system across cores.
+    std::function<void(double, const State&, State&, int, int)> rhs_range;
+    std::function<State(double)> analytical_solution;
+    State initial_conditions;
     double t_start, t_end;
     std::map<std::string, double> parameters;
+    // Expression form, when built from one (to_ode_system); lets batched
+    // evaluators such as VMEnsembleBackend run the RHS across members
+    std::shared_ptr<const RHSProgram> program;
+    // rhs / rhs_inplace interpret `program` one member at a time (the tape
+    // of to_ode_system, kept by RHSJit::system when compilation fails);
+    // ensemble dispatch then runs VMEnsembleBackend instead
+    bool rhs_interpreted = false;
     
-    // GPU-specific information
-    struct GPUInfo {
-        std::string glsl_rhs_code;           // Custom GLSL snippet
-        std::vector<float> gpu_uniforms;     // Additional parameters
-        std::string builtin_rhs_name;        // e.g., "exponential", "vanderpol"
-        bool force_cpu_fallback = false;    // Disable GPU for this problem
-    };
+    // GPU-specific information (shared by every precision)
+    using GPUInfo = ODEGPUInfo;
     std::optional<GPUInfo> gpu_info;
     
     // Helper methods
@@ -28,14 +55,33 @@ struct ODESystem {
     bool use_builtin_rhs() const { 
         return gpu_info && !gpu_info->builtin_rhs_name.empty(); 
     }
+    bool has_inplace_rhs() const { return static_cast<bool>(rhs_inplace); }
+    bool has_range_rhs() const { return static_cast<bool>(rhs_range); }
+    
+    // Evaluate f(t, y) into dydt, which must already have y.size() elements.
+    // Only allocates when the system has no rhs_inplace.
+    void evaluate_rhs(double t, const State& y, State& dydt) const {
+        if (rhs_inplace) {
+            rhs_inplace(t, y, dydt);
+        } else {
+            dydt = rhs(t, y);
+        }
+    }
 };
 
-class SolverBase {
+using ODESystem = BasicODESystem<double>;
+
+// Solvers fill `solution` with one state per output time, in the system's
+// precision
+template <typename Scalar>
+class BasicSolverBase {
 public:
-    virtual ~SolverBase() = default;
-    virtual void solve(const ODESystem& system, 
+    virtual ~BasicSolverBase() = default;
+    virtual void solve(const BasicODESystem<Scalar>& system,
                       double t0, double tf, double dt,
-                      const std::vector<double>& y0,
-                      std::vector<std::vector<double>>& solution) = 0;
+                      const std::vector<Scalar>& y0,
+                      std::vector<std::vector<Scalar>>& solution) = 0;
     virtual std::string name() const = 0;
-}; 
\ No newline at end of file
+};
+
+using SolverBase = BasicSolverBase<double>; 
\ No newline at end of file
@@ -1,43 +1,83 @@
 #pragma once
 #include "solver_base.h"
+#include "compensated.h"
 #include <memory>
 
+// Steppers are templated on the state precision like BasicODESystem and
+// instantiated for float, double and long double (src/steppers). The
+// double forms keep the plain names: TimeStepper, ExplicitEulerStepper,
+// RK45Stepper.
+//
+// Constructed with compensated = true, a stepper adds each step's increment
+// to the state through CompensatedUpdate (compensated.h), for long runs in
+// float that should drift like double.
+
 // Abstract base class for time-stepping algorithms
-class TimeStepper {
+template <typename Scalar>
+class BasicTimeStepper {
 public:
-    virtual ~TimeStepper() = default;
+    virtual ~BasicTimeStepper() = default;
     
     // Advance the solution by one time step
-    virtual void step(const ODESystem& system, double t, double dt, 
-                     std::vector<double>& y) = 0;
+    virtual void step(const BasicODESystem<Scalar>& system, double t, double dt, 
+                     std::vector<Scalar>& y) = 0;
     
     virtual std::string name() const = 0;
     virtual int order() const = 0;  // Accuracy order of the method
 };
 
 // Explicit Euler method: y_{n+1} = y_n + dt * f(t_n, y_n)
-class ExplicitEulerStepper : public TimeStepper {
+template <typename Scalar>
+class BasicExplicitEulerStepper : public BasicTimeStepper<Scalar> {
 public:
-    void step(const ODESystem& system, double t, double dt, 
-             std::vector<double>& y) override;
+    explicit BasicExplicitEulerStepper(bool compensated = false) : compensated_(compensated) {}
+
+    void step(const BasicODESystem<Scalar>& system, double t, double dt, 
+             std::vector<Scalar>& y) override;
     
-    std::string name() const override { return "Explicit_Euler"; }
+    std::string name() const override { return compensated_ ? "Explicit_Euler_Compensated" : "Explicit_Euler"; }
     int order() const override { return 1; }
+
+private:
+    std::vector<Scalar> dydt_;  // Reused across steps
+    bool compensated_;
+    CompensatedUpdate<Scalar> update_;
 };
 
 // Runge-Kutta 4th/5th order (Dormand-Prince)
-class RK45Stepper : public TimeStepper {
+template <typename Scalar>
+class BasicRK45Stepper : public BasicTimeStepper<Scalar> {
 public:
-    void step(const ODESystem& system, double t, double dt, 
-             std::vector<double>& y) override;
+    explicit BasicRK45Stepper(bool compensated = false) : compensated_(compensated) {}
+
+    void step(const BasicODESystem<Scalar>& system, double t, double dt, 
+             std::vector<Scalar>& y) override;
     
-    std::string name() const override { return "RK45_Dormand_Prince"; }
+    std::string name() const override {
+        return compensated_ ? "RK45_Dormand_Prince_Compensated" : "RK45_Dormand_Prince";
+    }
     int order() const override { return 5; }
 
 private:
-    std::vector<double> rk45_step(const ODESystem& system, double t, 
-                                 const std::vector<double>& y, double h);
+    // Stage workspaces, sized on the first step and reused afterwards so
+    // the step loop does not touch the heap (given an rhs_inplace system)
+    void resize_workspace(size_t n);
+    std::vector<Scalar> k1_, k2_, k3_, k4_, k5_, k6_;
+    std::vector<Scalar> y_temp_;
+    bool compensated_;
+    CompensatedUpdate<Scalar> update_;
 };
 
-// Factory function for creating steppers
-std::unique_ptr<TimeStepper> create_stepper(const std::string& method_name); 
\ No newline at end of file
+using TimeStepper = BasicTimeStepper<double>;
+using ExplicitEulerStepper = BasicExplicitEulerStepper<double>;
+using RK45Stepper = BasicRK45Stepper<double>;
+
+// Factory function for creating steppers ("euler", "rk45", or either with a
+// "_compensated" suffix); create_stepper<float> and create_stepper<long double>
+// for the other precisions
+template <typename Scalar = double>
+std::unique_ptr<BasicTimeStepper<Scalar>> create_stepper(const std::string& method_name);
+
+extern template std::unique_ptr<BasicTimeStepper<float>> create_stepper<float>(const std::string&);
+extern template std::unique_ptr<BasicTimeStepper<double>> create_stepper<double>(const std::string&);
+extern template std::unique_ptr<BasicTimeStepper<long double>> create_stepper<long double>(const std::string&);
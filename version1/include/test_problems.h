@@ -3,7 +3,25 @@
 
 class TestProblems {
 public:
-    static ODESystem create_exponential_decay();
-    static ODESystem create_van_der_pol();
-    static ODESystem create_scalability_test(int N);
+    // RHS evaluated in Scalar (float, double or long double); the
+    // parameters are rounded to Scalar once
+    template <typename Scalar = double>
+    static BasicODESystem<Scalar> create_exponential_decay(double lambda = 2.0);
+    template <typename Scalar = double>
+    static BasicODESystem<Scalar> create_van_der_pol(double mu = 1.0);
+    template <typename Scalar = double>
+    static BasicODESystem<Scalar> create_scalability_test(int N, double epsilon = 0.1);
+
+    // Lookup by short name for callers that only have a string (daemon,
+    // job files): "exponential", "vanderpol" or "scalability" (any
+    // dimension). Throws std::invalid_argument for unknown names or a
+    // dimension the problem does not have.
+    static ODESystem create(const std::string& name, int dimension);
+    // Same, with named parameters overriding the defaults ("lambda", "mu",
+    // "epsilon"); unknown names throw std::invalid_argument
+    static ODESystem create(const std::string& name, int dimension,
+                            const std::map<std::string, double>& parameters);
+    static std::vector<std::string> names();
+    // Dimension of a fixed-size problem, 0 for "scalability" (any)
+    static int fixed_dimension(const std::string& name);
 }; 
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fork-join pool for the CPU backends. parallel_for() splits an index range
+// into one contiguous chunk per worker and returns when every chunk is done;
+// the calling thread runs chunk 0 itself.
+//
+// Workers spin briefly before sleeping so that back-to-back parallel_for
+// calls (one per RK stage) do not pay a futex wake-up each time. The body is
+// passed by reference without type erasure, so dispatch never allocates.
+//
+// parallel_for() calls from different threads are serialized; calling it
+// from inside a body is not supported.
+class ThreadPool {
+public:
+    // n_threads includes the calling thread; 0 = hardware_threads().
+    // pin_threads binds worker i to CPU i (the caller to CPU 0).
+    explicit ThreadPool(int n_threads = 0, bool pin_threads = false);
+    ~ThreadPool();
+
+    int size() const { return n_threads_; }
+    bool pinned() const { return pinned_; }
+
+    // body(chunk_begin, chunk_end, worker_index); max_workers 0 = all.
+    // Exceptions thrown by a body are rethrown in the caller.
+    template <typename Body>
+    void parallel_for(long long begin, long long end, Body&& body, int max_workers = 0) {
+        using BodyType = typename std::remove_reference<Body>::type;
+        run(begin, end, max_workers,
+            [](void* ctx, long long b, long long e, int w) {
+                (*static_cast<BodyType*>(ctx))(b, e, w);
+            },
+            const_cast<void*>(static_cast<const void*>(&body)));
+    }
+
+    static int hardware_threads();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+private:
+    using ChunkFn = void (*)(void*, long long, long long, int);
+
+    void run(long long begin, long long end, int max_workers, ChunkFn fn, void* ctx);
+    void worker_loop(int index);
+    void run_chunk(int index);
+
+    int n_threads_;
+    bool pinned_;
+    std::vector<std::thread> workers_;
+
+    std::mutex submit_mutex_;  // Serializes parallel_for callers
+
+    // Current job, published by bumping generation_
+    ChunkFn fn_;
+    void* ctx_;
+    long long begin_;
+    long long end_;
+    long long chunk_;
+    int active_workers_;
+    std::atomic<unsigned> generation_;
+    std::atomic<int> remaining_;
+    std::atomic<bool> stop_;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
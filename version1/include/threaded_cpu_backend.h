@@ -0,0 +1,45 @@
+#pragma once
+#include "solver_base.h"
+#include "thread_pool.h"
+#include "scaling_table.h"
+
+// Splits one large system across the CPU cores: every stage's RHS
+// evaluation and state update runs as a parallel_for over equation ranges.
+// Needs ODESystem::rhs_range; systems without it are integrated on the
+// calling thread only.
+//
+// Results are bitwise identical to CPUBackend with the same method, since
+// each equation sees exactly the same arithmetic.
+class ThreadedCPUBackend : public SolverBase {
+public:
+    // method: "euler" or "rk45" (same names as create_stepper)
+    ThreadedCPUBackend(const std::string& method, ThreadPool& pool);
+
+    void solve(const ODESystem& system,
+              double t0, double tf, double dt,
+              const std::vector<double>& y0,
+              std::vector<std::vector<double>>& solution) override;
+
+    std::string name() const override { return "CPU_Threaded_" + method_; }
+
+    // Fixed thread count (0 = whole pool), or pick per system size from a
+    // table measured by scaling_benchmark (workload kind "system")
+    void set_max_threads(int threads) { max_threads_ = threads; }
+    void set_scaling_table(const ScalingTable* table) { scaling_table_ = table; }
+    int threads_for(int n_equations) const;
+
+private:
+    void solve_euler(const ODESystem& system, double t0, double dt, int n_steps, int threads,
+                     std::vector<std::vector<double>>& solution);
+    void solve_rk45(const ODESystem& system, double t0, double dt, int n_steps, int threads,
+                    std::vector<std::vector<double>>& solution);
+
+    std::string method_;
+    ThreadPool& pool_;
+    int max_threads_;
+    const ScalingTable* scaling_table_;
+
+    // Workspaces reused across solves
+    std::vector<double> y_, y_next_, y_temp_a_, y_temp_b_;
+    std::vector<double> k_[6];
+};
@@ -1,19 +1,25 @@
 #pragma once
 #include <chrono>
 
+// Wall-clock stopwatch for whole-run timings. steady_clock is monotonic
+// (high_resolution_clock may alias system_clock and jump with NTP).
+// For per-step latency distributions use ScopedTimer in profiler.h.
 class Timer {
 public:
     void start() {
-        start_time = std::chrono::high_resolution_clock::now();
+        start_time = std::chrono::steady_clock::now();
     }
     
     double elapsed() const {
-        auto end_time = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
-            end_time - start_time);
-        return duration.count() / 1000000.0; // Return seconds
+        return elapsed_ns() / 1e9; // Return seconds
+    }
+    
+    long long elapsed_ns() const {
+        auto end_time = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            end_time - start_time).count();
     }
     
 private:
-    std::chrono::high_resolution_clock::time_point start_time;
-}; 
\ No newline at end of file
+    std::chrono::steady_clock::time_point start_time;
+};
@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Scoped trace spans written as Chrome trace-event JSON
+// (open in chrome://tracing or https://ui.perfetto.dev).
+//
+// The ODE_TRACE_SCOPE macros compile to nothing unless ODE_ENABLE_TRACING is
+// defined (CMake: -DENABLE_TRACING=ON). When compiled in, spans are only
+// recorded after TraceRecorder::instance().set_enabled(true), so a disabled
+// span costs one relaxed atomic load.
+//
+// Each thread appends to its own fixed-size buffer; only the first span on a
+// new thread takes a lock (to register the buffer). Span names and
+// categories must be string literals - only the pointers are stored.
+
+class TraceRecorder {
+public:
+    static TraceRecorder& instance();
+
+    void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // Append a completed span for the calling thread
+    void record(const char* name, const char* category,
+                std::uint64_t start_ns, std::uint64_t end_ns);
+
+    // Name shown for the calling thread in the trace viewer
+    void set_thread_name(const char* name);
+
+    // Write every recorded span as {"traceEvents": [...]}. Call while no
+    // spans are being recorded (e.g. after the solve has returned).
+    bool dump_chrome_json(const std::string& path) const;
+
+    void clear();
+    std::uint64_t event_count() const;
+    std::uint64_t dropped_count() const;  // Spans lost to full buffers
+
+    static std::uint64_t now_ns();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+private:
+    TraceRecorder() = default;
+    std::atomic<bool> enabled_{false};
+};
+
+class TraceScope {
+public:
+    TraceScope(const char* name, const char* category)
+        : name_(name), category_(category), start_ns_(0) {
+        if (TraceRecorder::instance().enabled()) {
+            start_ns_ = TraceRecorder::now_ns();
+        }
+    }
+
+    ~TraceScope() {
+        if (start_ns_ != 0) {
+            TraceRecorder::instance().record(name_, category_, start_ns_,
+                                             TraceRecorder::now_ns());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    const char* category_;
+    std::uint64_t start_ns_;
+};
+
+#define ODE_TRACE_CONCAT_INNER(a, b) a##b
+#define ODE_TRACE_CONCAT(a, b) ODE_TRACE_CONCAT_INNER(a, b)
+
+#ifdef ODE_ENABLE_TRACING
+#define ODE_TRACE_SCOPE_CAT(name, category) \
+    TraceScope ODE_TRACE_CONCAT(ode_trace_scope_, __LINE__)(name, category)
+#define ODE_TRACE_THREAD_NAME(name) TraceRecorder::instance().set_thread_name(name)
+#else
+#define ODE_TRACE_SCOPE_CAT(name, category) ((void)0)
+#define ODE_TRACE_THREAD_NAME(name) ((void)0)
+#endif
+
+#define ODE_TRACE_SCOPE(name) ODE_TRACE_SCOPE_CAT(name, "ode")
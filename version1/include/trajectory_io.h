@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Binary trajectory files written by the batch runner.
+//
+//   file   = FileHeader, then Record*
+//   record = RecordHeader, rows x cols doubles (row-major), FNV-1a checksum
+//
+// Records are appended as jobs finish, in any order, and carry their job
+// index. A crash mid-write leaves a record whose length or checksum does
+// not add up; readers stop there and TrajectoryWriter::resume() trims it,
+// so an interrupted sweep continues from its last complete record.
+// Host byte order: the files are produced and consumed on the same board.
+
+struct TrajectoryFileInfo {
+    std::uint64_t fingerprint = 0;   // Identifies the sweep (JobSpec::fingerprint())
+    std::uint64_t total_jobs = 0;
+    std::uint32_t dimension = 0;
+    bool final_only = false;         // Records hold one row: the final state
+};
+
+struct TrajectoryRecord {
+    std::uint64_t job_index = 0;
+    double t_first = 0.0;            // Time of row 0
+    double dt = 0.0;                 // Row spacing
+    std::uint32_t rows = 0;
+    std::uint32_t cols = 0;
+    std::vector<double> data;
+
+    const double* row(std::uint32_t r) const { return data.data() + static_cast<size_t>(r) * cols; }
+};
+
+class TrajectoryWriter {
+public:
+    // Starts a new file, replacing any existing one
+    bool create(const std::string& path, const TrajectoryFileInfo& info);
+    // Reopens an existing file for appending. Fails if its header belongs to
+    // a different sweep; trims a torn final record; completed receives the
+    // job indices already on disk.
+    bool resume(const std::string& path, const TrajectoryFileInfo& info,
+                std::vector<std::uint64_t>& completed);
+
+    bool append(std::uint64_t job_index, double t_first, double dt,
+                const std::vector<std::vector<double>>& rows);
+    bool flush();
+    void close();
+
+    std::uint64_t records_written() const { return records_written_; }
+
+private:
+    std::ofstream out_;
+    std::string path_;
+    std::vector<double> staging_;    // Reused row-major copy of one record
+    std::uint64_t records_written_ = 0;
+};
+
+class TrajectoryReader {
+public:
+    bool open(const std::string& path);
+    const TrajectoryFileInfo& info() const { return info_; }
+
+    // False at end of file, or at a torn / corrupt record (then truncated())
+    bool next(TrajectoryRecord& record);
+    bool truncated() const { return truncated_; }
+    // File offset just past the last intact record read so far
+    std::uint64_t good_bytes() const { return good_bytes_; }
+
+private:
+    std::ifstream in_;
+    TrajectoryFileInfo info_;
+    bool truncated_ = false;
+    std::uint64_t good_bytes_ = 0;
+};
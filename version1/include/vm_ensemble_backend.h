@@ -0,0 +1,38 @@
+#pragma once
+#include "ensemble.h"
+#include "rhs_vm.h"
+
+// Ensemble on the CPU through the RHS bytecode VM: members are gathered
+// into structure-of-arrays batches of `width`, and each thread steps whole
+// batches, so every RHS instruction runs across `width` members at once.
+// Needs a system built from an RHSProgram (ODESystem::program).
+//
+// The stepper arithmetic is written out per lane in the same order as
+// ExplicitEulerStepper and RK45Stepper, so member m matches
+// CPUEnsembleBackend bit for bit. Concurrent solves are safe; they take
+// turns on the pool.
+class VMEnsembleBackend : public EnsembleSolverBase {
+public:
+    // method: "euler" or "rk45" (and their create_stepper aliases);
+    // width: members per batch, see RHSBytecode
+    VMEnsembleBackend(const std::string& method, ThreadPool& pool, int width = 16);
+
+    void solve_ensemble(const ODESystem& system,
+                        double t0, double tf, double dt,
+                        const std::vector<double>& y0,
+                        int n_members,
+                        std::vector<double>& final_states) override;
+
+    std::string name() const override { return "VM_Ensemble_" + method_; }
+    int width() const { return width_; }
+
+private:
+    std::string method_;
+    bool rk45_;
+    ThreadPool& pool_;
+    int width_;
+
+    // Per-worker SoA batch state and stage buffers, reused across solves;
+    // only used inside parallel_for
+    std::vector<std::vector<double>> workspace_;
+};
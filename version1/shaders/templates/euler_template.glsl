@@ -1,10 +1,29 @@
 #version 310 es
+// COMPENSATED 1: the state update carries its rounding error per equation
+// in CompensationBuffer (see compensated.h). The carry needs `precise`
+// (GL_EXT_gpu_shader5): without it a driver may fold (a - s) + b to zero,
+// and the update degrades to the plain one.
+#define COMPENSATED {{COMPENSATED}}
+#if COMPENSATED && defined(GL_EXT_gpu_shader5)
+#extension GL_EXT_gpu_shader5 : enable
+#define PRECISE precise
+#else
+#define PRECISE
+#endif
+
 layout(local_size_x = 4, local_size_y = 1, local_size_z = 1) in;
 
-layout(std430, binding = 0) buffer StateBuffer {
+// States ping-pong between StateBuffer and NextStateBuffer (the host
+// swaps the bindings after every dispatch), so a coupled RHS reads its
+// neighbours' old values whatever order invocations run in
+layout(std430, binding = 0) readonly buffer StateBuffer {
     float current_state[];  // [eq0, eq1, eq2, ..., eq_N-1]
 };
 
+layout(std430, binding = 5) writeonly buffer NextStateBuffer {
+    float next_state[];
+};
+
 layout(std430, binding = 1) buffer ParamBuffer {
     float dt;
     float t_current;
@@ -21,6 +40,12 @@ layout(std430, binding = 3) buffer TimeBuffer {
     int total_steps;
 };
 
+#if COMPENSATED
+layout(std430, binding = 4) buffer CompensationBuffer {
+    float state_carry[];  // Rounding error of the last update, per equation
+};
+#endif
+
 // User-defined RHS function - will be substituted at runtime
 {{RHS_FUNCTION}}
 
@@ -34,10 +59,19 @@ void main() {
     
     float y_current = current_state[eq_idx];
     float dydt = evaluate_rhs(eq_idx, y_current, t_current);
+#if COMPENSATED
+    // Neumaier two-sum: y_current + increment == y_new + carry exactly
+    PRECISE float increment = dt * dydt + state_carry[eq_idx];
+    PRECISE float y_new = y_current + increment;
+    PRECISE float carry = abs(y_current) >= abs(increment) ? (y_current - y_new) + increment
+                                                           : (increment - y_new) + y_current;
+    state_carry[eq_idx] = carry;
+#else
     float y_new = y_current + dt * dydt;
+#endif
     
-    // Update state for next timestep
-    current_state[eq_idx] = y_new;
+    // State for the next timestep
+    next_state[eq_idx] = y_new;
     
     // Store in time series (if recording)
     if (current_step >= 0 && current_step < total_steps) {
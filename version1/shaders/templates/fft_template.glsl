@@ -0,0 +1,53 @@
+#version 310 es
+// Batched complex FFT: one workgroup transforms one row of FFT_SIZE points
+// held in shared memory. Radix-2 Stockham passes ping-pong between the two
+// halves of `work`; ShaderGenerator::generate_fft_shader unrolls them so
+// every barrier() sits outside control flow, as GLSL ES 3.10 requires.
+// Dispatch one workgroup per row.
+#define FFT_SIZE {{FFT_SIZE}}u
+#define HALF_SIZE {{HALF_SIZE}}u
+#define WORKGROUP_SIZE {{WORKGROUP_SIZE}}u
+#define DIRECTION {{DIRECTION}}   // -1.0 forward, 1.0 inverse
+#define SCALE {{SCALE}}           // 1.0 forward, 1 / FFT_SIZE inverse
+
+layout(local_size_x = {{WORKGROUP_SIZE}}, local_size_y = 1, local_size_z = 1) in;
+
+layout(std430, binding = 0) buffer DataBuffer {
+    vec2 data[];  // [row0 (re, im) x FFT_SIZE, row1 ..., ...], transformed in place
+};
+
+shared vec2 work[2u * FFT_SIZE];
+
+vec2 complex_mul(vec2 a, vec2 b) {
+    return vec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+}
+
+// Splits sub-transforms of `len` points at stride `stride` (a power of two)
+// from work[src ...] into work[dst ...]
+void butterflies(uint len, uint log2_stride, uint src, uint dst) {
+    uint m = len / 2u;
+    float theta = DIRECTION * 6.28318530717958647 / float(len);
+    for (uint t = gl_LocalInvocationID.x; t < HALF_SIZE; t += WORKGROUP_SIZE) {
+        uint p = t >> log2_stride;
+        uint q = t & ((1u << log2_stride) - 1u);
+        vec2 a = work[src + q + (p << log2_stride)];
+        vec2 b = work[src + q + ((p + m) << log2_stride)];
+        float angle = theta * float(p);
+        work[dst + q + ((2u * p) << log2_stride)] = a + b;
+        work[dst + q + ((2u * p + 1u) << log2_stride)] = complex_mul(a - b, vec2(cos(angle), sin(angle)));
+    }
+}
+
+void main() {
+    uint base = gl_WorkGroupID.x * FFT_SIZE;
+    for (uint i = gl_LocalInvocationID.x; i < FFT_SIZE; i += WORKGROUP_SIZE) {
+        work[i] = data[base + i];
+    }
+    memoryBarrierShared();
+    barrier();
+
+{{FFT_PASSES}}
+    for (uint i = gl_LocalInvocationID.x; i < FFT_SIZE; i += WORKGROUP_SIZE) {
+        data[base + i] = SCALE * work[{{RESULT_OFFSET}}u + i];
+    }
+}
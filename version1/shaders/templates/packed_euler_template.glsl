@@ -0,0 +1,67 @@
+#version 310 es
+// Explicit Euler over a packed batch of different builtin systems: one
+// invocation per equation, one dispatch per step for the whole batch.
+// Members are grouped by type into segments (PackedBatchLayout), each
+// starting on a workgroup boundary, so a workgroup only ever runs one
+// type's RHS. States ping-pong between StateBuffer and NextStateBuffer:
+// coupled equations of a member read each other's old values.
+layout(local_size_x = {{WORKGROUP_SIZE}}, local_size_y = 1, local_size_z = 1) in;
+
+struct Segment {
+    uint first_eq;      // First equation, aligned to the workgroup size
+    uint end_eq;        // One past the last member's last equation
+    uint member_dim;
+    uint param_base;    // member_params offset of the segment's first member
+    uint param_count;   // Parameters per member
+    uint rhs_id;        // BuiltinRHS id
+};
+
+layout(std430, binding = 0) readonly buffer StateBuffer {
+    float current_state[];  // Packed members, padding between segments
+};
+
+layout(std430, binding = 1) writeonly buffer NextStateBuffer {
+    float next_state[];
+};
+
+layout(std430, binding = 2) readonly buffer ParamBuffer {
+    float member_params[];  // [member0 p0, p1, ..., member1 p0, ...] per segment
+};
+
+layout(std430, binding = 3) readonly buffer SegmentBuffer {
+    Segment segments[];
+};
+
+layout(std430, binding = 4) buffer ControlBuffer {
+    float dt;
+    float t_current;
+    int n_equations;    // Padded total
+    int n_segments;
+};
+
+// Parameters of the member this invocation belongs to; the RHS functions
+// below read them through their uniform-name macros
+uint member_param_base;
+
+{{RHS_FUNCTIONS}}
+
+void main() {
+    uint eq_idx = gl_GlobalInvocationID.x;
+    if (eq_idx >= uint(n_equations)) return;
+
+    // One segment per (type, size): a short scan
+    int s = 0;
+    while (s + 1 < n_segments && eq_idx >= segments[s + 1].first_eq) s++;
+    Segment segment = segments[s];
+    if (eq_idx >= segment.end_eq) return;  // Padding before the next segment
+
+    uint member = (eq_idx - segment.first_eq) / segment.member_dim;
+    member_param_base = segment.param_base + member * segment.param_count;
+
+    float y_current = current_state[eq_idx];
+    float dydt = 0.0;
+    switch (segment.rhs_id) {
+{{RHS_DISPATCH}}
+    }
+    next_state[eq_idx] = y_current + dt * dydt;
+}
@@ -0,0 +1,523 @@
+#include "../../include/auto_dispatcher.h"
+#include "../../include/builtin_rhs_registry.h"
+#include "../../include/gpu_context_manager.h"
+#include "../../include/gpu_executor.h"
+#include "../../include/test_problems.h"
+#include "../../include/timer.h"
+#include "../../include/trace.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// Weight of the newest actual/predicted ratio in the correction factor
+constexpr double kCorrectionRate = 0.3;
+
+// Minimum wall time of one RHS cost probe
+constexpr long long kProbeNs = 50000;
+
+// Decisions kept in history(); the older half is dropped beyond this
+constexpr size_t kMaxHistory = 4096;
+
+int stages_for(const std::string& method) {
+    return method == "euler" ? 1 : 6;
+}
+
+// GPU half of CostCalibration::measure(); runs on the executor thread
+void measure_gpu(CostCalibration& c, double dt) {
+    if (!GPUContextManager::instance().initialize()) {
+        return;
+    }
+
+    Timer timer;
+    std::vector<std::vector<double>> solution;
+
+    // GPU: first solve pays context + compile, a 1-equation run is pure
+    // per-step overhead, a large run adds per-equation and readback cost
+    GPUEulerBackend gpu;
+    auto exponential = TestProblems::create_exponential_decay();
+
+    timer.start();
+    gpu.solve(exponential, 0.0, 0.0, dt, {1.0}, solution);
+    if (solution.empty()) {
+        return;
+    }
+    c.gpu_setup_ms = timer.elapsed_ns() / 1e6;
+
+    const int overhead_steps = 200;
+    timer.start();
+    gpu.solve(exponential, 0.0, (overhead_steps + 0.5) * dt, dt, {1.0}, solution);
+    c.gpu_dispatch_overhead_us = timer.elapsed_ns() / (overhead_steps * 1e3);
+
+    const int big_n = 1 << 18;
+    const int big_steps = 20;
+    std::vector<double> y0(big_n, 1.0);
+    timer.start();
+    gpu.solve(exponential, 0.0, (big_steps + 0.5) * dt, dt, y0, solution);
+    double per_step_s = timer.elapsed() / big_steps;
+
+    const GPUSolveStats& stats = gpu.last_stats();
+    if (stats.host_readback_seconds > 0) {
+        c.gpu_readback_bytes_per_s = big_steps * big_n * sizeof(float) / stats.host_readback_seconds;
+    }
+    double kernel_s = stats.gpu_timing_available
+        ? stats.gpu_dispatch_seconds / big_steps
+        : per_step_s - c.gpu_dispatch_overhead_us * 1e-6
+                     - big_n * sizeof(float) / c.gpu_readback_bytes_per_s;
+    c.gpu_ns_per_eq_step = std::max(0.01, kernel_s * 1e9 / big_n);
+    c.gpu_available = true;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// CostCalibration
+// ---------------------------------------------------------------------------
+
+CostCalibration CostCalibration::defaults() {
+    CostCalibration c;
+    c.cpu_euler_ns_per_eq_step = 12.0;
+    c.cpu_rk45_ns_per_eq_step = 80.0;
+    c.cpu_ref_rhs_ns_per_eq = 9.0;
+    c.thread_fork_us = 5.0;
+    c.thread_efficiency = 0.8;
+    c.gpu_available = true;
+    c.gpu_setup_ms = 50.0;
+    c.gpu_dispatch_overhead_us = 120.0;
+    c.gpu_ns_per_eq_step = 1.0;
+    c.gpu_readback_bytes_per_s = 400e6;
+    return c;
+}
+
+CostCalibration CostCalibration::measure(ThreadPool& pool, bool include_gpu) {
+    CostCalibration c = defaults();
+    Timer timer;
+
+    // CPU: the single-thread path the dispatcher actually runs
+    const int n = 20000;
+    const int steps = 20;
+    const double dt = 0.001;
+    auto reference = TestProblems::create_scalability_test(n);
+    std::vector<std::vector<double>> solution;
+
+    ThreadedCPUBackend euler("euler", pool);
+    euler.set_max_threads(1);
+    timer.start();
+    euler.solve(reference, 0.0, steps * dt, dt, reference.initial_conditions, solution);
+    c.cpu_euler_ns_per_eq_step = timer.elapsed_ns() / (static_cast<double>(steps) * n);
+
+    ThreadedCPUBackend rk45("rk45", pool);
+    rk45.set_max_threads(1);
+    timer.start();
+    rk45.solve(reference, 0.0, steps * dt, dt, reference.initial_conditions, solution);
+    double rk45_single_ns = static_cast<double>(timer.elapsed_ns());
+    c.cpu_rk45_ns_per_eq_step = rk45_single_ns / (static_cast<double>(steps) * n);
+
+    std::vector<double> dydt(n);
+    const int rhs_reps = 20;
+    timer.start();
+    for (int r = 0; r < rhs_reps; ++r) {
+        reference.rhs_range(0.0, reference.initial_conditions, dydt, 0, n);
+    }
+    c.cpu_ref_rhs_ns_per_eq = timer.elapsed_ns() / (static_cast<double>(rhs_reps) * n);
+
+    if (pool.size() > 1) {
+        const int forks = 1000;
+        timer.start();
+        for (int r = 0; r < forks; ++r) {
+            pool.parallel_for(0, pool.size(), [](long long, long long, int) {});
+        }
+        c.thread_fork_us = timer.elapsed_ns() / (forks * 1e3);
+
+        ThreadedCPUBackend threaded("rk45", pool);
+        timer.start();
+        threaded.solve(reference, 0.0, steps * dt, dt, reference.initial_conditions, solution);
+        double threaded_ns = timer.elapsed_ns() - steps * 6 * c.thread_fork_us * 1e3;
+        if (threaded_ns > 0) {
+            c.thread_efficiency = std::min(1.0, std::max(0.05,
+                rk45_single_ns / (pool.size() * threaded_ns)));
+        }
+    }
+
+    c.gpu_available = false;
+    if (include_gpu) {
+        GPUExecutor::instance().run_on_gpu_thread([&]() { measure_gpu(c, dt); });
+    }
+    return c;
+}
+
+bool CostCalibration::save(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "CostCalibration: cannot write " << path << std::endl;
+        return false;
+    }
+
+    out << "# AutoDispatcher cost model calibration\n";
+    out << "cpu_euler_ns_per_eq_step " << cpu_euler_ns_per_eq_step << "\n";
+    out << "cpu_rk45_ns_per_eq_step " << cpu_rk45_ns_per_eq_step << "\n";
+    out << "cpu_ref_rhs_ns_per_eq " << cpu_ref_rhs_ns_per_eq << "\n";
+    out << "thread_fork_us " << thread_fork_us << "\n";
+    out << "thread_efficiency " << thread_efficiency << "\n";
+    out << "gpu_available " << (gpu_available ? 1 : 0) << "\n";
+    out << "gpu_setup_ms " << gpu_setup_ms << "\n";
+    out << "gpu_dispatch_overhead_us " << gpu_dispatch_overhead_us << "\n";
+    out << "gpu_ns_per_eq_step " << gpu_ns_per_eq_step << "\n";
+    out << "gpu_readback_bytes_per_s " << gpu_readback_bytes_per_s << "\n";
+    return out.good();
+}
+
+bool CostCalibration::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    const std::map<std::string, double CostCalibration::*> fields = {
+        {"cpu_euler_ns_per_eq_step", &CostCalibration::cpu_euler_ns_per_eq_step},
+        {"cpu_rk45_ns_per_eq_step", &CostCalibration::cpu_rk45_ns_per_eq_step},
+        {"cpu_ref_rhs_ns_per_eq", &CostCalibration::cpu_ref_rhs_ns_per_eq},
+        {"thread_fork_us", &CostCalibration::thread_fork_us},
+        {"thread_efficiency", &CostCalibration::thread_efficiency},
+        {"gpu_setup_ms", &CostCalibration::gpu_setup_ms},
+        {"gpu_dispatch_overhead_us", &CostCalibration::gpu_dispatch_overhead_us},
+        {"gpu_ns_per_eq_step", &CostCalibration::gpu_ns_per_eq_step},
+        {"gpu_readback_bytes_per_s", &CostCalibration::gpu_readback_bytes_per_s},
+    };
+
+    // Keys missing from the file keep their defaults
+    CostCalibration loaded = defaults();
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream entry(line);
+        std::string key;
+        double value;
+        if (!(entry >> key >> value)) {
+            std::cerr << "CostCalibration: bad line in " << path << ": " << line << std::endl;
+            return false;
+        }
+        if (key == "gpu_available") {
+            loaded.gpu_available = value != 0.0;
+            continue;
+        }
+        auto field = fields.find(key);
+        if (field != fields.end()) {
+            loaded.*(field->second) = value;
+        }
+    }
+
+    *this = loaded;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// AutoDispatcher
+// ---------------------------------------------------------------------------
+
+AutoDispatcher::AutoDispatcher(const std::string& method, ThreadPool& pool,
+                               const CostCalibration& calibration)
+    : method_(method == "explicit_euler" ? "euler" : method == "runge_kutta" ? "rk45" : method),
+      pool_(pool), calibration_(calibration), verbose_(true),
+      cpu_single_(method, pool), cpu_threaded_(method, pool), cpu_ensemble_(method, pool),
+      hybrid_(method, pool) {
+    cpu_single_.set_max_threads(1);
+    if (method_ == "euler" || method_ == "rk45") {
+        vm_ensemble_ = std::make_unique<VMEnsembleBackend>(method_, pool);
+    }
+}
+
+void AutoDispatcher::set_scaling_table(const ScalingTable* table) {
+    cpu_threaded_.set_scaling_table(table);
+    cpu_ensemble_.set_scaling_table(table);
+}
+
+double AutoDispatcher::correction(const std::string& backend) const {
+    auto it = correction_.find(backend);
+    return it != correction_.end() ? it->second : 1.0;
+}
+
+double AutoDispatcher::rhs_ns_per_eq(const ODESystem& system) {
+    std::string key = system.name + "#" + std::to_string(system.dimension);
+    auto cached = rhs_cost_cache_.find(key);
+    if (cached != rhs_cost_cache_.end()) {
+        return cached->second;
+    }
+
+    // Time a slice when the system can evaluate one, else whole calls
+    const int n = system.dimension;
+    std::vector<double> y = system.initial_conditions;
+    y.resize(n, 0.0);
+    std::vector<double> dydt(n);
+    int slice = system.has_range_rhs() ? std::min(n, 4096) : n;
+
+    Timer timer;
+    long long reps = 0;
+    timer.start();
+    do {
+        if (system.has_range_rhs()) {
+            system.rhs_range(0.0, y, dydt, 0, slice);
+        } else {
+            system.evaluate_rhs(0.0, y, dydt);
+        }
+        reps++;
+    } while (timer.elapsed_ns() < kProbeNs && reps < 1000);
+
+    double ns = timer.elapsed_ns() / (static_cast<double>(reps) * slice);
+    rhs_cost_cache_[key] = ns;
+    return ns;
+}
+
+bool AutoDispatcher::gpu_eligible(const ODESystem& system) const {
+    // Only an Euler kernel exists, and only for builtin GLSL RHS
+    return calibration_.gpu_available && method_ == "euler" &&
+           system.use_builtin_rhs() && !system.gpu_info->force_cpu_fallback &&
+           BuiltinRHSRegistry::has_rhs(system.gpu_info->builtin_rhs_name);
+}
+
+bool AutoDispatcher::gpu_ensemble_eligible(const ODESystem& system) const {
+    return gpu_eligible(system) && gpu_ensemble_.supports(system);
+}
+
+bool AutoDispatcher::vm_eligible(const ODESystem& system) const {
+    return vm_ensemble_ && system.rhs_interpreted && system.program;
+}
+
+double AutoDispatcher::predict_cpu(const ODESystem& system, long long n, int n_steps, int threads) {
+    const int stages = stages_for(method_);
+    double base = method_ == "euler" ? calibration_.cpu_euler_ns_per_eq_step
+                                     : calibration_.cpu_rk45_ns_per_eq_step;
+
+    // Reference cost with the reference RHS swapped for this system's
+    double per_eq = base + stages * (rhs_ns_per_eq(system) - calibration_.cpu_ref_rhs_ns_per_eq);
+    per_eq = std::max(per_eq, 0.25 * base);
+
+    double seconds = static_cast<double>(n_steps) * n * per_eq * 1e-9;
+    if (threads > 1) {
+        seconds = seconds / (threads * calibration_.thread_efficiency) +
+                  static_cast<double>(n_steps) * stages * calibration_.thread_fork_us * 1e-6;
+    }
+    return seconds;
+}
+
+double AutoDispatcher::predict_gpu(const ODESystem& system, long long n, int n_steps,
+                                   bool readback_every_step) const {
+    double setup = gpu_shaders_ready_.count(system.gpu_info->builtin_rhs_name)
+        ? 0.0 : calibration_.gpu_setup_ms * 1e-3;
+    double readback = n * sizeof(float) / calibration_.gpu_readback_bytes_per_s;
+    double per_step = calibration_.gpu_dispatch_overhead_us * 1e-6 +
+                      n * calibration_.gpu_ns_per_eq_step * 1e-9;
+    if (readback_every_step) {
+        return setup + n_steps * (per_step + readback);
+    }
+    return setup + n_steps * per_step + readback;
+}
+
+DispatchDecision AutoDispatcher::choose(DispatchDecision decision) const {
+    for (auto& candidate : decision.candidates) {
+        candidate.second *= correction(candidate.first);
+    }
+    auto best = std::min_element(decision.candidates.begin(), decision.candidates.end(),
+        [](const std::pair<std::string, double>& a, const std::pair<std::string, double>& b) {
+            return a.second < b.second;
+        });
+    decision.backend = best->first;
+    decision.predicted_seconds = best->second;
+    return decision;
+}
+
+DispatchDecision AutoDispatcher::plan(const ODESystem& system, double t0, double tf, double dt) {
+    DispatchDecision decision;
+    decision.system_name = system.name;
+    decision.n_equations = system.dimension;
+    decision.n_steps = static_cast<int>((tf - t0) / dt) + 1;
+
+    const long long n = decision.n_equations;
+    const int steps = decision.n_steps - 1;
+
+    decision.candidates.push_back({"CPU_Single_" + method_, predict_cpu(system, n, steps, 1)});
+
+    int threads = static_cast<int>(std::min<long long>(cpu_threaded_.threads_for(static_cast<int>(n)), n));
+    if (system.has_range_rhs() && threads > 1) {
+        decision.candidates.push_back({cpu_threaded_.name(), predict_cpu(system, n, steps, threads)});
+    }
+    if (gpu_eligible(system)) {
+        decision.candidates.push_back({gpu_euler_.name(), predict_gpu(system, n, steps)});
+    }
+    return choose(decision);
+}
+
+DispatchDecision AutoDispatcher::plan_ensemble(const ODESystem& system, double t0, double tf,
+                                               double dt, int n_members) {
+    DispatchDecision decision;
+    decision.system_name = system.name + " x" + std::to_string(n_members);
+    decision.n_equations = static_cast<long long>(n_members) * system.dimension;
+    decision.n_steps = static_cast<int>((tf - t0) / dt) + 1;
+
+    const long long n = decision.n_equations;
+    const int steps = decision.n_steps - 1;
+
+    if (vm_eligible(system)) {
+        // Batches of members share each decoded instruction; the tape's
+        // per-member cost measured by predict_cpu bounds the VM from above
+        const int batches = (n_members + vm_ensemble_->width() - 1) / vm_ensemble_->width();
+        int threads = std::min(pool_.size(), batches);
+        double seconds = predict_cpu(system, n, steps, 1);
+        if (threads > 1) {
+            seconds = seconds / (threads * calibration_.thread_efficiency) + calibration_.thread_fork_us * 1e-6;
+        }
+        decision.candidates.push_back({vm_ensemble_->name(), seconds});
+    } else {
+        decision.candidates.push_back({"CPU_Ensemble_Single", predict_cpu(system, n, steps, 1)});
+
+        // Members need no per-step synchronisation: one fork for the whole run
+        int threads = std::min(cpu_ensemble_.threads_for(n_members), n_members);
+        if (threads > 1) {
+            double seconds = predict_cpu(system, n, steps, 1) / (threads * calibration_.thread_efficiency) +
+                             calibration_.thread_fork_us * 1e-6;
+            decision.candidates.push_back({cpu_ensemble_.name(), seconds});
+        }
+    }
+    if (gpu_ensemble_eligible(system)) {
+        // Ensembles read back only the final states
+        double gpu_seconds = predict_gpu(system, n, steps, false);
+        decision.candidates.push_back({gpu_ensemble_.name(), gpu_seconds});
+
+        // Hybrid: GPU plus the remaining cores, each at its own throughput
+        int cpu_threads = std::min(pool_.size() - 1, n_members);
+        if (cpu_threads > 0) {
+            double setup = gpu_shaders_ready_.count(system.gpu_info->builtin_rhs_name)
+                ? 0.0 : calibration_.gpu_setup_ms * 1e-3;
+            double cpu_seconds = predict_cpu(system, n, steps, 1) /
+                (cpu_threads > 1 ? cpu_threads * calibration_.thread_efficiency : 1.0);
+            double gpu_steady = gpu_seconds - setup;
+            double combined = setup + 1.0 / (1.0 / gpu_steady + 1.0 / cpu_seconds);
+            decision.candidates.push_back({hybrid_.name(), combined});
+        }
+    }
+    return choose(decision);
+}
+
+void AutoDispatcher::record(DispatchDecision& decision, double actual_seconds) {
+    decision.actual_seconds = actual_seconds;
+
+    // Learn against the uncorrected model so the factor does not compound
+    double factor = correction(decision.backend);
+    double raw_prediction = decision.predicted_seconds / factor;
+    if (raw_prediction > 0 && actual_seconds > 0) {
+        correction_[decision.backend] =
+            (1.0 - kCorrectionRate) * factor + kCorrectionRate * (actual_seconds / raw_prediction);
+    }
+
+    if (verbose_) {
+        std::cout << "AutoDispatcher: " << decision.system_name
+                  << " (N=" << decision.n_equations << ", steps=" << decision.n_steps << ") -> "
+                  << decision.backend << std::fixed << std::setprecision(3)
+                  << " | predicted " << decision.predicted_seconds * 1e3 << " ms"
+                  << ", actual " << actual_seconds * 1e3 << " ms"
+                  << ", error " << std::showpos << std::setprecision(1)
+                  << decision.prediction_error() * 100.0 << "%" << std::noshowpos << std::endl;
+        for (const auto& candidate : decision.candidates) {
+            if (candidate.first == decision.backend) continue;
+            std::cout << "    rejected " << candidate.first << std::fixed << std::setprecision(3)
+                      << " (predicted " << candidate.second * 1e3 << " ms)" << std::endl;
+        }
+    }
+
+    // Long-lived dispatchers (daemon, coalescer) must not grow without bound
+    if (history_.size() >= kMaxHistory) {
+        history_.erase(history_.begin(), history_.begin() + kMaxHistory / 2);
+    }
+    history_.push_back(decision);
+}
+
+void AutoDispatcher::solve(const ODESystem& system,
+                           double t0, double tf, double dt,
+                           const std::vector<double>& y0,
+                           std::vector<std::vector<double>>& solution) {
+    ODE_TRACE_SCOPE_CAT("auto_dispatch_solve", "dispatch");
+
+    DispatchDecision decision = plan(system, t0, tf, dt);
+    Timer timer;
+    timer.start();
+
+    if (decision.backend == gpu_euler_.name()) {
+        solution.clear();
+        GPUExecutor::instance().run_on_gpu_thread([&]() {
+            gpu_euler_.solve(system, t0, tf, dt, y0, solution);
+        });
+        if (static_cast<int>(solution.size()) == decision.n_steps) {
+            gpu_shaders_ready_.insert(system.gpu_info->builtin_rhs_name);
+            record(decision, timer.elapsed());
+            return;
+        }
+
+        // GPU unusable on this machine: stop predicting it and re-route
+        std::cerr << "AutoDispatcher: GPU solve failed, disabling GPU backends" << std::endl;
+        calibration_.gpu_available = false;
+        decision = plan(system, t0, tf, dt);
+        timer.start();
+    }
+
+    if (decision.backend == cpu_threaded_.name()) {
+        cpu_threaded_.solve(system, t0, tf, dt, y0, solution);
+    } else {
+        cpu_single_.solve(system, t0, tf, dt, y0, solution);
+    }
+    record(decision, timer.elapsed());
+}
+
+void AutoDispatcher::solve_ensemble(const ODESystem& system,
+                                    double t0, double tf, double dt,
+                                    const std::vector<double>& y0,
+                                    int n_members,
+                                    std::vector<double>& final_states) {
+    ODE_TRACE_SCOPE_CAT("auto_dispatch_ensemble", "dispatch");
+
+    DispatchDecision decision = plan_ensemble(system, t0, tf, dt, n_members);
+    Timer timer;
+    timer.start();
+
+    if (decision.backend == gpu_ensemble_.name()) {
+        GPUExecutor::instance().run_on_gpu_thread([&]() {
+            gpu_ensemble_.solve_ensemble(system, t0, tf, dt, y0, n_members, final_states);
+        });
+        if (final_states.size() == y0.size()) {
+            gpu_shaders_ready_.insert(system.gpu_info->builtin_rhs_name);
+            record(decision, timer.elapsed());
+            return;
+        }
+
+        std::cerr << "AutoDispatcher: GPU solve failed, disabling GPU backends" << std::endl;
+        calibration_.gpu_available = false;
+        decision = plan_ensemble(system, t0, tf, dt, n_members);
+        timer.start();
+    }
+
+    if (vm_ensemble_ && decision.backend == vm_ensemble_->name()) {
+        vm_ensemble_->solve_ensemble(system, t0, tf, dt, y0, n_members, final_states);
+        record(decision, timer.elapsed());
+        return;
+    }
+
+    if (decision.backend == hybrid_.name()) {
+        // A failed GPU chunk is redone on the CPU inside the executor
+        hybrid_.solve_ensemble(system, t0, tf, dt, y0, n_members, final_states);
+        if (hybrid_.last_stats().gpu_failed) {
+            calibration_.gpu_available = false;
+        } else {
+            gpu_shaders_ready_.insert(system.gpu_info->builtin_rhs_name);
+        }
+        record(decision, timer.elapsed());
+        return;
+    }
+
+    cpu_ensemble_.set_max_threads(decision.backend == "CPU_Ensemble_Single" ? 1 : 0);
+    cpu_ensemble_.solve_ensemble(system, t0, tf, dt, y0, n_members, final_states);
+    record(decision, timer.elapsed());
+}
@@ -1,32 +1,38 @@
 #include "../../include/steppers.h"
 #include "../../include/solver_base.h"
+#include "../../include/trace.h"
 #include <memory>
 
-class CPUBackend : public SolverBase {
+template <typename Scalar>
+class BasicCPUBackend : public BasicSolverBase<Scalar> {
 public:
-    CPUBackend(std::unique_ptr<TimeStepper> stepper) 
+    BasicCPUBackend(std::unique_ptr<BasicTimeStepper<Scalar>> stepper) 
         : stepper_(std::move(stepper)) {}
     
-    void solve(const ODESystem& system, 
+    void solve(const BasicODESystem<Scalar>& system, 
               double t0, double tf, double dt,
-              const std::vector<double>& y0,
-              std::vector<std::vector<double>>& solution) override {
+              const std::vector<Scalar>& y0,
+              std::vector<std::vector<Scalar>>& solution) override {
+        
+        ODE_TRACE_SCOPE_CAT("cpu_solve", "cpu");
         
         int n_steps = static_cast<int>((tf - t0) / dt) + 1;
-        solution.clear();
-        solution.reserve(n_steps);
         
-        std::vector<double> y = y0;
+        // Allocate all output rows up front; the loop below only copies into them
+        solution.assign(n_steps, std::vector<Scalar>(y0.size()));
+        
+        std::vector<Scalar> y = y0;
         double t = t0;
         
         // Store initial condition
-        solution.push_back(y);
+        solution[0] = y;
         
         // Integration loop using stepper
         for (int i = 1; i < n_steps; ++i) {
+            ODE_TRACE_SCOPE_CAT("step", "cpu");
             stepper_->step(system, t, dt, y);
             t = t0 + i * dt;
-            solution.push_back(y);
+            solution[i] = y;
         }
     }
     
@@ -35,5 +41,7 @@ public:
     }
 
 private:
-    std::unique_ptr<TimeStepper> stepper_;
-}; 
\ No newline at end of file
+    std::unique_ptr<BasicTimeStepper<Scalar>> stepper_;
+};
+
+using CPUBackend = BasicCPUBackend<double>;
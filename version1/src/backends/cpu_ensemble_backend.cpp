@@ -0,0 +1,65 @@
+#include "../../include/ensemble.h"
+#include "../../include/trace.h"
+#include <algorithm>
+#include <stdexcept>
+
+CPUEnsembleBackend::CPUEnsembleBackend(const std::string& method, ThreadPool& pool)
+    : method_(method), pool_(pool), max_threads_(0), scaling_table_(nullptr) {
+    // Validate the method once, and give every potential worker its stepper
+    for (int w = 0; w < pool_.size(); ++w) {
+        steppers_.push_back(create_stepper(method_));
+    }
+    member_y_.resize(pool_.size());
+}
+
+int CPUEnsembleBackend::threads_for(int n_members) const {
+    int threads = max_threads_ > 0 ? max_threads_ : pool_.size();
+    if (scaling_table_) {
+        threads = scaling_table_->choose_threads("ensemble", n_members, threads);
+    }
+    return std::max(1, std::min(threads, pool_.size()));
+}
+
+void CPUEnsembleBackend::solve_ensemble(const ODESystem& system,
+                                        double t0, double tf, double dt,
+                                        const std::vector<double>& y0,
+                                        int n_members,
+                                        std::vector<double>& final_states) {
+    if (static_cast<long long>(y0.size()) != static_cast<long long>(n_members) * system.dimension) {
+        throw std::invalid_argument("Ensemble initial state size does not match n_members * dimension");
+    }
+    final_states.resize(y0.size());
+    solve_ensemble(system, t0, tf, dt, y0.data(), n_members, final_states.data());
+}
+
+void CPUEnsembleBackend::solve_ensemble(const ODESystem& system,
+                                        double t0, double tf, double dt,
+                                        const double* y0,
+                                        int n_members,
+                                        double* final_states) {
+    ODE_TRACE_SCOPE_CAT("cpu_ensemble_solve", "cpu");
+
+    const int dim = system.dimension;
+    int n_steps = static_cast<int>((tf - t0) / dt) + 1;
+
+    // Worker scratch is only touched inside parallel_for, whose calls the
+    // pool serializes, so concurrent solves never share it mid-flight
+    pool_.parallel_for(0, n_members, [&](long long b, long long e, int worker) {
+        TimeStepper& stepper = *steppers_[worker];
+        std::vector<double>& y = member_y_[worker];
+        y.resize(dim);
+
+        for (long long m = b; m < e; ++m) {
+            const double* start = y0 + m * dim;
+            std::copy(start, start + dim, y.begin());
+
+            // Same time sequence as CPUBackend, so member m matches a
+            // single-system solve from the same initial state
+            for (int i = 1; i < n_steps; ++i) {
+                stepper.step(system, t0 + (i - 1) * dt, dt, y);
+            }
+
+            std::copy(y.begin(), y.end(), final_states + m * dim);
+        }
+    }, threads_for(n_members));
+}
@@ -0,0 +1,59 @@
+#include "../../include/gpu_ensemble_backend.h"
+#include "../../include/builtin_rhs_registry.h"
+#include "../../include/trace.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+bool GPUEnsembleBackend::supports(const ODESystem& system) const {
+    if (!system.use_builtin_rhs() || system.gpu_info->force_cpu_fallback) {
+        return false;
+    }
+
+    if (!BuiltinRHSRegistry::has_rhs(system.gpu_info->builtin_rhs_name)) {
+        return false;
+    }
+
+    // Packing is only safe if the kernel never couples across members
+    int width = BuiltinRHSRegistry::get_rhs(system.gpu_info->builtin_rhs_name).coupling_width;
+    return width > 0 && system.dimension % width == 0;
+}
+
+bool GPUEnsembleBackend::solve_members(const ODESystem& system, double t0, double tf, double dt,
+                                       const double* y0, int n_members, double* final_states) {
+    ODE_TRACE_SCOPE_CAT("gpu_ensemble_solve", "gpu");
+
+    const size_t n_values = static_cast<size_t>(n_members) * system.dimension;
+    int steps = static_cast<int>((tf - t0) / dt);
+    if (steps == 0) {
+        std::copy(y0, y0 + n_values, final_states);
+        return true;
+    }
+
+    // Only the final states come back: no trajectory on either side
+    if (!euler_.solve_final(system, t0, tf, dt, y0, n_values, final_states)) {
+        std::cerr << "GPU Ensemble: solve failed" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void GPUEnsembleBackend::solve_ensemble(const ODESystem& system,
+                                        double t0, double tf, double dt,
+                                        const std::vector<double>& y0,
+                                        int n_members,
+                                        std::vector<double>& final_states) {
+    if (static_cast<long long>(y0.size()) != static_cast<long long>(n_members) * system.dimension) {
+        throw std::invalid_argument("Ensemble initial state size does not match n_members * dimension");
+    }
+    if (!supports(system)) {
+        std::cerr << "GPU Ensemble: system has no member-aligned builtin GPU RHS" << std::endl;
+        final_states.clear();
+        return;
+    }
+
+    final_states.resize(y0.size());
+    if (!solve_members(system, t0, tf, dt, y0.data(), n_members, final_states.data())) {
+        final_states.clear();
+    }
+}
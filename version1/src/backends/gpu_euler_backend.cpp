@@ -1,17 +1,40 @@
 #include "../../include/gpu_euler_backend.h"
+#include "../../include/gpu_executor.h"
+#include "../../include/trace.h"
 #include <iostream>
 #include <functional>
+#include <chrono>
+#include <algorithm>
+#include <limits>
 
-GPUEulerBackend::GPUEulerBackend() {
+namespace {
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+}
+
+GPUEulerBackend::GPUEulerBackend(bool compensated) : compensated_(compensated) {
     // GPU context is managed by singleton, no need to initialize here
 }
 
 GPUEulerBackend::~GPUEulerBackend() {
-    // Clean up cached shaders only
-    for (auto& pair : shader_cache_) {
-        glDeleteProgram(pair.second);
+    // Clean up cached shaders and buffers on the thread the context is
+    // current on; backends driven through GPUExecutor are often destroyed
+    // elsewhere
+    auto release = [this]() {
+        for (auto& pair : shader_cache_) {
+            glDeleteProgram(pair.second);
+        }
+        shader_cache_.clear();
+        buffer_mgr_.cleanup();
+    };
+
+    GPUContextManager& context = GPUContextManager::instance();
+    if (shader_cache_.empty() || !context.is_initialized() || context.is_current_thread()) {
+        release();
+    } else {
+        GPUExecutor::instance().run_on_gpu_thread(release);
     }
-    shader_cache_.clear();
 }
 
 GLuint GPUEulerBackend::get_or_compile_shader(const ODESystem& system) {
@@ -38,11 +61,13 @@ GLuint GPUEulerBackend::get_or_compile_shader(const ODESystem& system) {
     std::string shader_source;
     try {
         if (system.use_builtin_rhs()) {
-            shader_source = shader_gen_.generate_euler_shader_builtin(system.gpu_info->builtin_rhs_name);
+            shader_source = shader_gen_.generate_euler_shader_builtin(system.gpu_info->builtin_rhs_name, compensated_);
         } else {
-            // Handle custom GLSL code (not implemented in this step)
-            std::cerr << "Custom GLSL RHS not yet implemented" << std::endl;
-            return 0;
+            // Custom snippet, e.g. emitted from an RHSProgram
+            RHSDefinition custom;
+            custom.glsl_code = system.gpu_info->glsl_rhs_code;
+            custom.uniform_names = system.gpu_info->uniform_names;
+            shader_source = shader_gen_.generate_euler_shader(custom, compensated_);
         }
     } catch (const std::exception& e) {
         std::cerr << "Shader generation failed: " << e.what() << std::endl;
@@ -72,12 +97,10 @@ void GPUEulerBackend::setup_uniforms(const ODESystem& system, SystemParams& para
     } else {
         // Fallback: try to extract from parameters map
         if (system.use_builtin_rhs()) {
-            auto& registry = BuiltinRHSRegistry::instance();
-            auto rhs_def = registry.get_rhs(system.gpu_info->builtin_rhs_name);
+            const BuiltinRHS& rhs_def = BuiltinRHSRegistry::get_rhs(system.gpu_info->builtin_rhs_name);
             
-            for (size_t i = 0; i < rhs_def.uniform_names.size() && i < 16; ++i) {
-                const std::string& uniform_name = rhs_def.uniform_names[i];
-                auto param_it = system.parameters.find(uniform_name);
+            for (int i = 0; i < rhs_def.uniform_count && i < 16; ++i) {
+                auto param_it = system.parameters.find(std::string(rhs_def.uniform_names[i]));
                 if (param_it != system.parameters.end()) {
                     params.user_uniforms[i] = static_cast<float>(param_it->second);
                 }
@@ -91,40 +114,86 @@ void GPUEulerBackend::solve(const ODESystem& system,
                            const std::vector<double>& y0,
                            std::vector<std::vector<double>>& solution) {
     
+    ODE_TRACE_SCOPE_CAT("gpu_euler_solve", "gpu");
+    
+    int n_equations = y0.size();
+    // Rows at t0, t0 + dt, ..., like the CPU backends: row 0 is y0 and
+    // every later row is one dispatch
+    int n_rows = static_cast<int>((tf - t0) / dt) + 1;
+    int n_steps = n_rows - 1;
+    
+    std::cout << "GPU Euler: Solving " << n_equations << " equations for " 
+              << n_steps << " steps" << std::endl;
+    
+    // Convert initial conditions to float
+    state_.assign(y0.begin(), y0.end());
+    
+    // Allocate output rows up front so the per-step loop does not touch
+    // the heap; left empty on failure
+    solution.assign(n_rows, std::vector<double>(n_equations));
+    solution[0] = y0;
+    if (!integrate(system, t0, dt, n_steps, state_, &solution)) {
+        solution.clear();
+        return;
+    }
+    
+    std::cout << "GPU Euler: Integration completed successfully" << std::endl;
+}
+
+bool GPUEulerBackend::solve_final(const ODESystem& system,
+                                  double t0, double tf, double dt,
+                                  const double* y0, size_t n_values,
+                                  double* final_state) {
+    ODE_TRACE_SCOPE_CAT("gpu_euler_solve_final", "gpu");
+    
+    // The shader indexes equations with int
+    if (n_values > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        std::cerr << "GPU Euler: " << n_values << " equations exceed the shader's int indexing" << std::endl;
+        return false;
+    }
+    
+    int n_steps = static_cast<int>((tf - t0) / dt);
+    state_.assign(y0, y0 + n_values);
+    if (!integrate(system, t0, dt, n_steps, state_, nullptr)) {
+        return false;
+    }
+    
+    std::copy(state_.begin(), state_.end(), final_state);
+    return true;
+}
+
+bool GPUEulerBackend::integrate(const ODESystem& system, double t0, double dt, int n_steps,
+                                std::vector<float>& state,
+                                std::vector<std::vector<double>>* rows) {
     // Initialize GPU context using singleton
     if (!GPUContextManager::instance().initialize()) {
         std::cerr << "Failed to initialize GPU context" << std::endl;
-        return;
+        return false;
     }
+    gpu_timer_.initialize();
+    gpu_timer_.reset();
+    stats_ = GPUSolveStats{};
     
     if (!system.has_gpu_support()) {
         std::cerr << "System does not have GPU support information" << std::endl;
-        return;
+        return false;
     }
     
-    int n_equations = y0.size();
-    int n_steps = static_cast<int>((tf - t0) / dt) + 1;
-    
-    std::cout << "GPU Euler: Solving " << n_equations << " equations for " 
-              << n_steps << " steps" << std::endl;
+    int n_equations = static_cast<int>(state.size());
     
     // Get or compile shader
     GLuint program = get_or_compile_shader(system);
     if (program == 0) {
         std::cerr << "Failed to get shader program" << std::endl;
-        return;
-    }
-    
-    // Convert initial conditions to float
-    std::vector<float> initial_state(n_equations);
-    for (int i = 0; i < n_equations; ++i) {
-        initial_state[i] = static_cast<float>(y0[i]);
+        return false;
     }
     
-    // Allocate GPU buffers
-    if (!buffer_mgr_.allocate_standard_buffers(n_equations, n_steps, initial_state)) {
+    // Final-state runs need no time series; total_steps = 0 also keeps the
+    // shader from writing one
+    const int recorded_steps = rows ? n_steps : 0;
+    if (!buffer_mgr_.allocate_standard_buffers(n_equations, recorded_steps, state, compensated_)) {
         std::cerr << "Failed to allocate GPU buffers" << std::endl;
-        return;
+        return false;
     }
     
     // Setup system parameters
@@ -135,41 +204,74 @@ void GPUEulerBackend::solve(const ODESystem& system,
     
     // Time control
     TimeControl time_ctrl;
-    time_ctrl.total_steps = n_steps;
+    time_ctrl.total_steps = recorded_steps;
     
     // Use program and bind buffers
     glUseProgram(program);
     buffer_mgr_.bind_buffers();
     
-    // Integration loop
-    solution.clear();
-    solution.reserve(n_steps);
+    const int dispatch_label = gpu_timer_.label_id("dispatch");
     
+    // Integration loop
     for (int step = 0; step < n_steps; ++step) {
+        ODE_TRACE_SCOPE_CAT("step", "gpu");
+        
         params.t_current = static_cast<float>(t0 + step * dt);
         time_ctrl.current_step = step;
         
         // Update GPU parameters
-        buffer_mgr_.update_system_params(params);
-        buffer_mgr_.update_time_control(time_ctrl);
+        {
+            ODE_TRACE_SCOPE_CAT("upload", "gpu");
+            buffer_mgr_.update_system_params(params);
+            buffer_mgr_.update_time_control(time_ctrl);
+        }
         
         // Dispatch compute shader - Mali G31 MP2 has 4 ALUs
-        GLuint work_groups = (n_equations + 3) / 4;  // 4 threads per work group
-        glDispatchCompute(work_groups, 1, 1);
-        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        {
+            ODE_TRACE_SCOPE_CAT("dispatch", "gpu");
+            GLuint work_groups = (n_equations + 3) / 4;  // 4 threads per work group
+            auto dispatch_start = std::chrono::steady_clock::now();
+            gpu_timer_.begin(dispatch_label);
+            glDispatchCompute(work_groups, 1, 1);
+            gpu_timer_.end();
+            stats_.host_dispatch_seconds += seconds_since(dispatch_start);
+            stats_.n_dispatches++;
+        }
+        {
+            ODE_TRACE_SCOPE_CAT("barrier", "gpu");
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        }
+        buffer_mgr_.swap_state_buffers();
+        gpu_timer_.poll();  // Non-blocking; picks up finished dispatch timings
+        
+        if (!rows) continue;
         
         // Read back current state
-        auto current_state = buffer_mgr_.read_state_buffer();
+        auto readback_start = std::chrono::steady_clock::now();
+        buffer_mgr_.read_state_buffer(state);
+        stats_.host_readback_seconds += seconds_since(readback_start);
         
         // Convert to double and store
-        std::vector<double> step_solution(n_equations);
+        ODE_TRACE_SCOPE_CAT("convert", "gpu");
+        std::vector<double>& step_solution = (*rows)[step + 1];
         for (int i = 0; i < n_equations; ++i) {
-            step_solution[i] = static_cast<double>(current_state[i]);
+            step_solution[i] = static_cast<double>(state[i]);
         }
-        solution.push_back(step_solution);
     }
     
-    std::cout << "GPU Euler: Integration completed successfully" << std::endl;
+    if (!rows && n_steps > 0) {
+        auto readback_start = std::chrono::steady_clock::now();
+        bool read = buffer_mgr_.read_state_buffer(state);
+        stats_.host_readback_seconds += seconds_since(readback_start);
+        if (!read) {
+            std::cerr << "Failed to read back the final GPU state" << std::endl;
+            return false;
+        }
+    }
+    
+    gpu_timer_.finish();
+    GPUTimingSummary dispatch_timing = gpu_timer_.summary("dispatch");
+    stats_.gpu_timing_available = dispatch_timing.count > 0;
+    stats_.gpu_dispatch_seconds = dispatch_timing.total_ns * 1e-9;
+    return true;
 }
-
- 
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "../../include/hybrid_ensemble.h"
+#include "../../include/gpu_executor.h"
+#include "../../include/timer.h"
+#include "../../include/trace.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+// Weight of the newest chunk in the throughput estimates
+constexpr double kRateSmoothing = 0.5;
+
+void update_rate(double& rate, double sample) {
+    rate = rate > 0.0 ? (1.0 - kRateSmoothing) * rate + kRateSmoothing * sample : sample;
+}
+
+}  // namespace
+
+HybridEnsembleExecutor::HybridEnsembleExecutor(const std::string& method, ThreadPool& pool,
+                                               const HybridOptions& options)
+    : method_(method == "explicit_euler" ? "euler" : method), pool_(pool), options_(options),
+      gpu_enabled_(true), front_(0), back_(0), gpu_rate_(0.0), cpu_worker_rate_(0.0),
+      cpu_workers_(0) {
+    for (int w = 0; w < pool_.size(); ++w) {
+        steppers_.push_back(create_stepper(method_));
+    }
+    member_y_.resize(pool_.size());
+}
+
+bool HybridEnsembleExecutor::gpu_usable(const ODESystem& system) const {
+    // The GPU kernels are Euler only
+    return gpu_enabled_ && method_ == "euler" && gpu_.supports(system);
+}
+
+bool HybridEnsembleExecutor::take_cpu_chunk(int chunk, long long& begin, long long& end) {
+    std::lock_guard<std::mutex> lock(range_mutex_);
+    if (front_ >= back_) return false;
+
+    end = back_;
+    begin = std::max(front_, back_ - chunk);
+    back_ = begin;
+    return true;
+}
+
+bool HybridEnsembleExecutor::take_gpu_chunk(int steps, long long& begin, long long& end) {
+    std::lock_guard<std::mutex> lock(range_mutex_);
+    long long remaining = back_ - front_;
+    if (remaining <= 0) return false;
+
+    double cpu_rate = cpu_worker_rate_ * cpu_workers_;
+    double share = options_.initial_gpu_share;
+    if (gpu_rate_ > 0.0 && cpu_rate > 0.0) {
+        share = gpu_rate_ / (gpu_rate_ + cpu_rate);
+    } else if (cpu_workers_ == 0) {
+        share = 1.0;
+    }
+
+    // Guided: half of the GPU's fair share of what is left
+    long long size = static_cast<long long>(share * remaining / 2);
+    size = std::min(remaining, std::max<long long>(size, options_.gpu_min_chunk));
+
+    // Not worth it if the CPU would finish everything before this chunk
+    if (gpu_rate_ > 0.0 && cpu_rate > 0.0 &&
+        static_cast<double>(size) * steps / gpu_rate_ > static_cast<double>(remaining) * steps / cpu_rate) {
+        return false;
+    }
+
+    begin = front_;
+    end = front_ + size;
+    front_ = end;
+    return true;
+}
+
+void HybridEnsembleExecutor::run_cpu_worker(int worker, const ODESystem& system, double t0,
+                                            double dt, int steps, const std::vector<double>& y0,
+                                            std::vector<double>& final_states, int chunk) {
+    ODE_TRACE_SCOPE_CAT("hybrid_cpu_worker", "cpu");
+
+    const int dim = system.dimension;
+    TimeStepper& stepper = *steppers_[worker];
+    std::vector<double>& y = member_y_[worker];
+    y.resize(dim);
+
+    Timer timer;
+    long long begin, end;
+    while (take_cpu_chunk(chunk, begin, end)) {
+        timer.start();
+        for (long long m = begin; m < end; ++m) {
+            const double* start = y0.data() + m * dim;
+            std::copy(start, start + dim, y.begin());
+            for (int i = 1; i <= steps; ++i) {
+                stepper.step(system, t0 + (i - 1) * dt, dt, y);
+            }
+            std::copy(y.begin(), y.end(), final_states.begin() + m * dim);
+        }
+        double seconds = timer.elapsed();
+
+        std::lock_guard<std::mutex> lock(range_mutex_);
+        if (seconds > 0.0) {
+            update_rate(cpu_worker_rate_, (end - begin) * static_cast<double>(steps) / seconds);
+        }
+        stats_.cpu_members += end - begin;
+        stats_.cpu_chunks++;
+    }
+}
+
+void HybridEnsembleExecutor::solve_ensemble(const ODESystem& system,
+                                            double t0, double tf, double dt,
+                                            const std::vector<double>& y0,
+                                            int n_members,
+                                            std::vector<double>& final_states) {
+    ODE_TRACE_SCOPE_CAT("hybrid_ensemble_solve", "hybrid");
+
+    const int dim = system.dimension;
+    if (static_cast<long long>(y0.size()) != static_cast<long long>(n_members) * dim) {
+        throw std::invalid_argument("Ensemble initial state size does not match n_members * dimension");
+    }
+
+    const int steps = static_cast<int>((tf - t0) / dt);
+    final_states.resize(y0.size());
+    stats_ = HybridStats{};
+
+    bool use_gpu = gpu_usable(system);
+    cpu_workers_ = use_gpu ? pool_.size() - 1 : pool_.size();
+    int chunk = options_.cpu_chunk > 0
+        ? options_.cpu_chunk
+        : static_cast<int>(std::max<long long>(16, n_members / (32LL * std::max(1, cpu_workers_))));
+
+    front_ = 0;
+    back_ = n_members;
+
+    // Worker 0 feeds the GPU (the GL calls themselves run on the executor
+    // thread) and joins the CPU workers once the GPU stops taking chunks
+    pool_.parallel_for(0, pool_.size(), [&](long long, long long, int worker) {
+        if (worker == 0 && use_gpu) {
+            Timer timer;
+            long long begin, end;
+            while (take_gpu_chunk(steps, begin, end)) {
+                timer.start();
+                bool ok = GPUExecutor::instance().run_on_gpu_thread([&]() {
+                    return gpu_.solve_members(system, t0, tf, dt, y0.data() + begin * dim,
+                                              static_cast<int>(end - begin),
+                                              final_states.data() + begin * dim);
+                });
+                double seconds = timer.elapsed();
+
+                std::lock_guard<std::mutex> lock(range_mutex_);
+                if (!ok) {
+                    // Only the GPU takes from the front, so the chunk can be
+                    // handed straight back to the CPU workers
+                    std::cerr << "Hybrid Ensemble: GPU chunk failed, continuing on CPU" << std::endl;
+                    front_ = begin;
+                    stats_.gpu_failed = true;
+                    break;
+                }
+                // The first chunk also pays context setup and shader compile
+                if (seconds > 0.0) {
+                    update_rate(gpu_rate_, (end - begin) * static_cast<double>(steps) / seconds);
+                }
+                stats_.gpu_members += end - begin;
+                stats_.gpu_chunks++;
+            }
+        }
+        run_cpu_worker(worker, system, t0, dt, steps, y0, final_states, chunk);
+    });
+
+    if (stats_.gpu_failed) {
+        gpu_enabled_ = false;
+    }
+    stats_.gpu_rate = gpu_rate_;
+    stats_.cpu_rate = cpu_worker_rate_ * cpu_workers_;
+}
@@ -0,0 +1,284 @@
+#include "../../include/packed_batch.h"
+#include "../../include/builtin_rhs_registry.h"
+#include "../../include/gpu_context_manager.h"
+#include "../../include/gpu_executor.h"
+#include "../../include/trace.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+const BuiltinRHS& member_rhs(const PackedMember& member, int index) {
+    const ODESystem* system = member.system;
+    if (!system || !system->use_builtin_rhs() || !BuiltinRHSRegistry::has_rhs(system->gpu_info->builtin_rhs_name)) {
+        throw std::invalid_argument("Packed member " + std::to_string(index) + " has no builtin GPU RHS");
+    }
+    const BuiltinRHS& rhs = BuiltinRHSRegistry::get_rhs(system->gpu_info->builtin_rhs_name);
+    if (system->dimension <= 0 || system->dimension % rhs.coupling_width != 0) {
+        throw std::invalid_argument("Packed member " + std::to_string(index) + ": dimension " +
+                                    std::to_string(system->dimension) + " does not split into " +
+                                    std::string(rhs.name) + " blocks");
+    }
+    if (static_cast<int>(member.y0.size()) != system->dimension) {
+        throw std::invalid_argument("Packed member " + std::to_string(index) + ": y0 size does not match dimension");
+    }
+    return rhs;
+}
+
+// Same sources as GPUEulerBackend::setup_uniforms
+void append_parameters(const ODESystem& system, const BuiltinRHS& rhs, std::vector<float>& parameters) {
+    const std::vector<float>& uniforms = system.gpu_info->gpu_uniforms;
+    for (int k = 0; k < rhs.uniform_count; ++k) {
+        if (!uniforms.empty()) {
+            parameters.push_back(k < static_cast<int>(uniforms.size()) ? uniforms[k] : 0.0f);
+        } else {
+            auto it = system.parameters.find(std::string(rhs.uniform_names[k]));
+            parameters.push_back(it != system.parameters.end() ? static_cast<float>(it->second) : 0.0f);
+        }
+    }
+}
+
+int round_up(int value, int multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+// std430 layout of the template's Segment
+struct GPUSegment {
+    GLuint first_eq;
+    GLuint end_eq;
+    GLuint member_dim;
+    GLuint param_base;
+    GLuint param_count;
+    GLuint rhs_id;
+};
+
+// std430 layout of the template's ControlBuffer
+struct GPUControl {
+    float dt;
+    float t_current;
+    int n_equations;
+    int n_segments;
+};
+
+}  // namespace
+
+PackedBatchLayout::PackedBatchLayout(const std::vector<PackedMember>& members, int workgroup_size)
+    : workgroup_size_(workgroup_size), equations_(0), padded_equations_(0) {
+    if (workgroup_size <= 0) {
+        throw std::invalid_argument("Packed batch workgroup size must be positive");
+    }
+    const int n = static_cast<int>(members.size());
+    std::vector<int> rhs_ids(n);
+    dimensions_.resize(n);
+    offsets_.resize(n);
+    for (int m = 0; m < n; ++m) {
+        rhs_ids[m] = member_rhs(members[m], m).id;
+        dimensions_[m] = members[m].system->dimension;
+        equations_ += dimensions_[m];
+    }
+
+    order_.resize(n);
+    std::iota(order_.begin(), order_.end(), 0);
+    std::stable_sort(order_.begin(), order_.end(), [&](int a, int b) {
+        return rhs_ids[a] != rhs_ids[b] ? rhs_ids[a] < rhs_ids[b] : dimensions_[a] < dimensions_[b];
+    });
+
+    int cursor = 0;
+    for (int i = 0; i < n;) {
+        const int first = order_[i];
+        const BuiltinRHS& rhs = BuiltinRHSRegistry::get_rhs(rhs_ids[first]);
+        PackedSegment segment;
+        segment.rhs_id = rhs.id;
+        segment.member_dimension = dimensions_[first];
+        segment.first_equation = round_up(cursor, std::lcm(workgroup_size, rhs.coupling_width));
+        segment.first_member = i;
+        segment.param_base = static_cast<int>(parameters_.size());
+        segment.param_count = rhs.uniform_count;
+
+        int j = i;
+        for (; j < n && rhs_ids[order_[j]] == segment.rhs_id && dimensions_[order_[j]] == segment.member_dimension;
+             ++j) {
+            offsets_[order_[j]] = segment.first_equation + (j - i) * segment.member_dimension;
+            append_parameters(*members[order_[j]].system, rhs, parameters_);
+        }
+        segment.member_count = j - i;
+        segment.end_equation = segment.first_equation + segment.member_count * segment.member_dimension;
+        segments_.push_back(segment);
+        cursor = segment.end_equation;
+        i = j;
+    }
+    padded_equations_ = round_up(cursor, workgroup_size);
+
+    initial_state_.assign(padded_equations_, 0.0f);
+    for (int m = 0; m < n; ++m) {
+        std::copy(members[m].y0.begin(), members[m].y0.end(), initial_state_.begin() + offsets_[m]);
+    }
+}
+
+std::vector<int> PackedBatchLayout::rhs_ids() const {
+    std::vector<int> ids;
+    for (const PackedSegment& segment : segments_) {
+        if (ids.empty() || ids.back() != segment.rhs_id) ids.push_back(segment.rhs_id);
+    }
+    return ids;
+}
+
+void PackedBatchLayout::unpack(const float* state, std::vector<std::vector<double>>& member_states) const {
+    member_states.resize(offsets_.size());
+    for (size_t m = 0; m < offsets_.size(); ++m) {
+        member_states[m].assign(state + offsets_[m], state + offsets_[m] + dimensions_[m]);
+    }
+}
+
+PackedBatchBackend::~PackedBatchBackend() {
+    // As GPUEulerBackend: programs are deleted on the context's thread
+    auto release = [this]() {
+        for (auto& pair : shader_cache_) {
+            glDeleteProgram(pair.second);
+        }
+        shader_cache_.clear();
+    };
+
+    GPUContextManager& context = GPUContextManager::instance();
+    if (shader_cache_.empty() || !context.is_initialized() || context.is_current_thread()) {
+        release();
+    } else {
+        GPUExecutor::instance().run_on_gpu_thread(release);
+    }
+}
+
+GLuint PackedBatchBackend::get_or_compile_shader(const PackedBatchLayout& layout) {
+    const std::vector<int> ids = layout.rhs_ids();
+    std::string cache_key;
+    for (int id : ids) cache_key += std::to_string(id) + ",";
+
+    auto it = shader_cache_.find(cache_key);
+    if (it != shader_cache_.end()) {
+        return it->second;
+    }
+
+    std::string shader_source;
+    try {
+        shader_source = shader_gen_.generate_packed_euler_shader(ids, layout.workgroup_size());
+    } catch (const std::exception& e) {
+        std::cerr << "Shader generation failed: " << e.what() << std::endl;
+        return 0;
+    }
+    GLuint program = GPUContextManager::instance().compile_compute_shader(shader_source);
+    if (program != 0) {
+        shader_cache_[cache_key] = program;
+    }
+    return program;
+}
+
+void PackedBatchBackend::solve_batch(const std::vector<PackedMember>& members,
+                                     double t0, double tf, double dt,
+                                     std::vector<std::vector<double>>& final_states) {
+    ODE_TRACE_SCOPE_CAT("gpu_packed_batch_solve", "gpu");
+
+    const PackedBatchLayout layout(members, kWorkgroupSize);
+    stats_ = PackedBatchStats{};
+    stats_.members = static_cast<int>(members.size());
+    stats_.segments = static_cast<int>(layout.segments().size());
+    stats_.equations = layout.equations();
+    stats_.padded_equations = layout.padded_equations();
+
+    const int steps = static_cast<int>((tf - t0) / dt);
+    if (steps <= 0 || members.empty()) {
+        final_states.resize(members.size());
+        for (size_t m = 0; m < members.size(); ++m) final_states[m] = members[m].y0;
+        return;
+    }
+
+    // 65535 groups is the minimum GL_MAX_COMPUTE_WORK_GROUP_COUNT
+    const int groups = layout.padded_equations() / kWorkgroupSize;
+    if (groups > 65535) {
+        std::cerr << "GPU Packed Batch: " << layout.padded_equations()
+                  << " equations exceed one dispatch" << std::endl;
+        final_states.clear();
+        return;
+    }
+    if (!GPUContextManager::instance().initialize()) {
+        std::cerr << "Failed to initialize GPU context" << std::endl;
+        final_states.clear();
+        return;
+    }
+    GLuint program = get_or_compile_shader(layout);
+    if (program == 0) {
+        std::cerr << "Failed to get shader program" << std::endl;
+        final_states.clear();
+        return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<GPUSegment> segments;
+    for (const PackedSegment& s : layout.segments()) {
+        segments.push_back({static_cast<GLuint>(s.first_equation), static_cast<GLuint>(s.end_equation),
+                            static_cast<GLuint>(s.member_dimension), static_cast<GLuint>(s.param_base),
+                            static_cast<GLuint>(s.param_count), static_cast<GLuint>(s.rhs_id)});
+    }
+    std::vector<float> parameters = layout.parameters();
+    if (parameters.empty()) parameters.push_back(0.0f);  // No zero-sized buffers
+    GPUControl control{static_cast<float>(dt), static_cast<float>(t0), layout.padded_equations(),
+                       static_cast<int>(segments.size())};
+
+    // 0/1: state ping-pong, 2: parameters, 3: segments, 4: control
+    GLuint buffers[5];
+    glGenBuffers(5, buffers);
+    auto upload = [](GLuint buffer, size_t bytes, const void* data, GLenum usage) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, bytes, data, usage);
+    };
+    const size_t state_bytes = layout.initial_state().size() * sizeof(float);
+    upload(buffers[0], state_bytes, layout.initial_state().data(), GL_DYNAMIC_COPY);
+    upload(buffers[1], state_bytes, layout.initial_state().data(), GL_DYNAMIC_COPY);
+    upload(buffers[2], parameters.size() * sizeof(float), parameters.data(), GL_STATIC_DRAW);
+    upload(buffers[3], segments.size() * sizeof(GPUSegment), segments.data(), GL_STATIC_DRAW);
+    upload(buffers[4], sizeof(GPUControl), &control, GL_DYNAMIC_DRAW);
+    if (glGetError() != GL_NO_ERROR) {
+        std::cerr << "GPU Packed Batch: buffer allocation failed" << std::endl;
+        glDeleteBuffers(5, buffers);
+        final_states.clear();
+        return;
+    }
+
+    glUseProgram(program);
+    for (GLuint binding = 2; binding < 5; ++binding) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffers[binding]);
+    }
+
+    // One dispatch per step covers every member; only t goes up, nothing
+    // comes back until the end
+    int current = 0;
+    for (int step = 0; step < steps; ++step) {
+        ODE_TRACE_SCOPE_CAT("step", "gpu");
+        control.t_current = static_cast<float>(t0 + step * dt);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[4]);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GPUControl), &control);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffers[current]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, buffers[1 - current]);
+        glDispatchCompute(groups, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        current = 1 - current;
+        stats_.n_dispatches++;
+    }
+
+    {
+        ODE_TRACE_SCOPE_CAT("readback", "gpu");
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[current]);
+        const float* state = static_cast<const float*>(
+            glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, state_bytes, GL_MAP_READ_BIT));
+        if (state) {
+            layout.unpack(state, final_states);
+            glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+        } else {
+            std::cerr << "GPU Packed Batch: readback failed" << std::endl;
+            final_states.clear();
+        }
+    }
+    glDeleteBuffers(5, buffers);
+    stats_.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
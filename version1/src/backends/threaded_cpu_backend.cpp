@@ -0,0 +1,169 @@
+#include "../../include/threaded_cpu_backend.h"
+#include "../../include/steppers.h"
+#include "../../include/trace.h"
+#include <algorithm>
+#include <stdexcept>
+
+ThreadedCPUBackend::ThreadedCPUBackend(const std::string& method, ThreadPool& pool)
+    : pool_(pool), max_threads_(0), scaling_table_(nullptr) {
+    if (method == "euler" || method == "explicit_euler") {
+        method_ = "euler";
+    } else if (method == "rk45" || method == "runge_kutta") {
+        method_ = "rk45";
+    } else {
+        throw std::invalid_argument("Unknown stepper method: " + method);
+    }
+}
+
+int ThreadedCPUBackend::threads_for(int n_equations) const {
+    int threads = max_threads_ > 0 ? max_threads_ : pool_.size();
+    if (scaling_table_) {
+        threads = scaling_table_->choose_threads("system", n_equations, threads);
+    }
+    return std::max(1, std::min(threads, pool_.size()));
+}
+
+void ThreadedCPUBackend::solve(const ODESystem& system,
+                               double t0, double tf, double dt,
+                               const std::vector<double>& y0,
+                               std::vector<std::vector<double>>& solution) {
+    ODE_TRACE_SCOPE_CAT("cpu_threaded_solve", "cpu");
+
+    int n_steps = static_cast<int>((tf - t0) / dt) + 1;
+    solution.assign(n_steps, std::vector<double>(y0.size()));
+    solution[0] = y0;
+
+    if (!system.has_range_rhs()) {
+        // No way to split the RHS: integrate serially like CPUBackend
+        auto stepper = create_stepper(method_);
+        std::vector<double> y = y0;
+        for (int i = 1; i < n_steps; ++i) {
+            stepper->step(system, t0 + (i - 1) * dt, dt, y);
+            solution[i] = y;
+        }
+        return;
+    }
+
+    y_ = y0;
+    int threads = threads_for(static_cast<int>(y0.size()));
+    if (method_ == "euler") {
+        solve_euler(system, t0, dt, n_steps, threads, solution);
+    } else {
+        solve_rk45(system, t0, dt, n_steps, threads, solution);
+    }
+}
+
+void ThreadedCPUBackend::solve_euler(const ODESystem& system, double t0, double dt,
+                                     int n_steps, int threads,
+                                     std::vector<std::vector<double>>& solution) {
+    const long long n = static_cast<long long>(y_.size());
+    y_next_.resize(n);
+    k_[0].resize(n);
+
+    for (int step = 1; step < n_steps; ++step) {
+        double t = t0 + (step - 1) * dt;
+        std::vector<double>& row = solution[step];
+
+        // The RHS of equation i may read any y, so write into y_next_ and swap
+        pool_.parallel_for(0, n, [&](long long b, long long e, int) {
+            system.rhs_range(t, y_, k_[0], static_cast<int>(b), static_cast<int>(e));
+            for (long long i = b; i < e; ++i) {
+                y_next_[i] = y_[i] + dt * k_[0][i];
+                row[i] = y_next_[i];
+            }
+        }, threads);
+
+        y_.swap(y_next_);
+    }
+}
+
+void ThreadedCPUBackend::solve_rk45(const ODESystem& system, double t0, double h,
+                                    int n_steps, int threads,
+                                    std::vector<std::vector<double>>& solution) {
+    // RK45 (Dormand-Prince) coefficients
+    const double a21 = 1.0/5.0;
+    const double a31 = 3.0/40.0, a32 = 9.0/40.0;
+    const double a41 = 44.0/45.0, a42 = -56.0/15.0, a43 = 32.0/9.0;
+    const double a51 = 19372.0/6561.0, a52 = -25360.0/2187.0,
+                 a53 = 64448.0/6561.0, a54 = -212.0/729.0;
+    const double a61 = 9017.0/3168.0, a62 = -355.0/33.0,
+                 a63 = 46732.0/5247.0, a64 = 49.0/176.0, a65 = -5103.0/18656.0;
+
+    const double b1 = 35.0/384.0, b3 = 500.0/1113.0, b4 = 125.0/192.0,
+                 b5 = -2187.0/6784.0, b6 = 11.0/84.0;
+
+    const long long n = static_cast<long long>(y_.size());
+    y_temp_a_.resize(n);
+    y_temp_b_.resize(n);
+    for (auto& k : k_) k.resize(n);
+
+    std::vector<double>& y = y_;
+    std::vector<double>& ya = y_temp_a_;
+    std::vector<double>& yb = y_temp_b_;
+    std::vector<double>& k1 = k_[0];
+    std::vector<double>& k2 = k_[1];
+    std::vector<double>& k3 = k_[2];
+    std::vector<double>& k4 = k_[3];
+    std::vector<double>& k5 = k_[4];
+    std::vector<double>& k6 = k_[5];
+
+    // One parallel pass per stage: evaluate k_s on the own range, then form
+    // the next stage's input there. Stage inputs alternate between ya and yb
+    // so no chunk overwrites a vector its neighbours are still reading.
+    for (int step = 1; step < n_steps; ++step) {
+        double t = t0 + (step - 1) * h;
+        std::vector<double>& row = solution[step];
+
+        pool_.parallel_for(0, n, [&](long long b, long long e, int) {
+            system.rhs_range(t, y, k1, static_cast<int>(b), static_cast<int>(e));
+            for (long long i = b; i < e; ++i) {
+                k1[i] *= h;
+                ya[i] = y[i] + a21 * k1[i];
+            }
+        }, threads);
+
+        pool_.parallel_for(0, n, [&](long long b, long long e, int) {
+            system.rhs_range(t + h/5.0, ya, k2, static_cast<int>(b), static_cast<int>(e));
+            for (long long i = b; i < e; ++i) {
+                k2[i] *= h;
+                yb[i] = y[i] + a31 * k1[i] + a32 * k2[i];
+            }
+        }, threads);
+
+        pool_.parallel_for(0, n, [&](long long b, long long e, int) {
+            system.rhs_range(t + 3.0*h/10.0, yb, k3, static_cast<int>(b), static_cast<int>(e));
+            for (long long i = b; i < e; ++i) {
+                k3[i] *= h;
+                ya[i] = y[i] + a41 * k1[i] + a42 * k2[i] + a43 * k3[i];
+            }
+        }, threads);
+
+        pool_.parallel_for(0, n, [&](long long b, long long e, int) {
+            system.rhs_range(t + 4.0*h/5.0, ya, k4, static_cast<int>(b), static_cast<int>(e));
+            for (long long i = b; i < e; ++i) {
+                k4[i] *= h;
+                yb[i] = y[i] + a51 * k1[i] + a52 * k2[i] + a53 * k3[i] + a54 * k4[i];
+            }
+        }, threads);
+
+        pool_.parallel_for(0, n, [&](long long b, long long e, int) {
+            system.rhs_range(t + 8.0*h/9.0, yb, k5, static_cast<int>(b), static_cast<int>(e));
+            for (long long i = b; i < e; ++i) {
+                k5[i] *= h;
+                ya[i] = y[i] + a61 * k1[i] + a62 * k2[i] + a63 * k3[i] +
+                        a64 * k4[i] + a65 * k5[i];
+            }
+        }, threads);
+
+        // Last stage reads only ya, so y can be updated in place
+        pool_.parallel_for(0, n, [&](long long b, long long e, int) {
+            system.rhs_range(t + h, ya, k6, static_cast<int>(b), static_cast<int>(e));
+            for (long long i = b; i < e; ++i) {
+                k6[i] *= h;
+                y[i] = y[i] + b1 * k1[i] + b3 * k3[i] + b4 * k4[i] +
+                       b5 * k5[i] + b6 * k6[i];
+                row[i] = y[i];
+            }
+        }, threads);
+    }
+}
@@ -0,0 +1,139 @@
+#include "../../include/vm_ensemble_backend.h"
+#include "../../include/trace.h"
+#include <algorithm>
+#include <stdexcept>
+
+VMEnsembleBackend::VMEnsembleBackend(const std::string& method, ThreadPool& pool, int width)
+    : method_(method), pool_(pool), width_(width) {
+    if (method == "euler" || method == "explicit_euler") {
+        rk45_ = false;
+    } else if (method == "rk45" || method == "runge_kutta") {
+        rk45_ = true;
+    } else {
+        throw std::invalid_argument("VM ensemble supports euler and rk45, not " + method);
+    }
+    if (width != 8 && width != 16 && width != 32 && width != 64) {
+        throw std::invalid_argument("VM ensemble width must be 8, 16, 32 or 64");
+    }
+    workspace_.resize(pool_.size());
+}
+
+void VMEnsembleBackend::solve_ensemble(const ODESystem& system,
+                                       double t0, double tf, double dt,
+                                       const std::vector<double>& y0,
+                                       int n_members,
+                                       std::vector<double>& final_states) {
+    ODE_TRACE_SCOPE_CAT("vm_ensemble_solve", "cpu");
+
+    if (!system.program) {
+        throw std::invalid_argument("VM ensemble needs a system built from an RHSProgram");
+    }
+    const int dim = system.dimension;
+    if (system.program->dimension() != dim) {
+        throw std::invalid_argument("System dimension does not match its RHS program");
+    }
+    if (static_cast<long long>(y0.size()) != static_cast<long long>(n_members) * dim) {
+        throw std::invalid_argument("Ensemble initial state size does not match n_members * dimension");
+    }
+    final_states.resize(y0.size());
+
+    const RHSBytecode code(*system.program, system.program->param_values(system.parameters), width_);
+    const int W = width_;
+    const int n_steps = static_cast<int>((tf - t0) / dt) + 1;
+    const long long n_batches = (n_members + W - 1) / W;
+    const size_t slab = static_cast<size_t>(dim) * W;
+
+    // Sized inside parallel_for, whose calls the pool serializes, so
+    // concurrent solves never resize a workspace another one is using
+    pool_.parallel_for(0, n_batches, [&](long long b, long long e, int worker) {
+        std::vector<double>& work = workspace_[worker];
+        work.resize(slab * (rk45_ ? 8 : 2));
+        double* y = work.data();
+        double* f = y + slab;
+
+        for (long long batch = b; batch < e; ++batch) {
+            const long long first = batch * W;
+            const int lanes = static_cast<int>(std::min<long long>(W, n_members - first));
+            const size_t n = slab;
+
+            // Member-major in, SoA (state i of lane l at i * W + l) inside
+            for (int l = 0; l < lanes; ++l) {
+                const double* start = y0.data() + (first + l) * dim;
+                for (int i = 0; i < dim; ++i) y[i * W + l] = start[i];
+            }
+
+            // Same time sequence and per-element arithmetic as the steppers
+            for (int s = 1; s < n_steps; ++s) {
+                const double t = t0 + (s - 1) * dt;
+                if (!rk45_) {
+                    code.evaluate_batch(t, y, f, lanes, W);
+                    for (size_t i = 0; i < n; ++i) y[i] += dt * f[i];
+                    continue;
+                }
+
+                const double h = dt;
+                const double a21 = 1.0/5.0;
+                const double a31 = 3.0/40.0, a32 = 9.0/40.0;
+                const double a41 = 44.0/45.0, a42 = -56.0/15.0, a43 = 32.0/9.0;
+                const double a51 = 19372.0/6561.0, a52 = -25360.0/2187.0,
+                             a53 = 64448.0/6561.0, a54 = -212.0/729.0;
+                const double a61 = 9017.0/3168.0, a62 = -355.0/33.0,
+                             a63 = 46732.0/5247.0, a64 = 49.0/176.0, a65 = -5103.0/18656.0;
+                const double b1 = 35.0/384.0, b3 = 500.0/1113.0, b4 = 125.0/192.0,
+                             b5 = -2187.0/6784.0, b6 = 11.0/84.0;
+
+                double* k1 = f;
+                double* k2 = k1 + slab;
+                double* k3 = k2 + slab;
+                double* k4 = k3 + slab;
+                double* k5 = k4 + slab;
+                double* k6 = k5 + slab;
+                double* y_temp = k6 + slab;
+
+                code.evaluate_batch(t, y, k1, lanes, W);
+                for (size_t i = 0; i < n; ++i) k1[i] *= h;
+
+                for (size_t i = 0; i < n; ++i) {
+                    y_temp[i] = y[i] + a21 * k1[i];
+                }
+                code.evaluate_batch(t + h/5.0, y_temp, k2, lanes, W);
+                for (size_t i = 0; i < n; ++i) k2[i] *= h;
+
+                for (size_t i = 0; i < n; ++i) {
+                    y_temp[i] = y[i] + a31 * k1[i] + a32 * k2[i];
+                }
+                code.evaluate_batch(t + 3.0*h/10.0, y_temp, k3, lanes, W);
+                for (size_t i = 0; i < n; ++i) k3[i] *= h;
+
+                for (size_t i = 0; i < n; ++i) {
+                    y_temp[i] = y[i] + a41 * k1[i] + a42 * k2[i] + a43 * k3[i];
+                }
+                code.evaluate_batch(t + 4.0*h/5.0, y_temp, k4, lanes, W);
+                for (size_t i = 0; i < n; ++i) k4[i] *= h;
+
+                for (size_t i = 0; i < n; ++i) {
+                    y_temp[i] = y[i] + a51 * k1[i] + a52 * k2[i] + a53 * k3[i] + a54 * k4[i];
+                }
+                code.evaluate_batch(t + 8.0*h/9.0, y_temp, k5, lanes, W);
+                for (size_t i = 0; i < n; ++i) k5[i] *= h;
+
+                for (size_t i = 0; i < n; ++i) {
+                    y_temp[i] = y[i] + a61 * k1[i] + a62 * k2[i] + a63 * k3[i] +
+                                a64 * k4[i] + a65 * k5[i];
+                }
+                code.evaluate_batch(t + h, y_temp, k6, lanes, W);
+                for (size_t i = 0; i < n; ++i) k6[i] *= h;
+
+                for (size_t i = 0; i < n; ++i) {
+                    y[i] = y[i] + b1 * k1[i] + b3 * k3[i] + b4 * k4[i] +
+                           b5 * k5[i] + b6 * k6[i];
+                }
+            }
+
+            for (int l = 0; l < lanes; ++l) {
+                double* out = final_states.data() + (first + l) * dim;
+                for (int i = 0; i < dim; ++i) out[i] = y[i * W + l];
+            }
+        }
+    });
+}
@@ -0,0 +1,247 @@
+#include "../../include/ode_c_api.h"
+#include "../../include/ensemble.h"
+#include "../../include/steppers.h"
+#include "../../include/test_problems.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+struct ode_system {
+    ODESystem system;
+};
+
+struct ode_session {
+    std::string method;
+    std::unique_ptr<TimeStepper> stepper;     // Single-trajectory solves
+    std::vector<double> y;                    // Its working state (one state, reused)
+    ThreadPool pool;
+    CPUEnsembleBackend ensemble;
+
+    ode_session(const std::string& method_name, int threads)
+        : method(method_name), stepper(create_stepper(method_name)), pool(threads),
+          ensemble(method_name, pool) {}
+};
+
+namespace {
+
+thread_local std::string last_error;
+
+ode_status fail(ode_status status, const std::string& message) {
+    last_error = message;
+    return status;
+}
+
+// Runs body, turning every exception into a status: nothing may unwind
+// into C frames
+template <typename Body>
+ode_status guarded(Body&& body) {
+    try {
+        last_error.clear();
+        return body();
+    } catch (const std::bad_alloc&) {
+        return fail(ODE_ERR_SOLVER, "out of memory");
+    } catch (const std::invalid_argument& e) {
+        const std::string message = e.what();
+        const bool name_error = message.find("Unknown") != std::string::npos ||
+                                message.find("has no parameter") != std::string::npos;
+        return fail(name_error ? ODE_ERR_UNKNOWN_NAME : ODE_ERR_INVALID_ARGUMENT, message);
+    } catch (const std::exception& e) {
+        return fail(ODE_ERR_SOLVER, e.what());
+    } catch (...) {
+        return fail(ODE_ERR_SOLVER, "unknown error");
+    }
+}
+
+long long step_count(double t0, double tf, double dt) {
+    if (!(dt > 0.0) || !(tf >= t0) || !std::isfinite(t0) || !std::isfinite(tf)) {
+        return -1;
+    }
+    // Same count as CPUBackend / CPUEnsembleBackend
+    return static_cast<long long>((tf - t0) / dt) + 1;
+}
+
+ode_status check_solve_args(const ode_session* session, const ode_system* system,
+                            double t0, double tf, double dt, const void* y0, const void* out) {
+    if (!session || !system || !y0 || !out) {
+        return fail(ODE_ERR_INVALID_ARGUMENT, "null handle or buffer");
+    }
+    if (step_count(t0, tf, dt) < 1 || step_count(t0, tf, dt) > INT_MAX) {
+        return fail(ODE_ERR_INVALID_ARGUMENT, "need dt > 0, finite tf >= t0 and fewer than 2^31 steps");
+    }
+    return ODE_OK;
+}
+
+}  // namespace
+
+extern "C" {
+
+int ode_api_version(void) {
+    return ODE_API_VERSION;
+}
+
+const char* ode_status_string(ode_status status) {
+    switch (status) {
+        case ODE_OK: return "ok";
+        case ODE_ERR_INVALID_ARGUMENT: return "invalid argument";
+        case ODE_ERR_UNKNOWN_NAME: return "unknown name";
+        case ODE_ERR_BUFFER_TOO_SMALL: return "buffer too small";
+        case ODE_ERR_SOLVER: return "solver error";
+    }
+    return "unknown status";
+}
+
+const char* ode_last_error(void) {
+    return last_error.c_str();
+}
+
+ode_status ode_system_create_builtin(const char* name, int dimension,
+                                     const char* const* param_names,
+                                     const double* param_values, int n_params,
+                                     ode_system** out) {
+    return guarded([&]() {
+        if (!name || !out || n_params < 0 || (n_params > 0 && (!param_names || !param_values))) {
+            return fail(ODE_ERR_INVALID_ARGUMENT, "null name, output or parameter arrays");
+        }
+        std::map<std::string, double> parameters;
+        for (int i = 0; i < n_params; ++i) {
+            if (!param_names[i]) return fail(ODE_ERR_INVALID_ARGUMENT, "null parameter name");
+            parameters[param_names[i]] = param_values[i];
+        }
+        auto handle = std::make_unique<ode_system>();
+        handle->system = TestProblems::create(name, dimension, parameters);
+        *out = handle.release();
+        return ODE_OK;
+    });
+}
+
+ode_status ode_system_create_callback(int dimension, ode_rhs_fn rhs, void* user_data, ode_system** out) {
+    return guarded([&]() {
+        if (!rhs || !out || dimension < 1) {
+            return fail(ODE_ERR_INVALID_ARGUMENT, "need a callback, an output and dimension >= 1");
+        }
+        auto handle = std::make_unique<ode_system>();
+        ODESystem& system = handle->system;
+        system.name = "C callback";
+        system.dimension = dimension;
+        system.t_start = 0.0;
+        system.t_end = 1.0;
+        system.initial_conditions.assign(dimension, 0.0);
+        // The steppers' buffers are handed to the callback as they are
+        system.rhs_inplace = [rhs, user_data](double t, const std::vector<double>& y, std::vector<double>& dydt) {
+            rhs(t, y.data(), dydt.data(), static_cast<int>(y.size()), user_data);
+        };
+        system.rhs = [rhs, user_data](double t, const std::vector<double>& y) {
+            std::vector<double> dydt(y.size());
+            rhs(t, y.data(), dydt.data(), static_cast<int>(y.size()), user_data);
+            return dydt;
+        };
+        *out = handle.release();
+        return ODE_OK;
+    });
+}
+
+int ode_system_dimension(const ode_system* system) {
+    return system ? system->system.dimension : 0;
+}
+
+void ode_system_destroy(ode_system* system) {
+    delete system;
+}
+
+ode_status ode_session_create(const ode_session_config* config, ode_session** out) {
+    return guarded([&]() {
+        if (!out) {
+            return fail(ODE_ERR_INVALID_ARGUMENT, "null output");
+        }
+        // Fields past struct_size come from a newer header: use defaults
+        std::string method = "rk45";
+        int threads = 0;
+        if (config) {
+            if (config->struct_size >= offsetof(ode_session_config, method) + sizeof(config->method) &&
+                config->method) {
+                method = config->method;
+            }
+            if (config->struct_size >= offsetof(ode_session_config, threads) + sizeof(config->threads)) {
+                threads = std::max(0, config->threads);
+            }
+        }
+        *out = new ode_session(method, threads);
+        return ODE_OK;
+    });
+}
+
+void ode_session_destroy(ode_session* session) {
+    delete session;
+}
+
+size_t ode_trajectory_rows(double t0, double tf, double dt) {
+    const long long steps = step_count(t0, tf, dt);
+    return steps > 0 ? static_cast<size_t>(steps) : 0;
+}
+
+ode_status ode_solve(ode_session* session, const ode_system* system,
+                     double t0, double tf, double dt, const double* y0,
+                     double* out, size_t capacity_rows) {
+    return guarded([&]() {
+        ode_status status = check_solve_args(session, system, t0, tf, dt, y0, out);
+        if (status != ODE_OK) return status;
+        const int n_steps = static_cast<int>(step_count(t0, tf, dt));
+        if (capacity_rows < static_cast<size_t>(n_steps)) {
+            return fail(ODE_ERR_BUFFER_TOO_SMALL, "trajectory needs " + std::to_string(n_steps) + " rows");
+        }
+
+        const ODESystem& ode = system->system;
+        const size_t dim = static_cast<size_t>(ode.dimension);
+        std::vector<double>& y = session->y;
+        y.assign(y0, y0 + dim);
+        std::copy(y0, y0 + dim, out);
+
+        // Same time sequence as CPUBackend; rows go straight to the caller
+        for (int i = 1; i < n_steps; ++i) {
+            session->stepper->step(ode, t0 + (i - 1) * dt, dt, y);
+            std::copy(y.begin(), y.end(), out + static_cast<size_t>(i) * dim);
+        }
+        return ODE_OK;
+    });
+}
+
+ode_status ode_solve_final(ode_session* session, const ode_system* system,
+                           double t0, double tf, double dt, const double* y0,
+                           double* y_final) {
+    return guarded([&]() {
+        ode_status status = check_solve_args(session, system, t0, tf, dt, y0, y_final);
+        if (status != ODE_OK) return status;
+        const int n_steps = static_cast<int>(step_count(t0, tf, dt));
+
+        const ODESystem& ode = system->system;
+        std::vector<double>& y = session->y;
+        y.assign(y0, y0 + ode.dimension);
+        for (int i = 1; i < n_steps; ++i) {
+            session->stepper->step(ode, t0 + (i - 1) * dt, dt, y);
+        }
+        std::copy(y.begin(), y.end(), y_final);
+        return ODE_OK;
+    });
+}
+
+ode_status ode_solve_ensemble(ode_session* session, const ode_system* system,
+                              double t0, double tf, double dt, const double* y0,
+                              size_t n_members, double* final_states) {
+    return guarded([&]() {
+        ode_status status = check_solve_args(session, system, t0, tf, dt, y0, final_states);
+        if (status != ODE_OK) return status;
+        if (n_members == 0 || n_members > static_cast<size_t>(INT_MAX)) {
+            return fail(ODE_ERR_INVALID_ARGUMENT, "n_members must be in [1, 2^31)");
+        }
+        session->ensemble.solve_ensemble(system->system, t0, tf, dt, y0, static_cast<int>(n_members),
+                                         final_states);
+        return ODE_OK;
+    });
+}
+
+}  // extern "C"
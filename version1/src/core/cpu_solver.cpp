@@ -1,4 +1,5 @@
 #include "cpu_solver.h"
+#include "trace.h"
 #include <cmath>
 
 void CPUSolver::solve(const ODESystem& system, 
@@ -6,26 +7,30 @@ void CPUSolver::solve(const ODESystem& system,
                      const std::vector<double>& y0,
                      std::vector<std::vector<double>>& solution) {
     
+    ODE_TRACE_SCOPE_CAT("cpu_rk45_solve", "cpu");
+    
     int n_steps = static_cast<int>((tf - t0) / dt) + 1;
-    solution.clear();
-    solution.reserve(n_steps);
+    
+    // Allocate all output rows up front; the loop below only copies into them
+    solution.assign(n_steps, std::vector<double>(y0.size()));
     
     std::vector<double> y = y0;
     double t = t0;
     
     // Store initial condition
-    solution.push_back(y);
+    solution[0] = y;
     
     // RK45 integration loop
     for (int i = 1; i < n_steps; ++i) {
-        y = rk45_step(system, t, y, dt);
+        ODE_TRACE_SCOPE_CAT("step", "cpu");
+        rk45_step(system, t, y, dt);
         t = t0 + i * dt;
-        solution.push_back(y);
+        solution[i] = y;
     }
 }
 
-std::vector<double> CPUSolver::rk45_step(const ODESystem& system, double t, 
-                                        const std::vector<double>& y, double h) {
+void CPUSolver::rk45_step(const ODESystem& system, double t, 
+                          std::vector<double>& y, double h) {
     // RK45 (Dormand-Prince) coefficients
     const double a21 = 1.0/5.0;
     const double a31 = 3.0/40.0, a32 = 9.0/40.0;
@@ -38,48 +43,51 @@ std::vector<double> CPUSolver::rk45_step(const ODESystem& system, double t,
     const double b1 = 35.0/384.0, b3 = 500.0/1113.0, b4 = 125.0/192.0,
                  b5 = -2187.0/6784.0, b6 = 11.0/84.0;
     
+    const size_t n = y.size();
+    if (y_temp_.size() != n) {
+        k1_.resize(n); k2_.resize(n); k3_.resize(n);
+        k4_.resize(n); k5_.resize(n); k6_.resize(n);
+        y_temp_.resize(n);
+    }
+    
     // Compute k values
-    auto k1 = system.rhs(t, y);
-    for (auto& k : k1) k *= h;
+    system.evaluate_rhs(t, y, k1_);
+    for (auto& k : k1_) k *= h;
     
-    std::vector<double> y_temp(y.size());
-    for (size_t i = 0; i < y.size(); ++i) {
-        y_temp[i] = y[i] + a21 * k1[i];
+    for (size_t i = 0; i < n; ++i) {
+        y_temp_[i] = y[i] + a21 * k1_[i];
     }
-    auto k2 = system.rhs(t + h/5.0, y_temp);
-    for (auto& k : k2) k *= h;
+    system.evaluate_rhs(t + h/5.0, y_temp_, k2_);
+    for (auto& k : k2_) k *= h;
     
-    for (size_t i = 0; i < y.size(); ++i) {
-        y_temp[i] = y[i] + a31 * k1[i] + a32 * k2[i];
+    for (size_t i = 0; i < n; ++i) {
+        y_temp_[i] = y[i] + a31 * k1_[i] + a32 * k2_[i];
     }
-    auto k3 = system.rhs(t + 3.0*h/10.0, y_temp);
-    for (auto& k : k3) k *= h;
+    system.evaluate_rhs(t + 3.0*h/10.0, y_temp_, k3_);
+    for (auto& k : k3_) k *= h;
     
-    for (size_t i = 0; i < y.size(); ++i) {
-        y_temp[i] = y[i] + a41 * k1[i] + a42 * k2[i] + a43 * k3[i];
+    for (size_t i = 0; i < n; ++i) {
+        y_temp_[i] = y[i] + a41 * k1_[i] + a42 * k2_[i] + a43 * k3_[i];
     }
-    auto k4 = system.rhs(t + 4.0*h/5.0, y_temp);
-    for (auto& k : k4) k *= h;
+    system.evaluate_rhs(t + 4.0*h/5.0, y_temp_, k4_);
+    for (auto& k : k4_) k *= h;
     
-    for (size_t i = 0; i < y.size(); ++i) {
-        y_temp[i] = y[i] + a51 * k1[i] + a52 * k2[i] + a53 * k3[i] + a54 * k4[i];
+    for (size_t i = 0; i < n; ++i) {
+        y_temp_[i] = y[i] + a51 * k1_[i] + a52 * k2_[i] + a53 * k3_[i] + a54 * k4_[i];
     }
-    auto k5 = system.rhs(t + 8.0*h/9.0, y_temp);
-    for (auto& k : k5) k *= h;
+    system.evaluate_rhs(t + 8.0*h/9.0, y_temp_, k5_);
+    for (auto& k : k5_) k *= h;
     
-    for (size_t i = 0; i < y.size(); ++i) {
-        y_temp[i] = y[i] + a61 * k1[i] + a62 * k2[i] + a63 * k3[i] + 
-                    a64 * k4[i] + a65 * k5[i];
+    for (size_t i = 0; i < n; ++i) {
+        y_temp_[i] = y[i] + a61 * k1_[i] + a62 * k2_[i] + a63 * k3_[i] + 
+                     a64 * k4_[i] + a65 * k5_[i];
     }
-    auto k6 = system.rhs(t + h, y_temp);
-    for (auto& k : k6) k *= h;
+    system.evaluate_rhs(t + h, y_temp_, k6_);
+    for (auto& k : k6_) k *= h;
     
     // Compute final result
-    std::vector<double> y_new(y.size());
-    for (size_t i = 0; i < y.size(); ++i) {
-        y_new[i] = y[i] + b1 * k1[i] + b3 * k3[i] + b4 * k4[i] + 
-                   b5 * k5[i] + b6 * k6[i];
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = y[i] + b1 * k1_[i] + b3 * k3_[i] + b4 * k4_[i] + 
+               b5 * k5_[i] + b6 * k6_[i];
     }
-    
-    return y_new;
-} 
\ No newline at end of file
+}
@@ -3,12 +3,14 @@
 #include <vector>
 #include <cmath>
 #include "cpu_solver.h"
-#include "gpu_solver.h"
+#include "steppers.h"
+#include "auto_dispatcher.h"
 #include "test_problems.h"
 #include "timer.h"
 
-double compute_error(const std::vector<std::vector<double>>& solution,
-                    const ODESystem& system, double dt) {
+template <typename Scalar>
+double compute_error(const std::vector<std::vector<Scalar>>& solution,
+                    const BasicODESystem<Scalar>& system, double dt) {
     if (!system.analytical_solution) return -1.0;
     
     double max_error = 0.0;
@@ -17,14 +19,17 @@ double compute_error(const std::vector<std::vector<double>>& solution,
         auto analytical = system.analytical_solution(t);
         
         for (size_t j = 0; j < solution[i].size(); ++j) {
-            double error = std::abs(solution[i][j] - analytical[j]);
+            double error = std::abs(static_cast<double>(solution[i][j] - analytical[j]));
             max_error = std::max(max_error, error);
         }
     }
     return max_error;
 }
 
-void run_benchmark(const ODESystem& system, double dt) {
+// system_float is the same problem with its RHS in float: the GPU runs in
+// float, so its errors are compared against both CPU precisions
+void run_benchmark(const ODESystem& system, const BasicODESystem<float>& system_float, double dt,
+                   AutoDispatcher& dispatcher) {
     std::cout << "\n" << std::string(60, '=') << std::endl;
     std::cout << "Benchmark: " << system.name << std::endl;
     std::cout << "System dimension: " << system.dimension << std::endl;
@@ -52,68 +57,69 @@ void run_benchmark(const ODESystem& system, double dt) {
     std::cout << "  Throughput: " << std::fixed << std::setprecision(0) 
               << system.dimension / cpu_time << " ODEs/second" << std::endl;
     
-    // GPU Solver (only for exponential decay systems)
-    if (system.name.find("Exponential") != std::string::npos) {
-        
-        GPUSolver gpu_solver;
-        
-        std::cout << "\nRunning GPU solver..." << std::endl;
-        timer.start();
-        std::vector<std::vector<double>> gpu_solution;
-        bool gpu_success = true;
+    // Same RK45 in float
+    std::cout << "\nRunning CPU solver (float)..." << std::endl;
+    timer.start();
+    auto float_stepper = create_stepper<float>("rk45");
+    int n_steps = static_cast<int>((system.t_end - system.t_start) / dt) + 1;
+    std::vector<std::vector<float>> float_solution(n_steps, system_float.initial_conditions);
+    std::vector<float> y_float = system_float.initial_conditions;
+    for (int i = 1; i < n_steps; ++i) {
+        float_stepper->step(system_float, system.t_start + (i - 1) * dt, dt, y_float);
+        float_solution[i] = y_float;
+    }
+    double float_time = timer.elapsed();
+    double float_error = compute_error(float_solution, system_float, dt);
+    
+    std::cout << "CPU Results (float):" << std::endl;
+    std::cout << "  Time: " << std::fixed << std::setprecision(6) << float_time << " seconds" << std::endl;
+    if (float_error >= 0) {
+        std::cout << "  Max Error: " << std::scientific << std::setprecision(3) << float_error << std::endl;
+    }
+    std::cout << "  Throughput: " << std::fixed << std::setprecision(0) 
+              << system.dimension / float_time << " ODEs/second" << std::endl;
+    
+    // Auto-dispatched Euler solve: the cost model picks CPU (single or
+    // threaded) or GPU from the system's size, RHS and GPU support
+    std::cout << "\nRunning auto-dispatched Euler solve..." << std::endl;
+    timer.start();
+    std::vector<std::vector<double>> auto_solution;
+    dispatcher.solve(system, system.t_start, system.t_end, dt,
+                     system.initial_conditions, auto_solution);
+    double auto_time = timer.elapsed();
+    
+    if (!auto_solution.empty()) {
+        double auto_error = compute_error(auto_solution, system, dt);
         
-        try {
-            gpu_solver.solve(system, system.t_start, system.t_end, dt, 
-                            system.initial_conditions, gpu_solution);
-        } catch (...) {
-            gpu_success = false;
+        std::cout << "Auto Results (" << dispatcher.history().back().backend << "):" << std::endl;
+        std::cout << "  Time: " << std::fixed << std::setprecision(6) << auto_time << " seconds" << std::endl;
+        if (auto_error >= 0) {
+            std::cout << "  Max Error: " << std::scientific << std::setprecision(3) << auto_error << std::endl;
         }
+        std::cout << "  Throughput: " << std::fixed << std::setprecision(0) 
+                  << system.dimension / auto_time << " ODEs/second" << std::endl;
         
-        double gpu_time = timer.elapsed();
+        // Comparison
+        std::cout << "\nComparison:" << std::endl;
+        if (auto_time > 0) {
+            double speedup = cpu_time / auto_time;
+            std::cout << "  Speedup vs CPU RK45: " << std::fixed << std::setprecision(2) << speedup << "x" << std::endl;
+        }
         
-        if (gpu_success && !gpu_solution.empty()) {
-            double gpu_error = compute_error(gpu_solution, system, dt);
-            
-            std::cout << "GPU Results:" << std::endl;
-            std::cout << "  Time: " << std::fixed << std::setprecision(6) << gpu_time << " seconds" << std::endl;
-            if (gpu_error >= 0) {
-                std::cout << "  Max Error: " << std::scientific << std::setprecision(3) << gpu_error << std::endl;
-            }
-            std::cout << "  Throughput: " << std::fixed << std::setprecision(0) 
-                      << system.dimension / gpu_time << " ODEs/second" << std::endl;
-            
-            // Comparison
-            std::cout << "\nComparison:" << std::endl;
-            if (gpu_time > 0) {
-                double speedup = cpu_time / gpu_time;
-                std::cout << "  Speedup: " << std::fixed << std::setprecision(2) << speedup << "x";
-                if (speedup > 1.0) {
-                    std::cout << " (GPU faster)";
-                } else {
-                    std::cout << " (CPU faster)";
-                }
-                std::cout << std::endl;
+        // Solution consistency check (Euler vs RK45, so expect O(dt) differences)
+        double max_diff = 0.0;
+        size_t min_size = std::min(cpu_solution.size(), auto_solution.size());
+        for (size_t i = 0; i < min_size; ++i) {
+            for (size_t j = 0; j < cpu_solution[i].size(); ++j) {
+                double diff = std::abs(cpu_solution[i][j] - auto_solution[i][j]);
+                max_diff = std::max(max_diff, diff);
             }
-            
-            // Solution consistency check
-            if (!cpu_solution.empty() && !gpu_solution.empty()) {
-                double max_diff = 0.0;
-                size_t min_size = std::min(cpu_solution.size(), gpu_solution.size());
-                for (size_t i = 0; i < min_size; ++i) {
-                    for (size_t j = 0; j < cpu_solution[i].size(); ++j) {
-                        double diff = std::abs(cpu_solution[i][j] - gpu_solution[i][j]);
-                        max_diff = std::max(max_diff, diff);
-                    }
-                }
-                std::cout << "  Max CPU-GPU difference: " << std::scientific 
-                          << std::setprecision(3) << max_diff << std::endl;
-            }
-        } else {
-            std::cout << "GPU Results:" << std::endl;
-            std::cout << "  Status: Failed to solve" << std::endl;
         }
+        std::cout << "  Max RK45-Euler difference: " << std::scientific 
+                  << std::setprecision(3) << max_diff << std::endl;
     } else {
-        std::cout << "\nGPU solver: Skipped (only supports exponential decay problems)" << std::endl;
+        std::cout << "Auto Results:" << std::endl;
+        std::cout << "  Status: Failed to solve" << std::endl;
     }
 }
 
@@ -123,16 +129,30 @@ int main() {
     
     const double dt = 0.01;
     
+    // Cost model inputs: reuse a previous calibration when present
+    ThreadPool pool;
+    CostCalibration calibration;
+    if (!calibration.load("cost_calibration.txt")) {
+        std::cout << "Calibrating cost model..." << std::endl;
+        calibration = CostCalibration::measure(pool, true);
+        calibration.save("cost_calibration.txt");
+    }
+    ScalingTable scaling_table;
+    scaling_table.load("scaling_table.txt");  // Optional, from scaling_benchmark
+    
+    AutoDispatcher dispatcher("euler", pool, calibration);
+    dispatcher.set_scaling_table(&scaling_table);
+    
     // Test 1: Exponential Decay (validation)
     auto exp_decay = TestProblems::create_exponential_decay();
-    run_benchmark(exp_decay, dt);
+    run_benchmark(exp_decay, TestProblems::create_exponential_decay<float>(), dt, dispatcher);
     
-    // Test 2: Scalability tests (CPU only)
+    // Test 2: Scalability tests
     std::vector<int> problem_sizes = {100, 1000, 10000};
     
     for (int N : problem_sizes) {
         auto scalability_test = TestProblems::create_scalability_test(N);
-        run_benchmark(scalability_test, dt);
+        run_benchmark(scalability_test, TestProblems::create_scalability_test<float>(N), dt, dispatcher);
     }
     
     std::cout << "\n" << std::string(60, '=') << std::endl;
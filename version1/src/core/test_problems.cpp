@@ -1,83 +1,172 @@
 #include "test_problems.h"
 #include <cmath>
+#include <stdexcept>
 
-ODESystem TestProblems::create_exponential_decay() {
-    ODESystem system;
+namespace {
+
+// The allocating rhs on top of the in-place one, so each problem's
+// equations are written once
+template <typename Scalar, typename InPlace>
+auto allocating_rhs(int dimension, InPlace inplace) {
+    return [dimension, inplace](double t, const std::vector<Scalar>& y) {
+        std::vector<Scalar> dydt(dimension);
+        inplace(t, y, dydt);
+        return dydt;
+    };
+}
+
+}  // namespace
+
+template <typename Scalar>
+BasicODESystem<Scalar> TestProblems::create_exponential_decay(double lambda) {
+    using State = std::vector<Scalar>;
+    BasicODESystem<Scalar> system;
     system.name = "Exponential Decay";
     system.dimension = 1;
     system.t_start = 0.0;
     system.t_end = 5.0;
-    system.initial_conditions = {1.0};
-    system.parameters["lambda"] = 2.0;
+    system.initial_conditions = {Scalar(1)};
+    system.parameters["lambda"] = lambda;
+    const Scalar l = static_cast<Scalar>(lambda);
     
     // RHS function: dy/dt = -lambda * y
-    system.rhs = [](double t, const std::vector<double>& y) -> std::vector<double> {
-        return {-2.0 * y[0]};
+    system.rhs_inplace = [l](double /*t*/, const State& y, State& dydt) {
+        dydt[0] = -l * y[0];
     };
+    system.rhs = allocating_rhs<Scalar>(1, system.rhs_inplace);
     
     // Analytical solution: y(t) = y0 * exp(-lambda * t)
-    system.analytical_solution = [](double t) -> std::vector<double> {
-        return {std::exp(-2.0 * t)};
+    system.analytical_solution = [l](double t) -> State {
+        return {std::exp(-l * static_cast<Scalar>(t))};
     };
     
     // GPU support
-    system.gpu_info = ODESystem::GPUInfo{};
+    system.gpu_info = ODEGPUInfo{};
     system.gpu_info->builtin_rhs_name = "exponential";
-    system.gpu_info->gpu_uniforms = {2.0f};  // lambda value
+    system.gpu_info->gpu_uniforms = {static_cast<float>(lambda)};  // lambda value
     
     return system;
 }
 
-ODESystem TestProblems::create_van_der_pol() {
-    ODESystem system;
+template <typename Scalar>
+BasicODESystem<Scalar> TestProblems::create_van_der_pol(double mu) {
+    using State = std::vector<Scalar>;
+    BasicODESystem<Scalar> system;
     system.name = "Van der Pol Oscillator";
     system.dimension = 2;
     system.t_start = 0.0;
     system.t_end = 20.0;
-    system.initial_conditions = {2.0, 0.0};
-    system.parameters["mu"] = 1.0;
+    system.initial_conditions = {Scalar(2), Scalar(0)};
+    system.parameters["mu"] = mu;
+    const Scalar m = static_cast<Scalar>(mu);
     
     // RHS function: dx/dt = y, dy/dt = mu*(1-x^2)*y - x
-    system.rhs = [](double t, const std::vector<double>& y) -> std::vector<double> {
-        double x = y[0];
-        double v = y[1];
-        double mu = 1.0;
-        return {v, mu * (1 - x*x) * v - x};
+    system.rhs_inplace = [m](double /*t*/, const State& y, State& dydt) {
+        Scalar x = y[0];
+        Scalar v = y[1];
+        dydt[0] = v;
+        dydt[1] = m * (1 - x*x) * v - x;
     };
+    system.rhs = allocating_rhs<Scalar>(2, system.rhs_inplace);
     
     // GPU support
-    system.gpu_info = ODESystem::GPUInfo{};
+    system.gpu_info = ODEGPUInfo{};
     system.gpu_info->builtin_rhs_name = "vanderpol";
-    system.gpu_info->gpu_uniforms = {1.0f};  // mu value
+    system.gpu_info->gpu_uniforms = {static_cast<float>(mu)};  // mu value
     
     return system;
 }
 
-ODESystem TestProblems::create_scalability_test(int N) {
-    ODESystem system;
+template <typename Scalar>
+BasicODESystem<Scalar> TestProblems::create_scalability_test(int N, double epsilon) {
+    using State = std::vector<Scalar>;
+    BasicODESystem<Scalar> system;
     system.name = "Scalability Test N=" + std::to_string(N);
     system.dimension = N;
     system.t_start = 0.0;
     system.t_end = 5.0;
-    system.parameters["epsilon"] = 0.1;
+    system.parameters["epsilon"] = epsilon;
     
     system.initial_conditions.resize(N);
     for (int i = 0; i < N; ++i) {
-        system.initial_conditions[i] = i * 0.1;
+        system.initial_conditions[i] = static_cast<Scalar>(i * 0.1);
     }
+    const Scalar eps = static_cast<Scalar>(epsilon);
     
     // RHS function: dxi/dt = -xi + sin(xi-1) + epsilon*xi+1
-    system.rhs = [N](double t, const std::vector<double>& y) -> std::vector<double> {
-        std::vector<double> dydt(N);
-        const double eps = 0.1;
-        
-        for (int i = 0; i < N; ++i) {
+    system.rhs_range = [N, eps](double /*t*/, const State& y, State& dydt,
+                           int begin, int end) {
+        for (int i = begin; i < end; ++i) {
             dydt[i] = -y[i];
             if (i > 0) dydt[i] += std::sin(y[i-1]);
             if (i < N-1) dydt[i] += eps * y[i+1];
         }
-        return dydt;
     };
+    auto range = system.rhs_range;
+    system.rhs_inplace = [N, range](double t, const State& y, State& dydt) {
+        range(t, y, dydt, 0, N);
+    };
+    system.rhs = allocating_rhs<Scalar>(N, system.rhs_inplace);
     
     return system;
-} 
\ No newline at end of file
+}
+
+#define ODE_INSTANTIATE_TEST_PROBLEMS(Scalar) \
+    template BasicODESystem<Scalar> TestProblems::create_exponential_decay<Scalar>(double); \
+    template BasicODESystem<Scalar> TestProblems::create_van_der_pol<Scalar>(double); \
+    template BasicODESystem<Scalar> TestProblems::create_scalability_test<Scalar>(int, double);
+
+ODE_INSTANTIATE_TEST_PROBLEMS(float)
+ODE_INSTANTIATE_TEST_PROBLEMS(double)
+ODE_INSTANTIATE_TEST_PROBLEMS(long double)
+
+ODESystem TestProblems::create(const std::string& name, int dimension) {
+    return create(name, dimension, {});
+}
+
+ODESystem TestProblems::create(const std::string& name, int dimension,
+                               const std::map<std::string, double>& parameters) {
+    auto parameter = [&](const std::string& key, double fallback) {
+        auto it = parameters.find(key);
+        return it != parameters.end() ? it->second : fallback;
+    };
+
+    ODESystem system;
+    if (name == "exponential") {
+        system = create_exponential_decay(parameter("lambda", 2.0));
+    } else if (name == "vanderpol") {
+        system = create_van_der_pol(parameter("mu", 1.0));
+    } else if (name == "scalability") {
+        if (dimension < 1) {
+            throw std::invalid_argument("Scalability test needs a positive dimension");
+        }
+        system = create_scalability_test(dimension, parameter("epsilon", 0.1));
+    } else {
+        throw std::invalid_argument("Unknown test problem: " + name);
+    }
+
+    // Every override must name one of the problem's own parameters
+    for (const auto& entry : parameters) {
+        if (!system.parameters.count(entry.first)) {
+            throw std::invalid_argument("Test problem " + name + " has no parameter " + entry.first);
+        }
+    }
+
+    if (dimension != system.dimension) {
+        throw std::invalid_argument("Test problem " + name + " has dimension " +
+                                    std::to_string(system.dimension) + ", not " +
+                                    std::to_string(dimension));
+    }
+    return system;
+}
+
+std::vector<std::string> TestProblems::names() {
+    return {"exponential", "vanderpol", "scalability"};
+}
+
+int TestProblems::fixed_dimension(const std::string& name) {
+    if (name == "scalability") {
+        return 0;
+    }
+    return create(name, name == "vanderpol" ? 2 : 1).dimension;
+}
@@ -0,0 +1,130 @@
+#include "../../include/solve_client.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace solve_protocol;
+
+// ---------------------------------------------------------------------------
+// MappedResult
+// ---------------------------------------------------------------------------
+
+MappedResult::MappedResult(const ResultInfo& info, int fd) : info_(info) {
+    bytes_ = static_cast<size_t>(info.rows) * info.cols * sizeof(double);
+    if (bytes_ == 0) {
+        if (fd >= 0) close(fd);
+        return;
+    }
+    if (fd < 0) {
+        throw std::runtime_error("Daemon result arrived without its buffer");
+    }
+    void* map = mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        bytes_ = 0;
+        throw std::runtime_error(std::string("Cannot map daemon result: ") + std::strerror(errno));
+    }
+    data_ = static_cast<const double*>(map);
+}
+
+MappedResult::MappedResult(MappedResult&& other) noexcept
+    : info_(std::move(other.info_)), data_(other.data_), bytes_(other.bytes_) {
+    other.data_ = nullptr;
+    other.bytes_ = 0;
+}
+
+MappedResult& MappedResult::operator=(MappedResult&& other) noexcept {
+    if (this != &other) {
+        release();
+        info_ = std::move(other.info_);
+        data_ = other.data_;
+        bytes_ = other.bytes_;
+        other.data_ = nullptr;
+        other.bytes_ = 0;
+    }
+    return *this;
+}
+
+MappedResult::~MappedResult() {
+    release();
+}
+
+void MappedResult::release() {
+    if (data_) {
+        munmap(const_cast<double*>(data_), bytes_);
+        data_ = nullptr;
+        bytes_ = 0;
+    }
+}
+
+std::vector<std::vector<double>> MappedResult::to_rows() const {
+    std::vector<std::vector<double>> out(rows());
+    for (size_t r = 0; r < rows(); ++r) {
+        out[r].assign(row(r), row(r) + cols());
+    }
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// SolveClient
+// ---------------------------------------------------------------------------
+
+SolveClient::SolveClient(const std::string& socket_path) : fd_(-1), next_id_(1) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + socket_path);
+    }
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0 || connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::string reason = std::strerror(errno);
+        if (fd_ >= 0) close(fd_);
+        throw std::runtime_error("Cannot connect to solve daemon at " + socket_path + ": " + reason);
+    }
+}
+
+SolveClient::~SolveClient() {
+    if (fd_ >= 0) close(fd_);
+}
+
+std::vector<std::uint8_t> SolveClient::round_trip(MessageType type,
+                                                  const std::vector<std::uint8_t>& payload,
+                                                  MessageType expected, int* received_fd) {
+    const std::uint64_t id = next_id_++;
+    if (!send_message(fd_, type, id, payload)) {
+        throw std::runtime_error("Lost connection to solve daemon");
+    }
+
+    MessageHeader header;
+    std::vector<std::uint8_t> reply;
+    if (!recv_message(fd_, header, reply, received_fd)) {
+        throw std::runtime_error("Lost connection to solve daemon");
+    }
+    auto reply_type = static_cast<MessageType>(header.type);
+    if (reply_type == MessageType::Error) {
+        if (received_fd && *received_fd >= 0) close(*received_fd);
+        throw std::runtime_error("Solve daemon: " + std::string(reply.begin(), reply.end()));
+    }
+    if (reply_type != expected || header.request_id != id) {
+        if (received_fd && *received_fd >= 0) close(*received_fd);
+        throw std::runtime_error("Unexpected reply from solve daemon");
+    }
+    return reply;
+}
+
+MappedResult SolveClient::solve(const SolveRequest& request) {
+    int result_fd = -1;
+    std::vector<std::uint8_t> reply = round_trip(MessageType::Solve, encode(request),
+                                                 MessageType::Result, &result_fd);
+    return MappedResult(decode_result_info(reply), result_fd);
+}
+
+DaemonStats SolveClient::stats() {
+    return decode_daemon_stats(round_trip(MessageType::Stats, {}, MessageType::StatsReply, nullptr));
+}
@@ -0,0 +1,319 @@
+#include "../../include/solve_daemon.h"
+#include "../../include/test_problems.h"
+#include "../../include/trace.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <iostream>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace solve_protocol;
+
+namespace {
+
+// rows x cols doubles in a sealed memfd; the receiver can map it without
+// worrying that we resize or rewrite it afterwards. -1 on failure.
+template <typename FillRow>
+int make_result_memfd(size_t rows, size_t cols, FillRow fill_row) {
+    const size_t bytes = rows * cols * sizeof(double);
+    int fd = memfd_create("ode_result", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        std::cerr << "SolveDaemon: memfd_create failed: " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        std::cerr << "SolveDaemon: ftruncate failed: " << std::strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+
+    void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        std::cerr << "SolveDaemon: mmap failed: " << std::strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+    auto* out = static_cast<double*>(map);
+    for (size_t r = 0; r < rows; ++r) {
+        fill_row(r, out + r * cols);
+    }
+    munmap(map, bytes);
+
+    // Sealing writes needs the writable mapping gone, hence after munmap
+    fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+    return fd;
+}
+
+bool send_result(int fd, std::uint64_t request_id, ResultInfo info, size_t rows, size_t cols,
+                 const std::function<void(size_t, double*)>& fill_row) {
+    info.rows = static_cast<std::uint32_t>(rows);
+    info.cols = static_cast<std::uint32_t>(cols);
+
+    int result_fd = -1;
+    if (rows > 0 && cols > 0) {
+        result_fd = make_result_memfd(rows, cols, fill_row);
+        if (result_fd < 0) {
+            const std::string message = "Daemon could not allocate a result buffer";
+            return send_message(fd, MessageType::Error, request_id,
+                                std::vector<std::uint8_t>(message.begin(), message.end()));
+        }
+    }
+    bool sent = send_message(fd, MessageType::Result, request_id, encode(info), result_fd);
+    if (result_fd >= 0) {
+        close(result_fd);  // The client holds its own reference now
+    }
+    return sent;
+}
+
+}  // namespace
+
+SolveDaemon::SolveDaemon(const DaemonOptions& options, const CostCalibration& calibration)
+    : options_(options), service_(options.cpu_workers, calibration),
+      batch_pool_(options.cpu_workers),
+      coalescer_(batch_pool_, calibration, options.coalescing),
+      listen_fd_(-1), stopping_(false) {
+    wake_pipe_[0] = wake_pipe_[1] = -1;
+}
+
+SolveDaemon::~SolveDaemon() {
+    stop();
+    reap_connections(true);
+
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        unlink(options_.socket_path.c_str());
+    }
+    for (int fd : wake_pipe_) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+bool SolveDaemon::start() {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (options_.socket_path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "SolveDaemon: socket path too long: " << options_.socket_path << std::endl;
+        return false;
+    }
+    std::strncpy(addr.sun_path, options_.socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    if (pipe2(wake_pipe_, O_CLOEXEC | O_NONBLOCK) != 0) {
+        std::cerr << "SolveDaemon: pipe2 failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "SolveDaemon: socket failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    unlink(options_.socket_path.c_str());
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listen_fd_, 64) != 0) {
+        std::cerr << "SolveDaemon: cannot listen on " << options_.socket_path << ": "
+                  << std::strerror(errno) << std::endl;
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+void SolveDaemon::stop() {
+    stopping_.store(true);
+    if (wake_pipe_[1] >= 0) {
+        char byte = 1;
+        ssize_t ignored = write(wake_pipe_[1], &byte, 1);
+        (void)ignored;
+    }
+}
+
+void SolveDaemon::run() {
+    ODE_TRACE_THREAD_NAME("daemon_accept");
+    if (listen_fd_ < 0) {
+        std::cerr << "SolveDaemon: run() before a successful start()" << std::endl;
+        return;
+    }
+
+    while (!stopping_.load()) {
+        pollfd fds[2] = {{listen_fd_, POLLIN, 0}, {wake_pipe_[0], POLLIN, 0}};
+        int ready = poll(fds, 2, 1000);
+        reap_connections(false);
+        if (ready <= 0 || !(fds[0].revents & POLLIN)) {
+            continue;
+        }
+
+        int client = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        open_fds_.insert(client);
+        connection_threads_.emplace_back([this, client]() { serve_connection(client); });
+    }
+
+    // Unblock connection threads sitting in read()
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    for (int fd : open_fds_) {
+        shutdown(fd, SHUT_RDWR);
+    }
+}
+
+void SolveDaemon::reap_connections(bool all) {
+    std::vector<std::thread> done;
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        if (all) {
+            for (int fd : open_fds_) {
+                shutdown(fd, SHUT_RDWR);
+            }
+        }
+        auto finished = [&](const std::thread& t) {
+            return all || std::find(finished_.begin(), finished_.end(), t.get_id()) != finished_.end();
+        };
+        for (auto it = connection_threads_.begin(); it != connection_threads_.end();) {
+            if (finished(*it)) {
+                done.push_back(std::move(*it));
+                it = connection_threads_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (!all) {
+            finished_.clear();
+        }
+    }
+    for (auto& thread : done) {
+        thread.join();
+    }
+}
+
+solve_protocol::DaemonStats SolveDaemon::stats() const {
+    DaemonStats stats;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats = stats_;
+    }
+    CoalescerMetrics batching = coalescer_.metrics();
+    stats.batches = batching.batches;
+    stats.batched_requests = batching.requests;
+    stats.largest_batch = batching.largest_batch;
+    stats.full_flushes = batching.full_flushes;
+    stats.window_flushes = batching.window_flushes;
+    stats.mean_wait_us = batching.wait.mean_ns() * 1e-3;
+    stats.p99_wait_us = batching.wait.percentile_ns(99.0) * 1e-3;
+    return stats;
+}
+
+void SolveDaemon::serve_connection(int fd) {
+    ODE_TRACE_THREAD_NAME("daemon_connection");
+
+    MessageHeader header;
+    std::vector<std::uint8_t> payload;
+    while (recv_message(fd, header, payload)) {
+        bool ok = true;
+        switch (static_cast<MessageType>(header.type)) {
+        case MessageType::Solve:
+            ok = handle_solve(fd, header.request_id, payload);
+            break;
+        case MessageType::Stats:
+            ok = send_message(fd, MessageType::StatsReply, header.request_id, encode(stats()));
+            break;
+        default: {
+            const std::string message = "Unexpected message type " + std::to_string(header.type);
+            ok = send_message(fd, MessageType::Error, header.request_id,
+                              std::vector<std::uint8_t>(message.begin(), message.end()));
+            break;
+        }
+        }
+        if (!ok) break;
+    }
+
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    open_fds_.erase(fd);
+    close(fd);
+    finished_.push_back(std::this_thread::get_id());
+}
+
+bool SolveDaemon::handle_solve(int fd, std::uint64_t request_id,
+                               const std::vector<std::uint8_t>& payload) {
+    ODE_TRACE_SCOPE_CAT("daemon_request", "daemon");
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.requests++;
+    }
+
+    try {
+        SolveRequest request = decode_solve_request(payload);
+        if (request.method != "euler" && request.method != "rk45") {
+            throw std::invalid_argument("Unknown stepper method: " + request.method);
+        }
+        if (!(request.dt > 0.0) || !(request.tf >= request.t0)) {
+            throw std::invalid_argument("Need dt > 0 and tf >= t0");
+        }
+        // The client picks the step count and result size: bound both
+        // before anything converts them to int or allocates
+        const double steps = (request.tf - request.t0) / request.dt;
+        if (!std::isfinite(steps) || steps > static_cast<double>(options_.max_steps)) {
+            throw std::invalid_argument("Too many steps: (tf - t0) / dt must not exceed " +
+                                        std::to_string(options_.max_steps));
+        }
+        const bool batched = (request.flags & kFinalStateOnly) && request.backend == "auto";
+        if (!batched && (steps + 1.0) * static_cast<double>(request.y0.size()) >
+                            static_cast<double>(options_.max_trajectory_values)) {
+            throw std::invalid_argument("Trajectory too large: steps x dimension must not exceed " +
+                                        std::to_string(options_.max_trajectory_values));
+        }
+        ODESystem system = TestProblems::create(request.problem, static_cast<int>(request.y0.size()));
+        const size_t dim = request.y0.size();
+
+        if (batched) {
+            CoalescedResult batch = coalescer_.submit(system, request.method, request.t0,
+                                                      request.tf, request.dt,
+                                                      std::move(request.y0)).get();
+            ResultInfo info;
+            info.backend = batch.backend;
+            info.batch_size = batch.batch_size;
+            info.queue_seconds = batch.wait_seconds;
+            info.run_seconds = batch.run_seconds;
+            return send_result(fd, request_id, info, 1, dim, [&](size_t, double* row) {
+                std::copy(batch.final_state.begin(), batch.final_state.end(), row);
+            });
+        }
+
+        SolveOptions options;
+        options.t0 = request.t0;
+        options.tf = request.tf;
+        options.dt = request.dt;
+        options.y0 = request.y0;
+        options.method = request.method;
+        options.backend = request.backend;
+        options.priority = request.priority;
+        SolveResult result = service_.submit(system, options).get();
+
+        ResultInfo info;
+        info.backend = result.backend;
+        info.queue_seconds = result.queue_seconds;
+        info.run_seconds = result.run_seconds;
+        const auto& rows = result.solution;
+        size_t first = (request.flags & kFinalStateOnly) && !rows.empty() ? rows.size() - 1 : 0;
+        return send_result(fd, request_id, info, rows.size() - first, dim, [&](size_t r, double* row) {
+            std::copy(rows[first + r].begin(), rows[first + r].end(), row);
+        });
+    } catch (const std::exception& e) {
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            stats_.errors++;
+        }
+        const std::string message = e.what();
+        return send_message(fd, MessageType::Error, request_id,
+                            std::vector<std::uint8_t>(message.begin(), message.end()));
+    }
+}
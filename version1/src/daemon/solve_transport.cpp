@@ -0,0 +1,136 @@
+#include "../../include/solve_protocol.h"
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace solve_protocol {
+
+bool read_full(int fd, void* buffer, size_t bytes) {
+    auto* out = static_cast<std::uint8_t*>(buffer);
+    while (bytes > 0) {
+        ssize_t n = ::read(fd, out, bytes);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        out += n;
+        bytes -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool write_full(int fd, const void* buffer, size_t bytes) {
+    const auto* in = static_cast<const std::uint8_t*>(buffer);
+    while (bytes > 0) {
+        // MSG_NOSIGNAL: a vanished peer is an error return, not SIGPIPE
+        ssize_t n = ::send(fd, in, bytes, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        in += n;
+        bytes -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool send_message(int fd, MessageType type, std::uint64_t request_id,
+                  const std::vector<std::uint8_t>& payload, int pass_fd) {
+    MessageHeader header;
+    header.type = static_cast<std::uint16_t>(type);
+    header.request_id = request_id;
+    header.payload_bytes = static_cast<std::uint32_t>(payload.size());
+
+    iovec iov[2];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = const_cast<std::uint8_t*>(payload.data());
+    iov[1].iov_len = payload.size();
+
+    msghdr msg{};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = payload.empty() ? 1 : 2;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    if (pass_fd >= 0) {
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), &pass_fd, sizeof(int));
+    }
+
+    ssize_t sent;
+    do {
+        sent = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    if (sent <= 0) return false;
+
+    // Stream sockets may take a large message in pieces; the descriptor
+    // already went with the first byte
+    size_t done = static_cast<size_t>(sent);
+    if (done < sizeof(header)) {
+        if (!write_full(fd, reinterpret_cast<const std::uint8_t*>(&header) + done,
+                        sizeof(header) - done)) {
+            return false;
+        }
+        done = sizeof(header);
+    }
+    size_t payload_done = done - sizeof(header);
+    return write_full(fd, payload.data() + payload_done, payload.size() - payload_done);
+}
+
+bool recv_message(int fd, MessageHeader& header, std::vector<std::uint8_t>& payload,
+                  int* received_fd) {
+    if (received_fd) *received_fd = -1;
+
+    iovec iov;
+    iov.iov_base = &header;
+    iov.iov_len = sizeof(header);
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t n;
+    do {
+        n = ::recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) return false;
+
+    int passed = -1;
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            std::memcpy(&passed, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+    auto drop_passed = [&]() {
+        if (passed >= 0) ::close(passed);
+        return false;
+    };
+
+    if (static_cast<size_t>(n) < sizeof(header) &&
+        !read_full(fd, reinterpret_cast<std::uint8_t*>(&header) + n, sizeof(header) - n)) {
+        return drop_passed();
+    }
+    if (header.magic != kMagic || header.version != kVersion ||
+        header.payload_bytes > kMaxPayloadBytes) {
+        return drop_passed();
+    }
+
+    payload.resize(header.payload_bytes);
+    if (!read_full(fd, payload.data(), payload.size())) {
+        return drop_passed();
+    }
+
+    if (received_fd) {
+        *received_fd = passed;
+    } else if (passed >= 0) {
+        ::close(passed);
+    }
+    return true;
+}
+
+}  // namespace solve_protocol
@@ -1,115 +1,105 @@
 #include "../../include/builtin_rhs_registry.h"
+#include <deque>
+#include <mutex>
 #include <stdexcept>
 
-BuiltinRHSRegistry& BuiltinRHSRegistry::instance() {
-    static BuiltinRHSRegistry instance;
-    return instance;
-}
+namespace {
 
-BuiltinRHSRegistry::BuiltinRHSRegistry() {
-    register_builtin_systems();
-}
+// Systems added through BuiltinRHSRegistration. Entries never move (deque),
+// so the BuiltinRHS views handed out stay valid.
+struct Registered {
+    std::string name;
+    RHSDefinition definition;
+    std::vector<std::string_view> uniforms;
+    BuiltinRHS view;
+};
 
-void BuiltinRHSRegistry::register_rhs(const std::string& name, 
-                                     const RHSDefinition& definition) {
-    registry_[name] = definition;
+struct Extensions {
+    std::mutex mutex;
+    std::deque<Registered> entries;
+};
+
+Extensions& extensions() {
+    static Extensions extensions;
+    return extensions;
 }
 
-RHSDefinition BuiltinRHSRegistry::get_rhs(const std::string& name) {
-    auto it = registry_.find(name);
-    if (it == registry_.end()) {
-        throw std::invalid_argument("Unknown RHS system: " + name);
+}  // namespace
+
+const BuiltinRHS* BuiltinRHSRegistry::find(std::string_view name) {
+    const int id = find_builtin(name);
+    if (id >= 0) {
+        return &kBuiltinRHS[id];
     }
-    return it->second;
+    Extensions& ext = extensions();
+    std::lock_guard<std::mutex> lock(ext.mutex);
+    for (const Registered& entry : ext.entries) {
+        if (entry.view.name == name) return &entry.view;
+    }
+    return nullptr;
 }
 
-std::vector<std::string> BuiltinRHSRegistry::list_available() {
-    std::vector<std::string> names;
-    for (const auto& pair : registry_) {
-        names.push_back(pair.first);
+const BuiltinRHS& BuiltinRHSRegistry::get_rhs(std::string_view name) {
+    const BuiltinRHS* rhs = find(name);
+    if (!rhs) {
+        throw std::invalid_argument("Unknown RHS system: " + std::string(name));
     }
-    return names;
+    return *rhs;
 }
 
-bool BuiltinRHSRegistry::has_rhs(const std::string& name) {
-    return registry_.find(name) != registry_.end();
+const BuiltinRHS& BuiltinRHSRegistry::get_rhs(int id) {
+    if (id >= 0 && id < kBuiltinRHSCount) {
+        return kBuiltinRHS[id];
+    }
+    Extensions& ext = extensions();
+    std::lock_guard<std::mutex> lock(ext.mutex);
+    const long long index = static_cast<long long>(id) - kBuiltinRHSCount;
+    if (index < 0 || index >= static_cast<long long>(ext.entries.size())) {
+        throw std::invalid_argument("Unknown RHS system id: " + std::to_string(id));
+    }
+    return ext.entries[index].view;
 }
 
-void BuiltinRHSRegistry::register_builtin_systems() {
-    // Exponential decay: dy/dt = -lambda * y
-    RHSDefinition exponential;
-    exponential.glsl_code = R"(
-float evaluate_rhs(uint eq_idx, float y_val, float t) {
-    return -lambda * y_val;
+bool BuiltinRHSRegistry::has_rhs(std::string_view name) {
+    return find(name) != nullptr;
 }
-)";
-    exponential.uniform_names = {"lambda"};
-    exponential.problem_type_id = 0;
-    exponential.description = "Exponential decay: dy/dt = -lambda * y";
-    register_rhs("exponential", exponential);
-    
-    // Van der Pol oscillator: dx/dt = y, dy/dt = mu*(1-x^2)*y - x
-    RHSDefinition vanderpol;
-    vanderpol.glsl_code = R"(
-float evaluate_rhs(uint eq_idx, float y_val, float t) {
-    if (eq_idx % 2u == 0u) {
-        // Position equation: dx/dt = v
-        uint v_idx = eq_idx + 1u;
-        return (v_idx < uint(n_equations)) ? current_state[v_idx] : 0.0;
-    } else {
-        // Velocity equation: dv/dt = mu*(1-x^2)*v - x
-        uint x_idx = eq_idx - 1u;
-        float x = current_state[x_idx];
-        return mu * (1.0 - x*x) * y_val - x;
+
+std::vector<std::string_view> BuiltinRHSRegistry::list_available() {
+    std::vector<std::string_view> names;
+    for (const BuiltinRHS& rhs : kBuiltinRHS) {
+        names.push_back(rhs.name);
     }
-}
-)";
-    vanderpol.uniform_names = {"mu"};
-    vanderpol.problem_type_id = 1;
-    vanderpol.description = "Van der Pol oscillator";
-    register_rhs("vanderpol", vanderpol);
-    
-    // Lorenz system: dx/dt = σ(y-x), dy/dt = x(ρ-z)-y, dz/dt = xy-βz
-    RHSDefinition lorenz;
-    lorenz.glsl_code = R"(
-float evaluate_rhs(uint eq_idx, float y_val, float t) {
-    uint base_idx = (eq_idx / 3u) * 3u;
-    uint local_idx = eq_idx % 3u;
-    
-    if (base_idx + 2u < uint(n_equations)) {
-        float x = current_state[base_idx + 0u];
-        float y = current_state[base_idx + 1u]; 
-        float z = current_state[base_idx + 2u];
-        
-        if (local_idx == 0u) return sigma * (y - x);           // dx/dt
-        if (local_idx == 1u) return x * (rho - z) - y;        // dy/dt
-        if (local_idx == 2u) return x * y - beta * z;         // dz/dt
+    Extensions& ext = extensions();
+    std::lock_guard<std::mutex> lock(ext.mutex);
+    for (const Registered& entry : ext.entries) {
+        names.push_back(entry.view.name);
     }
-    return 0.0;
+    return names;
 }
-)";
-    lorenz.uniform_names = {"sigma", "rho", "beta"};
-    lorenz.problem_type_id = 2;
-    lorenz.description = "Lorenz system";
-    register_rhs("lorenz", lorenz);
-    
-    // Harmonic oscillator: d²x/dt² = -ω²x
-    RHSDefinition harmonic;
-    harmonic.glsl_code = R"(
-float evaluate_rhs(uint eq_idx, float y_val, float t) {
-    if (eq_idx % 2u == 0u) {
-        // Position equation: dx/dt = v
-        uint v_idx = eq_idx + 1u;
-        return (v_idx < uint(n_equations)) ? current_state[v_idx] : 0.0;
-    } else {
-        // Velocity equation: dv/dt = -ω²x  
-        uint x_idx = eq_idx - 1u;
-        return -omega_sq * current_state[x_idx];
+
+int BuiltinRHSRegistry::register_rhs(std::string name, RHSDefinition definition) {
+    Extensions& ext = extensions();
+    std::lock_guard<std::mutex> lock(ext.mutex);
+    bool taken = name.empty() || find_builtin(name) >= 0;
+    for (const Registered& entry : ext.entries) {
+        taken = taken || entry.name == name;
     }
+    if (taken) {
+        throw std::invalid_argument("RHS system already registered: " + name);
+    }
+    const int id = kBuiltinRHSCount + static_cast<int>(ext.entries.size());
+    ext.entries.push_back(Registered{std::move(name), std::move(definition), {}, {}});
+
+    Registered& entry = ext.entries.back();
+    entry.definition.problem_type_id = id;
+    for (const std::string& uniform : entry.definition.uniform_names) {
+        entry.uniforms.push_back(uniform);
+    }
+    entry.view = BuiltinRHS{id, entry.name, entry.definition.glsl_code, entry.uniforms.data(),
+                            static_cast<int>(entry.uniforms.size()), entry.definition.coupling_width,
+                            entry.definition.description};
+    return id;
 }
-)";
-    harmonic.uniform_names = {"omega_sq"};
-    harmonic.problem_type_id = 3;
-    harmonic.description = "Harmonic oscillator";
-    register_rhs("harmonic", harmonic);
-} 
\ No newline at end of file
+
+BuiltinRHSRegistration::BuiltinRHSRegistration(std::string name, RHSDefinition definition)
+    : id_(BuiltinRHSRegistry::register_rhs(std::move(name), std::move(definition))) {}
@@ -1,12 +1,16 @@
 #include "../../include/gpu_buffer_manager.h"
+#include "../../include/trace.h"
 #include <iostream>
 #include <cstring>
+#include <utility>
 
 GPUBufferManager::GPUBufferManager() : allocated_(false), n_equations_(0), n_timesteps_(0) {
     buffers_.state_buffer = 0;
+    buffers_.next_state_buffer = 0;
     buffers_.param_buffer = 0;
     buffers_.timeseries_buffer = 0;
     buffers_.time_control_buffer = 0;
+    buffers_.compensation_buffer = 0;
 }
 
 GPUBufferManager::~GPUBufferManager() {
@@ -14,21 +18,32 @@ GPUBufferManager::~GPUBufferManager() {
 }
 
 bool GPUBufferManager::allocate_standard_buffers(int n_equations, int n_timesteps, 
-                                                const std::vector<float>& initial_state) {
+                                                const std::vector<float>& initial_state,
+                                                bool compensated) {
+    ODE_TRACE_SCOPE_CAT("buffer_alloc", "gpu");
+    
     if (allocated_) {
         cleanup_buffers();
     }
     
     n_equations_ = n_equations;
     n_timesteps_ = n_timesteps;
+    const size_t state_size = static_cast<size_t>(n_equations) * sizeof(float);
     
     // Buffer 0: State buffer
     glGenBuffers(1, &buffers_.state_buffer);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers_.state_buffer);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, n_equations * sizeof(float),
+    glBufferData(GL_SHADER_STORAGE_BUFFER, state_size,
                  initial_state.data(), GL_DYNAMIC_DRAW);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffers_.state_buffer);
     
+    // Buffer 5: Next state, same contents so either can be read first
+    glGenBuffers(1, &buffers_.next_state_buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers_.next_state_buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, state_size,
+                 initial_state.data(), GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, buffers_.next_state_buffer);
+    
     // Buffer 1: Parameter buffer
     glGenBuffers(1, &buffers_.param_buffer);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers_.param_buffer);
@@ -37,7 +52,7 @@ bool GPUBufferManager::allocate_standard_buffers(int n_equations, int n_timestep
     
     // Buffer 2: Time series buffer (optional, for storing full trajectory)
     if (n_timesteps > 1) {
-        size_t timeseries_size = n_timesteps * n_equations * sizeof(float);
+        size_t timeseries_size = static_cast<size_t>(n_timesteps) * state_size;
         glGenBuffers(1, &buffers_.timeseries_buffer);
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers_.timeseries_buffer);
         glBufferData(GL_SHADER_STORAGE_BUFFER, timeseries_size, nullptr, GL_DYNAMIC_READ);
@@ -50,6 +65,16 @@ bool GPUBufferManager::allocate_standard_buffers(int n_equations, int n_timestep
     glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(TimeControl), nullptr, GL_DYNAMIC_DRAW);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, buffers_.time_control_buffer);
     
+    // Buffer 4: Compensation buffer, starting from zero carry
+    if (compensated) {
+        std::vector<float> zero_carry(n_equations, 0.0f);
+        glGenBuffers(1, &buffers_.compensation_buffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers_.compensation_buffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, state_size,
+                     zero_carry.data(), GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, buffers_.compensation_buffer);
+    }
+    
     // Check for OpenGL errors
     GLenum error = glGetError();
     if (error != GL_NO_ERROR) {
@@ -66,11 +91,15 @@ void GPUBufferManager::bind_buffers() {
     if (!allocated_) return;
     
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffers_.state_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, buffers_.next_state_buffer);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, buffers_.param_buffer);
     if (buffers_.timeseries_buffer != 0) {
         glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, buffers_.timeseries_buffer);
     }
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, buffers_.time_control_buffer);
+    if (buffers_.compensation_buffer != 0) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, buffers_.compensation_buffer);
+    }
 }
 
 void GPUBufferManager::update_system_params(const SystemParams& params) {
@@ -87,27 +116,47 @@ void GPUBufferManager::update_time_control(const TimeControl& time_ctrl) {
     glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(TimeControl), &time_ctrl);
 }
 
+void GPUBufferManager::swap_state_buffers() {
+    if (!allocated_) return;
+    
+    std::swap(buffers_.state_buffer, buffers_.next_state_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffers_.state_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, buffers_.next_state_buffer);
+}
+
 std::vector<float> GPUBufferManager::read_state_buffer() {
     if (!allocated_) return {};
     
     std::vector<float> result(n_equations_);
+    read_state_buffer(result);
+    return result;
+}
+
+bool GPUBufferManager::read_state_buffer(std::vector<float>& out) {
+    if (!allocated_) return false;
+    
+    ODE_TRACE_SCOPE_CAT("readback", "gpu");
+    
+    if (out.size() != static_cast<size_t>(n_equations_)) {
+        out.resize(n_equations_);
+    }
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers_.state_buffer);
     
+    const size_t state_size = static_cast<size_t>(n_equations_) * sizeof(float);
     float* data = static_cast<float*>(
-        glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, n_equations_ * sizeof(float), GL_MAP_READ_BIT));
+        glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, state_size, GL_MAP_READ_BIT));
     
-    if (data) {
-        std::memcpy(result.data(), data, n_equations_ * sizeof(float));
-        glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
-    }
+    if (!data) return false;
     
-    return result;
+    std::memcpy(out.data(), data, state_size);
+    glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    return true;
 }
 
 std::vector<float> GPUBufferManager::read_timeseries_buffer(int n_equations, int n_steps) {
     if (!allocated_ || buffers_.timeseries_buffer == 0) return {};
     
-    size_t total_size = n_equations * n_steps;
+    size_t total_size = static_cast<size_t>(n_equations) * n_steps;
     std::vector<float> result(total_size);
     
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers_.timeseries_buffer);
@@ -133,6 +182,10 @@ void GPUBufferManager::cleanup_buffers() {
         glDeleteBuffers(1, &buffers_.state_buffer);
         buffers_.state_buffer = 0;
     }
+    if (buffers_.next_state_buffer != 0) {
+        glDeleteBuffers(1, &buffers_.next_state_buffer);
+        buffers_.next_state_buffer = 0;
+    }
     if (buffers_.param_buffer != 0) {
         glDeleteBuffers(1, &buffers_.param_buffer);
         buffers_.param_buffer = 0;
@@ -145,4 +198,8 @@ void GPUBufferManager::cleanup_buffers() {
         glDeleteBuffers(1, &buffers_.time_control_buffer);
         buffers_.time_control_buffer = 0;
     }
+    if (buffers_.compensation_buffer != 0) {
+        glDeleteBuffers(1, &buffers_.compensation_buffer);
+        buffers_.compensation_buffer = 0;
+    }
 } 
\ No newline at end of file
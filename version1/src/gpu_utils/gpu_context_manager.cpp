@@ -1,4 +1,5 @@
 #include "../../include/gpu_context_manager.h"
+#include "../../include/trace.h"
 #include <fcntl.h>
 #include <unistd.h>
 #include <iostream>
@@ -18,10 +19,17 @@ GPUContextManager::~GPUContextManager() {
 }
 
 bool GPUContextManager::initialize() {
-    if (initialized_) {
+    std::lock_guard<std::mutex> lock(init_mutex_);
+    if (initialized_.load(std::memory_order_acquire)) {
+        if (owner_ != std::this_thread::get_id()) {
+            std::cerr << "GPU context is current on another thread; use GPUExecutor" << std::endl;
+            return false;
+        }
         return true;  // Already initialized
     }
     
+    ODE_TRACE_SCOPE_CAT("gpu_context_init", "gpu");
+    
     // Open DRI device
     dri_fd_ = open("/dev/dri/renderD128", O_RDWR);
     if (dri_fd_ < 0) {
@@ -79,17 +87,24 @@ bool GPUContextManager::initialize() {
         return false;
     }
     
-    initialized_ = true;
+    owner_ = std::this_thread::get_id();
+    initialized_.store(true, std::memory_order_release);
     std::cout << "GPU context manager initialized successfully" << std::endl;
     return true;
 }
 
+bool GPUContextManager::is_current_thread() const {
+    return initialized_.load(std::memory_order_acquire) && owner_ == std::this_thread::get_id();
+}
+
 GLuint GPUContextManager::compile_compute_shader(const std::string& source) {
     if (!initialized_) {
         std::cerr << "GPU context not initialized" << std::endl;
         return 0;
     }
     
+    ODE_TRACE_SCOPE_CAT("shader_compile", "gpu");
+    
     GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
     const char* src_ptr = source.c_str();
     glShaderSource(shader, 1, &src_ptr, nullptr);
@@ -123,6 +138,22 @@ GLuint GPUContextManager::compile_compute_shader(const std::string& source) {
     return program;
 }
 
+bool GPUContextManager::has_extension(const std::string& name) const {
+    if (!initialized_) {
+        return false;
+    }
+    
+    GLint n_extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &n_extensions);
+    for (GLint i = 0; i < n_extensions; ++i) {
+        const char* ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (ext && name == ext) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void GPUContextManager::cleanup() {
     if (context_ != EGL_NO_CONTEXT) {
         eglDestroyContext(display_, context_);
@@ -0,0 +1,168 @@
+#include "../../include/gpu_executor.h"
+#include "../../include/gpu_context_manager.h"
+#include "../../include/trace.h"
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// Idle polls before the executor parks on the condition variable; keeps
+// back-to-back command streams off the futex path
+constexpr int kIdleSpins = 256;
+
+}  // namespace
+
+GPUExecutor& GPUExecutor::instance() {
+    // The context manager must outlive the executor thread that uses it
+    GPUContextManager::instance();
+    static GPUExecutor instance;
+    return instance;
+}
+
+GPUExecutor::GPUExecutor()
+    : stop_(false), executed_(0), sleeping_(false) {
+}
+
+GPUExecutor::~GPUExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stop_.store(true);
+    }
+    wake_cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool GPUExecutor::on_executor_thread() const {
+    return thread_id_.load(std::memory_order_acquire) == std::this_thread::get_id();
+}
+
+void GPUExecutor::enqueue(std::function<void()> command) {
+    std::call_once(start_once_, [this]() {
+        thread_ = std::thread([this]() { thread_loop(); });
+    });
+
+    queue_.push(std::move(command));
+
+    // Pairs with the fence in thread_loop(): either the executor sees the
+    // new node before parking, or we see it parked and wake it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_cv_.notify_one();
+    }
+}
+
+void GPUExecutor::thread_loop() {
+    ODE_TRACE_THREAD_NAME("gpu_executor");
+    thread_id_.store(std::this_thread::get_id(), std::memory_order_release);
+
+    std::function<void()> command;
+    int idle = 0;
+    while (true) {
+        if (queue_.pop(command)) {
+            command();
+            command = nullptr;
+            executed_.fetch_add(1, std::memory_order_relaxed);
+            idle = 0;
+            continue;
+        }
+
+        if (stop_.load() && queue_.empty()) {
+            break;
+        }
+        if (++idle < kIdleSpins) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait(lock, [this]() { return !queue_.empty() || stop_.load(); });
+        }
+        sleeping_.store(false, std::memory_order_relaxed);
+        idle = 0;
+    }
+}
+
+bool GPUExecutor::ensure_context() {
+    return GPUContextManager::instance().initialize();
+}
+
+std::future<bool> GPUExecutor::initialize() {
+    return submit([this]() { return ensure_context(); });
+}
+
+std::future<GLuint> GPUExecutor::compile(std::string source) {
+    return submit([this, source = std::move(source)]() -> GLuint {
+        if (!ensure_context()) {
+            return 0;
+        }
+        return GPUContextManager::instance().compile_compute_shader(source);
+    });
+}
+
+std::future<bool> GPUExecutor::upload(GLuint buffer, std::vector<float> data, int offset) {
+    return submit([this, buffer, data = std::move(data), offset]() {
+        ODE_TRACE_SCOPE_CAT("executor_upload", "gpu");
+        if (!ensure_context()) {
+            return false;
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset * sizeof(float),
+                        data.size() * sizeof(float), data.data());
+        GLenum error = glGetError();
+        if (error != GL_NO_ERROR) {
+            std::cerr << "GPU executor: upload failed (GL error 0x" << std::hex << error
+                      << std::dec << ")" << std::endl;
+            return false;
+        }
+        return true;
+    });
+}
+
+std::future<bool> GPUExecutor::dispatch(GLuint program, GLuint groups_x, GLuint groups_y,
+                                        GLuint groups_z, bool barrier) {
+    return submit([this, program, groups_x, groups_y, groups_z, barrier]() {
+        ODE_TRACE_SCOPE_CAT("executor_dispatch", "gpu");
+        if (!ensure_context() || program == 0) {
+            return false;
+        }
+        glUseProgram(program);
+        glDispatchCompute(groups_x, groups_y, groups_z);
+        if (barrier) {
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        }
+        GLenum error = glGetError();
+        if (error != GL_NO_ERROR) {
+            std::cerr << "GPU executor: dispatch failed (GL error 0x" << std::hex << error
+                      << std::dec << ")" << std::endl;
+            return false;
+        }
+        return true;
+    });
+}
+
+std::future<std::vector<float>> GPUExecutor::readback(GLuint buffer, int count, int offset) {
+    return submit([this, buffer, count, offset]() {
+        ODE_TRACE_SCOPE_CAT("executor_readback", "gpu");
+        std::vector<float> result;
+        if (!ensure_context() || count <= 0) {
+            return result;
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+        const void* mapped = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, offset * sizeof(float),
+                                              count * sizeof(float), GL_MAP_READ_BIT);
+        if (!mapped) {
+            std::cerr << "GPU executor: failed to map buffer for readback" << std::endl;
+            return result;
+        }
+        result.resize(count);
+        std::memcpy(result.data(), mapped, count * sizeof(float));
+        glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+        return result;
+    });
+}
@@ -0,0 +1,201 @@
+#include "../../include/gpu_timer_query.h"
+#include "../../include/gpu_context_manager.h"
+#include "../../include/gpu_executor.h"
+#include <EGL/egl.h>
+#include <algorithm>
+#include <iostream>
+
+GPUTimerQueries::GPUTimerQueries()
+    : supported_(false), initialized_(false), active_(false), disjoint_events_(0), dropped_(0),
+      head_(0), pending_(0), gen_queries_(nullptr), delete_queries_(nullptr),
+      begin_query_(nullptr), end_query_(nullptr), get_query_uiv_(nullptr),
+      get_query_ui64v_(nullptr) {
+}
+
+GPUTimerQueries::~GPUTimerQueries() {
+    if (!supported_) return;
+
+    // Delete the queries on the thread the context is current on; the
+    // owning backend is often destroyed off the GPU executor
+    auto release = [this]() {
+        std::vector<GLuint> queries;
+        for (const RingSlot& slot : ring_) {
+            queries.push_back(slot.query);
+        }
+        delete_queries_(static_cast<GLsizei>(queries.size()), queries.data());
+    };
+
+    GPUContextManager& context = GPUContextManager::instance();
+    if (!context.is_initialized() || context.is_current_thread()) {
+        release();
+    } else {
+        GPUExecutor::instance().run_on_gpu_thread(release);
+    }
+}
+
+bool GPUTimerQueries::initialize() {
+    if (initialized_) {
+        return supported_;
+    }
+    initialized_ = true;
+
+    if (!GPUContextManager::instance().has_extension("GL_EXT_disjoint_timer_query")) {
+        std::cout << "GPU timer queries: GL_EXT_disjoint_timer_query not available, "
+                  << "using host timing only" << std::endl;
+        return false;
+    }
+
+    gen_queries_ = reinterpret_cast<PFNGLGENQUERIESEXTPROC>(
+        eglGetProcAddress("glGenQueriesEXT"));
+    delete_queries_ = reinterpret_cast<PFNGLDELETEQUERIESEXTPROC>(
+        eglGetProcAddress("glDeleteQueriesEXT"));
+    begin_query_ = reinterpret_cast<PFNGLBEGINQUERYEXTPROC>(
+        eglGetProcAddress("glBeginQueryEXT"));
+    end_query_ = reinterpret_cast<PFNGLENDQUERYEXTPROC>(
+        eglGetProcAddress("glEndQueryEXT"));
+    get_query_uiv_ = reinterpret_cast<PFNGLGETQUERYOBJECTUIVEXTPROC>(
+        eglGetProcAddress("glGetQueryObjectuivEXT"));
+    get_query_ui64v_ = reinterpret_cast<PFNGLGETQUERYOBJECTUI64VEXTPROC>(
+        eglGetProcAddress("glGetQueryObjectui64vEXT"));
+
+    supported_ = gen_queries_ && delete_queries_ && begin_query_ && end_query_ &&
+                 get_query_uiv_ && get_query_ui64v_;
+    if (!supported_) {
+        std::cerr << "GPU timer queries: extension advertised but entry points missing" << std::endl;
+        return false;
+    }
+
+    GLuint queries[kRingSize];
+    gen_queries_(kRingSize, queries);
+    ring_.reserve(kRingSize);
+    for (GLuint query : queries) {
+        ring_.push_back({query, -1});
+    }
+
+    // Clear any disjoint flag left over from context creation
+    check_disjoint();
+    return true;
+}
+
+int GPUTimerQueries::label_id(const std::string& label) {
+    for (size_t id = 0; id < labels_.size(); ++id) {
+        if (labels_[id] == label) return static_cast<int>(id);
+    }
+    labels_.push_back(label);
+    totals_.emplace_back();
+    return static_cast<int>(labels_.size()) - 1;
+}
+
+void GPUTimerQueries::begin(int label_id) {
+    if (!supported_ || active_) return;
+    if (label_id < 0 || label_id >= static_cast<int>(labels_.size())) return;
+
+    if (pending_ == kRingSize && poll() == 0) {
+        dropped_++;
+        return;
+    }
+    RingSlot& slot = ring_[(head_ + pending_) % kRingSize];
+    slot.label = label_id;
+    begin_query_(GL_TIME_ELAPSED_EXT, slot.query);
+    active_ = true;
+}
+
+void GPUTimerQueries::end() {
+    if (!supported_ || !active_) return;
+
+    end_query_(GL_TIME_ELAPSED_EXT);
+    pending_++;
+    active_ = false;
+}
+
+bool GPUTimerQueries::check_disjoint() {
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    return disjoint != 0;
+}
+
+void GPUTimerQueries::collect(const RingSlot& slot) {
+    GLuint64 elapsed = 0;
+    get_query_ui64v_(slot.query, GL_QUERY_RESULT_EXT, &elapsed);
+
+    GPUTimingSummary& summary = totals_[slot.label];
+    if (summary.count == 0) {
+        summary.min_ns = summary.max_ns = elapsed;
+    } else {
+        summary.min_ns = std::min<std::uint64_t>(summary.min_ns, elapsed);
+        summary.max_ns = std::max<std::uint64_t>(summary.max_ns, elapsed);
+    }
+    summary.count++;
+    summary.total_ns += elapsed;
+}
+
+void GPUTimerQueries::discard_pending() {
+    head_ = (head_ + pending_) % kRingSize;
+    pending_ = 0;
+}
+
+int GPUTimerQueries::poll() {
+    if (!supported_ || pending_ == 0) return 0;
+
+    // A disjoint event (frequency change, context loss...) invalidates every
+    // query in flight; recycle them without recording garbage numbers
+    if (check_disjoint()) {
+        disjoint_events_++;
+        discard_pending();
+        return 0;
+    }
+
+    // Queries complete in submission order, so stop at the first pending one
+    int collected = 0;
+    while (pending_ > 0) {
+        GLuint available = 0;
+        get_query_uiv_(ring_[head_].query, GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+        if (!available) break;
+
+        collect(ring_[head_]);
+        head_ = (head_ + 1) % kRingSize;
+        pending_--;
+        collected++;
+    }
+    return collected;
+}
+
+void GPUTimerQueries::finish() {
+    if (!supported_) return;
+
+    if (check_disjoint()) {
+        disjoint_events_++;
+        discard_pending();
+        return;
+    }
+
+    // GL_QUERY_RESULT_EXT blocks until the result is ready
+    while (pending_ > 0) {
+        collect(ring_[head_]);
+        head_ = (head_ + 1) % kRingSize;
+        pending_--;
+    }
+}
+
+std::map<std::string, GPUTimingSummary> GPUTimerQueries::summaries() const {
+    std::map<std::string, GPUTimingSummary> by_name;
+    for (size_t id = 0; id < labels_.size(); ++id) {
+        if (totals_[id].count > 0) by_name[labels_[id]] = totals_[id];
+    }
+    return by_name;
+}
+
+GPUTimingSummary GPUTimerQueries::summary(const std::string& label) const {
+    for (size_t id = 0; id < labels_.size(); ++id) {
+        if (labels_[id] == label) return totals_[id];
+    }
+    return GPUTimingSummary{};
+}
+
+void GPUTimerQueries::reset() {
+    for (GPUTimingSummary& summary : totals_) {
+        summary = GPUTimingSummary{};
+    }
+    disjoint_events_ = 0;
+    dropped_ = 0;
+}
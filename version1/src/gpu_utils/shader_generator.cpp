@@ -1,17 +1,64 @@
 #include "../../include/shader_generator.h"
+#include "../../include/trace.h"
+#include "embedded_shaders.h"
+#include <cstdlib>
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
 #include <iostream>
 
+namespace {
+
+constexpr std::string_view find_embedded_template(std::string_view name) {
+    for (const EmbeddedShader& shader : kEmbeddedShaders) {
+        if (shader.name == name) return shader.source;
+    }
+    return {};
+}
+
+static_assert(!find_embedded_template("euler_template.glsl").empty(),
+              "euler_template.glsl missing from the embedded shaders");
+static_assert(!find_embedded_template("fft_template.glsl").empty(),
+              "fft_template.glsl missing from the embedded shaders");
+static_assert(!find_embedded_template("packed_euler_template.glsl").empty(),
+              "packed_euler_template.glsl missing from the embedded shaders");
+
+void replace_all(std::string& text, const std::string& placeholder, const std::string& value) {
+    for (size_t pos = text.find(placeholder); pos != std::string::npos;
+         pos = text.find(placeholder, pos + value.size())) {
+        text.replace(pos, placeholder.size(), value);
+    }
+}
+
+}  // namespace
+
 ShaderGenerator::ShaderGenerator() {
-    // Set template path relative to binary location
-    template_path_ = "shaders/templates/";
+    const char* dir = std::getenv("ODE_SHADER_DIR");
+    set_template_override_dir(dir ? dir : "");
+}
+
+void ShaderGenerator::set_template_override_dir(const std::string& dir) {
+    override_dir_ = dir;
+    if (!override_dir_.empty() && override_dir_.back() != '/') {
+        override_dir_ += '/';
+    }
 }
 
-std::string ShaderGenerator::generate_euler_shader(const RHSDefinition& rhs) {
+std::string ShaderGenerator::generate_euler_shader(const RHSDefinition& rhs, bool compensated) {
+    ODE_TRACE_SCOPE_CAT("shader_generate", "gpu");
     std::string template_code = load_template("euler_template.glsl");
-    return substitute_rhs(template_code, rhs);
+    replace_all(template_code, "{{COMPENSATED}}", compensated ? "1" : "0");
+    return substitute_rhs(template_code, rhs.glsl_code,
+                          std::vector<std::string_view>(rhs.uniform_names.begin(), rhs.uniform_names.end()));
+}
+
+std::string ShaderGenerator::generate_euler_shader(const BuiltinRHS& rhs, bool compensated) {
+    ODE_TRACE_SCOPE_CAT("shader_generate", "gpu");
+    std::string template_code = load_template("euler_template.glsl");
+    replace_all(template_code, "{{COMPENSATED}}", compensated ? "1" : "0");
+    return substitute_rhs(template_code, rhs.glsl_code,
+                          std::vector<std::string_view>(rhs.uniform_names, rhs.uniform_names + rhs.uniform_count));
 }
 
 std::string ShaderGenerator::generate_rk45_shader(const RHSDefinition& rhs) {
@@ -19,31 +66,97 @@ std::string ShaderGenerator::generate_rk45_shader(const RHSDefinition& rhs) {
     return generate_euler_shader(rhs);
 }
 
-std::string ShaderGenerator::generate_euler_shader_builtin(const std::string& rhs_name) {
-    auto& registry = BuiltinRHSRegistry::instance();
-    RHSDefinition rhs = registry.get_rhs(rhs_name);
-    return generate_euler_shader(rhs);
+std::string ShaderGenerator::generate_euler_shader_builtin(std::string_view rhs_name, bool compensated) {
+    return generate_euler_shader(BuiltinRHSRegistry::get_rhs(rhs_name), compensated);
+}
+
+std::string ShaderGenerator::generate_fft_shader(int size, bool inverse) {
+    ODE_TRACE_SCOPE_CAT("shader_generate", "gpu");
+    if (size < 2 || size > kMaxFFTShaderSize || (size & (size - 1)) != 0) {
+        throw std::invalid_argument("FFT shader size must be a power of two in [2, " +
+                                    std::to_string(kMaxFFTShaderSize) + "], got " + std::to_string(size));
+    }
+    int log2_size = 0;
+    while ((1 << log2_size) < size) ++log2_size;
+
+    // One butterflies() call per pass, each followed by a barrier
+    std::stringstream passes;
+    for (int pass = 0; pass < log2_size; ++pass) {
+        const int src = (pass % 2) * size;
+        passes << "    butterflies(" << (size >> pass) << "u, " << pass << "u, " << src << "u, " << size - src
+               << "u);\n"
+               << "    memoryBarrierShared();\n"
+               << "    barrier();\n";
+    }
+    std::stringstream scale;
+    scale.precision(10);
+    scale << std::showpoint << (inverse ? 1.0 / size : 1.0);
+
+    std::string shader = load_template("fft_template.glsl");
+    replace_all(shader, "{{FFT_SIZE}}", std::to_string(size));
+    replace_all(shader, "{{HALF_SIZE}}", std::to_string(size / 2));
+    replace_all(shader, "{{WORKGROUP_SIZE}}", std::to_string(std::min(size / 2, 128)));
+    replace_all(shader, "{{DIRECTION}}", inverse ? "1.0" : "-1.0");
+    replace_all(shader, "{{SCALE}}", scale.str());
+    replace_all(shader, "{{FFT_PASSES}}", passes.str());
+    replace_all(shader, "{{RESULT_OFFSET}}", std::to_string((log2_size % 2) * size));
+    return shader;
+}
+
+std::string ShaderGenerator::generate_packed_euler_shader(const std::vector<int>& rhs_ids, int workgroup_size) {
+    ODE_TRACE_SCOPE_CAT("shader_generate", "gpu");
+    std::stringstream functions, dispatch;
+    for (int id : rhs_ids) {
+        const BuiltinRHS& rhs = BuiltinRHSRegistry::get_rhs(id);
+        const std::string function = "evaluate_rhs_" + std::to_string(id);
+
+        // The table's snippet unchanged, between a rename and the member's
+        // parameter macros
+        functions << "// " << rhs.name << "\n#define evaluate_rhs " << function << "\n";
+        for (int k = 0; k < rhs.uniform_count; ++k) {
+            functions << "#define " << glsl_uniform_macro(rhs.uniform_names[k])
+                      << " member_params[member_param_base + " << k << "u]\n";
+        }
+        functions << rhs.glsl_code << "#undef evaluate_rhs\n";
+        for (int k = 0; k < rhs.uniform_count; ++k) {
+            functions << "#undef " << glsl_uniform_macro(rhs.uniform_names[k]) << "\n";
+        }
+        functions << "\n";
+
+        dispatch << "    case " << id << "u: dydt = " << function << "(eq_idx, y_current, t_current); break;\n";
+    }
+
+    std::string shader = load_template("packed_euler_template.glsl");
+    replace_all(shader, "{{WORKGROUP_SIZE}}", std::to_string(workgroup_size));
+    replace_all(shader, "{{RHS_FUNCTIONS}}", functions.str());
+    replace_all(shader, "{{RHS_DISPATCH}}", dispatch.str());
+    return shader;
 }
 
 std::string ShaderGenerator::load_template(const std::string& template_name) {
-    std::string full_path = template_path_ + template_name;
-    std::ifstream file(full_path);
-    
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open shader template: " + full_path);
+    ODE_TRACE_SCOPE_CAT("template_load", "gpu");
+    if (!override_dir_.empty()) {
+        std::ifstream file(override_dir_ + template_name);
+        if (file.is_open()) {
+            std::stringstream buffer;
+            buffer << file.rdbuf();
+            return buffer.str();
+        }
     }
-    
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+
+    std::string_view embedded = find_embedded_template(template_name);
+    if (embedded.empty()) {
+        throw std::runtime_error("Unknown shader template: " + template_name);
+    }
+    return std::string(embedded);
 }
 
-std::string ShaderGenerator::substitute_rhs(const std::string& template_code, 
-                                           const RHSDefinition& rhs) {
+std::string ShaderGenerator::substitute_rhs(const std::string& template_code, std::string_view glsl_code,
+                                            const std::vector<std::string_view>& uniform_names) {
     std::string result = template_code;
     
     // Generate uniform declarations
-    std::string uniform_decls = generate_uniform_declarations(rhs.uniform_names);
+    std::string uniform_decls = generate_uniform_declarations(uniform_names);
     
     // Replace template placeholders
     size_t pos = result.find("{{USER_UNIFORMS}}");
@@ -53,19 +166,19 @@ std::string ShaderGenerator::substitute_rhs(const std::string& template_code,
     
     pos = result.find("{{RHS_FUNCTION}}");
     if (pos != std::string::npos) {
-        result.replace(pos, 16, rhs.glsl_code);  // 16 = length of "{{RHS_FUNCTION}}"
+        result.replace(pos, 16, glsl_code.data(), glsl_code.size());  // 16 = length of "{{RHS_FUNCTION}}"
     }
     
     return result;
 }
 
-std::string ShaderGenerator::generate_uniform_declarations(const std::vector<std::string>& uniform_names) {
+std::string ShaderGenerator::generate_uniform_declarations(const std::vector<std::string_view>& uniform_names) {
     std::stringstream ss;
     ss << "    float user_uniforms[16];\n";
     
     // Add convenience accessors as macros
     for (size_t i = 0; i < uniform_names.size(); ++i) {
-        ss << "#define " << uniform_names[i] << " user_uniforms[" << i << "]\n";
+        ss << "#define " << glsl_uniform_macro(uniform_names[i]) << " user_uniforms[" << i << "]\n";
     }
     
     return ss.str();
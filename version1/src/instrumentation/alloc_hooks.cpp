@@ -0,0 +1,68 @@
+// Global operator new/delete replacements that feed AllocTracker.
+//
+// Link this file ONLY into executables that want allocation tracking
+// (tests and benchmarks). Every allocation in the process goes through
+// these hooks once linked, so keep them minimal: malloc + two counters.
+#include "../../include/alloc_tracker.h"
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+void* tracked_alloc(std::size_t size) {
+    if (size == 0) size = 1;
+    void* ptr = std::malloc(size);
+    if (!ptr) throw std::bad_alloc();
+    AllocTracker::record_allocation(size);
+    return ptr;
+}
+
+void* tracked_aligned_alloc(std::size_t size, std::align_val_t align) {
+    std::size_t alignment = static_cast<std::size_t>(align);
+    if (alignment < sizeof(void*)) alignment = sizeof(void*);
+    if (size == 0) size = 1;
+
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, alignment, size) != 0) throw std::bad_alloc();
+    AllocTracker::record_allocation(size);
+    return ptr;
+}
+
+void tracked_free(void* ptr) noexcept {
+    if (!ptr) return;
+    AllocTracker::record_deallocation();
+    std::free(ptr);
+}
+
+struct HooksRegistration {
+    HooksRegistration() { AllocTracker::mark_hooks_installed(); }
+};
+HooksRegistration registration;
+
+}  // namespace
+
+void* operator new(std::size_t size) { return tracked_alloc(size); }
+void* operator new[](std::size_t size) { return tracked_alloc(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return tracked_alloc(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return tracked_alloc(size); } catch (...) { return nullptr; }
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    return tracked_aligned_alloc(size, align);
+}
+void* operator new[](std::size_t size, std::align_val_t align) {
+    return tracked_aligned_alloc(size, align);
+}
+
+void operator delete(void* ptr) noexcept { tracked_free(ptr); }
+void operator delete[](void* ptr) noexcept { tracked_free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { tracked_free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { tracked_free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { tracked_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { tracked_free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { tracked_free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { tracked_free(ptr); }
@@ -0,0 +1,74 @@
+#include "../../include/alloc_tracker.h"
+#include <atomic>
+
+namespace {
+
+// Plain POD so that thread_local access never needs a constructor call
+// (the hooks run before and during static initialization).
+struct ThreadCounters {
+    std::uint64_t allocations;
+    std::uint64_t deallocations;
+    std::uint64_t bytes_allocated;
+};
+
+thread_local ThreadCounters tls_counters = {0, 0, 0};
+
+std::atomic<std::uint64_t> g_allocations{0};
+std::atomic<std::uint64_t> g_deallocations{0};
+std::atomic<std::uint64_t> g_bytes_allocated{0};
+std::atomic<bool> g_hooks_installed{false};
+
+}  // namespace
+
+bool AllocTracker::hooks_installed() {
+    return g_hooks_installed.load(std::memory_order_relaxed);
+}
+
+AllocStats AllocTracker::thread_stats() {
+    AllocStats stats;
+    stats.allocations = tls_counters.allocations;
+    stats.deallocations = tls_counters.deallocations;
+    stats.bytes_allocated = tls_counters.bytes_allocated;
+    return stats;
+}
+
+AllocStats AllocTracker::global_stats() {
+    AllocStats stats;
+    stats.allocations = g_allocations.load(std::memory_order_relaxed);
+    stats.deallocations = g_deallocations.load(std::memory_order_relaxed);
+    stats.bytes_allocated = g_bytes_allocated.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AllocTracker::record_allocation(std::size_t bytes) {
+    tls_counters.allocations++;
+    tls_counters.bytes_allocated += bytes;
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void AllocTracker::record_deallocation() {
+    tls_counters.deallocations++;
+    g_deallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AllocTracker::mark_hooks_installed() {
+    g_hooks_installed.store(true, std::memory_order_relaxed);
+}
+
+AllocRegion::AllocRegion(const char* name) : name_(name) {
+    reset();
+}
+
+AllocStats AllocRegion::stats() const {
+    AllocStats now = AllocTracker::thread_stats();
+    AllocStats delta;
+    delta.allocations = now.allocations - start_.allocations;
+    delta.deallocations = now.deallocations - start_.deallocations;
+    delta.bytes_allocated = now.bytes_allocated - start_.bytes_allocated;
+    return delta;
+}
+
+void AllocRegion::reset() {
+    start_ = AllocTracker::thread_stats();
+}
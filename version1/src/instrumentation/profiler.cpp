@@ -0,0 +1,330 @@
+#include "../../include/profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <pthread.h>
+#include <time.h>
+
+// ---------------------------------------------------------------------------
+// ProfileClock
+// ---------------------------------------------------------------------------
+
+#if defined(__aarch64__)
+namespace {
+std::uint64_t read_cntvct() {
+    std::uint64_t ticks;
+    asm volatile("isb; mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+}
+
+std::uint64_t read_cntfrq() {
+    std::uint64_t freq;
+    asm volatile("mrs %0, cntfrq_el0" : "=r"(freq));
+    return freq;
+}
+}  // namespace
+
+std::uint64_t ProfileClock::now_ns() {
+    static const std::uint64_t freq = read_cntfrq();
+    std::uint64_t ticks = read_cntvct();
+    // Split to avoid overflowing ticks * 1e9 on long uptimes
+    return (ticks / freq) * 1000000000ull + (ticks % freq) * 1000000000ull / freq;
+}
+
+const char* ProfileClock::source() { return "cntvct"; }
+#else
+std::uint64_t ProfileClock::now_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ull +
+           static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+const char* ProfileClock::source() { return "monotonic_raw"; }
+#endif
+
+// ---------------------------------------------------------------------------
+// LatencyHistogram
+// ---------------------------------------------------------------------------
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+int LatencyHistogram::bucket_index(std::uint64_t value) {
+    if (value < static_cast<std::uint64_t>(kSubBuckets)) {
+        return static_cast<int>(value);  // Group 0 is exact
+    }
+    int exponent = 63 - __builtin_clzll(value);
+    if (exponent > kMaxExponent) {
+        return kBucketCount - 1;
+    }
+    int group = exponent - kSubBucketBits + 1;
+    int sub = static_cast<int>((value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1));
+    return group * kSubBuckets + sub;
+}
+
+std::uint64_t LatencyHistogram::bucket_upper_value(int index) {
+    int group = index / kSubBuckets;
+    int sub = index % kSubBuckets;
+    if (group == 0) {
+        return static_cast<std::uint64_t>(sub);
+    }
+    int shift = group - 1;
+    return ((static_cast<std::uint64_t>(kSubBuckets + sub + 1)) << shift) - 1;
+}
+
+void LatencyHistogram::record(std::uint64_t value_ns) {
+    counts_[bucket_index(value_ns)]++;
+    if (count_ == 0 || value_ns < min_ns_) min_ns_ = value_ns;
+    if (value_ns > max_ns_) max_ns_ = value_ns;
+    count_++;
+    total_ns_ += value_ns;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.count_ == 0) return;
+    for (int i = 0; i < kBucketCount; ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    if (count_ == 0 || other.min_ns_ < min_ns_) min_ns_ = other.min_ns_;
+    max_ns_ = std::max(max_ns_, other.max_ns_);
+    count_ += other.count_;
+    total_ns_ += other.total_ns_;
+}
+
+void LatencyHistogram::reset() {
+    std::memset(counts_, 0, sizeof(counts_));
+    count_ = 0;
+    total_ns_ = 0;
+    min_ns_ = 0;
+    max_ns_ = 0;
+}
+
+std::uint64_t LatencyHistogram::percentile_ns(double p) const {
+    if (count_ == 0) return 0;
+    p = std::min(100.0, std::max(0.0, p));
+
+    std::uint64_t target = static_cast<std::uint64_t>(std::ceil(p / 100.0 * count_));
+    if (target == 0) target = 1;
+
+    std::uint64_t seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        seen += counts_[i];
+        if (seen >= target) {
+            // Bucket bounds are approximate; the exact extremes are known
+            return std::min(std::max(bucket_upper_value(i), min_ns_), max_ns_);
+        }
+    }
+    return max_ns_;
+}
+
+// ---------------------------------------------------------------------------
+// Profiler call tree
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct ProfileNode {
+    const char* name;
+    int parent;
+    std::vector<int> children;
+    LatencyHistogram histogram;
+};
+
+struct ThreadProfile {
+    std::vector<std::unique_ptr<ProfileNode>> nodes;
+    int current = 0;
+
+    ThreadProfile() {
+        auto root = std::make_unique<ProfileNode>();
+        root->name = "";
+        root->parent = -1;
+        nodes.push_back(std::move(root));
+    }
+};
+
+std::mutex g_profile_mutex;
+
+// As the trace registry: held across fork() so children inherit it unlocked
+[[maybe_unused]] const int g_profile_atfork = pthread_atfork(
+    [] { g_profile_mutex.lock(); }, [] { g_profile_mutex.unlock(); }, [] { g_profile_mutex.unlock(); });
+
+std::vector<std::unique_ptr<ThreadProfile>>& thread_profiles() {
+    static std::vector<std::unique_ptr<ThreadProfile>> profiles;
+    return profiles;
+}
+
+ThreadProfile& thread_profile() {
+    thread_local ThreadProfile* profile = nullptr;
+    if (!profile) {
+        auto owned = std::make_unique<ThreadProfile>();
+        std::lock_guard<std::mutex> lock(g_profile_mutex);
+        profile = owned.get();
+        thread_profiles().push_back(std::move(owned));
+    }
+    return *profile;
+}
+
+bool same_name(const char* a, const char* b) {
+    return a == b || std::strcmp(a, b) == 0;
+}
+
+// Thread trees merged by call path
+struct MergedNode {
+    const char* name;
+    std::vector<std::unique_ptr<MergedNode>> children;
+    LatencyHistogram histogram;
+};
+
+void merge_into(MergedNode& target, const ThreadProfile& profile, int node_index) {
+    const ProfileNode& node = *profile.nodes[node_index];
+    target.histogram.merge(node.histogram);
+
+    for (int child_index : node.children) {
+        const char* child_name = profile.nodes[child_index]->name;
+        MergedNode* merged_child = nullptr;
+        for (auto& existing : target.children) {
+            if (same_name(existing->name, child_name)) {
+                merged_child = existing.get();
+                break;
+            }
+        }
+        if (!merged_child) {
+            target.children.push_back(std::make_unique<MergedNode>());
+            merged_child = target.children.back().get();
+            merged_child->name = child_name;
+        }
+        merge_into(*merged_child, profile, child_index);
+    }
+}
+
+std::unique_ptr<MergedNode> merge_all_threads() {
+    auto root = std::make_unique<MergedNode>();
+    root->name = "";
+    std::lock_guard<std::mutex> lock(g_profile_mutex);
+    for (const auto& profile : thread_profiles()) {
+        merge_into(*root, *profile, 0);
+    }
+    return root;
+}
+
+void flatten(const MergedNode& node, const std::string& parent_path, int depth,
+             std::vector<ProfileReportEntry>& out) {
+    for (const auto& child : node.children) {
+        std::string path = parent_path.empty() ? child->name : parent_path + "/" + child->name;
+        const LatencyHistogram& h = child->histogram;
+        out.push_back({path, depth, h.count(), h.total_ns(), h.mean_ns(),
+                       h.percentile_ns(50.0), h.percentile_ns(99.0), h.max_ns()});
+        flatten(*child, path, depth + 1, out);
+    }
+}
+
+}  // namespace
+
+Profiler& Profiler::instance() {
+    static Profiler instance;
+    return instance;
+}
+
+int Profiler::enter(const char* name) {
+    ThreadProfile& profile = thread_profile();
+    ProfileNode& current = *profile.nodes[profile.current];
+
+    for (int child : current.children) {
+        if (same_name(profile.nodes[child]->name, name)) {
+            profile.current = child;
+            return child;
+        }
+    }
+
+    // First visit of this call path: create its node
+    int index = static_cast<int>(profile.nodes.size());
+    auto node = std::make_unique<ProfileNode>();
+    node->name = name;
+    node->parent = profile.current;
+    {
+        // Reports walk the node list, so growth must not race with them
+        std::lock_guard<std::mutex> lock(g_profile_mutex);
+        profile.nodes.push_back(std::move(node));
+        profile.nodes[profile.current]->children.push_back(index);
+    }
+    profile.current = index;
+    return index;
+}
+
+void Profiler::exit(int node, std::uint64_t elapsed_ns) {
+    ThreadProfile& profile = thread_profile();
+    ProfileNode& entry = *profile.nodes[node];
+    entry.histogram.record(elapsed_ns);
+    profile.current = entry.parent;
+}
+
+std::vector<ProfileReportEntry> Profiler::report() const {
+    auto root = merge_all_threads();
+    std::vector<ProfileReportEntry> entries;
+    flatten(*root, "", 0, entries);
+    return entries;
+}
+
+LatencyHistogram Profiler::histogram(const std::string& path) const {
+    auto root = merge_all_threads();
+    const MergedNode* node = root.get();
+
+    size_t start = 0;
+    while (node && start <= path.size()) {
+        size_t end = path.find('/', start);
+        std::string part = path.substr(start, end == std::string::npos ? std::string::npos : end - start);
+
+        const MergedNode* next = nullptr;
+        for (const auto& child : node->children) {
+            if (part == child->name) {
+                next = child.get();
+                break;
+            }
+        }
+        node = next;
+        if (end == std::string::npos) break;
+        start = end + 1;
+    }
+    return node ? node->histogram : LatencyHistogram();
+}
+
+void Profiler::reset() {
+    std::lock_guard<std::mutex> lock(g_profile_mutex);
+    for (auto& profile : thread_profiles()) {
+        for (auto& node : profile->nodes) {
+            node->histogram.reset();
+        }
+    }
+}
+
+void Profiler::print_report(std::ostream& out) const {
+    auto entries = report();
+    std::ios state(nullptr);
+    state.copyfmt(out);
+
+    out << "Profile (clock: " << ProfileClock::source() << ", times in us)" << std::endl;
+    out << std::left << std::setw(36) << "scope" << std::right
+        << std::setw(10) << "count" << std::setw(14) << "total"
+        << std::setw(12) << "mean" << std::setw(12) << "p50"
+        << std::setw(12) << "p99" << std::setw(12) << "max" << std::endl;
+
+    out << std::fixed << std::setprecision(2);
+    for (const auto& e : entries) {
+        if (e.count == 0) continue;  // Paths not hit since the last reset()
+        std::string label = std::string(e.depth * 2, ' ') + e.path.substr(e.path.rfind('/') + 1);
+        out << std::left << std::setw(36) << label << std::right
+            << std::setw(10) << e.count
+            << std::setw(14) << e.total_ns / 1000.0
+            << std::setw(12) << e.mean_ns / 1000.0
+            << std::setw(12) << e.p50_ns / 1000.0
+            << std::setw(12) << e.p99_ns / 1000.0
+            << std::setw(12) << e.max_ns / 1000.0 << std::endl;
+    }
+    out.copyfmt(state);
+}
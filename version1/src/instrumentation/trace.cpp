@@ -0,0 +1,167 @@
+#include "../../include/trace.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <pthread.h>
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    std::uint64_t start_ns;
+    std::uint64_t duration_ns;
+};
+
+// Single-writer buffer owned by one thread. The owner publishes each event
+// with a release store of `count`; readers only look at [0, count).
+struct ThreadTraceBuffer {
+    static constexpr std::size_t kCapacity = 1 << 16;
+
+    int tid = 0;
+    const char* thread_name = nullptr;
+    std::atomic<std::size_t> count{0};
+    std::atomic<std::uint64_t> dropped{0};
+    std::unique_ptr<TraceEvent[]> events{new TraceEvent[kCapacity]};
+};
+
+// Buffers are never freed before exit so that spans from finished worker
+// threads can still be dumped.
+std::mutex g_registry_mutex;
+
+// Held across fork(), so a child (ShardedEnsemble worker) never inherits it
+// locked by a parent thread that does not exist there
+[[maybe_unused]] const int g_registry_atfork = pthread_atfork(
+    [] { g_registry_mutex.lock(); }, [] { g_registry_mutex.unlock(); }, [] { g_registry_mutex.unlock(); });
+
+std::vector<std::unique_ptr<ThreadTraceBuffer>>& registry() {
+    static std::vector<std::unique_ptr<ThreadTraceBuffer>> buffers;
+    return buffers;
+}
+
+ThreadTraceBuffer& thread_buffer() {
+    thread_local ThreadTraceBuffer* buffer = nullptr;
+    if (!buffer) {
+        auto owned = std::make_unique<ThreadTraceBuffer>();
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        owned->tid = static_cast<int>(registry().size()) + 1;
+        buffer = owned.get();
+        registry().push_back(std::move(owned));
+    }
+    return *buffer;
+}
+
+void write_json_string(std::ofstream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') out << '\\';
+        out << *c;
+    }
+    out << '"';
+}
+
+}  // namespace
+
+TraceRecorder& TraceRecorder::instance() {
+    static TraceRecorder instance;
+    return instance;
+}
+
+std::uint64_t TraceRecorder::now_ns() {
+    static const auto epoch = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::steady_clock::now() - epoch;
+    // +1 keeps a valid timestamp from ever being 0 (TraceScope's "off" marker)
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) + 1;
+}
+
+void TraceRecorder::record(const char* name, const char* category,
+                           std::uint64_t start_ns, std::uint64_t end_ns) {
+    ThreadTraceBuffer& buffer = thread_buffer();
+    std::size_t index = buffer.count.load(std::memory_order_relaxed);
+    if (index >= ThreadTraceBuffer::kCapacity) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    TraceEvent& event = buffer.events[index];
+    event.name = name;
+    event.category = category;
+    event.start_ns = start_ns;
+    event.duration_ns = end_ns - start_ns;
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+void TraceRecorder::set_thread_name(const char* name) {
+    thread_buffer().thread_name = name;
+}
+
+bool TraceRecorder::dump_chrome_json(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    bool first = true;
+    for (const auto& buffer : registry()) {
+        if (buffer->thread_name) {
+            out << (first ? "\n" : ",\n");
+            first = false;
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"args\":{\"name\":";
+            write_json_string(out, buffer->thread_name);
+            out << "}}";
+        }
+
+        std::size_t count = buffer->count.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < count; ++i) {
+            const TraceEvent& event = buffer->events[i];
+            out << (first ? "\n" : ",\n");
+            first = false;
+            out << "{\"name\":";
+            write_json_string(out, event.name);
+            out << ",\"cat\":";
+            write_json_string(out, event.category);
+            // Chrome expects microseconds; keep the nanosecond fraction
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"ts\":" << event.start_ns / 1000.0
+                << ",\"dur\":" << event.duration_ns / 1000.0 << "}";
+        }
+    }
+
+    out << "\n]}\n";
+    return out.good();
+}
+
+void TraceRecorder::clear() {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    for (auto& buffer : registry()) {
+        buffer->count.store(0, std::memory_order_release);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::uint64_t TraceRecorder::event_count() const {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    std::uint64_t total = 0;
+    for (const auto& buffer : registry()) {
+        total += buffer->count.load(std::memory_order_acquire);
+    }
+    return total;
+}
+
+std::uint64_t TraceRecorder::dropped_count() const {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    std::uint64_t total = 0;
+    for (const auto& buffer : registry()) {
+        total += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
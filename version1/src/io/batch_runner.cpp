@@ -0,0 +1,199 @@
+#include "../../include/batch_runner.h"
+#include "../../include/trace.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+
+// Buffered records reach the disk at least this often; a crash loses at
+// most these, and resume reruns them
+constexpr std::uint64_t kFlushEvery = 64;
+
+}  // namespace
+
+BatchRunner::BatchRunner(const JobSpec& spec, const BatchOptions& options,
+                         const CostCalibration& calibration)
+    : spec_(spec), options_(options), calibration_(calibration) {}
+
+BatchStats BatchRunner::run() {
+    ODE_TRACE_SCOPE_CAT("batch_run", "batch");
+    const auto started = std::chrono::steady_clock::now();
+
+    BatchStats stats;
+    stats.total = spec_.size();
+
+    TrajectoryFileInfo info;
+    info.fingerprint = spec_.fingerprint();
+    info.total_jobs = stats.total;
+    info.dimension = static_cast<std::uint32_t>(spec_.dimension());
+    info.final_only = spec_.final_only();
+
+    const std::string& path = spec_.output_path();
+    TrajectoryWriter writer;
+    std::vector<std::uint64_t> completed;
+    if (!options_.fresh && std::filesystem::exists(path)) {
+        if (!writer.resume(path, info, completed)) {
+            throw std::runtime_error("Cannot resume " + path + " (start over with fresh)");
+        }
+    } else if (!writer.create(path, info)) {
+        throw std::runtime_error("Cannot create " + path);
+    }
+    std::sort(completed.begin(), completed.end());
+    completed.erase(std::unique(completed.begin(), completed.end()), completed.end());
+    stats.skipped = completed.size();
+
+    const int workers = options_.cpu_workers > 0 ? options_.cpu_workers : ThreadPool::hardware_threads();
+    const size_t max_in_flight = options_.max_in_flight > 0 ? options_.max_in_flight
+                                                            : static_cast<size_t>(4 * workers);
+    SolveService service(workers, calibration_);
+    // Created on the first coalesced job; destroyed before its pool
+    std::unique_ptr<ThreadPool> batch_pool;
+    std::unique_ptr<RequestCoalescer> coalescer;
+
+    if (options_.verbose) {
+        std::cout << "Sweep of " << stats.total << " jobs -> " << path;
+        if (stats.skipped) std::cout << " (" << stats.skipped << " already done)";
+        std::cout << std::endl;
+    }
+
+    std::deque<Pending> in_flight;
+    std::uint64_t next_report = stats.total / 10;
+
+    auto ready = [](const Pending& pending) {
+        return pending.batched.valid()
+            ? pending.batched.wait_for(std::chrono::seconds(0)) == std::future_status::ready
+            : pending.handle.ready();
+    };
+
+    // Writes every finished job; with `block`, waits for at least one first
+    auto drain = [&](bool block) {
+        bool wrote = false;
+        for (auto it = in_flight.begin(); it != in_flight.end();) {
+            if (ready(*it)) {
+                write_result(*it, writer, stats);
+                it = in_flight.erase(it);
+                wrote = true;
+            } else {
+                ++it;
+            }
+        }
+        if (block && !wrote && !in_flight.empty()) {
+            if (in_flight.front().batched.valid()) {
+                in_flight.front().batched.wait();
+            } else {
+                in_flight.front().handle.wait();
+            }
+            write_result(in_flight.front(), writer, stats);
+            in_flight.pop_front();
+        }
+
+        const std::uint64_t done = stats.completed + stats.failed;
+        if (options_.verbose && next_report > 0 && done >= next_report) {
+            std::cout << "  " << done + stats.skipped << " / " << stats.total << std::endl;
+            next_report = done + stats.total / 10;
+        }
+    };
+
+    auto done_it = completed.begin();
+    for (std::uint64_t index = 0; index < stats.total; ++index) {
+        if (done_it != completed.end() && *done_it == index) {
+            ++done_it;
+            continue;
+        }
+
+        Pending pending;
+        pending.job = spec_.job(index);
+        SolveOptions solve;
+        solve.t0 = pending.job.t0;
+        solve.tf = pending.job.tf;
+        solve.dt = pending.job.dt;
+        solve.y0 = pending.job.y0;
+        solve.method = pending.job.method;
+        solve.backend = pending.job.backend;
+        try {
+            ODESystem system = spec_.system_for(pending.job);
+            if (spec_.final_only() && system.rhs_interpreted && solve.backend != "gpu") {
+                if (!coalescer) {
+                    batch_pool = std::make_unique<ThreadPool>(workers);
+                    coalescer = std::make_unique<RequestCoalescer>(*batch_pool, calibration_);
+                }
+                pending.batched = coalescer->submit(system, solve.method, solve.t0, solve.tf, solve.dt, solve.y0);
+            } else {
+                pending.handle = service.submit(system, solve);
+            }
+        } catch (const std::exception& e) {
+            // Rejected up front (e.g. rk45 on the gpu backend)
+            if (options_.verbose) {
+                std::cerr << "Job " << JobSpec::describe(pending.job) << " rejected: " << e.what() << std::endl;
+            }
+            stats.failed++;
+            continue;
+        }
+        in_flight.push_back(std::move(pending));
+
+        while (in_flight.size() >= max_in_flight) {
+            drain(true);
+        }
+    }
+    while (!in_flight.empty()) {
+        drain(true);
+    }
+
+    writer.flush();
+    writer.close();
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return stats;
+}
+
+bool BatchRunner::write_result(Pending& pending, TrajectoryWriter& writer, BatchStats& stats) {
+    const JobInstance& job = pending.job;
+    const bool batched = pending.batched.valid();
+    SolveResult result;
+    try {
+        if (batched) {
+            result.solution.push_back(pending.batched.get().final_state);
+        } else {
+            result = pending.handle.get();
+        }
+    } catch (const std::exception& e) {
+        if (options_.verbose) {
+            std::cerr << "Job " << JobSpec::describe(job) << " failed: " << e.what() << std::endl;
+        }
+        stats.failed++;
+        return false;
+    }
+    if (result.solution.empty()) {
+        // Backends report some failures (no GPU context, ...) as an empty solution
+        if (options_.verbose) {
+            std::cerr << "Job " << JobSpec::describe(job) << " failed: no solution" << std::endl;
+        }
+        stats.failed++;
+        return false;
+    }
+
+    bool written;
+    if (spec_.final_only()) {
+        // A coalesced result is the final row alone
+        const double steps = batched ? static_cast<double>(static_cast<int>((job.tf - job.t0) / job.dt))
+                                     : static_cast<double>(result.solution.size() - 1);
+        const double t_final = job.t0 + steps * job.dt;
+        written = writer.append(job.index, t_final, job.dt, {result.solution.back()});
+    } else {
+        written = writer.append(job.index, job.t0, job.dt, result.solution);
+    }
+    if (!written) {
+        throw std::runtime_error("Cannot write to " + spec_.output_path());
+    }
+
+    stats.completed++;
+    if (batched) stats.coalesced++;
+    if (stats.completed % kFlushEvery == 0) {
+        writer.flush();
+    }
+    return true;
+}
@@ -0,0 +1,412 @@
+#include "../../include/ensemble_stream.h"
+#include "../../include/bounded_queue.h"
+#include "../../include/trace.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+constexpr char kInputMagic[8] = {'O', 'D', 'E', 'E', 'N', 'S', 'I', '1'};
+constexpr char kOutputMagic[8] = {'O', 'D', 'E', 'E', 'N', 'S', 'O', '1'};
+constexpr std::uint32_t kVersion = 1;
+
+struct EnsembleFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t dimension;     // Input: state size; output: width
+    std::uint32_t n_params;      // Input only
+    std::uint32_t reserved;
+    std::uint64_t members;
+    double t0, tf, dt;           // Output only
+    std::uint64_t padding;
+};
+static_assert(sizeof(EnsembleFileHeader) == 64, "EnsembleFileHeader is part of the file format");
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+bool pwrite_full(int fd, const void* data, size_t bytes, off_t offset) {
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t n = ::pwrite(fd, p, bytes, offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        bytes -= static_cast<size_t>(n);
+        offset += n;
+    }
+    return true;
+}
+
+// Owns a file descriptor for the length of one run
+class FileHandle {
+public:
+    explicit FileHandle(int fd) : fd_(fd) {}
+    ~FileHandle() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+    int get() const { return fd_; }
+
+    FileHandle(const FileHandle&) = delete;
+    FileHandle& operator=(const FileHandle&) = delete;
+
+private:
+    int fd_;
+};
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Files
+// ---------------------------------------------------------------------------
+
+bool EnsembleInputWriter::create(const std::string& path, std::uint32_t dimension, std::uint32_t n_params) {
+    out_.open(path, std::ios::binary | std::ios::trunc);
+    if (!out_.is_open() || dimension == 0) {
+        std::cerr << "EnsembleInputWriter: cannot write " << path << std::endl;
+        return false;
+    }
+    info_ = EnsembleInputInfo{dimension, n_params, 0};
+    EnsembleFileHeader header{};
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));  // Filled in by close()
+    return static_cast<bool>(out_);
+}
+
+bool EnsembleInputWriter::append(const double* y0, const double* params) {
+    out_.write(reinterpret_cast<const char*>(y0), info_.dimension * sizeof(double));
+    if (info_.n_params > 0) {
+        out_.write(reinterpret_cast<const char*>(params), info_.n_params * sizeof(double));
+    }
+    info_.members++;
+    return static_cast<bool>(out_);
+}
+
+bool EnsembleInputWriter::close() {
+    if (!out_.is_open()) {
+        return false;
+    }
+    EnsembleFileHeader header{};
+    std::memcpy(header.magic, kInputMagic, sizeof(kInputMagic));
+    header.version = kVersion;
+    header.dimension = info_.dimension;
+    header.n_params = info_.n_params;
+    header.members = info_.members;
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    const bool ok = static_cast<bool>(out_);
+    out_.close();
+    return ok;
+}
+
+EnsembleResultFile::~EnsembleResultFile() {
+    if (mapping_) {
+        ::munmap(mapping_, mapped_bytes_);
+    }
+}
+
+bool EnsembleResultFile::open(const std::string& path) {
+    FileHandle file(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    struct stat st{};
+    if (file.get() < 0 || ::fstat(file.get(), &st) != 0 ||
+        static_cast<size_t>(st.st_size) < sizeof(EnsembleFileHeader)) {
+        std::cerr << "EnsembleResultFile: cannot open " << path << std::endl;
+        return false;
+    }
+
+    void* mapping = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, file.get(), 0);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "EnsembleResultFile: cannot map " << path << std::endl;
+        return false;
+    }
+    const auto* header = static_cast<const EnsembleFileHeader*>(mapping);
+    const std::uint64_t expected = sizeof(EnsembleFileHeader) + header->members * header->dimension * sizeof(double);
+    if (std::memcmp(header->magic, kOutputMagic, sizeof(kOutputMagic)) != 0 ||
+        header->version != kVersion || expected != static_cast<std::uint64_t>(st.st_size)) {
+        std::cerr << "EnsembleResultFile: " << path << " is not a complete result file" << std::endl;
+        ::munmap(mapping, st.st_size);
+        return false;
+    }
+
+    mapping_ = mapping;
+    mapped_bytes_ = st.st_size;
+    members_ = header->members;
+    width_ = header->dimension;
+    data_ = reinterpret_cast<const double*>(static_cast<const char*>(mapping) + sizeof(EnsembleFileHeader));
+    return true;
+}
+
+bool StreamingEnsemble::read_input_info(const std::string& path, EnsembleInputInfo& info) {
+    std::ifstream in(path, std::ios::binary);
+    EnsembleFileHeader header{};
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, kInputMagic, sizeof(kInputMagic)) != 0 ||
+        header.version != kVersion) {
+        return false;
+    }
+    info.dimension = header.dimension;
+    info.n_params = header.n_params;
+    info.members = header.members;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Pipeline
+// ---------------------------------------------------------------------------
+
+StreamingEnsemble::StreamingEnsemble(EnsembleSolverBase& solver, const StreamOptions& options)
+    : solver_(solver), options_(options) {
+    options_.chunk_members = std::max(1, options_.chunk_members);
+    options_.queue_depth = std::max(1, options_.queue_depth);
+    if (options_.output_width > 0 && !options_.reduce) {
+        throw std::invalid_argument("StreamOptions: output_width needs a reduce function");
+    }
+}
+
+StreamStats StreamingEnsemble::run(const ODESystem& system, const std::string& input_path,
+                                   const std::string& output_path, double t0, double tf, double dt) {
+    return run_pipeline(&system, nullptr, input_path, output_path, t0, tf, dt);
+}
+
+StreamStats StreamingEnsemble::run(const EnsembleSystemFactory& factory, const std::string& input_path,
+                                   const std::string& output_path, double t0, double tf, double dt) {
+    return run_pipeline(nullptr, &factory, input_path, output_path, t0, tf, dt);
+}
+
+StreamStats StreamingEnsemble::run_pipeline(const ODESystem* system, const EnsembleSystemFactory* factory,
+                                            const std::string& input_path, const std::string& output_path,
+                                            double t0, double tf, double dt) {
+    ODE_TRACE_SCOPE_CAT("stream_ensemble", "stream");
+    const Clock::time_point started = Clock::now();
+
+    EnsembleInputInfo info;
+    if (!read_input_info(input_path, info)) {
+        throw std::runtime_error("Not an ensemble input file: " + input_path);
+    }
+    if (system && (info.n_params != 0 || static_cast<int>(info.dimension) != system->dimension)) {
+        throw std::invalid_argument("Input file does not match the system (dimension or parameters)");
+    }
+    if (factory && info.n_params == 0) {
+        throw std::invalid_argument("Input file has no parameters for the system factory");
+    }
+
+    const size_t record_doubles = info.dimension + info.n_params;
+    const std::uint64_t record_bytes = record_doubles * sizeof(double);
+    const std::uint32_t width = options_.output_width > 0 ? options_.output_width : info.dimension;
+
+    FileHandle input(::open(input_path.c_str(), O_RDONLY | O_CLOEXEC));
+    struct stat st{};
+    if (input.get() < 0 || ::fstat(input.get(), &st) != 0 ||
+        static_cast<std::uint64_t>(st.st_size) < sizeof(EnsembleFileHeader) + info.members * record_bytes) {
+        throw std::runtime_error("Ensemble input is truncated: " + input_path);
+    }
+
+    // Preallocated (sparse) output: chunks land in their slots in any order
+    FileHandle output(::open(output_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+    EnsembleFileHeader out_header{};
+    std::memcpy(out_header.magic, kOutputMagic, sizeof(kOutputMagic));
+    out_header.version = kVersion;
+    out_header.dimension = width;
+    out_header.members = info.members;
+    out_header.t0 = t0;
+    out_header.tf = tf;
+    out_header.dt = dt;
+    if (output.get() < 0 ||
+        ::ftruncate(output.get(), sizeof(out_header) + info.members * width * sizeof(double)) != 0 ||
+        !pwrite_full(output.get(), &out_header, sizeof(out_header), 0)) {
+        throw std::runtime_error("Cannot create ensemble output: " + output_path);
+    }
+
+    StreamStats stats;
+    stats.members = info.members;
+
+    // The whole working set, allocated once
+    const int chunk_members = options_.chunk_members;
+    const int depth = options_.queue_depth;
+    std::vector<Chunk> chunks(2 * depth + 3);
+    for (Chunk& chunk : chunks) {
+        if (info.n_params > 0) chunk.records.reserve(static_cast<size_t>(chunk_members) * record_doubles);
+        chunk.y0.reserve(static_cast<size_t>(chunk_members) * info.dimension);
+        chunk.final_states.reserve(static_cast<size_t>(chunk_members) * info.dimension);
+        if (options_.output_width > 0) chunk.output.reserve(static_cast<size_t>(chunk_members) * width);
+        stats.buffer_bytes += (chunk.records.capacity() + chunk.y0.capacity() +
+                               chunk.final_states.capacity() + chunk.output.capacity()) * sizeof(double);
+    }
+
+    BoundedQueue<Chunk*> free_chunks(chunks.size());
+    BoundedQueue<Chunk*> to_solve(depth);
+    BoundedQueue<Chunk*> to_write(depth);
+    for (Chunk& chunk : chunks) {
+        free_chunks.push(&chunk);
+    }
+
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto fail = [&](std::exception_ptr e) {
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = e;
+        }
+        free_chunks.close();
+        to_solve.close();
+        to_write.close();
+    };
+
+    std::thread reader([&]() {
+        ODE_TRACE_THREAD_NAME("stream_reader");
+        const long page = ::sysconf(_SC_PAGESIZE);
+        try {
+            for (std::uint64_t begin = 0; begin < info.members; begin += chunk_members) {
+                Chunk* chunk = nullptr;
+                if (!free_chunks.pop(chunk)) break;
+                const Clock::time_point t = Clock::now();
+                ODE_TRACE_SCOPE_CAT("read_chunk", "stream");
+
+                chunk->begin = begin;
+                chunk->count = static_cast<int>(std::min<std::uint64_t>(chunk_members, info.members - begin));
+                const off_t offset = sizeof(EnsembleFileHeader) + begin * record_bytes;
+                const off_t aligned = offset - offset % page;
+                const size_t length = static_cast<size_t>(offset - aligned) + chunk->count * record_bytes;
+
+                void* window = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, input.get(), aligned);
+                if (window == MAP_FAILED) {
+                    throw std::runtime_error("Cannot map ensemble input: " + input_path);
+                }
+                ::madvise(window, length, MADV_SEQUENTIAL);
+                const double* records = reinterpret_cast<const double*>(
+                    static_cast<const char*>(window) + (offset - aligned));
+                // Without parameters the records are the states themselves
+                std::vector<double>& target = info.n_params > 0 ? chunk->records : chunk->y0;
+                target.assign(records, records + chunk->count * record_doubles);
+                ::munmap(window, length);
+
+                stats.read_seconds += seconds_since(t);
+                if (!to_solve.push(chunk)) break;
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+        to_solve.close();
+    });
+
+    std::thread writer([&]() {
+        ODE_TRACE_THREAD_NAME("stream_writer");
+        try {
+            Chunk* chunk = nullptr;
+            while (to_write.pop(chunk)) {
+                const Clock::time_point t = Clock::now();
+                ODE_TRACE_SCOPE_CAT("write_chunk", "stream");
+
+                const std::vector<double>* values = &chunk->final_states;
+                if (options_.output_width > 0) {
+                    chunk->output.resize(static_cast<size_t>(chunk->count) * width);
+                    for (int m = 0; m < chunk->count; ++m) {
+                        options_.reduce(chunk->final_states.data() + static_cast<size_t>(m) * info.dimension,
+                                        chunk->output.data() + static_cast<size_t>(m) * width);
+                    }
+                    values = &chunk->output;
+                }
+                const off_t offset = sizeof(EnsembleFileHeader) + chunk->begin * width * sizeof(double);
+                if (!pwrite_full(output.get(), values->data(), values->size() * sizeof(double), offset)) {
+                    throw std::runtime_error("Cannot write ensemble output: " + output_path);
+                }
+
+                stats.write_seconds += seconds_since(t);
+                stats.chunks++;
+                if (!free_chunks.push(chunk)) break;
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    });
+
+    // Solver stage on the calling thread
+    try {
+        Chunk* chunk = nullptr;
+        while (to_solve.pop(chunk)) {
+            const Clock::time_point t = Clock::now();
+            solve_chunk(*chunk, info, system, factory, t0, tf, dt, stats);
+            stats.solve_seconds += seconds_since(t);
+            if (!to_write.push(chunk)) break;
+        }
+    } catch (...) {
+        fail(std::current_exception());
+    }
+    to_write.close();
+
+    reader.join();
+    writer.join();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    stats.wall_seconds = seconds_since(started);
+    return stats;
+}
+
+void StreamingEnsemble::solve_chunk(Chunk& chunk, const EnsembleInputInfo& info, const ODESystem* system,
+                                    const EnsembleSystemFactory* factory, double t0, double tf, double dt,
+                                    StreamStats& stats) {
+    ODE_TRACE_SCOPE_CAT("solve_chunk", "stream");
+    const int dim = static_cast<int>(info.dimension);
+
+    if (system) {
+        solver_.solve_ensemble(*system, t0, tf, dt, chunk.y0, chunk.count, chunk.final_states);
+        stats.sub_ensembles++;
+        return;
+    }
+
+    // Group members with equal parameter vectors into one ensemble call each
+    const int n_params = static_cast<int>(info.n_params);
+    const size_t stride = dim + n_params;
+    auto params_of = [&](int m) { return chunk.records.data() + m * stride + dim; };
+    auto less = [&](int a, int b) {
+        return std::lexicographical_compare(params_of(a), params_of(a) + n_params,
+                                            params_of(b), params_of(b) + n_params);
+    };
+
+    order_.resize(chunk.count);
+    for (int m = 0; m < chunk.count; ++m) order_[m] = m;
+    std::stable_sort(order_.begin(), order_.end(), less);
+
+    chunk.final_states.resize(static_cast<size_t>(chunk.count) * dim);
+    std::vector<double> params(n_params);
+    for (int run_begin = 0; run_begin < chunk.count;) {
+        int run_end = run_begin + 1;
+        while (run_end < chunk.count && !less(order_[run_begin], order_[run_end])) {
+            run_end++;
+        }
+        const int n = run_end - run_begin;
+
+        run_y0_.resize(static_cast<size_t>(n) * dim);
+        for (int i = 0; i < n; ++i) {
+            const double* record = chunk.records.data() + order_[run_begin + i] * stride;
+            std::copy(record, record + dim, run_y0_.begin() + static_cast<size_t>(i) * dim);
+        }
+        params.assign(params_of(order_[run_begin]), params_of(order_[run_begin]) + n_params);
+
+        solver_.solve_ensemble((*factory)(params), t0, tf, dt, run_y0_, n, run_final_);
+        stats.sub_ensembles++;
+
+        for (int i = 0; i < n; ++i) {
+            std::copy(run_final_.begin() + static_cast<size_t>(i) * dim,
+                      run_final_.begin() + static_cast<size_t>(i + 1) * dim,
+                      chunk.final_states.begin() + static_cast<size_t>(order_[run_begin + i]) * dim);
+        }
+        run_begin = run_end;
+    }
+}
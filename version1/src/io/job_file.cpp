@@ -0,0 +1,409 @@
+#include "../../include/job_file.h"
+#include "../../include/rhs_jit.h"
+#include "../../include/test_problems.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+class ParseError {
+public:
+    ParseError(const std::string& source, int line) : prefix_(source + ":" + std::to_string(line) + ": ") {}
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::invalid_argument(prefix_ + message);
+    }
+
+private:
+    std::string prefix_;
+};
+
+std::string trim(const std::string& text) {
+    const size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    const size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+// Splits on commas and whitespace
+std::vector<std::string> split_list(const std::string& text) {
+    std::vector<std::string> items;
+    std::string current;
+    for (char c : text) {
+        if (c == ',' || c == ' ' || c == '\t') {
+            if (!current.empty()) items.push_back(current);
+            current.clear();
+        } else {
+            current += c;
+        }
+    }
+    if (!current.empty()) items.push_back(current);
+    return items;
+}
+
+double parse_number(const std::string& text, const ParseError& error) {
+    char* end = nullptr;
+    const double value = std::strtod(text.c_str(), &end);
+    if (text.empty() || *end != '\0' || !std::isfinite(value)) {
+        error.fail("not a number: '" + text + "'");
+    }
+    return value;
+}
+
+std::uint64_t parse_count(const std::string& text, const ParseError& error) {
+    const double value = parse_number(text, error);
+    if (value < 0.0 || value != std::floor(value)) {
+        error.fail("not a non-negative integer: '" + text + "'");
+    }
+    return static_cast<std::uint64_t>(value);
+}
+
+std::vector<double> parse_numbers(const std::string& text, const ParseError& error) {
+    for (const char* generator : {"linspace", "logspace"}) {
+        const std::string name(generator);
+        if (text.compare(0, name.size(), name) != 0) continue;
+
+        const size_t open = text.find('(');
+        const size_t close = text.rfind(')');
+        if (open != name.size() || close != text.size() - 1) {
+            error.fail("expected " + name + "(a, b, n)");
+        }
+        std::vector<std::string> args = split_list(text.substr(open + 1, close - open - 1));
+        if (args.size() != 3) {
+            error.fail("expected " + name + "(a, b, n)");
+        }
+        const double a = parse_number(args[0], error);
+        const double b = parse_number(args[1], error);
+        const std::uint64_t n = parse_count(args[2], error);
+        if (n == 0) {
+            error.fail(name + " needs n >= 1");
+        }
+
+        std::vector<double> values(n);
+        for (std::uint64_t i = 0; i < n; ++i) {
+            const double x = n == 1 ? a : a + (b - a) * static_cast<double>(i) / static_cast<double>(n - 1);
+            values[i] = name == "logspace" ? std::pow(10.0, x) : x;
+        }
+        return values;
+    }
+
+    std::vector<double> values;
+    for (const std::string& item : split_list(text)) {
+        values.push_back(parse_number(item, error));
+    }
+    if (values.empty()) {
+        error.fail("missing value");
+    }
+    return values;
+}
+
+std::uint64_t fnv1a(const std::string& text) {
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+std::string hex(double value) {
+    char buffer[40];
+    std::snprintf(buffer, sizeof(buffer), "%a", value);
+    return buffer;
+}
+
+}  // namespace
+
+JobSpec JobSpec::parse_file(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        throw std::invalid_argument("Cannot open job file " + path);
+    }
+    JobSpec spec = parse(in, path);
+    if (spec.output_.empty()) {
+        // sweeps/vdp.job -> sweeps/vdp.traj
+        const size_t slash = path.find_last_of('/');
+        const size_t dot = path.find_last_of('.');
+        const bool has_extension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+        spec.output_ = (has_extension ? path.substr(0, dot) : path) + ".traj";
+    }
+    return spec;
+}
+
+JobSpec JobSpec::parse(std::istream& in, const std::string& source_name) {
+    JobSpec spec;
+    std::string line;
+    int line_number = 0;
+    bool have_base_y0 = false;
+
+    while (std::getline(in, line)) {
+        line_number++;
+        const ParseError error(source_name, line_number);
+
+        const size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        line = trim(line);
+        if (line.empty()) continue;
+
+        const size_t split = line.find_first_of(" \t");
+        const std::string key = line.substr(0, split);
+        std::string value = split == std::string::npos ? "" : trim(line.substr(split));
+        if (value.empty()) {
+            error.fail("'" + key + "' needs a value");
+        }
+
+        auto add_axis = [&](Axis axis) {
+            for (const Axis& existing : spec.axes_) {
+                if (existing.kind == axis.kind && existing.key == axis.key) {
+                    error.fail("'" + axis.key + "' given twice");
+                }
+            }
+            spec.axes_.push_back(std::move(axis));
+        };
+
+        if (key == "problem") {
+            spec.problem_ = value;
+        } else if (key == "rhs") {
+            if (!spec.rhs_text_.empty()) error.fail("'rhs' given twice");
+            spec.rhs_text_ = value;
+        } else if (key == "dimension") {
+            const std::uint64_t dimension = parse_count(value, error);
+            if (dimension == 0 || dimension > 1u << 20) error.fail("dimension out of range");
+            spec.dimension_ = static_cast<int>(dimension);
+        } else if (key == "param") {
+            const size_t name_end = value.find_first_of(" \t");
+            if (name_end == std::string::npos) error.fail("expected 'param NAME VALUES'");
+            Axis axis{AxisKind::Parameter, value.substr(0, name_end), -1, {}, {}};
+            axis.numbers = parse_numbers(trim(value.substr(name_end)), error);
+            add_axis(std::move(axis));
+        } else if (key == "y0") {
+            if (have_base_y0) error.fail("'y0' given twice");
+            spec.base_y0_ = parse_numbers(value, error);
+            have_base_y0 = true;
+        } else if (key.compare(0, 3, "y0[") == 0 && key.back() == ']') {
+            Axis axis{AxisKind::State, key, -1, {}, {}};
+            axis.component = static_cast<int>(parse_count(key.substr(3, key.size() - 4), error));
+            axis.numbers = parse_numbers(value, error);
+            add_axis(std::move(axis));
+        } else if (key == "t0" || key == "tf" || key == "dt") {
+            Axis axis{key == "t0" ? AxisKind::T0 : key == "tf" ? AxisKind::Tf : AxisKind::Dt, key, -1, {}, {}};
+            axis.numbers = parse_numbers(value, error);
+            for (double number : axis.numbers) {
+                if (!std::isfinite(number)) error.fail(key + " must be finite");
+                if (axis.kind == AxisKind::Dt && !(number > 0.0)) error.fail("dt must be positive");
+            }
+            add_axis(std::move(axis));
+        } else if (key == "method" || key == "backend") {
+            Axis axis{key == "method" ? AxisKind::Method : AxisKind::Backend, key, -1, {}, {}};
+            axis.words = split_list(value);
+            for (const std::string& word : axis.words) {
+                const bool known = axis.kind == AxisKind::Method
+                    ? (word == "euler" || word == "rk45")
+                    : (word == "auto" || word == "cpu" || word == "cpu_threaded" || word == "gpu");
+                if (!known) error.fail("unknown " + key + " '" + word + "'");
+            }
+            add_axis(std::move(axis));
+        } else if (key == "samples") {
+            spec.samples_ = parse_count(value, error);
+            if (spec.samples_ == 0) error.fail("samples must be at least 1");
+        } else if (key == "perturb") {
+            spec.perturb_ = parse_number(value, error);
+            if (spec.perturb_ < 0.0) error.fail("perturb must be non-negative");
+        } else if (key == "seed") {
+            spec.seed_ = parse_count(value, error);
+        } else if (key == "output") {
+            spec.output_ = value;
+        } else if (key == "record") {
+            if (value != "final" && value != "full") error.fail("record is 'final' or 'full'");
+            spec.final_only_ = value == "final";
+        } else {
+            error.fail("unknown key '" + key + "'");
+        }
+    }
+
+    spec.finish(source_name);
+    return spec;
+}
+
+const JobSpec::Axis* JobSpec::find_axis(AxisKind kind, const std::string& key) const {
+    for (const Axis& axis : axes_) {
+        if (axis.kind == kind && (key.empty() || axis.key == key)) return &axis;
+    }
+    return nullptr;
+}
+
+void JobSpec::finish(const std::string& source_name) {
+    if (problem_.empty() && rhs_text_.empty()) {
+        throw std::invalid_argument(source_name + ": no 'problem' or 'rhs' given");
+    }
+
+    // Validates the problem name, its dimension and every parameter name
+    std::map<std::string, double> parameters;
+    for (const Axis& axis : axes_) {
+        if (axis.kind == AxisKind::Parameter) parameters[axis.key] = axis.numbers.front();
+    }
+    ODESystem system;
+    try {
+        if (!rhs_text_.empty()) {
+            std::string text = rhs_text_;
+            std::replace(text.begin(), text.end(), ';', '\n');
+            if (problem_.empty()) problem_ = "custom";
+            rhs_ = std::make_shared<const RHSProgram>(RHSProgram::parse(text, problem_));
+            if (dimension_ != 0 && dimension_ != rhs_->dimension()) {
+                throw std::invalid_argument("rhs has dimension " + std::to_string(rhs_->dimension()) +
+                                            ", not " + std::to_string(dimension_));
+            }
+            dimension_ = rhs_->dimension();
+            system = to_ode_system(*rhs_, parameters);
+        } else {
+            if (dimension_ == 0) {
+                dimension_ = TestProblems::fixed_dimension(problem_);
+                if (dimension_ == 0) {
+                    throw std::invalid_argument("problem " + problem_ + " needs a 'dimension'");
+                }
+            }
+            system = TestProblems::create(problem_, dimension_, parameters);
+        }
+    } catch (const std::invalid_argument& e) {
+        throw std::invalid_argument(source_name + ": " + e.what());
+    }
+    if (base_y0_.empty()) {
+        base_y0_ = system.initial_conditions;
+    }
+    if (static_cast<int>(base_y0_.size()) != dimension_) {
+        throw std::invalid_argument(source_name + ": y0 has " + std::to_string(base_y0_.size()) +
+                                    " components, problem has " + std::to_string(dimension_));
+    }
+    for (const Axis& axis : axes_) {
+        if (axis.kind == AxisKind::State && axis.component >= dimension_) {
+            throw std::invalid_argument(source_name + ": " + axis.key + " is out of range");
+        }
+    }
+
+    // Unset keys become single-value axes at the end (no effect on order)
+    if (!find_axis(AxisKind::T0, "")) axes_.push_back({AxisKind::T0, "t0", -1, {system.t_start}, {}});
+    if (!find_axis(AxisKind::Tf, "")) axes_.push_back({AxisKind::Tf, "tf", -1, {system.t_end}, {}});
+    if (!find_axis(AxisKind::Dt, "")) axes_.push_back({AxisKind::Dt, "dt", -1, {0.01}, {}});
+    if (!find_axis(AxisKind::Method, "")) axes_.push_back({AxisKind::Method, "method", -1, {}, {"rk45"}});
+    if (!find_axis(AxisKind::Backend, "")) axes_.push_back({AxisKind::Backend, "backend", -1, {}, {"auto"}});
+
+    // Every t0 is paired with every tf, so the largest t0 must still end
+    // before the smallest tf
+    const std::vector<double>& t0s = find_axis(AxisKind::T0, "")->numbers;
+    const std::vector<double>& tfs = find_axis(AxisKind::Tf, "")->numbers;
+    if (!(*std::max_element(t0s.begin(), t0s.end()) < *std::min_element(tfs.begin(), tfs.end()))) {
+        throw std::invalid_argument(source_name + ": every tf must be greater than every t0");
+    }
+
+    // Overflow guard: the index is a 64-bit mixed-radix number
+    std::uint64_t total = samples_;
+    for (const Axis& axis : axes_) {
+        if (total > UINT64_MAX / axis.size()) {
+            throw std::invalid_argument(source_name + ": sweep has more than 2^64 jobs");
+        }
+        total *= axis.size();
+    }
+}
+
+std::uint64_t JobSpec::size() const {
+    std::uint64_t total = samples_;
+    for (const Axis& axis : axes_) {
+        total *= axis.size();
+    }
+    return total;
+}
+
+JobInstance JobSpec::job(std::uint64_t index) const {
+    if (index >= size()) {
+        throw std::out_of_range("Job index " + std::to_string(index) + " past the end of the sweep");
+    }
+
+    JobInstance job;
+    job.index = index;
+    job.problem = problem_;
+    job.dimension = dimension_;
+    job.y0 = base_y0_;
+
+    // Mixed radix, last axis fastest, samples innermost
+    std::uint64_t rest = index / samples_;
+    std::vector<size_t> choice(axes_.size());
+    for (size_t a = axes_.size(); a-- > 0;) {
+        choice[a] = static_cast<size_t>(rest % axes_[a].size());
+        rest /= axes_[a].size();
+    }
+
+    for (size_t a = 0; a < axes_.size(); ++a) {
+        const Axis& axis = axes_[a];
+        const size_t c = choice[a];
+        switch (axis.kind) {
+            case AxisKind::Parameter: job.parameters[axis.key] = axis.numbers[c]; break;
+            case AxisKind::State:     job.y0[axis.component] = axis.numbers[c]; break;
+            case AxisKind::T0:        job.t0 = axis.numbers[c]; break;
+            case AxisKind::Tf:        job.tf = axis.numbers[c]; break;
+            case AxisKind::Dt:        job.dt = axis.numbers[c]; break;
+            case AxisKind::Method:    job.method = axis.words[c]; break;
+            case AxisKind::Backend:   job.backend = axis.words[c]; break;
+        }
+    }
+
+    if (perturb_ > 0.0) {
+        // Seeded per job, so any job can be rebuilt alone; mapped by hand
+        // because std::uniform_real_distribution differs between libraries
+        std::mt19937_64 rng(seed_ + index);
+        for (double& y : job.y0) {
+            const double unit = static_cast<double>(rng() >> 11) * 0x1.0p-53;
+            y += perturb_ * (2.0 * unit - 1.0);
+        }
+    }
+    return job;
+}
+
+ODESystem JobSpec::system_for(const JobInstance& job) const {
+    if (rhs_) {
+        // A swept parameter shares one compiled object across the sweep;
+        // fixed parameters are baked in
+        bool parameter_sweep = false;
+        for (const Axis& axis : axes_) {
+            if (axis.kind == AxisKind::Parameter && axis.size() > 1) parameter_sweep = true;
+        }
+        ODESystem system = RHSJit::instance().system(*rhs_, job.parameters, !parameter_sweep);
+        // One program object for the whole sweep, so RequestCoalescer can
+        // batch its jobs
+        system.program = rhs_;
+        return system;
+    }
+    return TestProblems::create(job.problem, job.dimension, job.parameters);
+}
+
+std::uint64_t JobSpec::fingerprint() const {
+    std::ostringstream canonical;
+    canonical << problem_ << '|' << dimension_ << '|' << samples_ << '|' << hex(perturb_) << '|'
+              << seed_ << '|' << final_only_ << "|y0";
+    for (double y : base_y0_) canonical << ',' << hex(y);
+    if (!rhs_text_.empty()) canonical << "|rhs=" << rhs_text_;   // Unchanged for named problems
+    for (const Axis& axis : axes_) {
+        canonical << '|' << static_cast<int>(axis.kind) << ':' << axis.key << '=';
+        for (double x : axis.numbers) canonical << hex(x) << ',';
+        for (const std::string& w : axis.words) canonical << w << ',';
+    }
+    return fnv1a(canonical.str());
+}
+
+std::string JobSpec::describe(const JobInstance& job) {
+    std::ostringstream text;
+    text << "#" << job.index << " " << job.problem;
+    for (const auto& entry : job.parameters) {
+        text << " " << entry.first << "=" << entry.second;
+    }
+    text << " " << job.method << "/" << job.backend << " t=[" << job.t0 << "," << job.tf
+         << "] dt=" << job.dt << " y0=(";
+    for (size_t i = 0; i < job.y0.size(); ++i) {
+        text << (i ? "," : "") << job.y0[i];
+    }
+    text << ")";
+    return text.str();
+}
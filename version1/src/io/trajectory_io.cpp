@@ -0,0 +1,245 @@
+#include "../../include/trajectory_io.h"
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+
+constexpr char kFileMagic[8] = {'O', 'D', 'E', 'T', 'R', 'A', 'J', '1'};
+constexpr std::uint32_t kFileVersion = 1;
+constexpr std::uint32_t kRecordMagic = 0x43455254;  // "TREC"
+constexpr std::uint32_t kFlagFinalOnly = 1u << 0;
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t flags;
+    std::uint64_t fingerprint;
+    std::uint64_t total_jobs;
+    std::uint32_t dimension;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(FileHeader) == 40, "FileHeader is part of the file format");
+
+struct RecordHeader {
+    std::uint32_t magic;
+    std::uint32_t rows;
+    std::uint32_t cols;
+    std::uint32_t reserved;
+    std::uint64_t job_index;
+    double t_first;
+    double dt;
+};
+static_assert(sizeof(RecordHeader) == 40, "RecordHeader is part of the file format");
+
+// FNV-1a, 64 bit; catches torn writes, not an integrity guarantee
+class Fnv1a {
+public:
+    void update(const void* data, size_t bytes) {
+        const auto* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < bytes; ++i) {
+            hash_ = (hash_ ^ p[i]) * 0x100000001b3ULL;
+        }
+    }
+    std::uint64_t value() const { return hash_; }
+
+private:
+    std::uint64_t hash_ = 0xcbf29ce484222325ULL;
+};
+
+FileHeader make_header(const TrajectoryFileInfo& info) {
+    FileHeader header{};
+    std::memcpy(header.magic, kFileMagic, sizeof(kFileMagic));
+    header.version = kFileVersion;
+    header.flags = info.final_only ? kFlagFinalOnly : 0;
+    header.fingerprint = info.fingerprint;
+    header.total_jobs = info.total_jobs;
+    header.dimension = info.dimension;
+    return header;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// TrajectoryWriter
+// ---------------------------------------------------------------------------
+
+bool TrajectoryWriter::create(const std::string& path, const TrajectoryFileInfo& info) {
+    close();
+    out_.open(path, std::ios::binary | std::ios::trunc);
+    if (!out_.is_open()) {
+        std::cerr << "TrajectoryWriter: cannot write " << path << std::endl;
+        return false;
+    }
+    path_ = path;
+    records_written_ = 0;
+
+    FileHeader header = make_header(info);
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return flush();
+}
+
+bool TrajectoryWriter::resume(const std::string& path, const TrajectoryFileInfo& info,
+                              std::vector<std::uint64_t>& completed) {
+    close();
+    completed.clear();
+
+    TrajectoryReader reader;
+    if (!reader.open(path)) {
+        return false;
+    }
+    const TrajectoryFileInfo& existing = reader.info();
+    if (existing.fingerprint != info.fingerprint || existing.total_jobs != info.total_jobs ||
+        existing.dimension != info.dimension || existing.final_only != info.final_only) {
+        std::cerr << "TrajectoryWriter: " << path << " belongs to a different sweep" << std::endl;
+        return false;
+    }
+
+    TrajectoryRecord record;
+    while (reader.next(record)) {
+        completed.push_back(record.job_index);
+    }
+    const bool torn = reader.truncated();
+    const std::uint64_t good_bytes = reader.good_bytes();
+    reader = TrajectoryReader();
+
+    if (torn) {
+        std::cerr << "TrajectoryWriter: dropping incomplete record at the end of " << path << std::endl;
+        std::error_code error;
+        std::filesystem::resize_file(path, good_bytes, error);
+        if (error) {
+            std::cerr << "TrajectoryWriter: cannot trim " << path << ": " << error.message() << std::endl;
+            return false;
+        }
+    }
+
+    out_.open(path, std::ios::binary | std::ios::app);
+    if (!out_.is_open()) {
+        std::cerr << "TrajectoryWriter: cannot append to " << path << std::endl;
+        return false;
+    }
+    path_ = path;
+    records_written_ = 0;
+    return true;
+}
+
+bool TrajectoryWriter::append(std::uint64_t job_index, double t_first, double dt,
+                              const std::vector<std::vector<double>>& rows) {
+    if (!out_.is_open()) {
+        return false;
+    }
+
+    RecordHeader header{};
+    header.magic = kRecordMagic;
+    header.rows = static_cast<std::uint32_t>(rows.size());
+    header.cols = rows.empty() ? 0 : static_cast<std::uint32_t>(rows.front().size());
+    header.job_index = job_index;
+    header.t_first = t_first;
+    header.dt = dt;
+
+    staging_.clear();
+    staging_.reserve(static_cast<size_t>(header.rows) * header.cols);
+    for (const auto& row : rows) {
+        if (row.size() != header.cols) {
+            std::cerr << "TrajectoryWriter: ragged rows in job " << job_index << std::endl;
+            return false;
+        }
+        staging_.insert(staging_.end(), row.begin(), row.end());
+    }
+
+    Fnv1a checksum;
+    checksum.update(&header, sizeof(header));
+    checksum.update(staging_.data(), staging_.size() * sizeof(double));
+    const std::uint64_t digest = checksum.value();
+
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out_.write(reinterpret_cast<const char*>(staging_.data()), staging_.size() * sizeof(double));
+    out_.write(reinterpret_cast<const char*>(&digest), sizeof(digest));
+    if (!out_) {
+        std::cerr << "TrajectoryWriter: write to " << path_ << " failed" << std::endl;
+        return false;
+    }
+    records_written_++;
+    return true;
+}
+
+bool TrajectoryWriter::flush() {
+    out_.flush();
+    return static_cast<bool>(out_);
+}
+
+void TrajectoryWriter::close() {
+    if (out_.is_open()) {
+        out_.close();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// TrajectoryReader
+// ---------------------------------------------------------------------------
+
+bool TrajectoryReader::open(const std::string& path) {
+    in_.open(path, std::ios::binary);
+    if (!in_.is_open()) {
+        std::cerr << "TrajectoryReader: cannot open " << path << std::endl;
+        return false;
+    }
+
+    FileHeader header{};
+    in_.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in_ || std::memcmp(header.magic, kFileMagic, sizeof(kFileMagic)) != 0 ||
+        header.version != kFileVersion) {
+        std::cerr << "TrajectoryReader: " << path << " is not a trajectory file" << std::endl;
+        return false;
+    }
+
+    info_.fingerprint = header.fingerprint;
+    info_.total_jobs = header.total_jobs;
+    info_.dimension = header.dimension;
+    info_.final_only = (header.flags & kFlagFinalOnly) != 0;
+    good_bytes_ = sizeof(header);
+    truncated_ = false;
+    return true;
+}
+
+bool TrajectoryReader::next(TrajectoryRecord& record) {
+    if (!in_.is_open() || truncated_) {
+        return false;
+    }
+
+    RecordHeader header{};
+    in_.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (in_.gcount() == 0 && in_.eof()) {
+        return false;  // Clean end
+    }
+    if (!in_ || header.magic != kRecordMagic) {
+        truncated_ = true;
+        return false;
+    }
+
+    record.job_index = header.job_index;
+    record.t_first = header.t_first;
+    record.dt = header.dt;
+    record.rows = header.rows;
+    record.cols = header.cols;
+    record.data.resize(static_cast<size_t>(header.rows) * header.cols);
+    in_.read(reinterpret_cast<char*>(record.data.data()), record.data.size() * sizeof(double));
+
+    std::uint64_t digest = 0;
+    in_.read(reinterpret_cast<char*>(&digest), sizeof(digest));
+    if (!in_) {
+        truncated_ = true;
+        return false;
+    }
+
+    Fnv1a checksum;
+    checksum.update(&header, sizeof(header));
+    checksum.update(record.data.data(), record.data.size() * sizeof(double));
+    if (checksum.value() != digest) {
+        truncated_ = true;
+        return false;
+    }
+
+    good_bytes_ += sizeof(header) + record.data.size() * sizeof(double) + sizeof(digest);
+    return true;
+}
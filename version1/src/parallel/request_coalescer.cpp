@@ -0,0 +1,250 @@
+#include "../../include/request_coalescer.h"
+#include "../../include/trace.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <stdexcept>
+
+namespace {
+
+std::uint64_t nanoseconds_between(std::chrono::steady_clock::time_point a,
+                                  std::chrono::steady_clock::time_point b) {
+    return static_cast<std::uint64_t>(
+        std::max<std::int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count()));
+}
+
+}  // namespace
+
+RequestCoalescer::RequestCoalescer(ThreadPool& pool, const CostCalibration& calibration,
+                                   const CoalescerOptions& options)
+    : euler_("euler", pool, calibration), rk45_("rk45", pool, calibration),
+      stopping_(false) {
+    set_options(options);
+    euler_.set_verbose(false);
+    rk45_.set_verbose(false);
+    thread_ = std::thread([this]() { flush_loop(); });
+}
+
+RequestCoalescer::~RequestCoalescer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+std::string RequestCoalescer::batch_key(const ODESystem& system, const std::string& method,
+                                        double t0, double tf, double dt) {
+    // Hex floats: equal keys only for bit-identical time grids and parameters
+    char number[40];
+    auto hex = [&number](double value) {
+        std::snprintf(number, sizeof(number), "%a", value);
+        return std::string(number);
+    };
+
+    // The whole group is solved with the first request's system, so the
+    // RHS has to be the same function. Builtins are fixed by their name
+    // and parameters, RHS programs by the program object; any other
+    // callable cannot be compared, and gets a group of its own.
+    std::string rhs;
+    if (system.use_builtin_rhs()) {
+        rhs = "builtin:" + system.gpu_info->builtin_rhs_name;
+    } else if (system.program) {
+        std::snprintf(number, sizeof(number), "%p", static_cast<const void*>(system.program.get()));
+        rhs = std::string("program:") + number;
+    } else {
+        static std::atomic<std::uint64_t> unique{0};
+        rhs = "custom:" + system.name + "#" + std::to_string(unique.fetch_add(1));
+    }
+
+    std::string key = rhs + "|" + std::to_string(system.dimension) + "|" + method + "|" + hex(t0) + "|" +
+                      hex(tf) + "|" + hex(dt) + "|";
+    for (const auto& parameter : system.parameters) {
+        key += parameter.first + "=" + hex(parameter.second) + ";";
+    }
+    if (system.gpu_info) {
+        key += "|";
+        for (float uniform : system.gpu_info->gpu_uniforms) {
+            key += hex(uniform) + ";";
+        }
+    }
+    return key;
+}
+
+std::future<CoalescedResult> RequestCoalescer::submit(const ODESystem& system,
+                                                      const std::string& method,
+                                                      double t0, double tf, double dt,
+                                                      std::vector<double> y0) {
+    if (method != "euler" && method != "rk45") {
+        throw std::invalid_argument("Unknown stepper method: " + method);
+    }
+    if (static_cast<int>(y0.size()) != system.dimension) {
+        throw std::invalid_argument("Initial state size does not match the system dimension");
+    }
+    if (!(dt > 0.0) || !(tf >= t0)) {
+        throw std::invalid_argument("Need dt > 0 and tf >= t0");
+    }
+
+    auto request = std::make_unique<Request>();
+    request->y0 = std::move(y0);
+    request->submitted = Clock::now();
+    std::future<CoalescedResult> future = request->promise.get_future();
+
+    const std::string key = batch_key(system, method, t0, tf, dt);
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            throw std::runtime_error("RequestCoalescer is shutting down");
+        }
+
+        std::unique_ptr<Group>& group = open_[key];
+        if (!group) {
+            group = std::make_unique<Group>();
+            group->system = system;
+            group->method = method;
+            group->t0 = t0;
+            group->tf = tf;
+            group->dt = dt;
+            group->deadline = request->submitted +
+                std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(options_.window_seconds));
+            wake = true;  // New earliest deadline, possibly
+        }
+        group->requests.push_back(std::move(request));
+
+        if (static_cast<int>(group->requests.size()) >= options_.max_batch) {
+            group->full = true;
+            ready_.push_back(std::move(group));
+            open_.erase(key);
+            wake = true;
+        }
+    }
+    if (wake) {
+        cv_.notify_one();
+    }
+    return future;
+}
+
+void RequestCoalescer::set_options(const CoalescerOptions& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    options_ = options;
+    options_.max_batch = std::max(1, options_.max_batch);
+    options_.window_seconds = std::max(0.0, options_.window_seconds);
+}
+
+CoalescerOptions RequestCoalescer::options() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return options_;
+}
+
+CoalescerMetrics RequestCoalescer::metrics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return metrics_;
+}
+
+void RequestCoalescer::reset_metrics() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    metrics_.requests = 0;
+    metrics_.batches = 0;
+    metrics_.full_flushes = 0;
+    metrics_.window_flushes = 0;
+    metrics_.largest_batch = 0;
+    metrics_.wait.reset();
+    metrics_.run.reset();
+}
+
+void RequestCoalescer::flush_loop() {
+    ODE_TRACE_THREAD_NAME("coalescer");
+
+    while (true) {
+        std::unique_ptr<Group> group;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!group) {
+                if (!ready_.empty()) {
+                    group = std::move(ready_.front());
+                    ready_.pop_front();
+                    break;
+                }
+
+                auto earliest = open_.end();
+                for (auto it = open_.begin(); it != open_.end(); ++it) {
+                    if (earliest == open_.end() || it->second->deadline < earliest->second->deadline) {
+                        earliest = it;
+                    }
+                }
+                if (earliest == open_.end()) {
+                    if (stopping_) return;
+                    cv_.wait(lock);
+                    continue;
+                }
+
+                // Shutdown dispatches held groups without waiting them out
+                Clock::time_point deadline = earliest->second->deadline;
+                if (stopping_ || Clock::now() >= deadline) {
+                    group = std::move(earliest->second);
+                    open_.erase(earliest);
+                } else {
+                    cv_.wait_until(lock, deadline);
+                }
+            }
+        }
+        run_group(*group);
+    }
+}
+
+void RequestCoalescer::run_group(Group& group) {
+    ODE_TRACE_SCOPE_CAT("coalesced_batch", "coalescer");
+
+    const int dim = group.system.dimension;
+    const int n = static_cast<int>(group.requests.size());
+
+    std::vector<double> y0;
+    y0.reserve(static_cast<size_t>(n) * dim);
+    for (const auto& request : group.requests) {
+        y0.insert(y0.end(), request->y0.begin(), request->y0.end());
+    }
+
+    const Clock::time_point started = Clock::now();
+    std::vector<double> final_states;
+    std::string backend;
+    std::exception_ptr failure;
+    try {
+        AutoDispatcher& dispatcher = group.method == "euler" ? euler_ : rk45_;
+        dispatcher.solve_ensemble(group.system, group.t0, group.tf, group.dt, y0, n, final_states);
+        backend = dispatcher.history().back().backend;
+    } catch (...) {
+        failure = std::current_exception();
+    }
+    const Clock::time_point finished = Clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        metrics_.requests += n;
+        metrics_.batches++;
+        (group.full ? metrics_.full_flushes : metrics_.window_flushes)++;
+        metrics_.largest_batch = std::max<std::uint64_t>(metrics_.largest_batch, n);
+        metrics_.run.record(nanoseconds_between(started, finished));
+        for (const auto& request : group.requests) {
+            metrics_.wait.record(nanoseconds_between(request->submitted, started));
+        }
+    }
+
+    for (int m = 0; m < n; ++m) {
+        Request& request = *group.requests[m];
+        if (failure) {
+            request.promise.set_exception(failure);
+            continue;
+        }
+        CoalescedResult result;
+        result.final_state.assign(final_states.begin() + static_cast<size_t>(m) * dim,
+                                  final_states.begin() + static_cast<size_t>(m + 1) * dim);
+        result.backend = backend;
+        result.batch_size = static_cast<std::uint32_t>(n);
+        result.wait_seconds = nanoseconds_between(request.submitted, started) * 1e-9;
+        result.run_seconds = nanoseconds_between(started, finished) * 1e-9;
+        request.promise.set_value(std::move(result));
+    }
+}
@@ -0,0 +1,85 @@
+#include "../../include/scaling_table.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+void ScalingTable::set(const std::string& kind, long long size, int threads) {
+    entries_[kind][size] = threads;
+}
+
+int ScalingTable::choose_threads(const std::string& kind, long long size, int fallback) const {
+    auto kind_it = entries_.find(kind);
+    if (kind_it == entries_.end() || kind_it->second.empty()) {
+        return fallback;
+    }
+
+    const auto& sizes = kind_it->second;
+    auto it = sizes.upper_bound(size);
+    if (it == sizes.begin()) {
+        return it->second;
+    }
+    --it;
+    return it->second;
+}
+
+long long ScalingTable::crossover(const std::string& kind) const {
+    auto kind_it = entries_.find(kind);
+    if (kind_it == entries_.end()) return -1;
+
+    for (const auto& entry : kind_it->second) {
+        if (entry.second > 1) return entry.first;
+    }
+    return -1;
+}
+
+std::vector<std::string> ScalingTable::kinds() const {
+    std::vector<std::string> names;
+    for (const auto& entry : entries_) {
+        names.push_back(entry.first);
+    }
+    return names;
+}
+
+bool ScalingTable::save(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "ScalingTable: cannot write " << path << std::endl;
+        return false;
+    }
+
+    out << "# Best thread count per workload size (examples/scaling_benchmark)\n";
+    out << "# kind size threads\n";
+    for (const auto& kind : entries_) {
+        for (const auto& entry : kind.second) {
+            out << kind.first << " " << entry.first << " " << entry.second << "\n";
+        }
+    }
+    return out.good();
+}
+
+bool ScalingTable::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    entries_.clear();
+    std::string line;
+    int line_number = 0;
+    while (std::getline(in, line)) {
+        line_number++;
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream fields(line);
+        std::string kind;
+        long long size;
+        int threads;
+        if (!(fields >> kind >> size >> threads) || threads < 1) {
+            std::cerr << "ScalingTable: bad entry at " << path << ":" << line_number << std::endl;
+            entries_.clear();
+            return false;
+        }
+        set(kind, size, threads);
+    }
+    return true;
+}
@@ -0,0 +1,315 @@
+#include "../../include/sharded_ensemble.h"
+#include "../../include/ensemble.h"
+#include "../../include/trace.h"
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <map>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+constexpr char kRegionMagic[8] = {'O', 'D', 'E', 'S', 'H', 'R', 'D', '1'};
+
+// Shared between processes, so the state words must not need a lock
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "process-shared flags need lock-free atomics");
+
+struct RegionHeader {
+    char magic[8];
+    std::int32_t dimension;
+    std::uint32_t n_shards;
+    std::uint64_t members;
+    std::uint64_t data_offset;
+};
+static_assert(sizeof(RegionHeader) <= 64, "controls start at byte 64");
+
+// One cache line per shard: workers finishing together do not share lines
+struct alignas(64) ShardControl {
+    std::atomic<std::uint32_t> state;       // ShardState
+    std::atomic<std::uint32_t> attempts;
+    std::atomic<std::int32_t> pid;          // Current worker, 0 if none
+    std::uint64_t begin;
+    std::uint64_t end;
+};
+
+RegionHeader* header_of(void* region) {
+    return static_cast<RegionHeader*>(region);
+}
+
+ShardControl* controls_of(void* region) {
+    return reinterpret_cast<ShardControl*>(static_cast<char*>(region) + 64);
+}
+
+double* data_of(void* region) {
+    return reinterpret_cast<double*>(static_cast<char*>(region) + header_of(region)->data_offset);
+}
+
+using Clock = std::chrono::steady_clock;
+
+// Worker process body; never returns
+[[noreturn]] void run_worker(void* region, int shard, const std::string& method, int threads,
+                             const ODESystem& system, double t0, double tf, double dt,
+                             const std::vector<double>& y0) {
+    int exit_code = 2;
+    try {
+        ShardControl& control = controls_of(region)[shard];
+        const int dim = header_of(region)->dimension;
+        const std::uint64_t count = control.end - control.begin;
+
+        std::vector<double> shard_y0(y0.begin() + control.begin * dim, y0.begin() + control.end * dim);
+        std::vector<double> final_states;
+        ThreadPool pool(threads);
+        CPUEnsembleBackend backend(method, pool);
+        backend.solve_ensemble(system, t0, tf, dt, shard_y0, static_cast<int>(count), final_states);
+
+        std::memcpy(data_of(region) + control.begin * dim, final_states.data(),
+                    final_states.size() * sizeof(double));
+        // Publishes the results written above
+        control.state.store(static_cast<std::uint32_t>(ShardState::Done), std::memory_order_release);
+        exit_code = 0;
+    } catch (...) {
+    }
+    // No atexit handlers or stdio flushes: those belong to the parent
+    _exit(exit_code);
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// ShardedResult
+// ---------------------------------------------------------------------------
+
+ShardedResult::~ShardedResult() {
+    release();
+}
+
+ShardedResult::ShardedResult(ShardedResult&& other) noexcept {
+    *this = std::move(other);
+}
+
+ShardedResult& ShardedResult::operator=(ShardedResult&& other) noexcept {
+    if (this != &other) {
+        release();
+        region_ = other.region_;
+        region_bytes_ = other.region_bytes_;
+        data_ = other.data_;
+        members_ = other.members_;
+        dimension_ = other.dimension_;
+        shm_name_ = std::move(other.shm_name_);
+        stats_ = other.stats_;
+        other.region_ = nullptr;
+        other.data_ = nullptr;
+        other.shm_name_.clear();
+    }
+    return *this;
+}
+
+void ShardedResult::release() {
+    if (region_) {
+        ::munmap(region_, region_bytes_);
+        region_ = nullptr;
+        data_ = nullptr;
+    }
+    if (!shm_name_.empty()) {
+        ::shm_unlink(shm_name_.c_str());
+        shm_name_.clear();
+    }
+}
+
+int ShardedResult::shards() const {
+    return region_ ? static_cast<int>(header_of(region_)->n_shards) : 0;
+}
+
+ShardState ShardedResult::shard_state(int shard) const {
+    return static_cast<ShardState>(controls_of(region_)[shard].state.load(std::memory_order_acquire));
+}
+
+std::uint64_t ShardedResult::shard_begin(int shard) const {
+    return controls_of(region_)[shard].begin;
+}
+
+std::uint64_t ShardedResult::shard_end(int shard) const {
+    return controls_of(region_)[shard].end;
+}
+
+bool ShardedResult::complete() const {
+    for (int s = 0; s < shards(); ++s) {
+        if (shard_state(s) != ShardState::Done) return false;
+    }
+    return region_ != nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// ShardedEnsemble
+// ---------------------------------------------------------------------------
+
+ShardedEnsemble::ShardedEnsemble(const std::string& method, const ShardOptions& options)
+    : method_(method), options_(options) {
+    create_stepper(method_);  // Validates the name in the parent, not in every worker
+    if (options_.processes <= 0) options_.processes = ThreadPool::hardware_threads();
+    if (options_.shards <= 0) options_.shards = 4 * options_.processes;
+    options_.threads_per_process = std::max(1, options_.threads_per_process);
+    options_.max_attempts = std::max(1, options_.max_attempts);
+}
+
+ShardedResult ShardedEnsemble::solve(const ODESystem& system, double t0, double tf, double dt,
+                                     const std::vector<double>& y0, std::uint64_t n_members) {
+    ODE_TRACE_SCOPE_CAT("sharded_ensemble_solve", "cpu");
+    const Clock::time_point started = Clock::now();
+
+    const int dim = system.dimension;
+    if (n_members == 0 || y0.size() != n_members * static_cast<std::uint64_t>(dim)) {
+        throw std::invalid_argument("Ensemble initial state size does not match n_members * dimension");
+    }
+    if (!(dt > 0.0) || !(tf >= t0)) {
+        throw std::invalid_argument("Need dt > 0 and tf >= t0");
+    }
+
+    const int n_shards = static_cast<int>(std::min<std::uint64_t>(options_.shards, n_members));
+    const std::uint64_t controls_end = 64 + static_cast<std::uint64_t>(n_shards) * sizeof(ShardControl);
+    const std::uint64_t data_offset = (controls_end + 63) / 64 * 64;
+    const size_t region_bytes = data_offset + n_members * dim * sizeof(double);
+
+    // Region setup. The name only lives as long as someone asked for it.
+    static std::atomic<int> region_counter{0};
+    ShardedResult result;
+    std::string name = options_.shm_name;
+    if (name.empty()) {
+        name = "/ode_shards_" + std::to_string(::getpid()) + "_" + std::to_string(region_counter++);
+    } else if (name[0] != '/') {
+        name = "/" + name;
+    }
+    int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("shm_open(" + name + ") failed: " + std::strerror(errno));
+    }
+    void* region = MAP_FAILED;
+    if (::ftruncate(fd, region_bytes) == 0) {
+        region = ::mmap(nullptr, region_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (options_.shm_name.empty() || region == MAP_FAILED) {
+        ::shm_unlink(name.c_str());
+    } else {
+        result.shm_name_ = name;
+    }
+    if (region == MAP_FAILED) {
+        throw std::runtime_error("Cannot map a " + std::to_string(region_bytes) + "-byte result region");
+    }
+    result.region_ = region;
+    result.region_bytes_ = region_bytes;
+    result.members_ = n_members;
+    result.dimension_ = dim;
+
+    RegionHeader* header = header_of(region);
+    std::memcpy(header->magic, kRegionMagic, sizeof(kRegionMagic));
+    header->dimension = dim;
+    header->n_shards = static_cast<std::uint32_t>(n_shards);
+    header->members = n_members;
+    header->data_offset = data_offset;
+    result.data_ = data_of(region);
+
+    ShardControl* controls = controls_of(region);
+    for (int s = 0; s < n_shards; ++s) {
+        ShardControl* control = new (&controls[s]) ShardControl;
+        control->state.store(static_cast<std::uint32_t>(ShardState::Pending));
+        control->attempts.store(0);
+        control->pid.store(0);
+        control->begin = n_members * s / n_shards;
+        control->end = n_members * (s + 1) / n_shards;
+    }
+
+    ShardStats& stats = result.stats_;
+    stats.shards = n_shards;
+    stats.processes = std::min(options_.processes, n_shards);
+
+    struct Worker {
+        int shard;
+        Clock::time_point started;
+        bool killed;
+    };
+    std::map<pid_t, Worker> running;
+    std::deque<int> pending;
+    for (int s = 0; s < n_shards; ++s) pending.push_back(s);
+
+    const auto timeout = std::chrono::duration<double>(options_.shard_timeout_seconds);
+    while (!pending.empty() || !running.empty()) {
+        while (static_cast<int>(running.size()) < stats.processes && !pending.empty()) {
+            const int shard = pending.front();
+            pending.pop_front();
+            ShardControl& control = controls[shard];
+            control.attempts.fetch_add(1);
+            control.state.store(static_cast<std::uint32_t>(ShardState::Running));
+
+            const pid_t pid = ::fork();
+            if (pid == 0) {
+                run_worker(region, shard, method_, options_.threads_per_process, system, t0, tf, dt, y0);
+            }
+            if (pid < 0) {
+                // Out of processes for now: retry when a worker finishes
+                control.attempts.fetch_sub(1);
+                control.state.store(static_cast<std::uint32_t>(ShardState::Pending));
+                pending.push_front(shard);
+                if (running.empty()) {
+                    throw std::runtime_error(std::string("fork() failed: ") + std::strerror(errno));
+                }
+                break;
+            }
+            control.pid.store(pid);
+            running[pid] = Worker{shard, Clock::now(), false};
+            stats.forks++;
+        }
+
+        // Reap only our own workers, never other children of this process
+        bool reaped = false;
+        for (auto it = running.begin(); it != running.end();) {
+            int status = 0;
+            const pid_t pid = ::waitpid(it->first, &status, WNOHANG);
+            if (pid == 0) {
+                if (options_.shard_timeout_seconds > 0.0 && !it->second.killed &&
+                    Clock::now() - it->second.started > timeout) {
+                    ::kill(it->first, SIGKILL);
+                    it->second.killed = true;
+                    stats.timeouts++;
+                }
+                ++it;
+                continue;
+            }
+
+            ShardControl& control = controls[it->second.shard];
+            control.pid.store(0);
+            if (control.state.load(std::memory_order_acquire) != static_cast<std::uint32_t>(ShardState::Done)) {
+                if (!it->second.killed) stats.crashes++;
+                if (static_cast<int>(control.attempts.load()) < options_.max_attempts) {
+                    control.state.store(static_cast<std::uint32_t>(ShardState::Pending));
+                    pending.push_back(it->second.shard);
+                    stats.retries++;
+                } else {
+                    control.state.store(static_cast<std::uint32_t>(ShardState::Failed));
+                    std::fill(data_of(region) + control.begin * dim, data_of(region) + control.end * dim,
+                              std::numeric_limits<double>::quiet_NaN());
+                }
+            }
+            it = running.erase(it);
+            reaped = true;
+        }
+        if (!reaped && !running.empty()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    }
+
+    stats.seconds = std::chrono::duration<double>(Clock::now() - started).count();
+    return result;
+}
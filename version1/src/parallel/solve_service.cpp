@@ -0,0 +1,253 @@
+#include "../../include/solve_service.h"
+#include "../../include/gpu_euler_backend.h"
+#include "../../include/gpu_executor.h"
+#include "../../include/threaded_cpu_backend.h"
+#include "../../include/trace.h"
+#include <chrono>
+#include <iostream>
+
+namespace detail {
+
+struct SolveJob {
+    std::uint64_t id = 0;
+    int priority = 0;
+    ODESystem system;
+    SolveOptions options;
+    std::string backend;   // Lane-specific backend key chosen at submit
+    std::promise<SolveResult> promise;
+    std::atomic<JobStatus> status{JobStatus::Queued};
+    std::chrono::steady_clock::time_point submitted;
+};
+
+}  // namespace detail
+
+namespace {
+
+double seconds_between(std::chrono::steady_clock::time_point a,
+                       std::chrono::steady_clock::time_point b) {
+    return std::chrono::duration<double>(b - a).count();
+}
+
+bool try_cancel(detail::SolveJob& job) {
+    JobStatus expected = JobStatus::Queued;
+    if (!job.status.compare_exchange_strong(expected, JobStatus::Cancelled)) {
+        return false;
+    }
+    job.promise.set_exception(std::make_exception_ptr(SolveCancelled()));
+    return true;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// SolveHandle
+// ---------------------------------------------------------------------------
+
+std::uint64_t SolveHandle::id() const {
+    return job_ ? job_->id : 0;
+}
+
+JobStatus SolveHandle::status() const {
+    return job_ ? job_->status.load() : JobStatus::Cancelled;
+}
+
+bool SolveHandle::cancel() {
+    return job_ && try_cancel(*job_);
+}
+
+// ---------------------------------------------------------------------------
+// SolveService
+// ---------------------------------------------------------------------------
+
+bool SolveService::JobOrder::operator()(const JobPtr& a, const JobPtr& b) const {
+    // priority_queue pops the "largest": higher priority, then lower id
+    if (a->priority != b->priority) return a->priority < b->priority;
+    return a->id > b->id;
+}
+
+SolveService::SolveService(int cpu_workers, const CostCalibration& calibration)
+    : calibration_(calibration), shared_pool_(), 
+      euler_planner_("euler", shared_pool_, calibration),
+      rk45_planner_("rk45", shared_pool_, calibration),
+      stopping_(false), gpu_used_(false), next_sequence_(1) {
+    euler_planner_.set_verbose(false);
+    rk45_planner_.set_verbose(false);
+
+    int n_workers = cpu_workers > 0 ? cpu_workers : ThreadPool::hardware_threads();
+    for (int i = 0; i < n_workers; ++i) {
+        cpu_workers_.emplace_back([this, i]() { cpu_worker_loop(i); });
+    }
+}
+
+SolveService::~SolveService() {
+    bool gpu_used;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stopping_ = true;
+        gpu_used = gpu_used_;
+        for (JobQueue* queue : {&cpu_queue_, &gpu_queue_}) {
+            while (!queue->empty()) {
+                try_cancel(*queue->top());
+                queue->pop();
+            }
+        }
+    }
+    cpu_cv_.notify_all();
+
+    for (auto& worker : cpu_workers_) {
+        worker.join();
+    }
+    // The executor runs commands in order, so this waits for every GPU job
+    // posted before it; the backend's GL objects die on the GL thread. A
+    // service that never had a GPU job leaves the executor thread unstarted.
+    if (gpu_used) {
+        GPUExecutor::instance().run_on_gpu_thread([this]() { gpu_.reset(); });
+    }
+}
+
+SolveHandle SolveService::submit(const ODESystem& system, const SolveOptions& options) {
+    if (options.method != "euler" && options.method != "rk45") {
+        throw std::invalid_argument("Unknown stepper method: " + options.method);
+    }
+
+    auto job = std::make_shared<detail::SolveJob>();
+    job->priority = options.priority;
+    job->system = system;
+    job->options = options;
+    if (job->options.y0.empty()) {
+        job->options.y0 = system.initial_conditions;
+    }
+    job->submitted = std::chrono::steady_clock::now();
+
+    if (options.backend == "auto") {
+        std::lock_guard<std::mutex> lock(planner_mutex_);
+        AutoDispatcher& planner = options.method == "euler" ? euler_planner_ : rk45_planner_;
+        std::string chosen = planner.plan(system, options.t0, options.tf, options.dt).backend;
+        job->backend = chosen == "GPU_Euler" ? "gpu"
+                     : chosen.rfind("CPU_Threaded", 0) == 0 ? "cpu_threaded" : "cpu";
+    } else if (options.backend == "cpu" || options.backend == "cpu_threaded") {
+        job->backend = options.backend;
+    } else if (options.backend == "gpu") {
+        if (options.method != "euler") {
+            throw std::invalid_argument("GPU backend only supports the euler method");
+        }
+        job->backend = "gpu";
+    } else {
+        throw std::invalid_argument("Unknown backend: " + options.backend);
+    }
+
+    std::future<SolveResult> future = job->promise.get_future();
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (stopping_) {
+            throw std::runtime_error("SolveService is shutting down");
+        }
+        job->id = next_sequence_++;
+        (job->backend == "gpu" ? gpu_queue_ : cpu_queue_).push(job);
+        gpu_used_ = gpu_used_ || job->backend == "gpu";
+    }
+    if (job->backend == "gpu") {
+        // One executor command per job; it runs whichever GPU job has the
+        // highest priority by then, so ordering is still by priority
+        GPUExecutor::instance().submit([this]() { run_next_gpu_job(); });
+    } else {
+        cpu_cv_.notify_one();
+    }
+
+    return SolveHandle(job, std::move(future));
+}
+
+size_t SolveService::queued_jobs() const {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    return cpu_queue_.size() + gpu_queue_.size();
+}
+
+SolveService::JobPtr SolveService::next_job(JobQueue& queue, std::condition_variable& cv) {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    while (true) {
+        cv.wait(lock, [&]() { return stopping_ || !queue.empty(); });
+        if (queue.empty()) {
+            return nullptr;  // Stopping
+        }
+
+        JobPtr job = queue.top();
+        queue.pop();
+        // Cancelled jobs stay in the queue until they surface here
+        if (job->status.load() == JobStatus::Queued) {
+            return job;
+        }
+    }
+}
+
+void SolveService::run_job(const JobPtr& job, SolverBase& backend, const std::string& label) {
+    JobStatus expected = JobStatus::Queued;
+    if (!job->status.compare_exchange_strong(expected, JobStatus::Running)) {
+        return;  // Cancelled between dequeue and start
+    }
+
+    ODE_TRACE_SCOPE_CAT("service_job", "service");
+
+    auto started = std::chrono::steady_clock::now();
+    SolveResult result;
+    result.backend = label;
+    result.queue_seconds = seconds_between(job->submitted, started);
+
+    try {
+        const SolveOptions& options = job->options;
+        backend.solve(job->system, options.t0, options.tf, options.dt, options.y0, result.solution);
+        if (result.solution.empty()) {
+            throw std::runtime_error(backend.name() + " produced no solution");
+        }
+        result.run_seconds = seconds_between(started, std::chrono::steady_clock::now());
+        job->status.store(JobStatus::Done);
+        job->promise.set_value(std::move(result));
+    } catch (...) {
+        job->status.store(JobStatus::Done);
+        job->promise.set_exception(std::current_exception());
+    }
+}
+
+void SolveService::cpu_worker_loop(int) {
+    ODE_TRACE_THREAD_NAME("solve_cpu");
+
+    // Backends are not thread-safe: every worker has its own. "cpu" jobs run
+    // on this thread alone, "cpu_threaded" ones share the service pool.
+    ThreadPool private_pool(1);
+    ThreadedCPUBackend single_euler("euler", private_pool);
+    ThreadedCPUBackend single_rk45("rk45", private_pool);
+    ThreadedCPUBackend threaded_euler("euler", shared_pool_);
+    ThreadedCPUBackend threaded_rk45("rk45", shared_pool_);
+
+    while (JobPtr job = next_job(cpu_queue_, cpu_cv_)) {
+        bool euler = job->options.method == "euler";
+        if (job->backend == "cpu_threaded") {
+            ThreadedCPUBackend& backend = euler ? threaded_euler : threaded_rk45;
+            run_job(job, backend, backend.name());
+        } else {
+            // Same names as AutoDispatcher's candidates
+            run_job(job, euler ? single_euler : single_rk45, "CPU_Single_" + job->options.method);
+        }
+    }
+}
+
+void SolveService::run_next_gpu_job() {
+    JobPtr job;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        // Cancelled jobs stay in the queue until they surface here
+        while (!gpu_queue_.empty() && !job) {
+            if (gpu_queue_.top()->status.load() == JobStatus::Queued) {
+                job = gpu_queue_.top();
+            }
+            gpu_queue_.pop();
+        }
+    }
+    if (!job) {
+        return;  // Cancelled, or already run by an earlier command
+    }
+
+    if (!gpu_) {
+        gpu_ = std::make_unique<GPUEulerBackend>();
+    }
+    run_job(job, *gpu_, gpu_->name());
+}
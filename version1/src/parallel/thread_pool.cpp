@@ -0,0 +1,138 @@
+#include "../../include/thread_pool.h"
+#include <algorithm>
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+
+namespace {
+
+// Iterations a worker busy-waits for the next job before sleeping
+constexpr int kSpinIterations = 2000;
+
+bool pin_current_thread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % ThreadPool::hardware_threads(), &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+}  // namespace
+
+int ThreadPool::hardware_threads() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n > 0 ? static_cast<int>(n) : 1;
+}
+
+ThreadPool::ThreadPool(int n_threads, bool pin_threads)
+    : n_threads_(n_threads > 0 ? n_threads : hardware_threads()), pinned_(pin_threads),
+      fn_(nullptr), ctx_(nullptr), begin_(0), end_(0), chunk_(0), active_workers_(0),
+      generation_(0), remaining_(0), stop_(false) {
+    if (pinned_ && !pin_current_thread(0)) {
+        std::cerr << "ThreadPool: failed to pin calling thread" << std::endl;
+    }
+
+    workers_.reserve(n_threads_ - 1);
+    for (int i = 1; i < n_threads_; ++i) {
+        workers_.emplace_back([this, i]() { worker_loop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stop_.store(true, std::memory_order_release);
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+    wake_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::run_chunk(int index) {
+    long long chunk_begin = begin_ + index * chunk_;
+    long long chunk_end = std::min(end_, chunk_begin + chunk_);
+    if (chunk_begin >= chunk_end) return;
+
+    try {
+        fn_(ctx_, chunk_begin, chunk_end, index);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        if (!error_) error_ = std::current_exception();
+    }
+}
+
+void ThreadPool::worker_loop(int index) {
+    if (pinned_ && !pin_current_thread(index)) {
+        std::cerr << "ThreadPool: failed to pin worker " << index << std::endl;
+    }
+
+    unsigned seen = 0;
+    while (true) {
+        // Spin first: stage-by-stage dispatch arrives microseconds apart
+        unsigned current = generation_.load(std::memory_order_acquire);
+        for (int spin = 0; current == seen && spin < kSpinIterations; ++spin) {
+            std::this_thread::yield();
+            current = generation_.load(std::memory_order_acquire);
+        }
+        if (current == seen) {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait(lock, [&]() {
+                return generation_.load(std::memory_order_acquire) != seen;
+            });
+            current = generation_.load(std::memory_order_acquire);
+        }
+        seen = current;
+
+        if (stop_.load(std::memory_order_acquire)) return;
+
+        // Idle workers still check in so the caller never rewrites the job
+        // fields while a worker may be reading them
+        if (index < active_workers_) {
+            run_chunk(index);
+        }
+        remaining_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+void ThreadPool::run(long long begin, long long end, int max_workers, ChunkFn fn, void* ctx) {
+    if (end <= begin) return;
+
+    std::lock_guard<std::mutex> submit_lock(submit_mutex_);
+
+    long long n_items = end - begin;
+    int workers = max_workers > 0 ? std::min(max_workers, n_threads_) : n_threads_;
+    workers = static_cast<int>(std::min<long long>(workers, n_items));
+
+    fn_ = fn;
+    ctx_ = ctx;
+    begin_ = begin;
+    end_ = end;
+    chunk_ = (n_items + workers - 1) / workers;
+    active_workers_ = workers;
+    error_ = nullptr;
+
+    bool fork = workers > 1;
+    if (fork) {
+        remaining_.store(n_threads_ - 1, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            generation_.fetch_add(1, std::memory_order_release);
+        }
+        wake_cv_.notify_all();
+    }
+
+    run_chunk(0);
+
+    if (fork) {
+        while (remaining_.load(std::memory_order_acquire) > 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,317 @@
+#include "../../include/fft.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+const double kTwoPi = 2.0 * std::acos(-1.0);
+
+inline Complex root(long long k, long long n) {
+    const double angle = -kTwoPi * static_cast<double>(k) / static_cast<double>(n);
+    return Complex(std::cos(angle), std::sin(angle));
+}
+
+int log2_exact(int n) {
+    int bits = 0;
+    while ((1 << bits) < n) ++bits;
+    return bits;
+}
+
+void check_size(int n, int minimum, const char* what) {
+    if (n < minimum || n > FFTPlan::kMaxSize || (n & (n - 1)) != 0) {
+        throw std::invalid_argument(std::string(what) + " size must be a power of two in [" +
+                                    std::to_string(minimum) + ", 2^26], got " + std::to_string(n));
+    }
+}
+
+// Per-thread scratch, grown on demand; one buffer per role because the
+// passes nest (2D columns -> four-step -> Stockham rows)
+std::vector<Complex>& scratch(int role, size_t size) {
+    thread_local std::vector<Complex> buffers[6];
+    if (buffers[role].size() < size) buffers[role].resize(size);
+    return buffers[role];
+}
+
+enum ScratchRole { kStockham = 0, kFourStep = 1, kRealHalf = 2, kColumns = 3, kField = 4, kFourStepOut = 5 };
+
+// Strided column access gathers this many complex values (four cache
+// lines) per row visited, amortizing the TLB miss of each large stride
+constexpr int kColumnBlock = 16;
+
+// out (cols x rows) = in (rows x cols) transposed, in square tiles
+void transpose(const Complex* in, Complex* out, int rows, int cols) {
+    constexpr int kTile = kColumnBlock;
+    for (int r0 = 0; r0 < rows; r0 += kTile) {
+        const int r1 = std::min(rows, r0 + kTile);
+        for (int c0 = 0; c0 < cols; c0 += kTile) {
+            const int c1 = std::min(cols, c0 + kTile);
+            for (int r = r0; r < r1; ++r) {
+                for (int c = c0; c < c1; ++c) {
+                    out[static_cast<long long>(c) * rows + r] = in[static_cast<long long>(r) * cols + c];
+                }
+            }
+        }
+    }
+}
+
+// Plans are built outside the lock: four-step and real plans fetch their
+// sub-plans from the cache while being constructed
+template <typename Plan>
+std::shared_ptr<const Plan> cached_plan(int n) {
+    static std::mutex mutex;
+    static std::map<int, std::shared_ptr<const Plan>> plans;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = plans.find(n);
+        if (it != plans.end()) return it->second;
+    }
+    auto plan = std::make_shared<const Plan>(n);
+    std::lock_guard<std::mutex> lock(mutex);
+    return plans.emplace(n, std::move(plan)).first->second;
+}
+
+}  // namespace
+
+FFTPlan::FFTPlan(int n) : n_(n) {
+    check_size(n, 1, "FFT");
+    if (n > kDirectMax) {
+        const int bits = log2_exact(n);
+        n1_ = 1 << (bits / 2);
+        n2_ = n / n1_;
+        n1_plan_ = get(n1_);
+        n2_plan_ = get(n2_);
+        fine_bits_ = (bits + 1) / 2;
+        fine_.resize(size_t(1) << fine_bits_);
+        coarse_.resize((size_t(n) >> fine_bits_) + 1);
+        for (size_t m = 0; m < fine_.size(); ++m) fine_[m] = root(m, n);
+        for (size_t m = 0; m < coarse_.size(); ++m) coarse_[m] = root(static_cast<long long>(m) << fine_bits_, n);
+        return;
+    }
+
+    // Stockham passes: split length L into 4 (or 2) sub-transforms of L / 4
+    // at stride s, twiddles w_L^p, w_L^2p, w_L^3p for p < L / 4
+    int length = n;
+    int stride = 1;
+    while (length >= 4) {
+        passes_.push_back(Pass{4, length, stride, twiddles_.size()});
+        for (int p = 0; p < length / 4; ++p) {
+            twiddles_.push_back(root(p, length));
+            twiddles_.push_back(root(2 * p, length));
+            twiddles_.push_back(root(3 * p, length));
+        }
+        length /= 4;
+        stride *= 4;
+    }
+    if (length == 2) {
+        passes_.push_back(Pass{2, 2, stride, twiddles_.size()});
+    }
+}
+
+std::shared_ptr<const FFTPlan> FFTPlan::get(int n) {
+    return cached_plan<FFTPlan>(n);
+}
+
+void FFTPlan::forward(Complex* data) const {
+    if (n1_ > 0) {
+        four_step(data);
+    } else {
+        stockham(data);
+    }
+}
+
+void FFTPlan::inverse(Complex* data) const {
+    // ifft(x) = conj(fft(conj(x))) / n
+    for (int i = 0; i < n_; ++i) data[i] = std::conj(data[i]);
+    forward(data);
+    const double scale = 1.0 / n_;
+    for (int i = 0; i < n_; ++i) data[i] = Complex(data[i].real() * scale, -data[i].imag() * scale);
+}
+
+void FFTPlan::stockham(Complex* data) const {
+    if (passes_.empty()) return;
+    Complex* in = data;
+    Complex* out = scratch(kStockham, n_).data();
+
+    for (const Pass& pass : passes_) {
+        const Complex* w = twiddles_.data() + pass.twiddle;
+        const long long s = pass.stride;
+        if (pass.radix == 4) {
+            const int m = pass.length / 4;
+            for (int p = 0; p < m; ++p) {
+                const Complex w1 = w[3 * p], w2 = w[3 * p + 1], w3 = w[3 * p + 2];
+                const Complex* x0 = in + s * p;
+                const Complex* x1 = in + s * (p + m);
+                const Complex* x2 = in + s * (p + 2 * m);
+                const Complex* x3 = in + s * (p + 3 * m);
+                Complex* y = out + s * 4 * p;
+                for (long long q = 0; q < s; ++q) {
+                    const Complex a = x0[q], b = x1[q], c = x2[q], d = x3[q];
+                    const Complex apc = a + c, amc = a - c, bpd = b + d;
+                    // -i (b - d)
+                    const Complex jbmd(b.imag() - d.imag(), d.real() - b.real());
+                    y[q] = apc + bpd;
+                    y[q + s] = multiply(amc + jbmd, w1);
+                    y[q + 2 * s] = multiply(apc - bpd, w2);
+                    y[q + 3 * s] = multiply(amc - jbmd, w3);
+                }
+            }
+        } else {
+            // Final length-2 pass, twiddle 1
+            for (long long q = 0; q < s; ++q) {
+                const Complex a = in[q], b = in[q + s];
+                out[q] = a + b;
+                out[q + s] = a - b;
+            }
+        }
+        std::swap(in, out);
+    }
+    if (in != data) std::copy(in, in + n_, data);
+}
+
+Complex FFTPlan::step_twiddle(long long m) const {
+    return multiply(coarse_[m >> fine_bits_], fine_[m & ((1LL << fine_bits_) - 1)]);
+}
+
+void FFTPlan::four_step(Complex* data) const {
+    // x[j1 + n1 j2] viewed as an n2 x n1 matrix; X[k2 + n2 k1] =
+    //   sum_j1 w_n1^(j1 k1) w_n^(j1 k2) sum_j2 w_n2^(j2 k2) x[j1 + n1 j2]
+    // Columns are transformed kColumnBlock at a time through a contiguous
+    // buffer, rows in place, then one blocked transpose
+    constexpr int kBlock = kColumnBlock;
+    Complex* buffer = scratch(kFourStep, static_cast<size_t>(kBlock) * n2_).data();
+    for (int j0 = 0; j0 < n1_; j0 += kBlock) {
+        for (int j2 = 0; j2 < n2_; ++j2) {
+            const Complex* row = data + static_cast<long long>(j2) * n1_ + j0;
+            for (int b = 0; b < kBlock; ++b) buffer[b * n2_ + j2] = row[b];
+        }
+        for (int b = 0; b < kBlock; ++b) {
+            Complex* column = buffer + b * n2_;
+            n2_plan_->forward(column);
+            for (int k2 = 1; k2 < n2_; ++k2) {
+                column[k2] = multiply(column[k2], step_twiddle(static_cast<long long>(j0 + b) * k2));
+            }
+        }
+        for (int k2 = 0; k2 < n2_; ++k2) {
+            Complex* row = data + static_cast<long long>(k2) * n1_ + j0;
+            for (int b = 0; b < kBlock; ++b) row[b] = buffer[b * n2_ + k2];
+        }
+    }
+    for (int k2 = 0; k2 < n2_; ++k2) {
+        n1_plan_->forward(data + static_cast<long long>(k2) * n1_);   // data[k2][k1]
+    }
+    Complex* work = scratch(kFourStepOut, n_).data();
+    transpose(data, work, n2_, n1_);                                  // work[k1][k2]
+    std::copy(work, work + n_, data);
+}
+
+RealFFTPlan::RealFFTPlan(int n) : n_(n) {
+    check_size(n, 2, "Real FFT");
+    half_ = FFTPlan::get(n / 2);
+    twiddles_.resize(n / 2);
+    for (int k = 0; k < n / 2; ++k) twiddles_[k] = root(k, n);
+}
+
+std::shared_ptr<const RealFFTPlan> RealFFTPlan::get(int n) {
+    return cached_plan<RealFFTPlan>(n);
+}
+
+void RealFFTPlan::forward(const double* in, Complex* out) const {
+    // z[m] = x[2m] + i x[2m + 1]; with E, O the transforms of the even and
+    // odd samples, Z = E + i O and X[k] = E[k] + w^k O[k]
+    const int half = n_ / 2;
+    Complex* z = out;   // out has half + 1 slots
+    for (int m = 0; m < half; ++m) z[m] = Complex(in[2 * m], in[2 * m + 1]);
+    half_->forward(z);
+
+    const Complex z0 = z[0];
+    out[0] = Complex(z0.real() + z0.imag(), 0.0);
+    out[half] = Complex(z0.real() - z0.imag(), 0.0);
+    for (int k = 1; k <= half / 2; ++k) {
+        const int r = half - k;
+        const Complex zk = z[k], zr = z[r];
+        // Pairs (k, r) are rewritten together
+        const Complex ek = 0.5 * (zk + std::conj(zr));
+        const Complex ok(0.5 * (zk.imag() + zr.imag()), -0.5 * (zk.real() - zr.real()));
+        const Complex er = std::conj(ek);
+        const Complex orr = std::conj(ok);
+        out[k] = ek + multiply(twiddles_[k], ok);
+        out[r] = er + multiply(twiddles_[r], orr);
+    }
+}
+
+void RealFFTPlan::inverse(const Complex* in, double* out) const {
+    const int half = n_ / 2;
+    Complex* z = scratch(kRealHalf, half).data();
+
+    // E[k] = (X[k] + conj(X[h - k])) / 2, O[k] = (X[k] - conj(X[h - k])) conj(w^k) / 2
+    const double x0 = in[0].real(), xh = in[half].real();
+    z[0] = Complex(0.5 * (x0 + xh), 0.5 * (x0 - xh));
+    for (int k = 1; k < half; ++k) {
+        const Complex xk = in[k], xr = std::conj(in[half - k]);
+        const Complex e = 0.5 * (xk + xr);
+        const Complex o = multiply(0.5 * (xk - xr), std::conj(twiddles_[k]));
+        z[k] = e + Complex(-o.imag(), o.real());
+    }
+    half_->inverse(z);
+    for (int m = 0; m < half; ++m) {
+        out[2 * m] = z[m].real();
+        out[2 * m + 1] = z[m].imag();
+    }
+}
+
+RealFFT2D::RealFFT2D(int nx, int ny) {
+    check_size(ny, 1, "2D FFT column");
+    rows_ = RealFFTPlan::get(nx);
+    columns_ = FFTPlan::get(ny);
+}
+
+template <bool Forward>
+void RealFFT2D::columns(Complex* data) const {
+    // Gather kColumnBlock columns, transform each contiguously, scatter back
+    constexpr int kBlock = kColumnBlock;
+    const int ny = columns_->size();
+    if (ny == 1) return;
+    const int width = rows_->modes();
+    Complex* buffer = scratch(kColumns, static_cast<size_t>(kBlock) * ny).data();
+    for (int c0 = 0; c0 < width; c0 += kBlock) {
+        const int count = std::min(kBlock, width - c0);
+        for (int j = 0; j < ny; ++j) {
+            const Complex* row = data + static_cast<long long>(j) * width + c0;
+            for (int b = 0; b < count; ++b) buffer[b * ny + j] = row[b];
+        }
+        for (int b = 0; b < count; ++b) {
+            if (Forward) {
+                columns_->forward(buffer + b * ny);
+            } else {
+                columns_->inverse(buffer + b * ny);
+            }
+        }
+        for (int j = 0; j < ny; ++j) {
+            Complex* row = data + static_cast<long long>(j) * width + c0;
+            for (int b = 0; b < count; ++b) row[b] = buffer[b * ny + j];
+        }
+    }
+}
+
+void RealFFT2D::forward(const double* in, Complex* out) const {
+    const int nx = rows_->size(), width = rows_->modes();
+    for (int j = 0; j < columns_->size(); ++j) {
+        rows_->forward(in + static_cast<long long>(j) * nx, out + static_cast<long long>(j) * width);
+    }
+    columns<true>(out);
+}
+
+void RealFFT2D::inverse(const Complex* in, double* out) const {
+    const int nx = rows_->size(), width = rows_->modes();
+    const int ny = columns_->size();
+    std::vector<Complex>& copy = scratch(kField, static_cast<size_t>(width) * ny);
+    std::copy(in, in + static_cast<long long>(width) * ny, copy.begin());
+    columns<false>(copy.data());
+    for (int j = 0; j < ny; ++j) {
+        rows_->inverse(copy.data() + static_cast<long long>(j) * width, out + static_cast<long long>(j) * nx);
+    }
+}
@@ -0,0 +1,410 @@
+#include "../../include/method_of_lines.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+
+constexpr int kMaxComponents = 16;
+
+// Padded row length: whole cache lines, and never a multiple of 4 KiB
+int padded_row(int nx) {
+    int stride = (nx + 7) / 8 * 8;
+    if (stride % 512 == 0) stride += 8;
+    return stride;
+}
+
+// out[i] += w u[i-1] + e u[i+1] + c u[i] + s S[i] + n N[i] + b B[i] + f F[i]
+// for i in [lo, hi), with u[-1] = left and u[nx] = right. Axes beyond
+// `dims` are skipped, so 1D and 2D rows do no work for them.
+struct Stencil {
+    double w = 0.0, e = 0.0, c = 0.0, s = 0.0, n = 0.0, b = 0.0, f = 0.0;
+};
+
+template <int Dims>
+void apply_row(const Stencil& st, const double* __restrict u,
+               const double* __restrict S, const double* __restrict N,
+               const double* __restrict B, const double* __restrict F,
+               double left, double right, int nx, int lo, int hi, double* __restrict out) {
+    auto point = [&](int i, double west, double east) {
+        double value = st.w * west + st.e * east + st.c * u[i];
+        if (Dims >= 2) value += st.s * S[i] + st.n * N[i];
+        if (Dims >= 3) value += st.b * B[i] + st.f * F[i];
+        out[i] += value;
+    };
+    if (lo >= hi) return;
+    if (lo == 0) point(0, left, nx > 1 ? u[1] : right);
+    const int first = std::max(lo, 1);
+    const int last = std::min(hi, nx - 1);
+    for (int i = first; i < last; ++i) {
+        double value = st.w * u[i - 1] + st.e * u[i + 1] + st.c * u[i];
+        if (Dims >= 2) value += st.s * S[i] + st.n * N[i];
+        if (Dims >= 3) value += st.b * B[i] + st.f * F[i];
+        out[i] += value;
+    }
+    if (hi == nx && nx > 1) point(nx - 1, u[nx - 2], right);
+}
+
+// Stencil over row (j, k) of one component field `u`, accumulated into out
+// for i in [lo, hi); `ghost` is the Dirichlet value row of the component
+void stencil_row(const Grid& grid, const Stencil& st, const double* u, const double* ghost,
+                 double ghost_value, const std::array<Boundary, 3>& boundary,
+                 int j, int k, int lo, int hi, double* out) {
+    const int nx = grid.points(0);
+    const double* centre = u + grid.index(0, j, k);
+
+    // Neighbouring rows along y and z, or the Dirichlet ghost row
+    auto row_at = [&](int axis, int side) -> const double* {
+        std::array<int, 3> p{0, j, k};
+        const int n = grid.points(axis);
+        int q = p[axis] + side;
+        if (q < 0 || q >= n) {
+            switch (boundary[axis]) {
+                case Boundary::Periodic: q = (q + n) % n; break;
+                case Boundary::Neumann: q = p[axis] - side; break;
+                case Boundary::Dirichlet: return ghost;
+            }
+        }
+        p[axis] = q;
+        return u + grid.index(0, p[1], p[2]);
+    };
+    auto x_ghost = [&](int side) {
+        switch (boundary[0]) {
+            case Boundary::Periodic: return side < 0 ? centre[nx - 1] : centre[0];
+            case Boundary::Neumann: return side < 0 ? centre[1] : centre[nx - 2];
+            case Boundary::Dirichlet: break;
+        }
+        return ghost_value;
+    };
+
+    const double left = x_ghost(-1);
+    const double right = x_ghost(+1);
+    switch (grid.dimensions()) {
+        case 1:
+            apply_row<1>(st, centre, nullptr, nullptr, nullptr, nullptr, left, right, nx, lo, hi, out);
+            break;
+        case 2:
+            apply_row<2>(st, centre, row_at(1, -1), row_at(1, +1), nullptr, nullptr, left, right, nx, lo, hi, out);
+            break;
+        default:
+            apply_row<3>(st, centre, row_at(1, -1), row_at(1, +1), row_at(2, -1), row_at(2, +1),
+                         left, right, nx, lo, hi, out);
+            break;
+    }
+}
+
+}  // namespace
+
+Grid::Grid(int nx, double lx) : Grid(nx, 1, 1, lx, 1.0, 1.0) {
+    dimensions_ = 1;
+}
+
+Grid::Grid(int nx, int ny, double lx, double ly) : Grid(nx, ny, 1, lx, ly, 1.0) {
+    dimensions_ = 2;
+}
+
+Grid::Grid(int nx, int ny, int nz, double lx, double ly, double lz)
+    : dimensions_(3), n_{nx, ny, nz}, length_{lx, ly, lz}, row_stride_(0) {
+    for (int axis = 0; axis < 3; ++axis) {
+        if (n_[axis] < 1 || !(length_[axis] > 0.0)) {
+            throw std::invalid_argument("Grid needs at least one point and a positive length per axis");
+        }
+    }
+    row_stride_ = padded_row(nx);
+}
+
+MethodOfLines::MethodOfLines(const Grid& grid, int components)
+    : grid_(grid),
+      components_(components),
+      boundary_{Boundary::Periodic, Boundary::Periodic, Boundary::Periodic},
+      boundary_value_(components > 0 ? components : 0, 0.0),
+      diffusion_(components > 0 ? components : 0, 0.0),
+      velocity_(components > 0 ? components : 0, std::array<double, 3>{0.0, 0.0, 0.0}) {
+    if (components < 1 || components > kMaxComponents) {
+        throw std::invalid_argument("Method of lines needs 1 to " + std::to_string(kMaxComponents) + " components");
+    }
+    ghost_rows_.assign(static_cast<size_t>(components) * grid_.row_stride(), 0.0);
+}
+
+void MethodOfLines::set_boundary(int axis, Boundary kind) {
+    if (axis < 0 || axis >= grid_.dimensions()) {
+        throw std::invalid_argument("Boundary axis " + std::to_string(axis) + " out of range");
+    }
+    if (kind == Boundary::Neumann && grid_.points(axis) < 2) {
+        throw std::invalid_argument("Neumann boundaries need at least two points on the axis");
+    }
+    boundary_[axis] = kind;
+}
+
+void MethodOfLines::set_boundary_value(int component, double value) {
+    if (component < 0 || component >= components_) {
+        throw std::invalid_argument("Component " + std::to_string(component) + " out of range");
+    }
+    boundary_value_[component] = value;
+    std::fill(ghost_rows_.begin() + static_cast<long long>(component) * grid_.row_stride(),
+              ghost_rows_.begin() + static_cast<long long>(component + 1) * grid_.row_stride(), value);
+}
+
+void MethodOfLines::set_diffusion(int component, double coefficient) {
+    if (component < 0 || component >= components_) {
+        throw std::invalid_argument("Component " + std::to_string(component) + " out of range");
+    }
+    diffusion_[component] = coefficient;
+}
+
+void MethodOfLines::set_advection(int component, std::array<double, 3> velocity) {
+    if (component < 0 || component >= components_) {
+        throw std::invalid_argument("Component " + std::to_string(component) + " out of range");
+    }
+    for (int axis = grid_.dimensions(); axis < 3; ++axis) {
+        if (velocity[axis] != 0.0) {
+            throw std::invalid_argument("Advection along an axis the grid does not have");
+        }
+    }
+    velocity_[component] = velocity;
+}
+
+void MethodOfLines::set_reaction(Reaction reaction) {
+    reaction_ = std::move(reaction);
+}
+
+double MethodOfLines::spacing(int axis) const {
+    if (axis >= grid_.dimensions()) return 1.0;
+    const int n = grid_.points(axis);
+    switch (boundary_[axis]) {
+        case Boundary::Periodic: return grid_.length(axis) / n;
+        case Boundary::Dirichlet: return grid_.length(axis) / (n + 1);
+        case Boundary::Neumann: break;
+    }
+    return grid_.length(axis) / (n - 1);
+}
+
+double MethodOfLines::coordinate(int axis, int i) const {
+    const int offset = axis < grid_.dimensions() && boundary_[axis] == Boundary::Dirichlet ? 1 : 0;
+    return (i + offset) * spacing(axis);
+}
+
+// Index within a component field of the point one step along `axis`
+// (side -1 or +1), or -1 for a Dirichlet ghost
+long long MethodOfLines::neighbour(int axis, int side, int i, int j, int k) const {
+    std::array<int, 3> p{i, j, k};
+    const int n = grid_.points(axis);
+    int q = p[axis] + side;
+    if (q < 0 || q >= n) {
+        switch (boundary_[axis]) {
+            case Boundary::Periodic: q = (q + n) % n; break;
+            case Boundary::Neumann: q = p[axis] - side; break;
+            case Boundary::Dirichlet: return -1;
+        }
+    }
+    p[axis] = q;
+    return grid_.index(p[0], p[1], p[2]);
+}
+
+void MethodOfLines::row(double t, const double* y, double* dydt, int c, int j, int k, int i0, int i1) const {
+    const int nx = grid_.points(0);
+    const long long offset = grid_.index(0, j, k);
+    const long long field = grid_.field_size();
+    double* out = dydt + c * field + offset;
+
+    // Padding carries no unknowns
+    for (int i = std::max(i0, nx); i < i1; ++i) out[i] = 0.0;
+    const int hi = std::min(i1, nx);
+    if (i0 >= hi) return;
+
+    if (reaction_) {
+        const double* u[kMaxComponents];
+        for (int m = 0; m < components_; ++m) {
+            u[m] = y + m * field + offset + i0;
+        }
+        reaction_(t, c, u, out + i0, hi - i0);
+    } else {
+        std::fill(out + i0, out + hi, 0.0);
+    }
+
+    const double d = diffusion_[c];
+    const std::array<double, 3>& v = velocity_[c];
+    if (d == 0.0 && v[0] == 0.0 && v[1] == 0.0 && v[2] == 0.0) return;
+
+    // Diffusion and upwind advection folded into one linear stencil
+    Stencil st;
+    double* sides[3][2] = {{&st.w, &st.e}, {&st.s, &st.n}, {&st.b, &st.f}};
+    for (int axis = 0; axis < grid_.dimensions(); ++axis) {
+        const double h = spacing(axis);
+        const double diffusive = d / (h * h);
+        const double upwind = std::abs(v[axis]) / h;
+        *sides[axis][0] = diffusive + (v[axis] > 0.0 ? upwind : 0.0);
+        *sides[axis][1] = diffusive + (v[axis] < 0.0 ? upwind : 0.0);
+        st.c -= 2.0 * diffusive + upwind;
+    }
+    stencil_row(grid_, st, y + c * field, ghost_rows_.data() + static_cast<long long>(c) * grid_.row_stride(),
+                boundary_value_[c], boundary_, j, k, i0, hi, out);
+}
+
+void MethodOfLines::evaluate(double t, const double* y, double* dydt, long long begin, long long end) const {
+    const long long stride = grid_.row_stride();
+    const int ny = grid_.points(1);
+    const int nz = grid_.points(2);
+    const long long rows_per_component = static_cast<long long>(ny) * nz;
+    if (begin >= end) return;
+    for (long long r = begin / stride; r <= (end - 1) / stride; ++r) {
+        const int c = static_cast<int>(r / rows_per_component);
+        const long long within = r % rows_per_component;
+        const int k = static_cast<int>(within / ny);
+        const int j = static_cast<int>(within % ny);
+        const int i0 = static_cast<int>(std::max(begin - r * stride, 0LL));
+        const int i1 = static_cast<int>(std::min(end - r * stride, stride));
+        row(t, y, dydt, c, j, k, i0, i1);
+    }
+}
+
+ODESystem MethodOfLines::system(const std::string& name) const {
+    if (dimension() > INT_MAX) {
+        throw std::invalid_argument("Method-of-lines system too large for an ODESystem");
+    }
+    auto mol = std::make_shared<const MethodOfLines>(*this);
+    ODESystem system;
+    system.name = name;
+    system.dimension = static_cast<int>(dimension());
+    system.t_start = 0.0;
+    system.t_end = 1.0;
+    system.rhs_range = [mol](double t, const std::vector<double>& y, std::vector<double>& dydt, int begin, int end) {
+        mol->evaluate(t, y.data(), dydt.data(), begin, end);
+    };
+    system.rhs_inplace = [mol](double t, const std::vector<double>& y, std::vector<double>& dydt) {
+        mol->evaluate(t, y.data(), dydt.data(), 0, mol->dimension());
+    };
+    system.rhs = [mol](double t, const std::vector<double>& y) {
+        std::vector<double> dydt(y.size());
+        mol->evaluate(t, y.data(), dydt.data(), 0, mol->dimension());
+        return dydt;
+    };
+    return system;
+}
+
+std::vector<double> MethodOfLines::initial_state(const InitialValue& value) const {
+    std::vector<double> y(dimension(), 0.0);
+    for (int c = 0; c < components_; ++c) {
+        double* field = y.data() + c * grid_.field_size();
+        for (int k = 0; k < grid_.points(2); ++k) {
+            for (int j = 0; j < grid_.points(1); ++j) {
+                for (int i = 0; i < grid_.points(0); ++i) {
+                    field[grid_.index(i, j, k)] = value(c, coordinate(0, i), coordinate(1, j), coordinate(2, k));
+                }
+            }
+        }
+    }
+    return y;
+}
+
+void MethodOfLines::laplacian(int component, const double* u, double* out) const {
+    std::fill(out, out + grid_.field_size(), 0.0);
+    Stencil st;
+    double* sides[3][2] = {{&st.w, &st.e}, {&st.s, &st.n}, {&st.b, &st.f}};
+    for (int axis = 0; axis < grid_.dimensions(); ++axis) {
+        const double h = spacing(axis);
+        *sides[axis][0] = *sides[axis][1] = 1.0 / (h * h);
+        st.c -= 2.0 / (h * h);
+    }
+    const double* ghost = ghost_rows_.data() + static_cast<long long>(component) * grid_.row_stride();
+    for (int k = 0; k < grid_.points(2); ++k) {
+        for (int j = 0; j < grid_.points(1); ++j) {
+            stencil_row(grid_, st, u, ghost, boundary_value_.at(component), boundary_, j, k, 0, grid_.points(0),
+                        out + grid_.index(0, j, k));
+        }
+    }
+}
+
+void MethodOfLines::gradient(int component, int axis, const double* u, double* out) const {
+    if (axis < 0 || axis >= grid_.dimensions()) {
+        throw std::invalid_argument("Gradient axis " + std::to_string(axis) + " out of range");
+    }
+    std::fill(out, out + grid_.field_size(), 0.0);
+    Stencil st;
+    double* sides[3][2] = {{&st.w, &st.e}, {&st.s, &st.n}, {&st.b, &st.f}};
+    const double h = spacing(axis);
+    *sides[axis][0] = -0.5 / h;
+    *sides[axis][1] = 0.5 / h;
+    const double* ghost = ghost_rows_.data() + static_cast<long long>(component) * grid_.row_stride();
+    for (int k = 0; k < grid_.points(2); ++k) {
+        for (int j = 0; j < grid_.points(1); ++j) {
+            stencil_row(grid_, st, u, ghost, boundary_value_.at(component), boundary_, j, k, 0, grid_.points(0),
+                        out + grid_.index(0, j, k));
+        }
+    }
+}
+
+JacobianPattern MethodOfLines::jacobian_pattern() const {
+    JacobianPattern pattern;
+    const long long n = dimension();
+    const long long field = grid_.field_size();
+    pattern.row_start.reserve(n + 1);
+    pattern.row_start.push_back(0);
+
+    std::vector<long long> columns;
+    for (int c = 0; c < components_; ++c) {
+        const double d = diffusion_[c];
+        const std::array<double, 3>& v = velocity_[c];
+        for (int k = 0; k < grid_.points(2); ++k) {
+            for (int j = 0; j < grid_.points(1); ++j) {
+                for (int i = 0; i < grid_.row_stride(); ++i) {
+                    columns.clear();
+                    if (i < grid_.points(0)) {
+                        const long long point = grid_.index(i, j, k);
+                        const long long row = c * field + point;
+                        if (reaction_) {
+                            for (int m = 0; m < components_; ++m) columns.push_back(m * field + point);
+                        } else {
+                            columns.push_back(row);
+                        }
+                        for (int axis = 0; axis < grid_.dimensions(); ++axis) {
+                            // Upwind advection only reaches upstream
+                            const bool back = d != 0.0 || v[axis] > 0.0;
+                            const bool ahead = d != 0.0 || v[axis] < 0.0;
+                            for (int side : {-1, +1}) {
+                                if ((side < 0 && !back) || (side > 0 && !ahead)) continue;
+                                const long long q = neighbour(axis, side, i, j, k);
+                                if (q >= 0) columns.push_back(c * field + q);
+                            }
+                        }
+                        std::sort(columns.begin(), columns.end());
+                        columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+                        for (long long col : columns) {
+                            pattern.lower_bandwidth = std::max(pattern.lower_bandwidth, row - col);
+                            pattern.upper_bandwidth = std::max(pattern.upper_bandwidth, col - row);
+                        }
+                    }
+                    pattern.columns.insert(pattern.columns.end(), columns.begin(), columns.end());
+                    pattern.row_start.push_back(static_cast<long long>(pattern.columns.size()));
+                }
+            }
+        }
+    }
+    return pattern;
+}
+
+MethodOfLines MethodOfLines::brusselator_2d(int n, double a, double b, double alpha) {
+    MethodOfLines mol(Grid(n, n, 1.0, 1.0), 2);
+    mol.set_diffusion(0, alpha);
+    mol.set_diffusion(1, alpha);
+    mol.set_reaction([a, b](double, int component, const double* const* u, double* out, int count) {
+        const double* __restrict x = u[0];
+        const double* __restrict y = u[1];
+        if (component == 0) {
+            for (int i = 0; i < count; ++i) out[i] = a - (b + 1.0) * x[i] + x[i] * x[i] * y[i];
+        } else {
+            for (int i = 0; i < count; ++i) out[i] = b * x[i] - x[i] * x[i] * y[i];
+        }
+    });
+    return mol;
+}
+
+std::vector<double> MethodOfLines::brusselator_initial_state(const MethodOfLines& mol, double a, double b) {
+    const double two_pi = 2.0 * std::acos(-1.0);
+    return mol.initial_state([a, b, two_pi](int component, double x, double y, double) {
+        const double wave = std::sin(two_pi * x) * std::cos(2.0 * two_pi * y);
+        return component == 0 ? a + 0.1 * wave : b / a - 0.1 * wave;
+    });
+}
@@ -0,0 +1,318 @@
+#include "../../include/pseudo_spectral.h"
+#include "../../include/trace.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+const double kPi = std::acos(-1.0);
+
+// Per-thread buffers for nonlinear() and evaluate(), so a shared operator
+// can serve several stepper threads
+struct Workspace {
+    std::vector<Complex> masked, spectrum;      // nonlinear()
+    std::vector<Complex> coefficients, rate;   // evaluate()
+    std::vector<double> field, gx, gy;
+
+    void resize(int size, int modes) {
+        if (static_cast<int>(field.size()) < size) {
+            field.resize(size);
+            gx.resize(size);
+            gy.resize(size);
+        }
+        if (static_cast<int>(masked.size()) < modes) {
+            masked.resize(modes);
+            spectrum.resize(modes);
+            coefficients.resize(modes);
+            rate.resize(modes);
+        }
+    }
+};
+
+Workspace& workspace(int size, int modes) {
+    thread_local Workspace work;
+    work.resize(size, modes);
+    return work;
+}
+
+// Signed index of row j in an FFT of n points
+int signed_index(int j, int n) {
+    return j <= n / 2 ? j : j - n;
+}
+
+void check_state(const PseudoSpectral& op, const std::vector<double>& y) {
+    if (static_cast<int>(y.size()) != op.size()) {
+        throw std::invalid_argument("Spectral stepper: state has " + std::to_string(y.size()) +
+                                    " values, operator has " + std::to_string(op.size()) + " points");
+    }
+}
+
+}  // namespace
+
+SpectralEquation SpectralEquation::burgers(double nu) {
+    SpectralEquation eq;
+    eq.laplacian = nu;
+    eq.flux = -0.5;
+    return eq;
+}
+
+SpectralEquation SpectralEquation::kdv() {
+    SpectralEquation eq;
+    eq.dispersion = -1.0;
+    eq.flux = -3.0;
+    return eq;
+}
+
+SpectralEquation SpectralEquation::kuramoto_sivashinsky() {
+    SpectralEquation eq;
+    eq.laplacian = -1.0;
+    eq.biharmonic = -1.0;
+    eq.flux = -0.5;
+    return eq;
+}
+
+SpectralEquation SpectralEquation::kuramoto_sivashinsky_2d() {
+    SpectralEquation eq;
+    eq.laplacian = -1.0;
+    eq.biharmonic = -1.0;
+    eq.gradient_squared = -0.5;
+    return eq;
+}
+
+PseudoSpectral::PseudoSpectral(int nx, double lx, const SpectralEquation& equation)
+    : PseudoSpectral(nx, 1, lx, lx, equation) {}
+
+PseudoSpectral::PseudoSpectral(int nx, int ny, double lx, double ly, const SpectralEquation& equation)
+    : nx_(nx), ny_(ny), lx_(lx), ly_(ly), equation_(equation), fft_(nx, ny) {
+    if (!(lx > 0.0) || !(ly > 0.0)) {
+        throw std::invalid_argument("Pseudo-spectral domain lengths must be positive");
+    }
+    const int width = nx / 2 + 1;
+    linear_.resize(modes());
+    mask_.resize(modes());
+    dx_.resize(modes());
+    dy_.resize(modes());
+    for (int j = 0; j < ny; ++j) {
+        const int jj = signed_index(j, ny);
+        const double ky = 2.0 * kPi * jj / ly;
+        // Odd derivatives drop the Nyquist mode, which has no sign
+        const double ky_odd = (ny > 1 && 2 * j == ny) ? 0.0 : ky;
+        for (int i = 0; i < width; ++i) {
+            const int m = j * width + i;
+            const double kx = 2.0 * kPi * i / lx;
+            const double kx_odd = 2 * i == nx ? 0.0 : kx;
+            const double k2 = kx * kx + ky * ky;
+            linear_[m] = Complex(-equation.laplacian * k2 + equation.biharmonic * k2 * k2,
+                                 -equation.dispersion * kx_odd * kx_odd * kx_odd);
+            mask_[m] = (3 * i < nx && 3 * std::abs(jj) < ny) ? 1.0 : 0.0;
+            dx_[m] = Complex(0.0, kx_odd);
+            dy_[m] = Complex(0.0, ky_odd);
+        }
+    }
+}
+
+void PseudoSpectral::to_spectral(const double* u, Complex* u_hat) const {
+    fft_.forward(u, u_hat);
+}
+
+void PseudoSpectral::to_physical(const Complex* u_hat, double* u) const {
+    fft_.inverse(u_hat, u);
+}
+
+void PseudoSpectral::nonlinear(const Complex* u_hat, Complex* n_hat) const {
+    ODE_TRACE_SCOPE_CAT("spectral_nonlinear", "cpu");
+    const int n = size(), m_count = modes();
+    Workspace& work = workspace(n, m_count);
+    for (int m = 0; m < m_count; ++m) {
+        work.masked[m] = mask_[m] * u_hat[m];
+        n_hat[m] = Complex(0.0, 0.0);
+    }
+
+    if (equation_.flux != 0.0) {
+        to_physical(work.masked.data(), work.field.data());
+        for (int p = 0; p < n; ++p) work.field[p] *= work.field[p];
+        to_spectral(work.field.data(), work.spectrum.data());
+        for (int m = 0; m < m_count; ++m) {
+            n_hat[m] += (equation_.flux * mask_[m]) * multiply(dx_[m] + dy_[m], work.spectrum[m]);
+        }
+    }
+
+    if (equation_.gradient_squared != 0.0) {
+        for (int m = 0; m < m_count; ++m) work.spectrum[m] = multiply(dx_[m], work.masked[m]);
+        to_physical(work.spectrum.data(), work.gx.data());
+        if (ny_ > 1) {
+            for (int m = 0; m < m_count; ++m) work.spectrum[m] = multiply(dy_[m], work.masked[m]);
+            to_physical(work.spectrum.data(), work.gy.data());
+        } else {
+            std::fill(work.gy.begin(), work.gy.begin() + n, 0.0);
+        }
+        for (int p = 0; p < n; ++p) work.field[p] = work.gx[p] * work.gx[p] + work.gy[p] * work.gy[p];
+        to_spectral(work.field.data(), work.spectrum.data());
+        for (int m = 0; m < m_count; ++m) {
+            n_hat[m] += (equation_.gradient_squared * mask_[m]) * work.spectrum[m];
+        }
+    }
+}
+
+void PseudoSpectral::evaluate(const double* u, double* dudt) const {
+    const int m_count = modes();
+    Workspace& work = workspace(size(), m_count);
+    to_spectral(u, work.coefficients.data());
+    nonlinear(work.coefficients.data(), work.rate.data());
+    for (int m = 0; m < m_count; ++m) {
+        work.rate[m] += multiply(linear_[m], work.coefficients[m]);
+    }
+    to_physical(work.rate.data(), dudt);
+}
+
+ODESystem PseudoSpectral::system(const std::string& name) const {
+    auto op = std::make_shared<const PseudoSpectral>(*this);
+    ODESystem system;
+    system.name = name;
+    system.dimension = size();
+    system.t_start = 0.0;
+    system.t_end = 1.0;
+    system.rhs_inplace = [op](double, const std::vector<double>& y, std::vector<double>& dydt) {
+        op->evaluate(y.data(), dydt.data());
+    };
+    system.rhs = [op](double, const std::vector<double>& y) {
+        std::vector<double> dydt(y.size());
+        op->evaluate(y.data(), dydt.data());
+        return dydt;
+    };
+    return system;
+}
+
+std::vector<double> PseudoSpectral::initial_state(const InitialValue& value) const {
+    std::vector<double> u(size());
+    for (int j = 0; j < ny_; ++j) {
+        for (int i = 0; i < nx_; ++i) {
+            u[j * nx_ + i] = value(coordinate(0, i), coordinate(1, j));
+        }
+    }
+    return u;
+}
+
+IntegratingFactorRK4Stepper::IntegratingFactorRK4Stepper(std::shared_ptr<const PseudoSpectral> op)
+    : op_(std::move(op)) {
+    const int m = op_->modes();
+    half_.resize(m);
+    full_.resize(m);
+    u_hat_.resize(m);
+    a_.resize(m);
+    b_.resize(m);
+    c_.resize(m);
+    d_.resize(m);
+    stage_.resize(m);
+}
+
+void IntegratingFactorRK4Stepper::prepare(double dt) {
+    if (dt == dt_) return;
+    const std::vector<Complex>& linear = op_->linear();
+    for (size_t m = 0; m < linear.size(); ++m) {
+        half_[m] = std::exp(0.5 * dt * linear[m]);
+        full_[m] = std::exp(dt * linear[m]);
+    }
+    dt_ = dt;
+}
+
+void IntegratingFactorRK4Stepper::step(const ODESystem&, double, double dt, std::vector<double>& y) {
+    check_state(*op_, y);
+    op_->to_spectral(y.data(), u_hat_.data());
+    step_spectral(dt, u_hat_.data());
+    op_->to_physical(u_hat_.data(), y.data());
+}
+
+void IntegratingFactorRK4Stepper::step_spectral(double dt, Complex* v) {
+    ODE_TRACE_SCOPE_CAT("if_rk4_step", "cpu");
+    prepare(dt);
+    const int n = op_->modes();
+    const PseudoSpectral& op = *op_;
+
+    op.nonlinear(v, a_.data());
+    for (int m = 0; m < n; ++m) {
+        a_[m] *= dt;
+        stage_[m] = multiply(half_[m], v[m] + 0.5 * a_[m]);
+    }
+    op.nonlinear(stage_.data(), b_.data());
+    for (int m = 0; m < n; ++m) {
+        b_[m] *= dt;
+        stage_[m] = multiply(half_[m], v[m]) + 0.5 * b_[m];
+    }
+    op.nonlinear(stage_.data(), c_.data());
+    for (int m = 0; m < n; ++m) {
+        c_[m] *= dt;
+        stage_[m] = multiply(full_[m], v[m]) + multiply(half_[m], c_[m]);
+    }
+    op.nonlinear(stage_.data(), d_.data());
+    for (int m = 0; m < n; ++m) {
+        const Complex d = dt * d_[m];
+        v[m] = multiply(full_[m], v[m]) +
+               (multiply(full_[m], a_[m]) + 2.0 * multiply(half_[m], b_[m] + c_[m]) + d) / 6.0;
+    }
+}
+
+ETDRK4Stepper::ETDRK4Stepper(std::shared_ptr<const PseudoSpectral> op) : op_(std::move(op)) {
+    const int m = op_->modes();
+    for (std::vector<Complex>* v : {&e_, &e2_, &q_, &f1_, &f2_, &f3_, &u_hat_, &a_, &b_, &c_, &nv_, &na_, &nb_, &nc_}) {
+        v->resize(m);
+    }
+}
+
+void ETDRK4Stepper::prepare(double dt) {
+    if (dt == dt_) return;
+    const std::vector<Complex>& linear = op_->linear();
+    // Mean over kContourPoints points on the unit circle around z = h L
+    std::vector<Complex> roots(kContourPoints);
+    for (int j = 0; j < kContourPoints; ++j) {
+        roots[j] = std::polar(1.0, 2.0 * kPi * (j + 0.5) / kContourPoints);
+    }
+    for (size_t m = 0; m < linear.size(); ++m) {
+        const Complex z = dt * linear[m];
+        e_[m] = std::exp(z);
+        e2_[m] = std::exp(0.5 * z);
+        Complex q(0.0), f1(0.0), f2(0.0), f3(0.0);
+        for (const Complex& r : roots) {
+            const Complex lr = z + r;
+            const Complex ez = std::exp(lr);
+            const Complex lr3 = lr * lr * lr;
+            q += (std::exp(0.5 * lr) - 1.0) / lr;
+            f1 += (-4.0 - lr + ez * (4.0 - 3.0 * lr + lr * lr)) / lr3;
+            f2 += (2.0 + lr + ez * (lr - 2.0)) / lr3;
+            f3 += (-4.0 - 3.0 * lr - lr * lr + ez * (4.0 - lr)) / lr3;
+        }
+        const double scale = dt / kContourPoints;
+        q_[m] = scale * q;
+        f1_[m] = scale * f1;
+        f2_[m] = scale * f2;
+        f3_[m] = scale * f3;
+    }
+    dt_ = dt;
+}
+
+void ETDRK4Stepper::step(const ODESystem&, double, double dt, std::vector<double>& y) {
+    check_state(*op_, y);
+    op_->to_spectral(y.data(), u_hat_.data());
+    step_spectral(dt, u_hat_.data());
+    op_->to_physical(u_hat_.data(), y.data());
+}
+
+void ETDRK4Stepper::step_spectral(double dt, Complex* v) {
+    ODE_TRACE_SCOPE_CAT("etd_rk4_step", "cpu");
+    prepare(dt);
+    const int n = op_->modes();
+    const PseudoSpectral& op = *op_;
+
+    op.nonlinear(v, nv_.data());
+    for (int m = 0; m < n; ++m) a_[m] = multiply(e2_[m], v[m]) + multiply(q_[m], nv_[m]);
+    op.nonlinear(a_.data(), na_.data());
+    for (int m = 0; m < n; ++m) b_[m] = multiply(e2_[m], v[m]) + multiply(q_[m], na_[m]);
+    op.nonlinear(b_.data(), nb_.data());
+    for (int m = 0; m < n; ++m) c_[m] = multiply(e2_[m], a_[m]) + multiply(q_[m], 2.0 * nb_[m] - nv_[m]);
+    op.nonlinear(c_.data(), nc_.data());
+    for (int m = 0; m < n; ++m) {
+        v[m] = multiply(e_[m], v[m]) + multiply(f1_[m], nv_[m]) + 2.0 * multiply(f2_[m], na_[m] + nb_[m]) +
+               multiply(f3_[m], nc_[m]);
+    }
+}
@@ -0,0 +1,128 @@
+// Build-time tool: writes builtin_rhs_table.h, the constexpr table of
+// builtin GPU right-hand sides, from emit_glsl() of the RHSLibrary programs.
+//   gen_builtin_rhs_table <header>
+// The header is rewritten only when its contents change.
+#include "../../include/rhs_expr.h"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+struct Entry {
+    const char* id;            // BuiltinRHSId enumerator
+    const char* uniforms;      // Name of the uniform-name array
+    RHSProgram (*program)();
+    const char* description;
+};
+
+// Order fixes the ids; the registry appends runtime registrations after it
+const Entry kEntries[] = {
+    {"Exponential", "kExponentialUniforms", RHSLibrary::exponential, "Exponential decay: dy/dt = -lambda * y"},
+    {"VanDerPol", "kVanDerPolUniforms", RHSLibrary::vanderpol, "Van der Pol oscillator"},
+    {"Lorenz", "kLorenzUniforms", RHSLibrary::lorenz, "Lorenz system"},
+    {"Harmonic", "kHarmonicUniforms", RHSLibrary::harmonic, "Harmonic oscillator"},
+};
+
+const char* const kDelimiter = "ode_glsl";
+
+std::string quoted(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+std::string generate() {
+    std::ostringstream out;
+    out << R"(// Generated from RHSLibrary by src/rhs/gen_builtin_rhs_table.cpp; do not edit.
+#pragma once
+#include <string_view>
+
+// A builtin GPU right-hand side as compile-time data. Every field views
+// static storage, so a lookup copies nothing.
+struct BuiltinRHS {
+    int id;                                  // Index into kBuiltinRHS (problem_type_id)
+    std::string_view name;
+    std::string_view glsl_code;              // evaluate_rhs for the shader templates
+    const std::string_view* uniform_names;   // Parameters, in user_uniforms order
+    int uniform_count;
+    int coupling_width;                      // See RHSDefinition::coupling_width
+    std::string_view description;
+};
+
+enum class BuiltinRHSId : int { )";
+    for (const Entry& entry : kEntries) {
+        out << entry.id << (&entry == &kEntries[std::size(kEntries) - 1] ? " };\n\n" : ", ");
+    }
+
+    std::ostringstream table;
+    int id = 0;
+    for (const Entry& entry : kEntries) {
+        const RHSProgram program = entry.program();
+        const RHSDefinition definition = to_rhs_definition(program, id, entry.description);
+        if (definition.glsl_code.find(std::string(")") + kDelimiter + "\"") != std::string::npos) {
+            throw std::runtime_error(program.name() + " GLSL contains the raw-string delimiter");
+        }
+
+        out << "inline constexpr std::string_view " << entry.uniforms << "[] = {";
+        for (size_t i = 0; i < definition.uniform_names.size(); ++i) {
+            out << (i ? ", " : "") << quoted(definition.uniform_names[i]);
+        }
+        out << "};\n";
+
+        table << (id ? "\n" : "") << "    {" << id << ", " << quoted(program.name()) << ", R\"" << kDelimiter
+              << "(" << definition.glsl_code << ")" << kDelimiter << "\", " << entry.uniforms << ", "
+              << definition.uniform_names.size() << ", " << definition.coupling_width << ", "
+              << quoted(definition.description) << "},\n";
+        ++id;
+    }
+
+    out << "\ninline constexpr BuiltinRHS kBuiltinRHS[] = {\n" << table.str() << "};\n";
+    out << R"(
+inline constexpr int kBuiltinRHSCount = static_cast<int>(sizeof(kBuiltinRHS) / sizeof(kBuiltinRHS[0]));
+
+constexpr bool builtin_rhs_ids_match() {
+    for (int i = 0; i < kBuiltinRHSCount; ++i) {
+        if (kBuiltinRHS[i].id != i) return false;
+    }
+    return static_cast<int>(BuiltinRHSId::)" << kEntries[std::size(kEntries) - 1].id << R"() == kBuiltinRHSCount - 1;
+}
+static_assert(builtin_rhs_ids_match(), "kBuiltinRHS ids must match their index and BuiltinRHSId");
+)";
+    return out.str();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <header>" << std::endl;
+        return 2;
+    }
+    try {
+        const std::string header = generate();
+        std::ifstream existing(argv[1], std::ios::binary);
+        std::ostringstream previous;
+        previous << existing.rdbuf();
+        // Rewrite only on change, so rebuilding the tool does not rebuild every includer
+        if (existing && previous.str() == header) return 0;
+        existing.close();
+
+        std::ofstream file(argv[1], std::ios::binary | std::ios::trunc);
+        file << header;
+        if (!file.flush()) {
+            std::cerr << "Cannot write " << argv[1] << std::endl;
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "gen_builtin_rhs_table: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
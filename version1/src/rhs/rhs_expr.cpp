@@ -0,0 +1,861 @@
+#include "../../include/rhs_expr.h"
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+bool is_leaf(RHSOp op) {
+    return op == RHSOp::Const || op == RHSOp::State || op == RHSOp::Param || op == RHSOp::Time;
+}
+
+bool is_unary(RHSOp op) {
+    return op >= RHSOp::Neg;
+}
+
+bool is_identifier(const std::string& name) {
+    if (name.empty() || !(std::isalpha(static_cast<unsigned char>(name[0])) || name[0] == '_')) {
+        return false;
+    }
+    for (char c : name) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') return false;
+    }
+    return true;
+}
+
+double fold(RHSOp op, double a, double b) {
+    switch (op) {
+        case RHSOp::Add: return a + b;
+        case RHSOp::Sub: return a - b;
+        case RHSOp::Mul: return a * b;
+        case RHSOp::Div: return a / b;
+        case RHSOp::Neg: return -a;
+        case RHSOp::Sin: return std::sin(a);
+        case RHSOp::Cos: return std::cos(a);
+        case RHSOp::Exp: return std::exp(a);
+        case RHSOp::Log: return std::log(a);
+        case RHSOp::Sqrt: return std::sqrt(a);
+        case RHSOp::Tanh: return std::tanh(a);
+        default: break;
+    }
+    throw std::logic_error("fold: not an operation");
+}
+
+const char* function_name(RHSOp op) {
+    switch (op) {
+        case RHSOp::Sin: return "sin";
+        case RHSOp::Cos: return "cos";
+        case RHSOp::Exp: return "exp";
+        case RHSOp::Log: return "log";
+        case RHSOp::Sqrt: return "sqrt";
+        case RHSOp::Tanh: return "tanh";
+        default: return nullptr;
+    }
+}
+
+const char* operator_symbol(RHSOp op) {
+    switch (op) {
+        case RHSOp::Add: return " + ";
+        case RHSOp::Sub: return " - ";
+        case RHSOp::Mul: return " * ";
+        case RHSOp::Div: return " / ";
+        default: return nullptr;
+    }
+}
+
+// Shortest literal that round-trips at the target precision, always with
+// a '.' or exponent so GLSL reads it as float
+std::string literal(double value, int digits) {
+    if (!std::isfinite(value)) {
+        throw std::invalid_argument("RHS constant is not finite");
+    }
+    char buffer[40];
+    std::snprintf(buffer, sizeof(buffer), "%.*g", digits, value);
+    std::string text = buffer;
+    if (text.find_first_of(".e") == std::string::npos) text += ".0";
+    return value < 0 ? "(" + text + ")" : text;
+}
+
+// One SSA statement per live non-leaf node, `leaf` spelling the leaves and
+// `reg` naming temporaries
+template <typename LeafName>
+std::string emit_statements(const RHSProgram& program, const std::vector<int>& live,
+                            const char* type, const std::string& indent, LeafName leaf) {
+    const auto& nodes = program.nodes();
+    auto operand = [&](int id) {
+        return is_leaf(nodes[id].op) ? leaf(nodes[id]) : "r_" + std::to_string(id);
+    };
+    std::ostringstream out;
+    for (int id : live) {
+        const RHSNode& node = nodes[id];
+        if (is_leaf(node.op)) continue;
+        out << indent << type << " r_" << id << " = ";
+        if (node.op == RHSOp::Neg) {
+            out << "-" << operand(node.a);
+        } else if (is_unary(node.op)) {
+            out << function_name(node.op) << "(" << operand(node.a) << ")";
+        } else {
+            out << operand(node.a) << operator_symbol(node.op) << operand(node.b);
+        }
+        out << ";\n";
+    }
+    return out.str();
+}
+
+}  // namespace
+
+std::size_t RHSProgram::NodeKeyHash::operator()(const NodeKey& key) const {
+    std::uint64_t h = static_cast<std::uint64_t>(key.op);
+    h = h * 1000003u ^ static_cast<std::uint64_t>(static_cast<std::uint32_t>(key.a));
+    h = h * 1000003u ^ static_cast<std::uint64_t>(static_cast<std::uint32_t>(key.b));
+    h = h * 1000003u ^ static_cast<std::uint64_t>(static_cast<std::uint32_t>(key.index));
+    h = h * 1000003u ^ key.bits;
+    return static_cast<std::size_t>(h ^ (h >> 29));
+}
+
+RHSProgram::RHSProgram(const std::string& name, int dimension)
+    : name_(name), dimension_(dimension), outputs_(dimension > 0 ? dimension : 0, -1) {
+    if (dimension < 1) {
+        throw std::invalid_argument("RHS program needs dimension >= 1");
+    }
+}
+
+int RHSProgram::intern(RHSNode node) {
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &node.value, sizeof(bits));
+    NodeKey key{node.op, node.a, node.b, node.index, bits};
+    auto it = interned_.find(key);
+    if (it != interned_.end()) {
+        return it->second;
+    }
+    nodes_.push_back(node);
+    const int id = static_cast<int>(nodes_.size()) - 1;
+    interned_.emplace(key, id);
+    return id;
+}
+
+void RHSProgram::check_owner(RHSExpr expr) const {
+    if (expr.program != this || expr.id < 0 || expr.id >= static_cast<int>(nodes_.size())) {
+        throw std::invalid_argument("Expression does not belong to RHS program " + name_);
+    }
+}
+
+RHSExpr RHSProgram::state(int i) {
+    if (i < 0 || i >= dimension_) {
+        throw std::invalid_argument("State y" + std::to_string(i) + " out of range for dimension " +
+                                    std::to_string(dimension_));
+    }
+    RHSNode node{RHSOp::State};
+    node.index = i;
+    return wrap(intern(node));
+}
+
+RHSExpr RHSProgram::time() {
+    return wrap(intern(RHSNode{RHSOp::Time}));
+}
+
+RHSExpr RHSProgram::constant(double value) {
+    RHSNode node{RHSOp::Const};
+    node.value = value;
+    return wrap(intern(node));
+}
+
+RHSExpr RHSProgram::param(const std::string& name, double default_value) {
+    int index = param_index(name);
+    if (index < 0) {
+        // Shaders see the parameter as glsl_uniform_macro(name), whose
+        // prefix keeps it clear of every GLSL and template identifier; only
+        // a double underscore (reserved in GLSL) can still go wrong
+        if (!is_identifier(name) || glsl_uniform_macro(name).find("__") != std::string::npos) {
+            throw std::invalid_argument("Invalid parameter name: " + name);
+        }
+        index = static_cast<int>(param_names_.size());
+        param_names_.push_back(name);
+        param_defaults_.push_back(default_value);
+    }
+    RHSNode node{RHSOp::Param};
+    node.index = index;
+    return wrap(intern(node));
+}
+
+void RHSProgram::set_output(int i, RHSExpr expr) {
+    check_owner(expr);
+    if (i < 0 || i >= static_cast<int>(outputs_.size())) {
+        throw std::invalid_argument("Output " + std::to_string(i) + " out of range");
+    }
+    outputs_[i] = expr.id;
+}
+
+RHSExpr RHSProgram::unary(RHSOp op, RHSExpr x) {
+    check_owner(x);
+    if (!is_unary(op)) {
+        throw std::invalid_argument("Not a unary operation");
+    }
+    const RHSNode& operand = nodes_[x.id];
+    if (operand.op == RHSOp::Const) {
+        return constant(fold(op, operand.value, 0.0));
+    }
+    if (op == RHSOp::Neg && operand.op == RHSOp::Neg) {
+        return wrap(operand.a);
+    }
+    RHSNode node{op};
+    node.a = x.id;
+    return wrap(intern(node));
+}
+
+RHSExpr RHSProgram::binary(RHSOp op, RHSExpr x, RHSExpr y) {
+    check_owner(x);
+    check_owner(y);
+    if (is_leaf(op) || is_unary(op)) {
+        throw std::invalid_argument("Not a binary operation");
+    }
+    const RHSNode& a = nodes_[x.id];
+    const RHSNode& b = nodes_[y.id];
+    if (a.op == RHSOp::Const && b.op == RHSOp::Const) {
+        return constant(fold(op, a.value, b.value));
+    }
+    // Identities that are exact in floating point
+    auto is_const = [](const RHSNode& node, double value) {
+        return node.op == RHSOp::Const && node.value == value;
+    };
+    if (op == RHSOp::Add && is_const(a, 0.0)) return y;
+    if ((op == RHSOp::Add || op == RHSOp::Sub) && is_const(b, 0.0)) return x;
+    if (op == RHSOp::Mul && is_const(a, 1.0)) return y;
+    if ((op == RHSOp::Mul || op == RHSOp::Div) && is_const(b, 1.0)) return x;
+
+    RHSNode node{op};
+    node.a = x.id;
+    node.b = y.id;
+    // Commutative: one canonical operand order, so x*y and y*x are one node
+    if ((op == RHSOp::Add || op == RHSOp::Mul) && node.a > node.b) {
+        std::swap(node.a, node.b);
+    }
+    return wrap(intern(node));
+}
+
+int RHSProgram::param_index(const std::string& name) const {
+    for (size_t i = 0; i < param_names_.size(); ++i) {
+        if (param_names_[i] == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+bool RHSProgram::complete() const {
+    for (int id : outputs_) {
+        if (id < 0) return false;
+    }
+    return true;
+}
+
+std::vector<int> RHSProgram::live_nodes() const {
+    std::vector<char> live(nodes_.size(), 0);
+    for (int id : outputs_) {
+        if (id >= 0) live[id] = 1;
+    }
+    // Ids are topological, so one backward sweep marks every operand
+    for (int id = static_cast<int>(nodes_.size()) - 1; id >= 0; --id) {
+        if (!live[id]) continue;
+        if (nodes_[id].a >= 0) live[nodes_[id].a] = 1;
+        if (nodes_[id].b >= 0) live[nodes_[id].b] = 1;
+    }
+    std::vector<int> ids;
+    for (size_t id = 0; id < nodes_.size(); ++id) {
+        if (live[id]) ids.push_back(static_cast<int>(id));
+    }
+    return ids;
+}
+
+int RHSProgram::operation_count() const {
+    int count = 0;
+    for (int id : live_nodes()) {
+        if (!is_leaf(nodes_[id].op)) ++count;
+    }
+    return count;
+}
+
+std::vector<double> RHSProgram::param_values(const std::map<std::string, double>& overrides) const {
+    std::vector<double> values = param_defaults_;
+    for (const auto& entry : overrides) {
+        const int index = param_index(entry.first);
+        if (index < 0) {
+            throw std::invalid_argument("RHS " + name_ + " has no parameter " + entry.first);
+        }
+        values[index] = entry.second;
+    }
+    return values;
+}
+
+RHSProgram RHSProgram::jacobian() const {
+    if (!complete()) {
+        throw std::invalid_argument("RHS " + name_ + " has unassigned outputs");
+    }
+    const int n = dimension_;
+    RHSProgram jac(*this);
+    jac.name_ = name_ + "_jacobian";
+    jac.outputs_.assign(static_cast<size_t>(n) * n, -1);
+
+    constexpr int kZero = -1;   // Structural zero: never materialized
+    const std::vector<int> live = live_nodes();
+    auto expr = [&](int id) { return jac.wrap(id); };
+    auto add = [&](int a, int b) {
+        if (a == kZero) return b;
+        if (b == kZero) return a;
+        return (expr(a) + expr(b)).id;
+    };
+    auto scale = [&](int derivative, RHSExpr factor) {
+        return derivative == kZero ? kZero : (factor * expr(derivative)).id;
+    };
+
+    // Forward mode, one state at a time: d[id] = d node / d y_j
+    std::vector<int> d(nodes_.size(), kZero);
+    for (int j = 0; j < n; ++j) {
+        for (int id : live) {
+            const RHSNode node = jac.nodes_[id];
+            const int da = node.a >= 0 ? d[node.a] : kZero;
+            const int db = node.b >= 0 ? d[node.b] : kZero;
+            int result = kZero;
+            switch (node.op) {
+                case RHSOp::State:
+                    result = node.index == j ? jac.constant(1.0).id : kZero;
+                    break;
+                case RHSOp::Const:
+                case RHSOp::Param:
+                case RHSOp::Time:
+                    break;
+                case RHSOp::Add:
+                    result = add(da, db);
+                    break;
+                case RHSOp::Sub:
+                    if (db == kZero) result = da;
+                    else if (da == kZero) result = (-expr(db)).id;
+                    else result = (expr(da) - expr(db)).id;
+                    break;
+                case RHSOp::Mul:
+                    result = add(scale(da, expr(node.b)), scale(db, expr(node.a)));
+                    break;
+                case RHSOp::Div:
+                    // (a/b)' = (a' - (a/b) b') / b, reusing the quotient node
+                    if (db == kZero) {
+                        result = da == kZero ? kZero : (expr(da) / expr(node.b)).id;
+                    } else {
+                        RHSExpr quotient_term = expr(id) * expr(db);
+                        RHSExpr numerator = da == kZero ? -quotient_term : expr(da) - quotient_term;
+                        result = (numerator / expr(node.b)).id;
+                    }
+                    break;
+                case RHSOp::Neg:
+                    result = da == kZero ? kZero : (-expr(da)).id;
+                    break;
+                case RHSOp::Sin:
+                    result = scale(da, cos(expr(node.a)));
+                    break;
+                case RHSOp::Cos:
+                    result = scale(da, -sin(expr(node.a)));
+                    break;
+                case RHSOp::Exp:
+                    result = scale(da, expr(id));
+                    break;
+                case RHSOp::Log:
+                    result = da == kZero ? kZero : (expr(da) / expr(node.a)).id;
+                    break;
+                case RHSOp::Sqrt:
+                    result = da == kZero ? kZero : (expr(da) / (2.0 * expr(id))).id;
+                    break;
+                case RHSOp::Tanh:
+                    result = scale(da, 1.0 - expr(id) * expr(id));
+                    break;
+            }
+            d[id] = result;
+        }
+        for (int i = 0; i < n; ++i) {
+            const int derivative = d[outputs_[i]];
+            jac.outputs_[static_cast<size_t>(i) * n + j] =
+                derivative == kZero ? jac.constant(0.0).id : derivative;
+        }
+    }
+    return jac;
+}
+
+RHSExpr operator+(RHSExpr x, RHSExpr y) { return x.program->binary(RHSOp::Add, x, y); }
+RHSExpr operator-(RHSExpr x, RHSExpr y) { return x.program->binary(RHSOp::Sub, x, y); }
+RHSExpr operator*(RHSExpr x, RHSExpr y) { return x.program->binary(RHSOp::Mul, x, y); }
+RHSExpr operator/(RHSExpr x, RHSExpr y) { return x.program->binary(RHSOp::Div, x, y); }
+RHSExpr operator-(RHSExpr x) { return x.program->unary(RHSOp::Neg, x); }
+RHSExpr operator+(RHSExpr x, double y) { return x + x.program->constant(y); }
+RHSExpr operator-(RHSExpr x, double y) { return x - x.program->constant(y); }
+RHSExpr operator*(RHSExpr x, double y) { return x * x.program->constant(y); }
+RHSExpr operator/(RHSExpr x, double y) { return x / x.program->constant(y); }
+RHSExpr operator+(double x, RHSExpr y) { return y.program->constant(x) + y; }
+RHSExpr operator-(double x, RHSExpr y) { return y.program->constant(x) - y; }
+RHSExpr operator*(double x, RHSExpr y) { return y.program->constant(x) * y; }
+RHSExpr operator/(double x, RHSExpr y) { return y.program->constant(x) / y; }
+RHSExpr sin(RHSExpr x) { return x.program->unary(RHSOp::Sin, x); }
+RHSExpr cos(RHSExpr x) { return x.program->unary(RHSOp::Cos, x); }
+RHSExpr exp(RHSExpr x) { return x.program->unary(RHSOp::Exp, x); }
+RHSExpr log(RHSExpr x) { return x.program->unary(RHSOp::Log, x); }
+RHSExpr sqrt(RHSExpr x) { return x.program->unary(RHSOp::Sqrt, x); }
+RHSExpr tanh(RHSExpr x) { return x.program->unary(RHSOp::Tanh, x); }
+
+// Text form ------------------------------------------------------------------
+
+namespace {
+
+class LineParser {
+public:
+    LineParser(RHSProgram& program, std::map<std::string, RHSExpr>& lets, const std::string& text, int line)
+        : program_(program), lets_(lets), text_(text), line_(line) {}
+
+    RHSExpr parse_expression() {
+        RHSExpr result = term();
+        while (true) {
+            if (accept('+')) result = result + term();
+            else if (accept('-')) result = result - term();
+            else return result;
+        }
+    }
+
+    std::string identifier() {
+        skip_space();
+        size_t start = pos_;
+        while (pos_ < text_.size() && (std::isalnum(static_cast<unsigned char>(text_[pos_])) || text_[pos_] == '_')) {
+            ++pos_;
+        }
+        if (start == pos_ || std::isdigit(static_cast<unsigned char>(text_[start]))) {
+            fail("expected a name");
+        }
+        return text_.substr(start, pos_ - start);
+    }
+
+    double number() {
+        skip_space();
+        const char* begin = text_.c_str() + pos_;
+        char* end = nullptr;
+        double value = std::strtod(begin, &end);
+        if (end == begin) fail("expected a number");
+        pos_ += static_cast<size_t>(end - begin);
+        return value;
+    }
+
+    // State index after "y": y3 or y[3]
+    int state_index(const std::string& name) {
+        if (name.size() > 1) {
+            for (size_t i = 1; i < name.size(); ++i) {
+                if (!std::isdigit(static_cast<unsigned char>(name[i]))) return -1;
+            }
+            return std::stoi(name.substr(1));
+        }
+        if (!accept('[')) return -1;
+        const double index = number();
+        expect(']');
+        if (index < 0 || index != std::floor(index)) fail("state index must be a non-negative integer");
+        return static_cast<int>(index);
+    }
+
+    bool accept(char c) {
+        skip_space();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!accept(c)) fail(std::string("expected '") + c + "'");
+    }
+
+    void expect_end() {
+        skip_space();
+        if (pos_ != text_.size()) fail("unexpected '" + text_.substr(pos_) + "'");
+    }
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::invalid_argument("RHS line " + std::to_string(line_) + ": " + message);
+    }
+
+private:
+    RHSExpr term() {
+        RHSExpr result = unary();
+        while (true) {
+            if (accept('*')) result = result * unary();
+            else if (accept('/')) result = result / unary();
+            else return result;
+        }
+    }
+
+    RHSExpr unary() {
+        if (accept('-')) return -unary();
+        if (accept('+')) return unary();
+        return power();
+    }
+
+    RHSExpr power() {
+        RHSExpr base = primary();
+        if (!accept('^')) return base;
+        const bool negative = accept('-');
+        const double exponent = number();
+        if (exponent != std::floor(exponent) || exponent > 64) {
+            fail("'^' needs an integer exponent up to 64");
+        }
+        int n = static_cast<int>(exponent);
+        if (n == 0) return program_.constant(1.0);
+        // Left-to-right products, so y0^2 is the same node as y0*y0
+        RHSExpr result = base;
+        for (int i = 1; i < n; ++i) result = result * base;
+        return negative ? 1.0 / result : result;
+    }
+
+    RHSExpr primary() {
+        skip_space();
+        if (accept('(')) {
+            RHSExpr inner = parse_expression();
+            expect(')');
+            return inner;
+        }
+        if (pos_ < text_.size() && (std::isdigit(static_cast<unsigned char>(text_[pos_])) || text_[pos_] == '.')) {
+            return program_.constant(number());
+        }
+        const std::string name = identifier();
+        if (name == "t") return program_.time();
+        if (name[0] == 'y') {
+            const int index = state_index(name);
+            if (index >= 0) {
+                if (index >= program_.dimension()) fail("no state " + name);
+                return program_.state(index);
+            }
+        }
+        static const std::map<std::string, RHSOp> functions = {
+            {"sin", RHSOp::Sin}, {"cos", RHSOp::Cos}, {"exp", RHSOp::Exp},
+            {"log", RHSOp::Log}, {"sqrt", RHSOp::Sqrt}, {"tanh", RHSOp::Tanh}};
+        auto function = functions.find(name);
+        if (function != functions.end()) {
+            expect('(');
+            RHSExpr argument = parse_expression();
+            expect(')');
+            return program_.unary(function->second, argument);
+        }
+        auto let = lets_.find(name);
+        if (let != lets_.end()) return let->second;
+        const int param = program_.param_index(name);
+        if (param >= 0) return program_.param(name, 0.0);
+        fail("unknown name " + name);
+    }
+
+    void skip_space() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) ++pos_;
+    }
+
+    RHSProgram& program_;
+    std::map<std::string, RHSExpr>& lets_;
+    const std::string& text_;
+    int line_;
+    size_t pos_ = 0;
+};
+
+// Statement lines with comments stripped, numbered from 1
+std::vector<std::pair<int, std::string>> statement_lines(const std::string& text) {
+    std::vector<std::pair<int, std::string>> lines;
+    std::istringstream in(text);
+    std::string line;
+    int number = 0;
+    while (std::getline(in, line)) {
+        ++number;
+        line = line.substr(0, line.find('#'));
+        if (line.find_first_not_of(" \t\r") != std::string::npos) {
+            lines.emplace_back(number, line);
+        }
+    }
+    return lines;
+}
+
+// dy index of an assignment line, -1 for other statements
+int output_index(const std::string& line, int number) {
+    size_t start = line.find_first_not_of(" \t");
+    if (line.compare(start, 2, "dy") != 0) return -1;
+    std::map<std::string, RHSExpr> no_lets;
+    RHSProgram scratch("scratch", 1);
+    std::string head = line.substr(start, line.find('=') - start);
+    LineParser parser(scratch, no_lets, head, number);
+    const std::string name = parser.identifier();
+    if (name.size() > 2) {
+        for (size_t i = 2; i < name.size(); ++i) {
+            if (!std::isdigit(static_cast<unsigned char>(name[i]))) return -1;
+        }
+        return std::stoi(name.substr(2));
+    }
+    if (name != "dy" || !parser.accept('[')) return -1;
+    return static_cast<int>(parser.number());
+}
+
+}  // namespace
+
+RHSProgram RHSProgram::parse(const std::string& text, const std::string& name) {
+    const auto lines = statement_lines(text);
+    int dimension = 0;
+    for (const auto& line : lines) {
+        dimension = std::max(dimension, output_index(line.second, line.first) + 1);
+    }
+    if (dimension < 1) {
+        throw std::invalid_argument("RHS text assigns no dy outputs");
+    }
+
+    RHSProgram program(name, dimension);
+    std::map<std::string, RHSExpr> lets;
+    for (const auto& line : lines) {
+        const size_t equals = line.second.find('=');
+        if (equals == std::string::npos) {
+            throw std::invalid_argument("RHS line " + std::to_string(line.first) + ": expected '='");
+        }
+        const std::string head = line.second.substr(0, equals);
+        const std::string body = line.second.substr(equals + 1);
+        LineParser head_parser(program, lets, head, line.first);
+        LineParser body_parser(program, lets, body, line.first);
+
+        const int output = output_index(line.second, line.first);
+        if (output >= 0) {
+            if (program.outputs()[output] >= 0) head_parser.fail("dy" + std::to_string(output) + " assigned twice");
+            RHSExpr value = body_parser.parse_expression();
+            body_parser.expect_end();
+            program.set_output(output, value);
+            continue;
+        }
+
+        const std::string keyword = head_parser.identifier();
+        const std::string target = head_parser.identifier();
+        head_parser.expect_end();
+        const bool reserved = target == "t" || (target[0] == 'y' && target.size() > 1 &&
+                              target.find_first_not_of("0123456789", 1) == std::string::npos);
+        if (reserved || lets.count(target) || program.param_index(target) >= 0) {
+            head_parser.fail("name " + target + " already in use");
+        }
+        if (keyword == "param") {
+            const bool negative = body_parser.accept('-');
+            const double value = body_parser.number();
+            body_parser.expect_end();
+            program.param(target, negative ? -value : value);
+        } else if (keyword == "let") {
+            RHSExpr value = body_parser.parse_expression();
+            body_parser.expect_end();
+            lets.emplace(target, value);
+        } else {
+            head_parser.fail("expected 'param', 'let' or a dy assignment");
+        }
+    }
+    for (int i = 0; i < dimension; ++i) {
+        if (program.outputs()[i] < 0) {
+            throw std::invalid_argument("RHS text never assigns dy" + std::to_string(i));
+        }
+    }
+    return program;
+}
+
+// Emitters -------------------------------------------------------------------
+
+std::string emit_glsl(const RHSProgram& program) {
+    if (!program.complete() || static_cast<int>(program.outputs().size()) != program.dimension()) {
+        throw std::invalid_argument("emit_glsl needs a complete RHS program");
+    }
+    if (static_cast<int>(program.param_names().size()) > kMaxGLSLParameters) {
+        throw std::invalid_argument("GLSL RHS supports at most " + std::to_string(kMaxGLSLParameters) +
+                                    " parameters, program has " + std::to_string(program.param_names().size()));
+    }
+    const int n = program.dimension();
+    const std::vector<int> live = program.live_nodes();
+    auto leaf = [&](const RHSNode& node) -> std::string {
+        switch (node.op) {
+            case RHSOp::Const: return literal(node.value, 9);
+            case RHSOp::State: return "r_y" + std::to_string(node.index);
+            case RHSOp::Param: return glsl_uniform_macro(program.param_names()[node.index]);
+            default: return "t";
+        }
+    };
+    auto value = [&](int id) {
+        const RHSNode& node = program.nodes()[id];
+        return is_leaf(node.op) ? leaf(node) : "r_" + std::to_string(id);
+    };
+
+    std::ostringstream out;
+    out << "\n// Generated from RHS program \"" << program.name() << "\"\n";
+    out << "float evaluate_rhs(uint eq_idx, float y_val, float t) {\n";
+    const std::string width = std::to_string(n) + "u";
+    if (n == 1) {
+        out << "    uint r_base = eq_idx;\n";
+    } else {
+        out << "    uint r_base = (eq_idx / " << width << ") * " << width << ";\n";
+        out << "    uint r_local = eq_idx - r_base;\n";
+        out << "    if (r_base + " << (n - 1) << "u >= uint(n_equations)) return 0.0;\n";
+    }
+    std::vector<char> loaded(n, 0);
+    for (int id : live) {
+        const RHSNode& node = program.nodes()[id];
+        if (node.op == RHSOp::State && !loaded[node.index]) {
+            loaded[node.index] = 1;
+            out << "    float r_y" << node.index << " = current_state[r_base + " << node.index << "u];\n";
+        }
+    }
+    out << emit_statements(program, live, "float", "    ", leaf);
+    for (int i = 0; i + 1 < n; ++i) {
+        out << "    if (r_local == " << i << "u) return " << value(program.outputs()[i]) << ";\n";
+    }
+    out << "    return " << value(program.outputs()[n - 1]) << ";\n";
+    out << "}\n";
+    return out.str();
+}
+
+RHSDefinition to_rhs_definition(const RHSProgram& program, int problem_type_id,
+                                const std::string& description) {
+    RHSDefinition definition;
+    definition.glsl_code = emit_glsl(program);
+    definition.uniform_names = program.param_names();
+    definition.problem_type_id = problem_type_id;
+    definition.coupling_width = program.dimension();
+    definition.description = description;
+    return definition;
+}
+
+std::string emit_cpp(const RHSProgram& program, const std::string& function_name,
+                     const std::vector<double>* baked_params) {
+    if (!program.complete()) {
+        throw std::invalid_argument("emit_cpp needs a complete RHS program");
+    }
+    if (!is_identifier(function_name)) {
+        throw std::invalid_argument("Invalid function name: " + function_name);
+    }
+    if (baked_params && baked_params->size() != program.param_names().size()) {
+        throw std::invalid_argument("emit_cpp: wrong number of baked parameters");
+    }
+    const std::vector<int> live = program.live_nodes();
+    auto leaf = [&](const RHSNode& node) -> std::string {
+        switch (node.op) {
+            case RHSOp::Const: return literal(node.value, 17);
+            case RHSOp::State: return "y[" + std::to_string(node.index) + " * stride + l]";
+            case RHSOp::Param:
+                return baked_params ? literal((*baked_params)[node.index], 17)
+                                    : "params[" + std::to_string(node.index) + "]";
+            default: return "t";
+        }
+    };
+
+    std::ostringstream out;
+    out << "// Generated from RHS program \"" << program.name() << "\"\n";
+    out << "#include <cmath>\n";
+    out << "using std::sin; using std::cos; using std::exp; using std::log; using std::sqrt; using std::tanh;\n\n";
+    out << "extern \"C\" void " << function_name
+        << "(double t, const double* __restrict y, double* __restrict dydt,\n"
+        << "        const double* __restrict params, int lanes, int stride) {\n";
+    out << "    (void)t; (void)params;\n";
+    out << "#pragma GCC ivdep\n";
+    out << "    for (int l = 0; l < lanes; ++l) {\n";
+    out << emit_statements(program, live, "const double", "        ", leaf);
+    for (size_t i = 0; i < program.outputs().size(); ++i) {
+        const int id = program.outputs()[i];
+        const RHSNode& node = program.nodes()[id];
+        out << "        dydt[" << i << " * stride + l] = "
+            << (is_leaf(node.op) ? leaf(node) : "r_" + std::to_string(id)) << ";\n";
+    }
+    out << "    }\n}\n";
+    return out.str();
+}
+
+// Tape -----------------------------------------------------------------------
+
+RHSTape::RHSTape(const RHSProgram& program, std::vector<double> params)
+    : dimension_(program.dimension()), registers_(0) {
+    if (!program.complete()) {
+        throw std::invalid_argument("RHS " + program.name() + " has unassigned outputs");
+    }
+    if (params.size() != program.param_names().size()) {
+        throw std::invalid_argument("RHS " + program.name() + " needs " +
+                                    std::to_string(program.param_names().size()) + " parameters");
+    }
+    std::vector<int> reg(program.nodes().size(), -1);
+    for (int id : program.live_nodes()) {
+        const RHSNode& node = program.nodes()[id];
+        const int r = registers_++;
+        reg[id] = r;
+        switch (node.op) {
+            case RHSOp::Const: constants_.emplace_back(r, node.value); break;
+            case RHSOp::Param: constants_.emplace_back(r, params[node.index]); break;
+            case RHSOp::State: state_loads_.emplace_back(r, node.index); break;
+            case RHSOp::Time: time_regs_.push_back(r); break;
+            default:
+                code_.push_back(Instruction{node.op, r, reg[node.a], node.b >= 0 ? reg[node.b] : 0});
+                break;
+        }
+    }
+    for (int id : program.outputs()) {
+        output_regs_.push_back(reg[id]);
+    }
+}
+
+void RHSTape::evaluate(double t, const double* y, double* dydt) const {
+    thread_local std::vector<double> scratch;
+    if (scratch.size() < static_cast<size_t>(registers_)) {
+        scratch.resize(registers_);
+    }
+    double* r = scratch.data();
+    for (const auto& c : constants_) r[c.first] = c.second;
+    for (const auto& s : state_loads_) r[s.first] = y[s.second];
+    for (int reg : time_regs_) r[reg] = t;
+    for (const Instruction& in : code_) {
+        const double a = r[in.a];
+        const double b = r[in.b];
+        switch (in.op) {
+            case RHSOp::Add: r[in.dst] = a + b; break;
+            case RHSOp::Sub: r[in.dst] = a - b; break;
+            case RHSOp::Mul: r[in.dst] = a * b; break;
+            case RHSOp::Div: r[in.dst] = a / b; break;
+            case RHSOp::Neg: r[in.dst] = -a; break;
+            case RHSOp::Sin: r[in.dst] = std::sin(a); break;
+            case RHSOp::Cos: r[in.dst] = std::cos(a); break;
+            case RHSOp::Exp: r[in.dst] = std::exp(a); break;
+            case RHSOp::Log: r[in.dst] = std::log(a); break;
+            case RHSOp::Sqrt: r[in.dst] = std::sqrt(a); break;
+            case RHSOp::Tanh: r[in.dst] = std::tanh(a); break;
+            default: break;
+        }
+    }
+    for (size_t i = 0; i < output_regs_.size(); ++i) {
+        dydt[i] = r[output_regs_[i]];
+    }
+}
+
+ODESystem to_ode_system(const RHSProgram& program, const std::map<std::string, double>& parameters) {
+    if (static_cast<int>(program.outputs().size()) != program.dimension()) {
+        throw std::invalid_argument("to_ode_system needs an RHS program, not a Jacobian");
+    }
+    const std::vector<double> values = program.param_values(parameters);
+    auto tape = std::make_shared<const RHSTape>(program, values);
+
+    ODESystem system;
+    system.name = program.name();
+    system.dimension = program.dimension();
+    system.t_start = 0.0;
+    system.t_end = 1.0;
+    system.initial_conditions.assign(system.dimension, 0.0);
+    for (size_t k = 0; k < values.size(); ++k) {
+        system.parameters[program.param_names()[k]] = values[k];
+    }
+    system.program = std::make_shared<const RHSProgram>(program);
+    system.rhs_interpreted = true;
+    system.rhs_inplace = [tape](double t, const std::vector<double>& y, std::vector<double>& dydt) {
+        tape->evaluate(t, y.data(), dydt.data());
+    };
+    system.rhs = [tape](double t, const std::vector<double>& y) {
+        std::vector<double> dydt(y.size());
+        tape->evaluate(t, y.data(), dydt.data());
+        return dydt;
+    };
+
+    system.gpu_info = ODESystem::GPUInfo{};
+    system.gpu_info->glsl_rhs_code = emit_glsl(program);
+    system.gpu_info->uniform_names = program.param_names();
+    for (double value : values) {
+        system.gpu_info->gpu_uniforms.push_back(static_cast<float>(value));
+    }
+    return system;
+}
@@ -0,0 +1,315 @@
+#include "../../include/rhs_jit.h"
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr const char* kFunctionName = "ode_jit_rhs";
+
+std::uint64_t fnv1a(const std::string& text) {
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+std::string hex(std::uint64_t value) {
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+    return buffer;
+}
+
+std::string shell_quote(const std::string& text) {
+    std::string quoted = "'";
+    for (char c : text) {
+        if (c == '\'') quoted += "'\\''";
+        else quoted += c;
+    }
+    return quoted + "'";
+}
+
+// Runs a shell command, returning its exit status and combined output
+int run_command(const std::string& command, std::string& output) {
+    FILE* pipe = popen((command + " 2>&1").c_str(), "r");
+    if (!pipe) {
+        output = "popen failed";
+        return -1;
+    }
+    char buffer[4096];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+        output.append(buffer, n);
+    }
+    return pclose(pipe);
+}
+
+std::string default_cache_dir() {
+    if (const char* dir = std::getenv("ODE_JIT_CACHE")) return dir;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME")) return std::string(xdg) + "/ode_jit";
+    if (const char* home = std::getenv("HOME")) return std::string(home) + "/.cache/ode_jit";
+    return "/tmp/ode_jit_" + std::to_string(getuid());
+}
+
+// What "native" means on this machine. The compiler's driver resolves it
+// into an explicit CPU and feature list on the cc1 command line; without a
+// working driver the kernel's CPU description stands in.
+std::string native_target(const std::string& compiler, const std::string& flags) {
+    std::string output;
+    if (run_command(shell_quote(compiler) + " " + flags + " -### -E - < /dev/null", output) == 0) {
+        std::istringstream lines(output);
+        std::string line, target;
+        while (std::getline(lines, line)) {
+            if (line.find("cc1") != std::string::npos) target += line + '\n';
+        }
+        if (!target.empty()) return target;
+    }
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line, target;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0 || line.compare(0, 5, "flags") == 0 ||
+            line.compare(0, 8, "Features") == 0 || line.compare(0, 8, "CPU part") == 0) {
+            target += line + '\n';
+        }
+        if (line.empty() && !target.empty()) break;   // First processor only
+    }
+    return target;
+}
+
+// Objects in the cache are loaded into the process, so the directory must
+// be ours alone: created 0700, a real directory (not a symlink), owned by
+// this user and not writable by anyone else
+bool secure_cache_dir(const std::string& dir, std::string& error) {
+    std::error_code ec;
+    const std::filesystem::path path(dir);
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path(), ec);
+    }
+    if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) {
+        error = "cannot create " + dir + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat info;
+    if (lstat(dir.c_str(), &info) != 0) {
+        error = "cannot stat " + dir + ": " + std::strerror(errno);
+        return false;
+    }
+    if (!S_ISDIR(info.st_mode)) {
+        error = dir + " is not a directory";
+        return false;
+    }
+    if (info.st_uid != getuid()) {
+        error = dir + " is owned by another user";
+        return false;
+    }
+    if (info.st_mode & (S_IWGRP | S_IWOTH)) {
+        error = dir + " is writable by other users";
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+struct JitKernel::Module {
+    void* handle = nullptr;
+    Function function = nullptr;
+    std::string path;
+    ~Module() {
+        if (handle) dlclose(handle);
+    }
+};
+
+const std::string& JitKernel::object_path() const {
+    return module_->path;
+}
+
+RHSJit& RHSJit::instance() {
+    static RHSJit instance;
+    return instance;
+}
+
+RHSJit::RHSJit(JitOptions options) : options_(std::move(options)) {
+    if (options_.compiler.empty()) {
+        const char* cxx = std::getenv("ODE_JIT_CXX");
+        options_.compiler = cxx ? cxx : "c++";
+    }
+    cache_dir_ = options_.cache_dir.empty() ? default_cache_dir() : options_.cache_dir;
+    // A compiler upgrade must not load objects built by the old one
+    std::string version;
+    if (run_command(shell_quote(options_.compiler) + " --version", version) == 0) {
+        compiler_id_ = version.substr(0, version.find('\n'));
+    }
+    // -march=native builds for the machine that compiled the object; a cache
+    // shared with (or copied to) another CPU must not hand it out there
+    if (!compiler_id_.empty() && options_.flags.find("=native") != std::string::npos) {
+        target_id_ = native_target(options_.compiler, options_.flags);
+    }
+}
+
+std::shared_ptr<JitKernel::Module> RHSJit::load_module(const std::string& source, std::uint64_t key) {
+    auto cached = loaded_.find(key);
+    if (cached != loaded_.end()) {
+        if (auto module = cached->second.lock()) {
+            ++stats_.memory_hits;
+            return module;
+        }
+    }
+
+    if (!cache_dir_checked_) {
+        if (!secure_cache_dir(cache_dir_, last_error_)) {
+            return nullptr;
+        }
+        cache_dir_checked_ = true;
+    }
+
+    const std::string stem = cache_dir_ + "/rhs_" + hex(key);
+    const std::string object = stem + ".so";
+    bool compiled = false;
+    if (access(object.c_str(), R_OK) != 0) {
+        if (!build_object(source, stem)) {
+            return nullptr;
+        }
+        compiled = true;
+    }
+
+    auto module = std::make_shared<JitKernel::Module>();
+    module->path = object;
+    for (;;) {
+        module->handle = dlopen(object.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (module->handle) {
+            module->function = reinterpret_cast<JitKernel::Function>(dlsym(module->handle, kFunctionName));
+        }
+        if (module->function) {
+            break;
+        }
+        last_error_ = module->handle ? object + " has no " + kFunctionName
+                                     : std::string("dlopen failed: ") + dlerror();
+        if (module->handle) {
+            dlclose(module->handle);
+            module->handle = nullptr;
+        }
+        // A truncated or foreign object in the cache: replace it once
+        if (compiled) {
+            return nullptr;
+        }
+        std::remove(object.c_str());
+        if (!build_object(source, stem)) {
+            return nullptr;
+        }
+        compiled = true;
+    }
+    if (compiled) ++stats_.compiles;
+    else ++stats_.disk_hits;
+    loaded_[key] = module;
+    return module;
+}
+
+bool RHSJit::build_object(const std::string& source, const std::string& stem) {
+    if (compiler_id_.empty()) {
+        last_error_ = "compiler '" + options_.compiler + "' not found";
+        return false;
+    }
+    // Build under private names and rename into place, so concurrent
+    // processes never load a half-written object
+    const std::string tag = "." + std::to_string(getpid()) + ".tmp";
+    const std::string source_path = stem + tag + ".cpp";
+    {
+        std::ofstream out(source_path);
+        out << source;
+        if (!out) {
+            last_error_ = "cannot write " + source_path;
+            return false;
+        }
+    }
+    const std::string temp_object = stem + tag + ".so";
+    const std::string command = shell_quote(options_.compiler) + " " + options_.flags +
+                                " -std=c++17 -fPIC -shared -o " + shell_quote(temp_object) + " " +
+                                shell_quote(source_path);
+    auto start = std::chrono::steady_clock::now();
+    std::string output;
+    const int status = run_command(command, output);
+    stats_.compile_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (status != 0) {
+        std::remove(temp_object.c_str());
+        std::remove(source_path.c_str());
+        last_error_ = "compile failed: " + command + "\n" + output;
+        return false;
+    }
+    std::rename(source_path.c_str(), (stem + ".cpp").c_str());   // Kept for inspection
+    if (std::rename(temp_object.c_str(), (stem + ".so").c_str()) != 0) {
+        std::remove(temp_object.c_str());
+        last_error_ = "cannot move the object into " + cache_dir_;
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const JitKernel> RHSJit::compile(const RHSProgram& program, const std::vector<double>& params,
+                                                 bool bake_parameters) {
+    if (params.size() != program.param_names().size()) {
+        throw std::invalid_argument("RHS " + program.name() + " needs " +
+                                    std::to_string(program.param_names().size()) + " parameters");
+    }
+    const std::string source = emit_cpp(program, kFunctionName, bake_parameters ? &params : nullptr);
+    const std::uint64_t key = fnv1a(source + '\n' + options_.compiler + '\n' + options_.flags + '\n' +
+                                    compiler_id_ + '\n' + target_id_);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::shared_ptr<JitKernel::Module> module = load_module(source, key);
+    if (!module) {
+        ++stats_.failures;
+        return nullptr;
+    }
+    auto kernel = std::make_shared<JitKernel>();
+    kernel->module_ = module;
+    kernel->function_ = module->function;
+    kernel->params_ = params;
+    kernel->baked_ = bake_parameters;
+    return kernel;
+}
+
+ODESystem RHSJit::system(const RHSProgram& program, const std::map<std::string, double>& parameters,
+                         bool bake_parameters) {
+    ODESystem system = to_ode_system(program, parameters);
+    std::shared_ptr<const JitKernel> kernel = compile(program, program.param_values(parameters), bake_parameters);
+    if (!kernel) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!warned_) {
+            std::cerr << "RHS JIT unavailable, interpreting " << program.name() << ": " << last_error_ << std::endl;
+            warned_ = true;
+        }
+        return system;
+    }
+    system.rhs_interpreted = false;
+    system.rhs_inplace = [kernel](double t, const std::vector<double>& y, std::vector<double>& dydt) {
+        kernel->evaluate(t, y.data(), dydt.data());
+    };
+    system.rhs = [kernel](double t, const std::vector<double>& y) {
+        std::vector<double> dydt(y.size());
+        kernel->evaluate(t, y.data(), dydt.data());
+        return dydt;
+    };
+    return system;
+}
+
+JitStats RHSJit::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::string RHSJit::last_error() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_error_;
+}
@@ -0,0 +1,47 @@
+#include "../../include/rhs_expr.h"
+
+// Parameter defaults and expressions match TestProblems; test_rhs_expr holds
+// the two to bit-identical results
+
+RHSProgram RHSLibrary::exponential() {
+    // dy/dt = -lambda * y
+    RHSProgram p("exponential", 1);
+    RHSExpr lambda = p.param("lambda", 2.0);
+    p.set_output(0, -lambda * p.state(0));
+    return p;
+}
+
+RHSProgram RHSLibrary::vanderpol() {
+    // dx/dt = v, dv/dt = mu*(1-x^2)*v - x
+    RHSProgram p("vanderpol", 2);
+    RHSExpr mu = p.param("mu", 1.0);
+    RHSExpr x = p.state(0);
+    RHSExpr v = p.state(1);
+    p.set_output(0, v);
+    p.set_output(1, mu * (1.0 - x * x) * v - x);
+    return p;
+}
+
+RHSProgram RHSLibrary::lorenz() {
+    // dx/dt = sigma(y-x), dy/dt = x(rho-z)-y, dz/dt = xy-beta z
+    RHSProgram p("lorenz", 3);
+    RHSExpr sigma = p.param("sigma", 10.0);
+    RHSExpr rho = p.param("rho", 28.0);
+    RHSExpr beta = p.param("beta", 8.0 / 3.0);
+    RHSExpr x = p.state(0);
+    RHSExpr y = p.state(1);
+    RHSExpr z = p.state(2);
+    p.set_output(0, sigma * (y - x));
+    p.set_output(1, x * (rho - z) - y);
+    p.set_output(2, x * y - beta * z);
+    return p;
+}
+
+RHSProgram RHSLibrary::harmonic() {
+    // dx/dt = v, dv/dt = -omega^2 x
+    RHSProgram p("harmonic", 2);
+    RHSExpr omega_sq = p.param("omega_sq", 1.0);
+    p.set_output(0, p.state(1));
+    p.set_output(1, -omega_sq * p.state(0));
+    return p;
+}
@@ -0,0 +1,163 @@
+#include "../../include/rhs_vm.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+RHSBytecode::RHSBytecode(const RHSProgram& program, std::vector<double> params, int width)
+    : dimension_(program.dimension()),
+      outputs_(static_cast<int>(program.outputs().size())),
+      width_(width),
+      registers_(0) {
+    if (width != 8 && width != 16 && width != 32 && width != 64) {
+        throw std::invalid_argument("RHSBytecode width must be 8, 16, 32 or 64");
+    }
+    if (!program.complete()) {
+        throw std::invalid_argument("RHS " + program.name() + " has unassigned outputs");
+    }
+    if (params.size() != program.param_names().size()) {
+        throw std::invalid_argument("RHS " + program.name() + " needs " +
+                                    std::to_string(program.param_names().size()) + " parameters");
+    }
+    if (dimension_ > std::numeric_limits<std::uint16_t>::max() ||
+        outputs_ > std::numeric_limits<std::uint16_t>::max()) {
+        throw std::invalid_argument("RHS " + program.name() + " is too large for bytecode");
+    }
+
+    const auto& nodes = program.nodes();
+    const std::vector<int> live = program.live_nodes();
+
+    // Position in `live` of each node's last use as an operand
+    std::vector<int> last_use(nodes.size(), -1);
+    for (size_t p = 0; p < live.size(); ++p) {
+        const RHSNode& node = nodes[live[p]];
+        if (node.a >= 0) last_use[node.a] = static_cast<int>(p);
+        if (node.b >= 0) last_use[node.b] = static_cast<int>(p);
+    }
+    std::vector<std::vector<int>> stores(nodes.size());
+    for (size_t i = 0; i < program.outputs().size(); ++i) {
+        stores[program.outputs()[i]].push_back(static_cast<int>(i));
+    }
+
+    std::vector<int> reg(nodes.size(), -1);
+    std::vector<int> free_regs;
+    auto allocate = [&]() {
+        if (!free_regs.empty()) {
+            const int r = free_regs.back();
+            free_regs.pop_back();
+            return r;
+        }
+        return registers_++;
+    };
+
+    for (size_t p = 0; p < live.size(); ++p) {
+        const int id = live[p];
+        const RHSNode& node = nodes[id];
+        if (node.op == RHSOp::Const || node.op == RHSOp::Param) {
+            reg[id] = registers_++;   // Pinned, never freed
+            constants_.emplace_back(static_cast<std::uint16_t>(reg[id]),
+                                    node.op == RHSOp::Const ? node.value : params[node.index]);
+        } else {
+            // The destination is taken before operands are released, so it
+            // never aliases them and each loop below is a pure map
+            reg[id] = allocate();
+            Instruction in{Op::LoadTime, static_cast<std::uint16_t>(reg[id]), 0, 0};
+            switch (node.op) {
+                case RHSOp::State: in.op = Op::LoadState; in.a = static_cast<std::uint16_t>(node.index); break;
+                case RHSOp::Time: in.op = Op::LoadTime; break;
+                case RHSOp::Add: in.op = Op::Add; break;
+                case RHSOp::Sub: in.op = Op::Sub; break;
+                case RHSOp::Mul: in.op = Op::Mul; break;
+                case RHSOp::Div: in.op = Op::Div; break;
+                case RHSOp::Neg: in.op = Op::Neg; break;
+                case RHSOp::Sin: in.op = Op::Sin; break;
+                case RHSOp::Cos: in.op = Op::Cos; break;
+                case RHSOp::Exp: in.op = Op::Exp; break;
+                case RHSOp::Log: in.op = Op::Log; break;
+                case RHSOp::Sqrt: in.op = Op::Sqrt; break;
+                case RHSOp::Tanh: in.op = Op::Tanh; break;
+                default: break;
+            }
+            if (node.a >= 0) in.a = static_cast<std::uint16_t>(reg[node.a]);
+            if (node.b >= 0) in.b = static_cast<std::uint16_t>(reg[node.b]);
+            code_.push_back(in);
+        }
+        for (int output : stores[id]) {
+            code_.push_back(Instruction{Op::Store, static_cast<std::uint16_t>(output),
+                                        static_cast<std::uint16_t>(reg[id]), 0});
+        }
+        // Release operands whose last use this was (pinned registers stay)
+        for (int operand : {node.a, node.b}) {
+            if (operand < 0 || last_use[operand] != static_cast<int>(p)) continue;
+            const RHSOp kind = nodes[operand].op;
+            if (kind == RHSOp::Const || kind == RHSOp::Param) continue;
+            if (operand == node.b && node.a == node.b) continue;   // x*x: release once
+            free_regs.push_back(reg[operand]);
+        }
+        // A value nobody reads again (an output only) is free right away
+        if (last_use[id] < 0 && node.op != RHSOp::Const && node.op != RHSOp::Param) {
+            free_regs.push_back(reg[id]);
+        }
+    }
+    if (registers_ > std::numeric_limits<std::uint16_t>::max()) {
+        throw std::invalid_argument("RHS " + program.name() + " needs too many registers");
+    }
+}
+
+template <int W>
+void RHSBytecode::run(double t, const double* y, double* dydt, int lanes, int stride) const {
+    // One register file per thread, reused across calls
+    thread_local std::vector<double> file;
+    if (file.size() < static_cast<size_t>(registers_) * W) {
+        file.resize(static_cast<size_t>(registers_) * W);
+    }
+    double* regs = file.data();
+    for (const auto& c : constants_) {
+        std::fill(regs + c.first * W, regs + (c.first + 1) * W, c.second);
+    }
+
+    for (int lane0 = 0; lane0 < lanes; lane0 += W) {
+        const int count = std::min(W, lanes - lane0);
+        for (const Instruction& in : code_) {
+            double* __restrict d = regs + in.dst * W;
+            const double* __restrict a = regs + in.a * W;
+            const double* __restrict b = regs + in.b * W;
+            switch (in.op) {
+                case Op::LoadState: {
+                    const double* src = y + static_cast<size_t>(in.a) * stride + lane0;
+                    // Padding lanes repeat lane 0, which keeps them in the domain
+                    for (int l = 0; l < W; ++l) d[l] = src[l < count ? l : 0];
+                    break;
+                }
+                case Op::LoadTime:
+                    for (int l = 0; l < W; ++l) d[l] = t;
+                    break;
+                case Op::Store: {
+                    double* dst = dydt + static_cast<size_t>(in.dst) * stride + lane0;
+                    for (int l = 0; l < count; ++l) dst[l] = a[l];
+                    break;
+                }
+                case Op::Add: for (int l = 0; l < W; ++l) d[l] = a[l] + b[l]; break;
+                case Op::Sub: for (int l = 0; l < W; ++l) d[l] = a[l] - b[l]; break;
+                case Op::Mul: for (int l = 0; l < W; ++l) d[l] = a[l] * b[l]; break;
+                case Op::Div: for (int l = 0; l < W; ++l) d[l] = a[l] / b[l]; break;
+                case Op::Neg: for (int l = 0; l < W; ++l) d[l] = -a[l]; break;
+                case Op::Sin: for (int l = 0; l < W; ++l) d[l] = std::sin(a[l]); break;
+                case Op::Cos: for (int l = 0; l < W; ++l) d[l] = std::cos(a[l]); break;
+                case Op::Exp: for (int l = 0; l < W; ++l) d[l] = std::exp(a[l]); break;
+                case Op::Log: for (int l = 0; l < W; ++l) d[l] = std::log(a[l]); break;
+                case Op::Sqrt: for (int l = 0; l < W; ++l) d[l] = std::sqrt(a[l]); break;
+                case Op::Tanh: for (int l = 0; l < W; ++l) d[l] = std::tanh(a[l]); break;
+            }
+        }
+    }
+}
+
+void RHSBytecode::evaluate_batch(double t, const double* y, double* dydt, int lanes, int stride) const {
+    switch (width_) {
+        case 8: run<8>(t, y, dydt, lanes, stride); break;
+        case 16: run<16>(t, y, dydt, lanes, stride); break;
+        case 32: run<32>(t, y, dydt, lanes, stride); break;
+        default: run<64>(t, y, dydt, lanes, stride); break;
+    }
+}
@@ -1,11 +1,25 @@
 #include "../../include/steppers.h"
 
-void ExplicitEulerStepper::step(const ODESystem& system, double t, double dt, 
-                               std::vector<double>& y) {
+template <typename Scalar>
+void BasicExplicitEulerStepper<Scalar>::step(const BasicODESystem<Scalar>& system, double t, double dt, 
+                                            std::vector<Scalar>& y) {
     // Explicit Euler: y_{n+1} = y_n + dt * f(t_n, y_n)
-    auto dydt = system.rhs(t, y);
+    if (dydt_.size() != y.size()) dydt_.resize(y.size());
+    system.evaluate_rhs(t, y, dydt_);
     
+    const Scalar h = static_cast<Scalar>(dt);
+    if (compensated_) {
+        update_.begin(y, t, dt);
+        for (size_t i = 0; i < y.size(); ++i) {
+            update_.add(y, i, h * dydt_[i]);
+        }
+        return;
+    }
     for (size_t i = 0; i < y.size(); ++i) {
-        y[i] += dt * dydt[i];
+        y[i] += h * dydt_[i];
     }
-} 
\ No newline at end of file
+}
+
+template class BasicExplicitEulerStepper<float>;
+template class BasicExplicitEulerStepper<double>;
+template class BasicExplicitEulerStepper<long double>;
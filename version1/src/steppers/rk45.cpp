@@ -1,67 +1,85 @@
 #include "../../include/steppers.h"
 #include <cmath>
 
-void RK45Stepper::step(const ODESystem& system, double t, double dt, 
-                      std::vector<double>& y) {
-    y = rk45_step(system, t, y, dt);
+template <typename Scalar>
+void BasicRK45Stepper<Scalar>::resize_workspace(size_t n) {
+    if (y_temp_.size() == n) return;
+    k1_.resize(n); k2_.resize(n); k3_.resize(n);
+    k4_.resize(n); k5_.resize(n); k6_.resize(n);
+    y_temp_.resize(n);
 }
 
-std::vector<double> RK45Stepper::rk45_step(const ODESystem& system, double t, 
-                                          const std::vector<double>& y, double h) {
-    // RK45 (Dormand-Prince) coefficients
-    const double a21 = 1.0/5.0;
-    const double a31 = 3.0/40.0, a32 = 9.0/40.0;
-    const double a41 = 44.0/45.0, a42 = -56.0/15.0, a43 = 32.0/9.0;
-    const double a51 = 19372.0/6561.0, a52 = -25360.0/2187.0, 
-                 a53 = 64448.0/6561.0, a54 = -212.0/729.0;
-    const double a61 = 9017.0/3168.0, a62 = -355.0/33.0, 
-                 a63 = 46732.0/5247.0, a64 = 49.0/176.0, a65 = -5103.0/18656.0;
-                 
-    const double b1 = 35.0/384.0, b3 = 500.0/1113.0, b4 = 125.0/192.0,
-                 b5 = -2187.0/6784.0, b6 = 11.0/84.0;
-    
+template <typename Scalar>
+void BasicRK45Stepper<Scalar>::step(const BasicODESystem<Scalar>& system, double t, double h,
+                                   std::vector<Scalar>& y) {
+    // RK45 (Dormand-Prince) coefficients, rounded once to the state precision
+    auto c = [](int num, int den) { return static_cast<Scalar>(num) / static_cast<Scalar>(den); };
+    const Scalar a21 = c(1, 5);
+    const Scalar a31 = c(3, 40), a32 = c(9, 40);
+    const Scalar a41 = c(44, 45), a42 = -c(56, 15), a43 = c(32, 9);
+    const Scalar a51 = c(19372, 6561), a52 = -c(25360, 2187),
+                 a53 = c(64448, 6561), a54 = -c(212, 729);
+    const Scalar a61 = c(9017, 3168), a62 = -c(355, 33),
+                 a63 = c(46732, 5247), a64 = c(49, 176), a65 = -c(5103, 18656);
+
+    const Scalar b1 = c(35, 384), b3 = c(500, 1113), b4 = c(125, 192),
+                 b5 = -c(2187, 6784), b6 = c(11, 84);
+
+    const size_t n = y.size();
+    resize_workspace(n);
+    const Scalar hs = static_cast<Scalar>(h);
+
     // Compute k values
-    auto k1 = system.rhs(t, y);
-    for (auto& k : k1) k *= h;
-    
-    std::vector<double> y_temp(y.size());
-    for (size_t i = 0; i < y.size(); ++i) {
-        y_temp[i] = y[i] + a21 * k1[i];
+    system.evaluate_rhs(t, y, k1_);
+    for (auto& k : k1_) k *= hs;
+
+    for (size_t i = 0; i < n; ++i) {
+        y_temp_[i] = y[i] + a21 * k1_[i];
+    }
+    system.evaluate_rhs(t + h/5.0, y_temp_, k2_);
+    for (auto& k : k2_) k *= hs;
+
+    for (size_t i = 0; i < n; ++i) {
+        y_temp_[i] = y[i] + a31 * k1_[i] + a32 * k2_[i];
     }
-    auto k2 = system.rhs(t + h/5.0, y_temp);
-    for (auto& k : k2) k *= h;
-    
-    for (size_t i = 0; i < y.size(); ++i) {
-        y_temp[i] = y[i] + a31 * k1[i] + a32 * k2[i];
+    system.evaluate_rhs(t + 3.0*h/10.0, y_temp_, k3_);
+    for (auto& k : k3_) k *= hs;
+
+    for (size_t i = 0; i < n; ++i) {
+        y_temp_[i] = y[i] + a41 * k1_[i] + a42 * k2_[i] + a43 * k3_[i];
     }
-    auto k3 = system.rhs(t + 3.0*h/10.0, y_temp);
-    for (auto& k : k3) k *= h;
-    
-    for (size_t i = 0; i < y.size(); ++i) {
-        y_temp[i] = y[i] + a41 * k1[i] + a42 * k2[i] + a43 * k3[i];
+    system.evaluate_rhs(t + 4.0*h/5.0, y_temp_, k4_);
+    for (auto& k : k4_) k *= hs;
+
+    for (size_t i = 0; i < n; ++i) {
+        y_temp_[i] = y[i] + a51 * k1_[i] + a52 * k2_[i] + a53 * k3_[i] + a54 * k4_[i];
     }
-    auto k4 = system.rhs(t + 4.0*h/5.0, y_temp);
-    for (auto& k : k4) k *= h;
-    
-    for (size_t i = 0; i < y.size(); ++i) {
-        y_temp[i] = y[i] + a51 * k1[i] + a52 * k2[i] + a53 * k3[i] + a54 * k4[i];
+    system.evaluate_rhs(t + 8.0*h/9.0, y_temp_, k5_);
+    for (auto& k : k5_) k *= hs;
+
+    for (size_t i = 0; i < n; ++i) {
+        y_temp_[i] = y[i] + a61 * k1_[i] + a62 * k2_[i] + a63 * k3_[i] +
+                     a64 * k4_[i] + a65 * k5_[i];
     }
-    auto k5 = system.rhs(t + 8.0*h/9.0, y_temp);
-    for (auto& k : k5) k *= h;
-    
-    for (size_t i = 0; i < y.size(); ++i) {
-        y_temp[i] = y[i] + a61 * k1[i] + a62 * k2[i] + a63 * k3[i] + 
-                    a64 * k4[i] + a65 * k5[i];
+    system.evaluate_rhs(t + h, y_temp_, k6_);
+    for (auto& k : k6_) k *= hs;
+
+    // Compute final result in place (k2 does not enter the 5th order solution).
+    // Compensated: the weighted sum is formed on its own, at the scale of
+    // the increment, and only then added to y
+    if (compensated_) {
+        update_.begin(y, t, h);
+        for (size_t i = 0; i < n; ++i) {
+            update_.add(y, i, b1 * k1_[i] + b3 * k3_[i] + b4 * k4_[i] + b5 * k5_[i] + b6 * k6_[i]);
+        }
+        return;
     }
-    auto k6 = system.rhs(t + h, y_temp);
-    for (auto& k : k6) k *= h;
-    
-    // Compute final result
-    std::vector<double> y_new(y.size());
-    for (size_t i = 0; i < y.size(); ++i) {
-        y_new[i] = y[i] + b1 * k1[i] + b3 * k3[i] + b4 * k4[i] + 
-                   b5 * k5[i] + b6 * k6[i];
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = y[i] + b1 * k1_[i] + b3 * k3_[i] + b4 * k4_[i] +
+               b5 * k5_[i] + b6 * k6_[i];
     }
-    
-    return y_new;
-} 
\ No newline at end of file
+}
+
+template class BasicRK45Stepper<float>;
+template class BasicRK45Stepper<double>;
+template class BasicRK45Stepper<long double>;
@@ -1,12 +1,21 @@
 #include "../../include/steppers.h"
 #include <stdexcept>
 
-std::unique_ptr<TimeStepper> create_stepper(const std::string& method_name) {
+template <typename Scalar>
+std::unique_ptr<BasicTimeStepper<Scalar>> create_stepper(const std::string& method_name) {
     if (method_name == "euler" || method_name == "explicit_euler") {
-        return std::make_unique<ExplicitEulerStepper>();
+        return std::make_unique<BasicExplicitEulerStepper<Scalar>>();
     } else if (method_name == "rk45" || method_name == "runge_kutta") {
-        return std::make_unique<RK45Stepper>();
+        return std::make_unique<BasicRK45Stepper<Scalar>>();
+    } else if (method_name == "euler_compensated") {
+        return std::make_unique<BasicExplicitEulerStepper<Scalar>>(true);
+    } else if (method_name == "rk45_compensated") {
+        return std::make_unique<BasicRK45Stepper<Scalar>>(true);
     } else {
         throw std::invalid_argument("Unknown stepper method: " + method_name);
     }
-} 
\ No newline at end of file
+}
+
+template std::unique_ptr<BasicTimeStepper<float>> create_stepper<float>(const std::string&);
+template std::unique_ptr<BasicTimeStepper<double>> create_stepper<double>(const std::string&);
+template std::unique_ptr<BasicTimeStepper<long double>> create_stepper<long double>(const std::string&);
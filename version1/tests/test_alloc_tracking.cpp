@@ -0,0 +1,167 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include "../include/alloc_tracker.h"
+#include "../include/steppers.h"
+#include "../include/cpu_solver.h"
+#include "../include/test_problems.h"
+#include "../include/gpu_context_manager.h"
+#include "../include/gpu_euler_backend.h"
+#include "../src/backends/cpu_backend.cpp"
+
+// Enforces the "zero allocations per step after warmup" rule for the CPU
+// hot loops and the GPU Euler loop with its dispatch timer queries. Must
+// be linked with src/instrumentation/alloc_hooks.cpp.
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+// Allocations made by `steps` stepper calls after one warmup step
+static AllocStats measure_stepper(const std::string& method, const ODESystem& system, int steps) {
+    auto stepper = create_stepper(method);
+    std::vector<double> y = system.initial_conditions;
+    const double dt = 0.001;
+
+    stepper->step(system, 0.0, dt, y);  // Warmup sizes the workspaces
+
+    AllocRegion region(method.c_str());
+    for (int i = 1; i <= steps; ++i) {
+        stepper->step(system, i * dt, dt, y);
+    }
+    return region.stats();
+}
+
+void test_region_counting() {
+    std::cout << "\n=== ALLOC REGION COUNTING ===" << std::endl;
+
+    check(AllocTracker::hooks_installed(), "operator new hooks are linked in");
+
+    AllocRegion region("vector");
+    {
+        std::vector<double> v(1000);
+        v[0] = 1.0;
+    }
+    AllocStats stats = region.stats();
+    std::cout << "   allocations=" << stats.allocations
+              << " bytes=" << stats.bytes_allocated << std::endl;
+    check(stats.allocations == 1, "one vector -> one allocation");
+    check(stats.bytes_allocated == 1000 * sizeof(double), "bytes counted");
+    check(stats.deallocations == 1, "deallocation counted");
+}
+
+void test_stepper_loops() {
+    std::cout << "\n=== STEPPER HOT LOOPS ===" << std::endl;
+
+    std::vector<ODESystem> systems = {
+        TestProblems::create_exponential_decay(),
+        TestProblems::create_van_der_pol(),
+        TestProblems::create_scalability_test(1000)
+    };
+
+    for (const auto& system : systems) {
+        for (const std::string method : {"euler", "rk45"}) {
+            AllocStats stats = measure_stepper(method, system, 500);
+            std::cout << "   " << system.name << " / " << method << ": "
+                      << stats.allocations << " allocations in 500 steps" << std::endl;
+            check(stats.allocations == 0, method + " step is allocation-free: " + system.name);
+        }
+    }
+
+    // Systems without rhs_inplace still work, but pay one vector per RHS call
+    ODESystem legacy = TestProblems::create_exponential_decay();
+    legacy.rhs_inplace = nullptr;
+    AllocStats stats = measure_stepper("rk45", legacy, 100);
+    check(stats.allocations == 6 * 100, "legacy rhs costs exactly one allocation per stage");
+}
+
+// The only per-step allocation left in a full solve is the output row itself
+template <typename Solver>
+void check_solve_loop(Solver& solver, const std::string& label,
+                      const ODESystem& system = TestProblems::create_scalability_test(100)) {
+    const double dt = 0.01;
+
+    // Warm up the solver's internal workspaces
+    {
+        std::vector<std::vector<double>> warm;
+        solver.solve(system, 0.0, 0.1, dt, system.initial_conditions, warm);
+    }
+
+    std::vector<std::vector<double>> short_run, long_run;
+    AllocRegion short_region("short");
+    solver.solve(system, 0.0, 1.0, dt, system.initial_conditions, short_run);
+    AllocStats short_stats = short_region.stats();
+
+    AllocRegion long_region("long");
+    solver.solve(system, 0.0, 2.0, dt, system.initial_conditions, long_run);
+    AllocStats long_stats = long_region.stats();
+
+    uint64_t extra_steps = long_run.size() - short_run.size();
+    uint64_t extra_allocs = long_stats.allocations - short_stats.allocations;
+    std::cout << "   " << label << ": " << extra_allocs << " extra allocations for "
+              << extra_steps << " extra steps" << std::endl;
+    check(extra_allocs == extra_steps, label + " allocates only output rows");
+}
+
+void test_solver_loops() {
+    std::cout << "\n=== SOLVER HOT LOOPS ===" << std::endl;
+
+    CPUSolver cpu_solver;
+    check_solve_loop(cpu_solver, cpu_solver.name());
+
+    CPUBackend euler_backend(create_stepper("euler"));
+    check_solve_loop(euler_backend, euler_backend.name());
+
+    CPUBackend rk45_backend(create_stepper("rk45"));
+    check_solve_loop(rk45_backend, rk45_backend.name());
+}
+
+void test_gpu_loop() {
+    std::cout << "\n=== GPU HOT LOOP (TIMER QUERIES ON) ===" << std::endl;
+
+    // Labels are registered once; begin/end/poll never allocate, with or
+    // without the extension
+    GPUTimerQueries timer;
+    const int label = timer.label_id("dispatch");
+    AllocRegion timer_region("timer");
+    for (int i = 0; i < 1000; ++i) {
+        timer.begin(label);
+        timer.end();
+        timer.poll();
+    }
+    AllocStats stats = timer_region.stats();
+    std::cout << "   1000 timed scopes: " << stats.allocations << " allocations" << std::endl;
+    check(stats.allocations == 0 && timer.label_id("dispatch") == label,
+          "timer scopes are allocation-free");
+
+    if (!GPUContextManager::instance().initialize()) {
+        std::cout << "   (no GPU here: skipping the GPU Euler solve loop)" << std::endl;
+        return;
+    }
+    ODESystem system = TestProblems::create_exponential_decay();
+    system.dimension = 100;
+    system.initial_conditions.assign(100, 1.0);
+    GPUEulerBackend gpu_backend;
+    check_solve_loop(gpu_backend, gpu_backend.name(), system);
+}
+
+int main() {
+    std::cout << "=== ALLOCATION TRACKING TEST ===" << std::endl;
+
+    test_region_counting();
+    test_stepper_loops();
+    test_solver_loops();
+    test_gpu_loop();
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed == 0 ? 0 : 1;
+}
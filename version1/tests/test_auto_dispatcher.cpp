@@ -0,0 +1,203 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include "../include/auto_dispatcher.h"
+#include "../include/rhs_expr.h"
+#include "../include/test_problems.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+// Fixed numbers so routing does not depend on the machine running the test
+static CostCalibration synthetic_calibration() {
+    CostCalibration c = CostCalibration::defaults();
+    c.cpu_euler_ns_per_eq_step = 10.0;
+    c.cpu_rk45_ns_per_eq_step = 70.0;
+    c.cpu_ref_rhs_ns_per_eq = 8.0;
+    c.thread_fork_us = 5.0;
+    c.thread_efficiency = 0.9;
+    c.gpu_available = true;
+    c.gpu_setup_ms = 50.0;
+    c.gpu_dispatch_overhead_us = 100.0;
+    c.gpu_ns_per_eq_step = 0.5;
+    c.gpu_readback_bytes_per_s = 1e9;
+    return c;
+}
+
+static bool has_candidate(const DispatchDecision& decision, const std::string& name) {
+    for (const auto& candidate : decision.candidates) {
+        if (candidate.first == name) return true;
+    }
+    return false;
+}
+
+void test_routing() {
+    std::cout << "\n=== ROUTING ===" << std::endl;
+
+    ThreadPool pool(4);
+    AutoDispatcher euler("euler", pool, synthetic_calibration());
+    AutoDispatcher rk45("rk45", pool, synthetic_calibration());
+
+    auto small = TestProblems::create_scalability_test(100);
+    auto decision = euler.plan(small, 0.0, 1.0, 0.01);
+    check(decision.backend == "CPU_Single_euler", "small system stays on one thread (" + decision.backend + ")");
+    check(!has_candidate(decision, "GPU_Euler"), "no GPU candidate without GLSL RHS");
+
+    auto large = TestProblems::create_scalability_test(1000000);
+    decision = rk45.plan(large, 0.0, 0.01, 0.001);
+    check(decision.backend == "CPU_Threaded_rk45", "large system goes multi-threaded (" + decision.backend + ")");
+
+    auto exponential = TestProblems::create_exponential_decay();
+    decision = euler.plan(exponential, 0.0, 1.0, 0.01);
+    check(has_candidate(decision, "GPU_Euler"), "builtin RHS offers GPU candidate");
+    check(decision.backend != "GPU_Euler", "single equation is not worth a GPU setup");
+    // 100 steps on every candidate: setup + 100 * (dispatch + compute + readback)
+    double gpu_predicted = 0.0;
+    for (const auto& candidate : decision.candidates) {
+        if (candidate.first == "GPU_Euler") gpu_predicted = candidate.second;
+    }
+    const double gpu_expected = 50e-3 + 100 * (100e-6 + 0.5e-9 + sizeof(float) / 1e9);
+    check(std::fabs(gpu_predicted - gpu_expected) < 1e-12, "GPU predicted for the same step count as the CPU");
+
+    decision = rk45.plan(exponential, 0.0, 1.0, 0.01);
+    check(!has_candidate(decision, "GPU_Euler"), "no GPU candidate for rk45");
+
+    auto forced = TestProblems::create_exponential_decay();
+    forced.gpu_info->force_cpu_fallback = true;
+    decision = euler.plan(forced, 0.0, 1.0, 0.01);
+    check(!has_candidate(decision, "GPU_Euler"), "force_cpu_fallback excludes GPU");
+
+    // One million Van der Pol members: GPU throughput wins, and the spare
+    // cores add to it
+    auto vdp = TestProblems::create_van_der_pol();
+    decision = euler.plan_ensemble(vdp, 0.0, 1.0, 0.01, 1000000);
+    check(has_candidate(decision, "GPU_Ensemble") && has_candidate(decision, "Hybrid_Ensemble_euler"),
+          "ensemble offers GPU and hybrid candidates");
+    check(decision.backend == "Hybrid_Ensemble_euler", "large ensemble uses GPU plus CPU (" + decision.backend + ")");
+    // The ensemble path reads back once, not every step
+    double ensemble_gpu = 0.0;
+    for (const auto& candidate : decision.candidates) {
+        if (candidate.first == "GPU_Ensemble") ensemble_gpu = candidate.second;
+    }
+    const double members_n = 2e6;
+    const double ensemble_expected = 50e-3 + 100 * (100e-6 + members_n * 0.5e-9) + members_n * sizeof(float) / 1e9;
+    check(std::fabs(ensemble_gpu - ensemble_expected) < 1e-9, "GPU ensemble predicted with one final readback");
+    decision = euler.plan_ensemble(vdp, 0.0, 1.0, 0.01, 1);
+    check(decision.backend == "CPU_Ensemble_Single", "single member stays on one thread (" + decision.backend + ")");
+
+    // Odd member dimension would split Van der Pol pairs across members
+    auto odd = TestProblems::create_van_der_pol();
+    odd.dimension = 3;
+    decision = euler.plan_ensemble(odd, 0.0, 1.0, 0.01, 1000000);
+    check(!has_candidate(decision, "GPU_Ensemble"), "misaligned coupling blocks keep ensemble on CPU");
+}
+
+void test_solve_and_feedback() {
+    std::cout << "\n=== SOLVE AND PREDICTION FEEDBACK ===" << std::endl;
+
+    ThreadPool pool(2);
+    CostCalibration calibration = synthetic_calibration();
+    calibration.gpu_available = false;
+    AutoDispatcher dispatcher("rk45", pool, calibration);
+    dispatcher.set_verbose(false);
+
+    auto system = TestProblems::create_scalability_test(2000);
+    std::vector<std::vector<double>> solution, reference;
+    dispatcher.solve(system, 0.0, 0.2, 0.01, system.initial_conditions, solution);
+
+    ThreadedCPUBackend cpu("rk45", pool);
+    cpu.solve(system, 0.0, 0.2, 0.01, system.initial_conditions, reference);
+    check(solution == reference, "dispatched solve matches direct backend");
+
+    check(dispatcher.history().size() == 1, "decision recorded");
+    const DispatchDecision& decision = dispatcher.history().back();
+    check(decision.actual_seconds > 0, "actual time recorded");
+    std::cout << "   predicted " << decision.predicted_seconds * 1e3 << " ms, actual "
+              << decision.actual_seconds * 1e3 << " ms" << std::endl;
+
+    double expected = 0.7 + 0.3 * decision.actual_seconds / decision.predicted_seconds;
+    check(std::abs(dispatcher.correction(decision.backend) - expected) < 1e-9,
+          "correction factor learns actual/predicted");
+
+    // The GPU path has to fall back cleanly when there is no usable device
+    AutoDispatcher euler("euler", pool, synthetic_calibration());
+    euler.set_verbose(false);
+    auto vdp = TestProblems::create_van_der_pol();
+    std::vector<double> y0, final_states;
+    for (int m = 0; m < 200000; ++m) {
+        y0.push_back(1.0 + 1e-6 * m);
+        y0.push_back(0.0);
+    }
+    euler.solve_ensemble(vdp, 0.0, 0.1, 0.01, y0, 200000, final_states);
+
+    CPUEnsembleBackend cpu_ensemble("euler", pool);
+    std::vector<double> expected_states;
+    cpu_ensemble.solve_ensemble(vdp, 0.0, 0.1, 0.01, y0, 200000, expected_states);
+
+    double max_diff = 0.0;
+    for (size_t i = 0; i < expected_states.size() && i < final_states.size(); ++i) {
+        max_diff = std::max(max_diff, std::abs(final_states[i] - expected_states[i]));
+    }
+    std::cout << "   ensemble ran on " << euler.history().back().backend
+              << ", max diff vs CPU " << max_diff << std::endl;
+    check(final_states.size() == y0.size() && max_diff < 1e-4, "ensemble result valid on any backend");
+
+    // An interpreted RHS program (no JIT) is batched on the VM, which
+    // matches the per-member tape bit for bit
+    ODESystem program_vdp = to_ode_system(RHSLibrary::vanderpol(), {{"mu", 1.0}});
+    const int members = 300;
+    y0.assign(y0.begin(), y0.begin() + 2 * members);
+    dispatcher.solve_ensemble(program_vdp, 0.0, 0.5, 0.01, y0, members, final_states);
+    check(dispatcher.history().back().backend == "VM_Ensemble_rk45",
+          "interpreted program routed to the VM (" + dispatcher.history().back().backend + ")");
+    CPUEnsembleBackend("rk45", pool).solve_ensemble(program_vdp, 0.0, 0.5, 0.01, y0, members, expected_states);
+    check(final_states == expected_states, "VM result bit-identical to the tape");
+}
+
+void test_calibration_file() {
+    std::cout << "\n=== CALIBRATION FILE ===" << std::endl;
+
+    CostCalibration calibration = synthetic_calibration();
+    calibration.gpu_available = false;
+    calibration.thread_fork_us = 7.25;
+
+    const std::string path = "test_cost_calibration.txt";
+    check(calibration.save(path), "save");
+
+    CostCalibration loaded = CostCalibration::defaults();
+    check(loaded.load(path), "load");
+    check(!loaded.gpu_available && loaded.thread_fork_us == 7.25 &&
+          loaded.gpu_readback_bytes_per_s == 1e9, "round trip");
+    std::remove(path.c_str());
+
+    check(!loaded.load("does_not_exist.txt"), "missing file reported");
+
+    ThreadPool pool(2);
+    CostCalibration measured = CostCalibration::measure(pool, false);
+    check(measured.cpu_euler_ns_per_eq_step > 0 && measured.cpu_rk45_ns_per_eq_step >
+          measured.cpu_euler_ns_per_eq_step, "measured CPU costs are plausible");
+    check(!measured.gpu_available, "GPU skipped when not requested");
+}
+
+int main() {
+    std::cout << "=== AUTO DISPATCHER TEST ===" << std::endl;
+
+    test_routing();
+    test_solve_and_feedback();
+    test_calibration_file();
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed == 0 ? 0 : 1;
+}
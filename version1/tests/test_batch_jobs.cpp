@@ -0,0 +1,336 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../include/batch_runner.h"
+#include "../include/job_file.h"
+#include "../include/test_problems.h"
+#include "../include/trajectory_io.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+static JobSpec parse_text(const std::string& text) {
+    std::istringstream in(text);
+    return JobSpec::parse(in, "test.job");
+}
+
+static std::string parse_error(const std::string& text) {
+    try {
+        parse_text(text);
+    } catch (const std::invalid_argument& e) {
+        return e.what();
+    }
+    return "";
+}
+
+static std::string temp_path(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+void test_expansion() {
+    std::cout << "\n=== EXPANSION ===" << std::endl;
+
+    JobSpec spec = parse_text(
+        "# two parameters, one state axis, two samples\n"
+        "problem vanderpol\n"
+        "param   mu linspace(1, 3, 3)\n"
+        "y0[0]   0.5, 2.0\n"
+        "method  euler rk45\n"
+        "samples 2\n"
+        "tf      2\n"
+        "dt      0.01\n");
+    check(spec.size() == 3 * 2 * 2 * 2, "size is the product of the axes and samples");
+    check(spec.dimension() == 2, "fixed dimension taken from the problem");
+
+    JobInstance first = spec.job(0);
+    JobInstance second = spec.job(1);
+    JobInstance third = spec.job(2);
+    check(first.parameters.at("mu") == 1.0 && first.y0[0] == 0.5 && first.method == "euler",
+          "job 0 is the first value of every axis");
+    check(second.method == first.method && second.y0 == first.y0, "samples vary fastest");
+    check(third.method == "rk45" && third.y0[0] == 0.5, "then the last axis in file order");
+    JobInstance last = spec.job(spec.size() - 1);
+    check(last.parameters.at("mu") == 3.0 && last.y0[0] == 2.0 && last.method == "rk45",
+          "last job is the last value of every axis");
+    check(first.y0[1] == 0.0 && first.tf == 2.0 && first.t0 == 0.0 && first.backend == "auto",
+          "defaults from the problem and the file");
+
+    ODESystem system = spec.system_for(spec.job(8));
+    check(system.parameters.at("mu") == 2.0 && system.gpu_info->gpu_uniforms[0] == 2.0f,
+          "system built with the job's parameters");
+
+    JobSpec log = parse_text("problem exponential\nparam lambda logspace(-1, 1, 3)\n");
+    check(std::fabs(log.job(0).parameters.at("lambda") - 0.1) < 1e-15 &&
+          std::fabs(log.job(2).parameters.at("lambda") - 10.0) < 1e-12, "logspace()");
+
+    JobSpec noisy = parse_text("problem exponential\nsamples 100\nperturb 0.1\nseed 3\n");
+    bool in_range = true;
+    std::set<double> distinct;
+    for (std::uint64_t i = 0; i < noisy.size(); ++i) {
+        double y = noisy.job(i).y0[0];
+        if (std::fabs(y - 1.0) > 0.1) in_range = false;
+        distinct.insert(y);
+    }
+    check(in_range && distinct.size() == 100, "perturbed samples stay within +-perturb");
+    check(noisy.job(42).y0 == noisy.job(42).y0, "samples are reproducible per index");
+
+    check(spec.fingerprint() == parse_text(
+              "problem vanderpol\nparam mu linspace(1, 3, 3)\ny0[0] 0.5, 2.0\n"
+              "method euler rk45\nsamples 2\ntf 2\ndt 0.01\noutput elsewhere.traj\n").fingerprint(),
+          "fingerprint ignores the output path");
+    check(spec.fingerprint() != parse_text(
+              "problem vanderpol\nparam mu linspace(1, 3, 4)\ny0[0] 0.5, 2.0\n"
+              "method euler rk45\nsamples 2\ntf 2\ndt 0.01\n").fingerprint(),
+          "fingerprint changes with the sweep");
+}
+
+void test_parse_errors() {
+    std::cout << "\n=== PARSE ERRORS ===" << std::endl;
+
+    check(parse_error("problem vanderpol\n\nmethod euler, midpoint\n").find("test.job:3:") == 0,
+          "unknown method reported with its line");
+    check(parse_error("problem vanderpol\nparam mu 1,x\n").find("test.job:2: not a number") == 0,
+          "bad number reported with its line");
+    check(parse_error("problem vanderpol\nfrobnicate 3\n").find("unknown key") != std::string::npos,
+          "unknown key");
+    check(parse_error("problem vanderpol\ndt 0.1\ndt 0.2\n").find("given twice") != std::string::npos,
+          "duplicate key");
+    check(parse_error("problem vanderpol\nparam lambda 1\n").find("no parameter lambda") != std::string::npos,
+          "parameter the problem does not have");
+    check(parse_error("problem scalability\n").find("needs a 'dimension'") != std::string::npos,
+          "any-dimension problem without a dimension");
+    check(parse_error("problem vanderpol\ny0[2] 1\n").find("out of range") != std::string::npos,
+          "state axis past the dimension");
+    check(parse_error("param mu 1\n").find("no 'problem'") != std::string::npos, "missing problem");
+    check(parse_error("problem vanderpol\ndt 0.1, 0\n").find("test.job:2: dt must be positive") == 0,
+          "non-positive dt");
+    check(parse_error("problem vanderpol\nt0 0, 5\ntf 4\n").find("every tf must be greater") != std::string::npos &&
+          parse_error("problem vanderpol\nt0 1\ntf 1\n").find("every tf must be greater") != std::string::npos,
+          "tf not after t0");
+}
+
+void test_trajectory_file() {
+    std::cout << "\n=== TRAJECTORY FILE ===" << std::endl;
+
+    const std::string path = temp_path("ode_test_trajectory.traj");
+    TrajectoryFileInfo info;
+    info.fingerprint = 0x1234;
+    info.total_jobs = 3;
+    info.dimension = 2;
+
+    TrajectoryWriter writer;
+    check(writer.create(path, info), "create()");
+    writer.append(2, 0.0, 0.5, {{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}});
+    writer.append(0, 0.5, 0.5, {{7.0, 8.0}});
+    writer.close();
+
+    TrajectoryReader reader;
+    TrajectoryRecord record;
+    check(reader.open(path) && reader.info().fingerprint == 0x1234 && reader.info().total_jobs == 3,
+          "header round trip");
+    bool first = reader.next(record) && record.job_index == 2 && record.rows == 3 && record.cols == 2 &&
+                 record.row(2)[1] == 6.0 && record.dt == 0.5;
+    bool second = reader.next(record) && record.job_index == 0 && record.t_first == 0.5 &&
+                  record.row(0)[0] == 7.0;
+    check(first && second, "records round trip in write order");
+    check(!reader.next(record) && !reader.truncated(), "clean end of file");
+    const std::uint64_t intact = reader.good_bytes();
+
+    // Simulate a crash halfway through a third record
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        std::vector<char> partial(50, 'x');
+        out.write(partial.data(), partial.size());
+    }
+    TrajectoryReader torn;
+    torn.open(path);
+    int intact_records = 0;
+    while (torn.next(record)) intact_records++;
+    check(intact_records == 2 && torn.truncated() && torn.good_bytes() == intact, "reader stops at a torn record");
+
+    std::vector<std::uint64_t> completed;
+    check(writer.resume(path, info, completed) && completed == std::vector<std::uint64_t>{2, 0},
+          "resume() lists the jobs on disk");
+    writer.append(1, 0.0, 0.5, {{9.0, 9.0}});
+    writer.close();
+    check(std::filesystem::file_size(path) > intact, "appends after the trimmed tail");
+    TrajectoryReader resumed;
+    resumed.open(path);
+    intact_records = 0;
+    while (resumed.next(record)) intact_records++;
+    check(intact_records == 3 && !resumed.truncated() && record.job_index == 1, "torn tail replaced");
+
+    TrajectoryFileInfo other = info;
+    other.fingerprint = 0x9999;
+    check(!writer.resume(path, other, completed), "resume() refuses a different sweep");
+    std::remove(path.c_str());
+}
+
+void test_batch_run_and_resume() {
+    std::cout << "\n=== BATCH RUN / RESUME ===" << std::endl;
+
+    const std::string path = temp_path("ode_test_sweep.traj");
+    std::remove(path.c_str());
+    JobSpec spec = parse_text(
+        "problem exponential\n"
+        "param   lambda 0.5, 1.0, 2.0\n"
+        "y0[0]   1.0, 3.0\n"
+        "method  euler, rk45\n"
+        "backend cpu\n"
+        "tf      1\n"
+        "dt      0.01\n"
+        "record  final\n");
+    spec.set_output_path(path);
+
+    BatchOptions options;
+    options.cpu_workers = 2;
+    options.max_in_flight = 3;
+    options.verbose = false;
+    BatchStats stats = BatchRunner(spec, options).run();
+    check(stats.total == 12 && stats.completed == 12 && stats.failed == 0, "every job solved");
+
+    TrajectoryReader reader;
+    TrajectoryRecord record;
+    reader.open(path);
+    std::set<std::uint64_t> seen;
+    bool accurate = true;
+    while (reader.next(record)) {
+        seen.insert(record.job_index);
+        JobInstance job = spec.job(record.job_index);
+        double expected = job.y0[0] * std::exp(-job.parameters.at("lambda") * record.t_first);
+        double tolerance = job.method == "euler" ? 2e-2 : 1e-6;
+        if (record.rows != 1 || std::fabs(record.t_first - 1.0) > 1e-9 ||
+            std::fabs(record.row(0)[0] - expected) > tolerance) {
+            accurate = false;
+        }
+    }
+    check(seen.size() == 12, "one record per job");
+    check(accurate, "final states match the analytical solution");
+
+    // Interrupted sweep: keep the first 5 records plus half of the sixth
+    std::uint64_t keep = 0;
+    {
+        TrajectoryReader partial;
+        partial.open(path);
+        for (int i = 0; i < 5; ++i) partial.next(record);
+        keep = partial.good_bytes();
+    }
+    std::filesystem::resize_file(path, keep + 20);
+
+    stats = BatchRunner(spec, options).run();
+    check(stats.skipped == 5 && stats.completed == 7, "resume reruns only the missing jobs");
+
+    reader = TrajectoryReader();
+    reader.open(path);
+    seen.clear();
+    int records = 0;
+    while (reader.next(record)) {
+        seen.insert(record.job_index);
+        records++;
+    }
+    check(records == 12 && seen.size() == 12 && !reader.truncated(), "resumed file is complete");
+
+    stats = BatchRunner(spec, options).run();
+    check(stats.skipped == 12 && stats.completed == 0, "finished sweep has nothing to do");
+
+    JobSpec full = parse_text("problem exponential\nbackend cpu\nmethod rk45\ntf 0.5\ndt 0.1\nrecord full\n");
+    full.set_output_path(path);
+    bool refused = false;
+    try {
+        BatchRunner(full, options).run();
+    } catch (const std::runtime_error&) {
+        refused = true;
+    }
+    check(refused, "different sweep does not resume into the file");
+
+    options.fresh = true;
+    stats = BatchRunner(full, options).run();
+    reader = TrajectoryReader();
+    reader.open(path);
+    check(stats.completed == 1 && reader.next(record) && record.rows == 6 && record.t_first == 0.0,
+          "fresh run with full trajectories");
+
+    // Without a GPU the backend returns an empty solution: a failed job,
+    // not a record
+    JobSpec gpu = parse_text("problem exponential\nbackend gpu\nmethod euler\ntf 0.5\ndt 0.1\nrecord final\n");
+    gpu.set_output_path(path);
+    stats = BatchRunner(gpu, options).run();
+    reader = TrajectoryReader();
+    reader.open(path);
+    const bool has_record = reader.next(record);
+    check(stats.completed + stats.failed == 1 && has_record == (stats.completed == 1),
+          "empty solution counted as failed");
+    std::remove(path.c_str());
+}
+
+void test_interpreted_sweep() {
+    std::cout << "\n=== INTERPRETED RHS SWEEP ===" << std::endl;
+
+    // No compiler: the job file's RHS stays on the interpreter, and
+    // final-only jobs go to the coalescer's VM ensembles
+    setenv("ODE_JIT_CXX", "/nonexistent/c++", 1);
+    const std::string path = temp_path("ode_test_vm_sweep.traj");
+    std::remove(path.c_str());
+    JobSpec spec = parse_text(
+        "rhs     param k = 1; dy0 = -k*y0\n"
+        "param   k 0.5, 2.0\n"
+        "y0[0]   1.0, 2.0, 3.0, 4.0\n"
+        "method  rk45\n"
+        "tf      1\n"
+        "dt      0.01\n"
+        "record  final\n");
+    spec.set_output_path(path);
+
+    BatchOptions options;
+    options.cpu_workers = 2;
+    options.verbose = false;
+    BatchStats stats = BatchRunner(spec, options).run();
+    check(stats.completed == 8 && stats.coalesced == 8 && stats.failed == 0, "jobs solved in coalesced batches");
+
+    TrajectoryReader reader;
+    TrajectoryRecord record;
+    reader.open(path);
+    int records = 0;
+    bool accurate = true;
+    while (reader.next(record)) {
+        records++;
+        JobInstance job = spec.job(record.job_index);
+        double expected = job.y0[0] * std::exp(-job.parameters.at("k"));
+        if (record.rows != 1 || std::fabs(record.t_first - 1.0) > 1e-9 ||
+            std::fabs(record.row(0)[0] - expected) > 1e-6) {
+            accurate = false;
+        }
+    }
+    check(records == 8 && accurate, "coalesced final states at t = tf");
+    std::remove(path.c_str());
+    unsetenv("ODE_JIT_CXX");
+}
+
+int main() {
+    std::cout << "Batch Job Tests" << std::endl;
+
+    test_expansion();
+    test_parse_errors();
+    test_trajectory_file();
+    test_batch_run_and_resume();
+    test_interpreted_sweep();
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,171 @@
+/* Built as C and linked against libode.so only: checks the header and the
+ * exported symbol set as a C host sees them. */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/ode_c_api.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(int condition, const char* test_name) {
+    if (condition) {
+        printf("✓ %s\n", test_name);
+        tests_passed++;
+    } else {
+        printf("✗ %s\n", test_name);
+        tests_failed++;
+    }
+}
+
+typedef struct {
+    double lambda;
+    long calls;
+} decay_data;
+
+static void decay_rhs(double t, const double* y, double* dydt, int dimension, void* user_data) {
+    decay_data* data = (decay_data*)user_data;
+    int i;
+    (void)t;
+    for (i = 0; i < dimension; ++i) {
+        dydt[i] = -data->lambda * y[i];
+    }
+    data->calls++;
+}
+
+static void test_trajectories(void) {
+    ode_session_config config;
+    ode_session* session = NULL;
+    ode_system* builtin = NULL;
+    ode_system* callback = NULL;
+    decay_data data = {2.0, 0};
+    double y0 = 1.0;
+    double* out;
+    double* out_callback;
+    double final_state = 0.0;
+    size_t rows, i;
+    int identical = 1;
+
+    printf("\n=== TRAJECTORIES ===\n");
+
+    memset(&config, 0, sizeof(config));
+    config.struct_size = sizeof(config);
+    config.method = "rk45";
+    config.threads = 2;
+    check(ode_session_create(&config, &session) == ODE_OK && session != NULL, "session created");
+    check(ode_system_create_builtin("exponential", 1, NULL, NULL, 0, &builtin) == ODE_OK &&
+          ode_system_dimension(builtin) == 1, "builtin system from the registry");
+    check(ode_system_create_callback(1, decay_rhs, &data, &callback) == ODE_OK, "callback system");
+
+    rows = ode_trajectory_rows(0.0, 1.0, 0.01);
+    check(rows == 101, "row count");
+    out = (double*)malloc(rows * sizeof(double));
+    out_callback = (double*)malloc(rows * sizeof(double));
+
+    check(ode_solve(session, builtin, 0.0, 1.0, 0.01, &y0, out, rows) == ODE_OK &&
+          out[0] == 1.0 && fabs(out[rows - 1] - exp(-2.0)) < 1e-6, "trajectory into the caller's buffer");
+    check(ode_solve(session, callback, 0.0, 1.0, 0.01, &y0, out_callback, rows) == ODE_OK &&
+          data.calls == 600, "callback invoked six times per RK45 step");
+    for (i = 0; i < rows; ++i) {
+        if (out[i] != out_callback[i]) identical = 0;
+    }
+    check(identical, "callback and builtin agree bit for bit");
+
+    check(ode_solve(session, builtin, 0.0, 1.0, 0.01, &y0, out, rows - 1) == ODE_ERR_BUFFER_TOO_SMALL &&
+          strstr(ode_last_error(), "101") != NULL, "short buffer rejected with a message");
+    check(ode_solve_final(session, builtin, 0.0, 1.0, 0.01, &y0, &final_state) == ODE_OK &&
+          final_state == out[rows - 1], "final state only");
+
+    free(out);
+    free(out_callback);
+    ode_system_destroy(builtin);
+    ode_system_destroy(callback);
+    ode_session_destroy(session);
+}
+
+static void test_ensemble(void) {
+    const size_t members = 1000;
+    ode_session* session = NULL;
+    ode_system* vdp = NULL;
+    const char* names[] = {"mu"};
+    double mu = 2.0;
+    double* states;
+    double reference[2];
+    size_t m;
+    int matches = 1;
+
+    printf("\n=== ENSEMBLE ===\n");
+
+    check(ode_session_create(NULL, &session) == ODE_OK, "default session");
+    check(ode_system_create_builtin("vanderpol", 2, names, &mu, 1, &vdp) == ODE_OK, "parameter override");
+
+    states = (double*)malloc(members * 2 * sizeof(double));
+    for (m = 0; m < members; ++m) {
+        states[2 * m] = 0.5 + 0.001 * (double)m;
+        states[2 * m + 1] = 0.0;
+    }
+    /* In place: final states overwrite the initial ones */
+    check(ode_solve_ensemble(session, vdp, 0.0, 1.0, 0.01, states, members, states) == ODE_OK,
+          "ensemble solved in place");
+    for (m = 0; m < members; m += 111) {
+        double y0[2];
+        y0[0] = 0.5 + 0.001 * (double)m;
+        y0[1] = 0.0;
+        ode_solve_final(session, vdp, 0.0, 1.0, 0.01, y0, reference);
+        if (states[2 * m] != reference[0] || states[2 * m + 1] != reference[1]) matches = 0;
+    }
+    check(matches, "members match single solves");
+
+    free(states);
+    ode_system_destroy(vdp);
+    ode_session_destroy(session);
+}
+
+static void test_errors(void) {
+    ode_system* system = NULL;
+    ode_session* session = NULL;
+    ode_session_config config;
+    const char* names[] = {"lambda"};
+    double value = 1.0;
+    double y = 1.0;
+
+    printf("\n=== ERRORS ===\n");
+
+    check(ode_api_version() == ODE_API_VERSION, "API version");
+    check(ode_system_create_builtin("lorenz", 3, NULL, NULL, 0, &system) == ODE_ERR_UNKNOWN_NAME &&
+          system == NULL, "unknown problem");
+    check(ode_system_create_builtin("vanderpol", 2, names, &value, 1, &system) == ODE_ERR_UNKNOWN_NAME,
+          "unknown parameter");
+    check(ode_system_create_builtin("vanderpol", 3, NULL, NULL, 0, &system) == ODE_ERR_INVALID_ARGUMENT,
+          "wrong dimension");
+
+    memset(&config, 0, sizeof(config));
+    config.struct_size = sizeof(config);
+    config.method = "midpoint";
+    check(ode_session_create(&config, &session) == ODE_ERR_UNKNOWN_NAME && session == NULL, "unknown method");
+
+    /* A caller built against an older, smaller config struct */
+    config.struct_size = sizeof(size_t);
+    check(ode_session_create(&config, &session) == ODE_OK, "short config uses defaults");
+    ode_system_create_builtin("exponential", 1, NULL, NULL, 0, &system);
+    check(ode_solve_final(session, system, 0.0, 1.0, -0.1, &y, &y) == ODE_ERR_INVALID_ARGUMENT,
+          "negative dt rejected");
+    check(ode_solve_final(NULL, system, 0.0, 1.0, 0.1, &y, &y) == ODE_ERR_INVALID_ARGUMENT,
+          "null session rejected");
+    check(strcmp(ode_status_string(ODE_ERR_BUFFER_TOO_SMALL), "buffer too small") == 0, "status strings");
+
+    ode_system_destroy(system);
+    ode_session_destroy(session);
+}
+
+int main(void) {
+    printf("C API Tests\n");
+
+    test_trajectories();
+    test_ensemble();
+    test_errors();
+
+    printf("\nPassed: %d, Failed: %d\n", tests_passed, tests_failed);
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,233 @@
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../include/bounded_queue.h"
+#include "../include/ensemble.h"
+#include "../include/ensemble_stream.h"
+#include "../include/test_problems.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+static std::string temp_path(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// Van der Pol members on a ring of starting amplitudes
+static std::vector<double> member_state(int m) {
+    return {0.5 + 0.001 * (m % 1000), 0.01 * (m % 7)};
+}
+
+static void write_input(const std::string& path, int members, const std::vector<double>& mus = {}) {
+    EnsembleInputWriter writer;
+    writer.create(path, 2, mus.empty() ? 0 : 1);
+    for (int m = 0; m < members; ++m) {
+        std::vector<double> y0 = member_state(m);
+        double mu = mus.empty() ? 0.0 : mus[m % mus.size()];
+        writer.append(y0.data(), &mu);
+    }
+    writer.close();
+}
+
+void test_bounded_queue() {
+    std::cout << "\n=== BOUNDED QUEUE ===" << std::endl;
+
+    BoundedQueue<int> queue(2);
+    check(queue.push(1) && queue.push(2) && queue.size() == 2, "fills to capacity");
+    int value = 0;
+    check(queue.pop(value) && value == 1, "FIFO order");
+    queue.close();
+    check(!queue.push(3), "push fails after close()");
+    check(queue.pop(value) && value == 2 && !queue.pop(value), "pop drains, then fails");
+}
+
+void test_stream_matches_in_memory() {
+    std::cout << "\n=== STREAM VS IN-MEMORY ===" << std::endl;
+
+    const std::string input = temp_path("ode_test_stream_in.ens");
+    const std::string output = temp_path("ode_test_stream_out.ens");
+    const int members = 10000;
+    write_input(input, members);
+
+    EnsembleInputInfo info;
+    check(StreamingEnsemble::read_input_info(input, info) && info.members == members &&
+          info.dimension == 2 && info.n_params == 0, "input header");
+
+    ThreadPool pool(2);
+    CPUEnsembleBackend backend("rk45", pool);
+    auto system = TestProblems::create_van_der_pol();
+
+    StreamOptions options;
+    options.chunk_members = 768;     // Last chunk is partial
+    options.queue_depth = 2;
+    StreamingEnsemble stream(backend, options);
+    StreamStats stats = stream.run(system, input, output, 0.0, 1.0, 0.01);
+    check(stats.members == members && stats.chunks == (members + 767) / 768, "every chunk passed through");
+
+    std::vector<double> y0;
+    for (int m = 0; m < members; ++m) {
+        std::vector<double> s = member_state(m);
+        y0.insert(y0.end(), s.begin(), s.end());
+    }
+    std::vector<double> expected;
+    backend.solve_ensemble(system, 0.0, 1.0, 0.01, y0, members, expected);
+
+    EnsembleResultFile result;
+    bool identical = result.open(output) && result.members() == members && result.width() == 2;
+    for (int m = 0; identical && m < members; ++m) {
+        if (result.row(m)[0] != expected[2 * m] || result.row(m)[1] != expected[2 * m + 1]) identical = false;
+    }
+    check(identical, "results bit-identical to an in-memory ensemble, in member order");
+    std::cout << "   read " << stats.read_seconds * 1e3 << " ms, solve " << stats.solve_seconds * 1e3
+              << " ms, write " << stats.write_seconds * 1e3 << " ms, wall " << stats.wall_seconds * 1e3
+              << " ms (overlap " << stats.overlap() << "x)" << std::endl;
+
+    // Ten times the members, same buffers
+    const std::string big = temp_path("ode_test_stream_big.ens");
+    write_input(big, 10 * members);
+    StreamStats big_stats = stream.run(system, big, output, 0.0, 0.1, 0.01);
+    check(big_stats.buffer_bytes == stats.buffer_bytes && big_stats.members == 10 * members,
+          "buffer memory independent of ensemble size");
+    std::cout << "   " << big_stats.buffer_bytes / 1024 << " KiB of chunk buffers for "
+              << big_stats.members << " members" << std::endl;
+
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+    std::remove(big.c_str());
+}
+
+void test_reduction_and_parameters() {
+    std::cout << "\n=== REDUCTION / PARAMETERS ===" << std::endl;
+
+    const std::string input = temp_path("ode_test_stream_params.ens");
+    const std::string output = temp_path("ode_test_stream_params_out.ens");
+    const int members = 3000;
+    const std::vector<double> mus = {0.5, 1.0, 2.0};
+    write_input(input, members, mus);
+
+    ThreadPool pool(2);
+    CPUEnsembleBackend backend("rk45", pool);
+    StreamOptions options;
+    options.chunk_members = 1000;
+    options.output_width = 1;        // Keep only the amplitude
+    options.reduce = [](const double* y, double* out) { out[0] = std::hypot(y[0], y[1]); };
+    StreamingEnsemble stream(backend, options);
+
+    int systems_built = 0;
+    StreamStats stats = stream.run(
+        [&](const std::vector<double>& params) {
+            systems_built++;
+            return TestProblems::create_van_der_pol(params[0]);
+        },
+        input, output, 0.0, 1.0, 0.01);
+    check(stats.sub_ensembles == 3 * stats.chunks && systems_built == 3 * static_cast<int>(stats.chunks),
+          "one ensemble call per parameter value per chunk");
+
+    EnsembleResultFile result;
+    bool correct = result.open(output) && result.width() == 1;
+    for (int m = 0; correct && m < members; m += 97) {
+        auto system = TestProblems::create_van_der_pol(mus[m % 3]);
+        std::vector<double> final_state;
+        backend.solve_ensemble(system, 0.0, 1.0, 0.01, member_state(m), 1, final_state);
+        if (result.row(m)[0] != std::hypot(final_state[0], final_state[1])) correct = false;
+    }
+    check(correct, "per-member parameters and reduction applied");
+
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+}
+
+void test_errors() {
+    std::cout << "\n=== ERRORS ===" << std::endl;
+
+    const std::string input = temp_path("ode_test_stream_err.ens");
+    const std::string output = temp_path("ode_test_stream_err_out.ens");
+    write_input(input, 5000);
+
+    ThreadPool pool(1);
+    CPUEnsembleBackend backend("euler", pool);
+    StreamOptions options;
+    options.chunk_members = 500;
+    StreamingEnsemble stream(backend, options);
+
+    bool mismatch = false;
+    try {
+        stream.run(TestProblems::create_exponential_decay(), input, output, 0.0, 1.0, 0.1);
+    } catch (const std::invalid_argument&) {
+        mismatch = true;
+    }
+    check(mismatch, "system of the wrong dimension rejected");
+
+    bool missing = false;
+    try {
+        stream.run(TestProblems::create_van_der_pol(), temp_path("ode_no_such_input.ens"), output, 0.0, 1.0, 0.1);
+    } catch (const std::runtime_error&) {
+        missing = true;
+    }
+    check(missing, "missing input reported");
+
+    // A solver failure mid-stream stops every stage and surfaces in run()
+    auto failing = TestProblems::create_van_der_pol();
+    int calls = 0;
+    failing.rhs_inplace = [&calls](double, const std::vector<double>& y, std::vector<double>& dydt) {
+        if (++calls > 3000) throw std::runtime_error("rhs blew up");
+        dydt[0] = y[1];
+        dydt[1] = -y[0];
+    };
+    bool propagated = false;
+    try {
+        stream.run(failing, input, output, 0.0, 1.0, 0.1);
+    } catch (const std::runtime_error& e) {
+        propagated = std::string(e.what()) == "rhs blew up";
+    }
+    check(propagated, "solver error propagated, pipeline shut down");
+
+    bool needs_reduce = false;
+    try {
+        StreamOptions bad;
+        bad.output_width = 3;
+        StreamingEnsemble unused(backend, bad);
+    } catch (const std::invalid_argument&) {
+        needs_reduce = true;
+    }
+    check(needs_reduce, "output_width without reduce rejected");
+
+    // Header promises more members than the file holds
+    std::filesystem::resize_file(input, 64 + 100 * 16);
+    bool truncated = false;
+    try {
+        stream.run(TestProblems::create_van_der_pol(), input, output, 0.0, 1.0, 0.1);
+    } catch (const std::runtime_error&) {
+        truncated = true;
+    }
+    check(truncated, "truncated input detected up front");
+
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+}
+
+int main() {
+    std::cout << "Streaming Ensemble Tests" << std::endl;
+
+    test_bounded_queue();
+    test_stream_matches_in_memory();
+    test_reduction_and_parameters();
+    test_errors();
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include "../include/test_problems.h"
+#include "../include/gpu_euler_backend.h"
+
+// Separates GPU kernel time from driver overhead for the Euler backend.
+// Without GL_EXT_disjoint_timer_query only the host-side numbers are shown.
+
+ODESystem make_exponential_system(int N) {
+    ODESystem system = TestProblems::create_exponential_decay();
+    system.name = "Exponential x" + std::to_string(N);
+    system.dimension = N;
+    system.initial_conditions.assign(N, 1.0);
+    return system;
+}
+
+int main() {
+    std::cout << "=== GPU TIMER QUERY TEST ===" << std::endl;
+    
+    try {
+        GPUEulerBackend gpu_solver;
+        
+        for (int N : {4, 256, 4096}) {
+            auto system = make_exponential_system(N);
+            std::vector<std::vector<double>> solution;
+            gpu_solver.solve(system, 0.0, 0.5, 0.01, system.initial_conditions, solution);
+            
+            if (solution.empty()) {
+                std::cout << "✗ GPU solver returned empty solution" << std::endl;
+                return 1;
+            }
+            
+            const GPUSolveStats& stats = gpu_solver.last_stats();
+            std::cout << "\nN = " << N << " (" << stats.n_dispatches << " dispatches)" << std::endl;
+            std::cout << std::fixed << std::setprecision(2);
+            std::cout << "   Host time in glDispatchCompute: " << stats.mean_driver_overhead_us() 
+                      << " us/dispatch" << std::endl;
+            std::cout << "   Host readback: " << stats.host_readback_seconds * 1e3 << " ms total" << std::endl;
+            
+            if (stats.gpu_timing_available) {
+                GPUTimingSummary timing = gpu_solver.timer_queries().summary("dispatch");
+                std::cout << "   GPU kernel time: " << stats.mean_gpu_dispatch_us() << " us/dispatch"
+                          << " (min " << timing.min_ns / 1000.0 << ", max " << timing.max_ns / 1000.0 
+                          << ")" << std::endl;
+            } else {
+                std::cout << "   GPU kernel time: unavailable (no timer query support)" << std::endl;
+            }
+            
+            if (gpu_solver.timer_queries().disjoint_events() > 0) {
+                std::cout << "   ⚠ " << gpu_solver.timer_queries().disjoint_events()
+                          << " disjoint events discarded" << std::endl;
+            }
+        }
+        
+        std::cout << "\n✓ GPU timer query test completed" << std::endl;
+        
+    } catch (const std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
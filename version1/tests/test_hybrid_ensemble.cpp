@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include "../include/hybrid_ensemble.h"
+#include "../include/test_problems.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+static std::vector<double> sweep_initial_states(int members) {
+    std::vector<double> y0;
+    for (int m = 0; m < members; ++m) {
+        y0.push_back(0.5 + 2.0 * m / members);
+        y0.push_back(0.1 * (m % 7));
+    }
+    return y0;
+}
+
+void test_cpu_only() {
+    std::cout << "\n=== CPU ONLY ===" << std::endl;
+
+    ThreadPool pool(4);
+    auto system = TestProblems::create_van_der_pol();
+    const int members = 5000;
+    auto y0 = sweep_initial_states(members);
+
+    std::vector<double> reference;
+    CPUEnsembleBackend cpu("rk45", pool);
+    cpu.solve_ensemble(system, 0.0, 1.0, 0.01, y0, members, reference);
+
+    HybridOptions options;
+    options.cpu_chunk = 37;  // Odd size so chunks never line up with threads
+    HybridEnsembleExecutor hybrid("rk45", pool, options);
+    check(!hybrid.gpu_usable(system), "rk45 has no GPU share");
+
+    std::vector<double> final_states;
+    hybrid.solve_ensemble(system, 0.0, 1.0, 0.01, y0, members, final_states);
+    check(final_states == reference, "matches CPUEnsembleBackend bitwise, in member order");
+
+    const HybridStats& stats = hybrid.last_stats();
+    check(stats.cpu_members == members && stats.gpu_members == 0, "all members on CPU");
+    check(stats.cpu_chunks == (members + 36) / 37, "chunk count follows cpu_chunk");
+    check(stats.cpu_rate > 0.0, "CPU throughput measured");
+}
+
+void test_gpu_share() {
+    std::cout << "\n=== GPU + CPU ===" << std::endl;
+
+    ThreadPool pool(4);
+    auto system = TestProblems::create_van_der_pol();
+    const int members = 50000;
+    auto y0 = sweep_initial_states(members);
+
+    std::vector<double> reference;
+    CPUEnsembleBackend cpu("euler", pool);
+    cpu.solve_ensemble(system, 0.0, 0.2, 0.01, y0, members, reference);
+
+    HybridOptions options;
+    options.gpu_min_chunk = 2048;
+    HybridEnsembleExecutor hybrid("euler", pool, options);
+    check(hybrid.gpu_usable(system), "euler + builtin RHS can use the GPU");
+
+    // Without a GPU the failed chunk is redone on the CPU; with one, the
+    // GPU prefix is single precision and the CPU rest is double
+    std::vector<double> final_states;
+    hybrid.solve_ensemble(system, 0.0, 0.2, 0.01, y0, members, final_states);
+    const HybridStats& stats = hybrid.last_stats();
+    std::cout << "   GPU " << stats.gpu_members << " members in " << stats.gpu_chunks
+              << " chunks, CPU " << stats.cpu_members << " members in " << stats.cpu_chunks
+              << " chunks" << (stats.gpu_failed ? " (GPU unavailable)" : "") << std::endl;
+
+    check(stats.gpu_members + stats.cpu_members == members, "every member solved exactly once");
+    const size_t split = static_cast<size_t>(stats.gpu_members) * system.dimension;
+    bool gpu_within_float = true;
+    for (size_t i = 0; i < split; ++i) {
+        if (std::abs(final_states[i] - reference[i]) > 1e-5 * (1.0 + std::abs(reference[i]))) {
+            gpu_within_float = false;
+        }
+    }
+    check(gpu_within_float, "GPU members within float tolerance of the CPU reference");
+    check(final_states.size() == reference.size() &&
+          std::equal(final_states.begin() + split, final_states.end(), reference.begin() + split),
+          "CPU members match the CPU reference bitwise");
+    if (stats.gpu_failed) {
+        check(!hybrid.gpu_usable(system), "GPU disabled after failure");
+    } else {
+        check(stats.gpu_rate > 0.0 && stats.cpu_rate > 0.0, "both throughputs measured");
+    }
+
+    bool rejected = false;
+    try {
+        hybrid.solve_ensemble(system, 0.0, 0.2, 0.01, y0, members - 1, final_states);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    check(rejected, "mismatched initial state rejected");
+}
+
+int main() {
+    std::cout << "=== HYBRID ENSEMBLE TEST ===" << std::endl;
+
+    test_cpu_only();
+    test_gpu_share();
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../include/method_of_lines.h"
+#include "../include/steppers.h"
+#include "../include/threaded_cpu_backend.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+// Serial RK45 with the backends' time sequence (step i starts at t = i * dt)
+static std::vector<double> integrate(const ODESystem& system, std::vector<double> y, int steps, double dt) {
+    auto stepper = create_stepper("rk45");
+    for (int i = 0; i < steps; ++i) {
+        stepper->step(system, i * dt, dt, y);
+    }
+    return y;
+}
+
+static const double kTwoPi = 2.0 * std::acos(-1.0);
+
+// Largest |a - b| over the grid points of component c (padding skipped)
+static double max_error(const MethodOfLines& mol, int c, const double* a, const std::vector<double>& b) {
+    const Grid& grid = mol.grid();
+    double error = 0.0;
+    for (int k = 0; k < grid.points(2); ++k) {
+        for (int j = 0; j < grid.points(1); ++j) {
+            for (int i = 0; i < grid.points(0); ++i) {
+                const long long p = c * grid.field_size() + grid.index(i, j, k);
+                error = std::max(error, std::abs(a[p] - b[p]));
+            }
+        }
+    }
+    return error;
+}
+
+void test_layout() {
+    std::cout << "\n=== LAYOUT ===" << std::endl;
+
+    Grid grid(1024, 1024, 1.0, 1.0);
+    check(grid.row_stride() == 1032 && grid.field_size() == 1032LL * 1024, "rows padded off the 4 KiB multiple");
+    check(Grid(100, 1.0).row_stride() == 104 && Grid(100, 1.0).dimensions() == 1, "rows padded to cache lines");
+
+    MethodOfLines mol(Grid(13, 5, 1.0, 1.0), 2);
+    check(mol.dimension() == 2 * 16 * 5 && mol.grid().index(3, 2) == 35, "component-major, x fastest");
+    check(mol.spacing(0) == 1.0 / 13 && mol.coordinate(1, 4) == 4 * 0.2, "periodic spacing");
+    mol.set_boundary(0, Boundary::Dirichlet);
+    mol.set_boundary(1, Boundary::Neumann);
+    check(mol.spacing(0) == 1.0 / 14 && mol.coordinate(0, 0) == 1.0 / 14 && mol.spacing(1) == 0.25,
+          "Dirichlet and Neumann spacing");
+
+    bool threw = false;
+    try {
+        MethodOfLines(Grid(8, 1.0), 1).set_boundary(1, Boundary::Periodic);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    check(threw, "boundary on a missing axis rejected");
+}
+
+void test_stencils() {
+    std::cout << "\n=== STENCILS ===" << std::endl;
+
+    // Discrete eigenfunction: lap_h sin(2 pi m x) = -(4 / h^2) sin^2(pi m h) sin(2 pi m x)
+    MethodOfLines periodic(Grid(64, 48, 1.0, 2.0), 1);
+    std::vector<double> u = periodic.initial_state([](int, double x, double y, double) {
+        return std::sin(kTwoPi * 3 * x) * std::cos(kTwoPi * y);
+    });
+    std::vector<double> lap(u.size()), expected(u.size(), 0.0);
+    periodic.laplacian(0, u.data(), lap.data());
+    const double hx = periodic.spacing(0), hy = periodic.spacing(1);
+    const double eigen = -4.0 / (hx * hx) * std::pow(std::sin(kTwoPi * 3 * hx / 2), 2) -
+                         4.0 / (hy * hy) * std::pow(std::sin(kTwoPi * hy / 2), 2);
+    for (size_t p = 0; p < u.size(); ++p) expected[p] = eigen * u[p];
+    check(max_error(periodic, 0, lap.data(), expected) < 1e-9, "2D periodic Laplacian eigenvalue");
+
+    std::vector<double> grad(u.size());
+    periodic.gradient(0, 0, u.data(), grad.data());
+    std::vector<double> dx = periodic.initial_state([hx](int, double x, double y, double) {
+        return std::sin(kTwoPi * 3 * hx) / hx * std::cos(kTwoPi * 3 * x) * std::cos(kTwoPi * y);
+    });
+    check(max_error(periodic, 0, grad.data(), dx) < 1e-9, "central gradient");
+
+    // Constant fields are steady under every boundary kind
+    for (Boundary kind : {Boundary::Periodic, Boundary::Dirichlet, Boundary::Neumann}) {
+        MethodOfLines mol(Grid(9, 7, 5, 1.0, 1.0, 1.0), 1);
+        for (int axis = 0; axis < 3; ++axis) mol.set_boundary(axis, kind);
+        mol.set_boundary_value(0, 2.5);
+        std::vector<double> c = mol.initial_state([](int, double, double, double) { return 2.5; });
+        std::vector<double> out(c.size());
+        mol.laplacian(0, c.data(), out.data());
+        check(*std::max_element(out.begin(), out.end()) < 1e-9 && *std::min_element(out.begin(), out.end()) > -1e-9,
+              "3D constant field steady (boundary kind " + std::to_string(static_cast<int>(kind)) + ")");
+    }
+
+    // Dirichlet 1D: lap of the zero field sees the boundary values
+    MethodOfLines rod(Grid(9, 1.0), 1);
+    rod.set_boundary(0, Boundary::Dirichlet);
+    rod.set_boundary_value(0, 1.0);
+    std::vector<double> zero(rod.dimension(), 0.0), out(rod.dimension());
+    rod.laplacian(0, zero.data(), out.data());
+    const double h2 = rod.spacing(0) * rod.spacing(0);
+    check(std::abs(out[0] - 1.0 / h2) < 1e-9 && std::abs(out[8] - 1.0 / h2) < 1e-9 && out[4] == 0.0,
+          "Dirichlet values enter at both ends");
+}
+
+void test_system() {
+    std::cout << "\n=== SYSTEM ===" << std::endl;
+
+    MethodOfLines mol = MethodOfLines::brusselator_2d(37);
+    ODESystem system = mol.system("brusselator");
+    std::vector<double> y = MethodOfLines::brusselator_initial_state(mol);
+    check(system.dimension == 2 * 40 * 37 && system.has_range_rhs(), "Brusselator system with a range RHS");
+
+    std::vector<double> whole(y.size(), -1.0), pieces(y.size(), -1.0);
+    system.rhs_inplace(0.0, y, whole);
+    for (int begin = 0; begin < system.dimension; begin += 97) {
+        system.rhs_range(0.0, y, pieces, begin, std::min(system.dimension, begin + 97));
+    }
+    check(whole == pieces, "ranges that split rows match the whole evaluation");
+    bool padding_zero = true;
+    for (int row = 0; row < 2 * 37; ++row) {
+        for (int i = 37; i < 40; ++i) padding_zero = padding_zero && whole[row * 40 + i] == 0.0;
+    }
+    check(padding_zero, "padding has zero derivative");
+
+    // The homogeneous steady state stays put
+    std::vector<double> steady = mol.initial_state([](int c, double, double, double) { return c == 0 ? 1.0 : 3.4; });
+    std::vector<double> rate(steady.size());
+    system.rhs_inplace(0.0, steady, rate);
+    check(*std::max_element(rate.begin(), rate.end()) < 1e-12 && *std::min_element(rate.begin(), rate.end()) > -1e-12,
+          "steady state (a, b/a) has zero rate");
+
+    ThreadPool pool(3);
+    ThreadedCPUBackend threaded("rk45", pool);
+    std::vector<std::vector<double>> path;
+    threaded.solve(system, 0.0, 0.05, 0.005, y, path);
+    check(path.size() == 11 && path.back() == integrate(system, y, 10, 0.005),
+          "ThreadedCPUBackend bit-identical to the serial stepper");
+
+    // Upwind advection carries a bump around a periodic line, conserving mass
+    MethodOfLines line(Grid(200, 1.0), 1);
+    line.set_advection(0, {1.0, 0.0, 0.0});
+    std::vector<double> bump = line.initial_state([](int, double x, double, double) {
+        return std::exp(-200.0 * (x - 0.3) * (x - 0.3));
+    });
+    std::vector<double> moved = integrate(line.system(), bump, 100, 0.002);
+    double mass0 = 0.0, mass1 = 0.0;
+    int peak = 0;
+    for (int i = 0; i < 200; ++i) {
+        mass0 += bump[i];
+        mass1 += moved[i];
+        if (moved[i] > moved[peak]) peak = i;
+    }
+    check(std::abs(mass1 - mass0) < 1e-9 * mass0 && std::abs(peak - 100) <= 2, "advection moves the bump by v t");
+}
+
+void test_pattern() {
+    std::cout << "\n=== JACOBIAN PATTERN ===" << std::endl;
+
+    MethodOfLines mol = MethodOfLines::brusselator_2d(6);
+    mol.set_boundary(1, Boundary::Dirichlet);
+    JacobianPattern pattern = mol.jacobian_pattern();
+    const long long n = mol.dimension();
+    check(static_cast<long long>(pattern.row_start.size()) == n + 1, "one row per unknown");
+    // 2 components x 36 points, 6 entries each (5-point stencil + coupling),
+    // minus the Dirichlet neighbours of the 2 x 12 y-boundary points
+    check(pattern.nonzeros() == 2 * 36 * 6 - 2 * 12, "5-point stencil plus pointwise coupling");
+
+    // Perturbing y[q] may only move dydt rows whose pattern contains q
+    ODESystem system = mol.system();
+    std::vector<double> y = MethodOfLines::brusselator_initial_state(mol), base(n), moved(n);
+    system.rhs_inplace(0.0, y, base);
+    bool covered = true;
+    long long lower = 0, upper = 0;
+    for (long long q = 0; q < n; ++q) {
+        std::vector<double> z = y;
+        z[q] += 1e-3;
+        system.rhs_inplace(0.0, z, moved);
+        for (long long r = 0; r < n; ++r) {
+            if (moved[r] == base[r]) continue;
+            const auto first = pattern.columns.begin() + pattern.row_start[r];
+            const auto last = pattern.columns.begin() + pattern.row_start[r + 1];
+            covered = covered && std::binary_search(first, last, q);
+            lower = std::max(lower, r - q);
+            upper = std::max(upper, q - r);
+        }
+    }
+    check(covered, "pattern covers every dependence");
+    check(pattern.lower_bandwidth >= lower && pattern.upper_bandwidth >= upper &&
+          pattern.upper_bandwidth == mol.grid().field_size(), "bandwidths bound the dependence");
+}
+
+int main() {
+    std::cout << "Method of Lines Tests" << std::endl;
+
+    test_layout();
+    test_stencils();
+    test_system();
+    test_pattern();
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed > 0 ? 1 : 0;
+}
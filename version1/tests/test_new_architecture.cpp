@@ -60,16 +60,15 @@ void test_steppers() {
 void test_rhs_registry() {
     std::cout << "\n=== TESTING RHS REGISTRY ===" << std::endl;
     
-    auto& registry = BuiltinRHSRegistry::instance();
-    auto available = registry.list_available();
+    auto available = BuiltinRHSRegistry::list_available();
     
     std::cout << "Available RHS systems: " << available.size() << std::endl;
     for (const auto& name : available) {
-        auto rhs = registry.get_rhs(name);
+        const BuiltinRHS& rhs = BuiltinRHSRegistry::get_rhs(name);
         std::cout << "  - " << name << ": " << rhs.description << std::endl;
         std::cout << "    Uniforms: ";
-        for (const auto& uniform : rhs.uniform_names) {
-            std::cout << uniform << " ";
+        for (int i = 0; i < rhs.uniform_count; ++i) {
+            std::cout << rhs.uniform_names[i] << " ";
         }
         std::cout << std::endl;
     }
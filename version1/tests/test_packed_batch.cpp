@@ -0,0 +1,201 @@
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../include/packed_batch.h"
+#include "../include/builtin_rhs_registry.h"
+#include "../include/gpu_context_manager.h"
+#include "../include/rhs_expr.h"
+#include "../include/steppers.h"
+#include "../include/test_problems.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+static ODESystem builtin_system(const RHSProgram& program, const std::map<std::string, double>& parameters) {
+    ODESystem system = to_ode_system(program, parameters);
+    system.gpu_info->builtin_rhs_name = program.name();
+    return system;
+}
+
+// The four builtin types with two parameter sets each
+struct MixedBatch {
+    ODESystem decay_slow = TestProblems::create_exponential_decay(0.5);
+    ODESystem decay_fast = TestProblems::create_exponential_decay(3.0);
+    ODESystem vdp = TestProblems::create_van_der_pol(1.0);
+    ODESystem vdp_stiff = TestProblems::create_van_der_pol(2.5);
+    ODESystem lorenz = builtin_system(RHSLibrary::lorenz(), {});
+    ODESystem lorenz_low = builtin_system(RHSLibrary::lorenz(), {{"rho", 14.0}});
+    ODESystem harmonic = builtin_system(RHSLibrary::harmonic(), {});
+    ODESystem harmonic_fast = builtin_system(RHSLibrary::harmonic(), {{"omega_sq", 4.0}});
+
+    // Interleaved, so packing has to reorder them
+    std::vector<PackedMember> members() const {
+        std::vector<PackedMember> m;
+        for (int copy = 0; copy < 3; ++copy) {
+            const double s = 1.0 + 0.25 * copy;
+            m.push_back({&lorenz, {s, 1.0, 1.0}});
+            m.push_back({&decay_slow, {s}});
+            m.push_back({&harmonic, {s, 0.0}});
+            m.push_back({&vdp, {2.0 * s, 0.0}});
+            m.push_back({&decay_fast, {-s}});
+            m.push_back({&lorenz_low, {1.0, s, 2.0}});
+            m.push_back({&vdp_stiff, {s, 0.5}});
+            m.push_back({&harmonic_fast, {0.0, s}});
+        }
+        return m;
+    }
+};
+
+void test_layout() {
+    std::cout << "\n=== LAYOUT ===" << std::endl;
+
+    MixedBatch batch;
+    const std::vector<PackedMember> members = batch.members();
+    PackedBatchLayout layout(members, 64);
+    const auto& segments = layout.segments();
+
+    bool sorted = segments.size() == 4;
+    for (size_t s = 0; sorted && s < segments.size(); ++s) {
+        sorted = segments[s].rhs_id == static_cast<int>(s) && segments[s].member_count == 6;
+    }
+    check(sorted, "one segment per type, in id order");
+    check(layout.rhs_ids() == std::vector<int>({0, 1, 2, 3}), "distinct RHS ids");
+
+    bool aligned = layout.padded_equations() % 64 == 0;
+    for (size_t s = 0; s < segments.size(); ++s) {
+        const int width = BuiltinRHSRegistry::get_rhs(segments[s].rhs_id).coupling_width;
+        aligned = aligned && segments[s].first_equation % 64 == 0 && segments[s].first_equation % width == 0;
+        if (s > 0) aligned = aligned && segments[s].first_equation >= segments[s - 1].end_equation;
+    }
+    check(aligned && segments[2].first_equation % 192 == 0, "segments on workgroup and coupling boundaries");
+
+    // Stable within a type, each member at its own slot with its parameters
+    bool placed = layout.equations() == 6 * 1 + 6 * 2 + 6 * 3 + 6 * 2;
+    for (size_t s = 0; s < segments.size(); ++s) {
+        const PackedSegment& segment = segments[s];
+        for (int i = 0; i < segment.member_count; ++i) {
+            const int m = layout.order()[segment.first_member + i];
+            placed = placed && (i == 0 || m > layout.order()[segment.first_member + i - 1]);
+            placed = placed && layout.member_offset(m) == segment.first_equation + i * segment.member_dimension;
+            const std::vector<float>& expected = members[m].system->gpu_info->gpu_uniforms;
+            for (int k = 0; k < segment.param_count; ++k) {
+                placed = placed &&
+                         layout.parameters()[segment.param_base + i * segment.param_count + k] == expected[k];
+            }
+        }
+    }
+    check(placed, "members in order, at their offsets, with their own parameters");
+    check(layout.parameters()[segments[0].param_base] == 0.5f &&
+          layout.parameters()[segments[2].param_base + 3 + 1] == 14.0f, "per-member parameter values");
+
+    std::vector<std::vector<double>> unpacked;
+    layout.unpack(layout.initial_state().data(), unpacked);
+    bool round_trip = unpacked.size() == members.size();
+    for (size_t m = 0; round_trip && m < members.size(); ++m) {
+        round_trip = unpacked[m] == members[m].y0;
+    }
+    float padding = 0.0f;
+    for (int i = segments[0].end_equation; i < segments[1].first_equation; ++i) {
+        padding += std::abs(layout.initial_state()[i]);
+    }
+    check(round_trip && padding == 0.0f, "pack/unpack round trip, zero padding");
+
+    bool rejected_plain = false, rejected_size = false;
+    ODESystem plain = TestProblems::create_scalability_test(4);
+    try {
+        PackedBatchLayout({{&plain, plain.initial_conditions}}, 64);
+    } catch (const std::invalid_argument&) {
+        rejected_plain = true;
+    }
+    try {
+        PackedBatchLayout({{&batch.lorenz, {1.0, 2.0}}}, 64);
+    } catch (const std::invalid_argument&) {
+        rejected_size = true;
+    }
+    check(rejected_plain && rejected_size, "members without a builtin RHS or with a bad y0 throw");
+}
+
+void test_shader() {
+    std::cout << "\n=== SHADER ===" << std::endl;
+
+    ShaderGenerator generator;
+    std::string shader = generator.generate_packed_euler_shader({0, 2, 3}, 64);
+    auto count = [&](const std::string& text) {
+        int n = 0;
+        for (size_t pos = shader.find(text); pos != std::string::npos; pos = shader.find(text, pos + 1)) ++n;
+        return n;
+    };
+    check(shader.find("{{") == std::string::npos && count("local_size_x = 64") == 1, "placeholders substituted");
+    check(count("#define evaluate_rhs evaluate_rhs_") == 3 && count("case 2u: dydt = evaluate_rhs_2(") == 1 &&
+          count("evaluate_rhs_1") == 0, "one renamed RHS and case per type");
+    check(shader.find("#define p_sigma member_params[member_param_base + 0u]") != std::string::npos &&
+          shader.find("#define p_beta member_params[member_param_base + 2u]") != std::string::npos &&
+          count("#undef p_omega_sq") == 1, "uniform names read the member's parameters");
+
+    bool threw = false;
+    try {
+        generator.generate_packed_euler_shader({1000}, 64);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    check(threw, "unknown RHS id throws");
+}
+
+void test_gpu_solve() {
+    std::cout << "\n=== GPU SOLVE ===" << std::endl;
+
+    MixedBatch batch;
+    const std::vector<PackedMember> members = batch.members();
+    PackedBatchBackend backend;
+    std::vector<std::vector<double>> final_states;
+
+    if (!GPUContextManager::instance().initialize()) {
+        std::cout << "   (no GPU here: checking the failure paths)" << std::endl;
+        backend.solve_batch(members, 0.0, 0.5, 0.001, final_states);
+        check(final_states.empty(), "failed solve leaves the final states empty");
+        backend.solve_batch(members, 0.0, 0.0, 0.001, final_states);
+        check(final_states.size() == members.size() && final_states[5] == members[5].y0,
+              "zero steps return y0 without the GPU");
+        return;
+    }
+
+    backend.solve_batch(members, 0.0, 0.5, 0.001, final_states);
+    const PackedBatchStats& stats = backend.last_stats();
+    check(stats.n_dispatches == 500 && stats.segments == 4, "one dispatch per step for the whole batch");
+
+    // Every member against its own double-precision Euler run
+    double max_error = final_states.size() == members.size() ? 0.0 : 1e30;
+    for (size_t m = 0; m < members.size() && m < final_states.size(); ++m) {
+        auto stepper = create_stepper("euler");
+        std::vector<double> y = members[m].y0;
+        for (int step = 0; step < 500; ++step) stepper->step(*members[m].system, step * 0.001, 0.001, y);
+        for (size_t i = 0; i < y.size(); ++i) {
+            max_error = std::max(max_error, std::abs(final_states[m][i] - y[i]) / (1.0 + std::abs(y[i])));
+        }
+    }
+    std::cout << "   max relative difference from CPU Euler: " << max_error << std::endl;
+    check(max_error < 1e-4, "mixed batch matches per-member CPU Euler (float)");
+}
+
+int main() {
+    std::cout << "Packed Batch Tests" << std::endl;
+
+    test_layout();
+    test_shader();
+    test_gpu_solve();
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,218 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <stdexcept>
+#include <cstdio>
+#include <thread>
+#include "../include/thread_pool.h"
+#include "../include/threaded_cpu_backend.h"
+#include "../include/ensemble.h"
+#include "../include/scaling_table.h"
+#include "../include/test_problems.h"
+#include "../src/backends/cpu_backend.cpp"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+void test_thread_pool() {
+    std::cout << "\n=== THREAD POOL ===" << std::endl;
+
+    ThreadPool pool(4);
+    check(pool.size() == 4, "pool size");
+
+    const long long n = 1000003;
+    std::vector<int> hits(n, 0);
+    for (int round = 0; round < 200; ++round) {
+        pool.parallel_for(0, n, [&](long long b, long long e, int) {
+            for (long long i = b; i < e; ++i) hits[i]++;
+        });
+    }
+    bool all_hit = true;
+    for (int h : hits) {
+        if (h != 200) all_hit = false;
+    }
+    check(all_hit, "every index visited exactly once per call");
+
+    std::atomic<int> workers_used(0);
+    pool.parallel_for(0, 100, [&](long long, long long, int) { workers_used++; }, 2);
+    check(workers_used == 2, "max_workers limits the split");
+
+    std::atomic<int> tiny(0);
+    pool.parallel_for(0, 2, [&](long long b, long long e, int) { tiny += static_cast<int>(e - b); });
+    check(tiny == 2, "range smaller than pool");
+
+    bool caught = false;
+    try {
+        pool.parallel_for(0, 100, [&](long long b, long long, int) {
+            if (b > 0) throw std::runtime_error("worker failure");
+        });
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    check(caught, "worker exception rethrown in caller");
+
+    long long sum = 0;
+    pool.parallel_for(0, 10, [&](long long b, long long e, int) {
+        if (b == 0) sum = e - b;
+    }, 1);
+    check(sum == 10, "pool usable after exception");
+}
+
+void test_threaded_backend() {
+    std::cout << "\n=== THREADED CPU BACKEND ===" << std::endl;
+
+    ThreadPool pool(4);
+    auto system = TestProblems::create_scalability_test(1001);
+
+    for (const char* method : {"euler", "rk45"}) {
+        std::vector<std::vector<double>> reference;
+        CPUBackend serial(create_stepper(method));
+        serial.solve(system, 0.0, 0.5, 0.01, system.initial_conditions, reference);
+
+        ThreadedCPUBackend threaded(method, pool);
+        std::vector<std::vector<double>> solution;
+        threaded.solve(system, 0.0, 0.5, 0.01, system.initial_conditions, solution);
+
+        check(solution == reference, std::string(method) + " matches CPUBackend bitwise");
+
+        // Reusing the backend must not leak state between solves
+        threaded.solve(system, 0.0, 0.5, 0.01, system.initial_conditions, solution);
+        check(solution == reference, std::string(method) + " repeatable");
+    }
+
+    // No rhs_range: falls back to the serial stepper
+    auto vdp = TestProblems::create_van_der_pol();
+    std::vector<std::vector<double>> reference, solution;
+    CPUBackend serial(create_stepper("rk45"));
+    serial.solve(vdp, 0.0, 1.0, 0.01, vdp.initial_conditions, reference);
+    ThreadedCPUBackend threaded("rk45", pool);
+    threaded.solve(vdp, 0.0, 1.0, 0.01, vdp.initial_conditions, solution);
+    check(solution == reference, "serial fallback without rhs_range");
+
+    bool rejected = false;
+    try {
+        ThreadedCPUBackend unknown("leapfrog", pool);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    check(rejected, "unknown method rejected");
+}
+
+void test_ensemble_backend() {
+    std::cout << "\n=== CPU ENSEMBLE BACKEND ===" << std::endl;
+
+    ThreadPool pool(3);
+    auto system = TestProblems::create_van_der_pol();
+    const int members = 37;
+
+    std::vector<double> y0;
+    for (int m = 0; m < members; ++m) {
+        y0.push_back(0.5 + 0.1 * m);
+        y0.push_back(-0.2 * m);
+    }
+
+    CPUEnsembleBackend ensemble("rk45", pool);
+    std::vector<double> final_states;
+    ensemble.solve_ensemble(system, 0.0, 2.0, 0.01, y0, members, final_states);
+    check(final_states.size() == y0.size(), "final state size");
+
+    bool all_match = true;
+    for (int m = 0; m < members; ++m) {
+        std::vector<double> member_y0 = {y0[2 * m], y0[2 * m + 1]};
+        std::vector<std::vector<double>> reference;
+        CPUBackend serial(create_stepper("rk45"));
+        serial.solve(system, 0.0, 2.0, 0.01, member_y0, reference);
+        if (reference.back()[0] != final_states[2 * m] ||
+            reference.back()[1] != final_states[2 * m + 1]) {
+            all_match = false;
+        }
+    }
+    check(all_match, "each member matches a single-system solve");
+
+    // Two callers with different dimensions share the per-worker scratch
+    auto chain = TestProblems::create_scalability_test(5);
+    std::vector<double> chain_y0(5 * members, 0.3);
+    std::vector<double> vdp_expected, chain_expected;
+    ensemble.solve_ensemble(system, 0.0, 0.5, 0.01, y0, members, vdp_expected);
+    ensemble.solve_ensemble(chain, 0.0, 0.5, 0.01, chain_y0, members, chain_expected);
+    std::atomic<bool> concurrent_match{true};
+    auto caller = [&](const ODESystem& sys, const std::vector<double>& start, const std::vector<double>& expected) {
+        std::vector<double> out;
+        for (int r = 0; r < 20; ++r) {
+            ensemble.solve_ensemble(sys, 0.0, 0.5, 0.01, start, members, out);
+            if (out != expected) concurrent_match = false;
+        }
+    };
+    std::thread first(caller, std::cref(system), std::cref(y0), std::cref(vdp_expected));
+    std::thread second(caller, std::cref(chain), std::cref(chain_y0), std::cref(chain_expected));
+    first.join();
+    second.join();
+    check(concurrent_match, "concurrent solves on one backend");
+
+    bool rejected = false;
+    try {
+        ensemble.solve_ensemble(system, 0.0, 1.0, 0.01, y0, members + 1, final_states);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    check(rejected, "mismatched initial state rejected");
+}
+
+void test_scaling_table() {
+    std::cout << "\n=== SCALING TABLE ===" << std::endl;
+
+    ScalingTable table;
+    check(table.choose_threads("system", 1000, 7) == 7, "fallback when empty");
+
+    table.set("system", 100, 1);
+    table.set("system", 10000, 1);
+    table.set("system", 100000, 4);
+    table.set("ensemble", 100, 2);
+
+    check(table.choose_threads("system", 10, 8) == 1, "below smallest size");
+    check(table.choose_threads("system", 50000, 8) == 1, "between sizes uses lower entry");
+    check(table.choose_threads("system", 5000000, 8) == 4, "above largest size");
+    check(table.crossover("system") == 100000, "system crossover");
+    check(table.crossover("ensemble") == 100, "ensemble crossover");
+    check(table.crossover("missing") == -1, "no crossover for unknown kind");
+
+    const std::string path = "test_scaling_table.txt";
+    check(table.save(path), "save");
+    ScalingTable loaded;
+    check(loaded.load(path), "load");
+    check(loaded.choose_threads("system", 200000, 8) == 4 &&
+          loaded.choose_threads("ensemble", 1000, 8) == 2, "round trip");
+    std::remove(path.c_str());
+
+    ThreadPool pool(4);
+    ThreadedCPUBackend threaded("euler", pool);
+    threaded.set_scaling_table(&table);
+    check(threaded.threads_for(1000) == 1 && threaded.threads_for(1000000) == 4,
+          "backend consults table");
+    threaded.set_scaling_table(nullptr);
+    threaded.set_max_threads(2);
+    check(threaded.threads_for(1000000) == 2, "fixed max threads");
+}
+
+int main() {
+    std::cout << "=== PARALLEL BACKENDS TEST ===" << std::endl;
+
+    test_thread_pool();
+    test_threaded_backend();
+    test_ensemble_backend();
+    test_scaling_table();
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed == 0 ? 0 : 1;
+}
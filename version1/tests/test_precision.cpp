@@ -0,0 +1,163 @@
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "../include/precision.h"
+#include "../include/steppers.h"
+#include "../include/test_problems.h"
+#include "../src/backends/cpu_backend.cpp"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+static_assert(std::is_same<ODESystem, BasicODESystem<double>>::value &&
+              std::is_same<TimeStepper, BasicTimeStepper<double>>::value &&
+              std::is_same<SolverBase, BasicSolverBase<double>>::value,
+              "the plain names are the double instantiations");
+
+template <typename Scalar>
+static std::vector<Scalar> integrate(const BasicODESystem<Scalar>& system, std::vector<Scalar> y,
+                                     const std::string& method, int steps, double dt) {
+    auto stepper = create_stepper<Scalar>(method);
+    for (int i = 0; i < steps; ++i) {
+        stepper->step(system, i * dt, dt, y);
+    }
+    return y;
+}
+
+// y(1) for y' = -2y after RK45 at dt = 0.01, widened to long double
+template <typename Scalar>
+static long double decay() {
+    auto system = TestProblems::create_exponential_decay<Scalar>();
+    std::vector<Scalar> y = integrate(system, system.initial_conditions, "rk45", 100, 0.01);
+    return y[0];
+}
+
+void test_precisions() {
+    std::cout << "\n=== PRECISIONS ===" << std::endl;
+
+    const long double exact = std::exp(-2.0L);
+    const long double y_float = decay<float>(), y_double = decay<double>(), y_long = decay<long double>();
+    std::cout << "   RK45 decay error: float " << static_cast<double>(std::abs(y_float - exact)) << ", double "
+              << static_cast<double>(std::abs(y_double - exact)) << ", long double "
+              << static_cast<double>(std::abs(y_long - exact)) << std::endl;
+    check(std::abs(y_float - exact) < 1e-6 && std::abs(y_float - y_long) > 100 * std::abs(y_double - y_long),
+          "float runs at float rounding");
+    // Same truncation error in every precision; double differs from the
+    // long double reference by its rounding only
+    check(std::abs(y_double - exact) < 1e-11 && std::abs(y_double - y_long) < 1e-15,
+          "long double reference matches double to rounding");
+
+    auto stepper = create_stepper<float>("euler");
+    check(stepper->name() == "Explicit_Euler" && create_stepper<long double>("rk45")->order() == 5,
+          "factory for every precision");
+
+    BasicCPUBackend<float> backend(create_stepper<float>("rk45"));
+    auto vdp = TestProblems::create_van_der_pol<float>();
+    std::vector<std::vector<float>> solution;
+    backend.solve(vdp, 0.0, 1.0, 0.01, vdp.initial_conditions, solution);
+    auto reference = TestProblems::create_van_der_pol();
+    std::vector<double> y = integrate(reference, reference.initial_conditions, "rk45", 100, 0.01);
+    check(solution.size() == 101 && std::abs(solution.back()[0] - y[0]) < 1e-5 &&
+          std::abs(solution.back()[1] - y[1]) < 1e-5, "float backend and output rows track double");
+}
+
+void test_mixed() {
+    std::cout << "\n=== MIXED PRECISION ===" << std::endl;
+
+    // 20000 small steps: pure float loses the O(dt) increments to rounding
+    // against the state, mixed keeps them
+    const int steps = 20000;
+    const double dt = 1e-4;
+    auto single = TestProblems::create_exponential_decay<float>();
+    ODESystem mixed = mixed_precision(single);
+    const double exact = std::exp(-2.0 * steps * dt);
+    const double float_error = std::abs(integrate(single, single.initial_conditions, "euler", steps, dt)[0] -
+                                        integrate(TestProblems::create_exponential_decay(), {1.0}, "euler", steps,
+                                                  dt)[0]);
+    const double mixed_error = std::abs(integrate(mixed, mixed.initial_conditions, "euler", steps, dt)[0] -
+                                        integrate(TestProblems::create_exponential_decay(), {1.0}, "euler", steps,
+                                                  dt)[0]);
+    std::cout << "   Euler vs double Euler after " << steps << " steps: float " << float_error << ", mixed "
+              << mixed_error << " (value " << exact << ")" << std::endl;
+    check(mixed_error < 1e-9 && float_error > 100 * mixed_error, "mixed mode keeps double accumulation");
+
+    check(mixed.dimension == 1 && mixed.has_inplace_rhs() && mixed.gpu_info &&
+          mixed.gpu_info->builtin_rhs_name == "exponential" && mixed.analytical_solution(0.5).size() == 1,
+          "metadata and GPU info carried over");
+
+    // Range RHS: converted ranges reassemble the whole evaluation
+    auto scalability = TestProblems::create_scalability_test<float>(50);
+    ODESystem wide = mixed_precision(scalability);
+    std::vector<double> state = convert_state<double>(scalability.initial_conditions);
+    std::vector<double> whole(50), pieces(50, -1.0);
+    wide.rhs_inplace(0.0, state, whole);
+    for (int begin = 0; begin < 50; begin += 7) wide.rhs_range(0.0, state, pieces, begin, std::min(50, begin + 7));
+    std::vector<float> direct(50);
+    scalability.rhs_inplace(0.0, scalability.initial_conditions, direct);
+    check(whole == pieces && whole == convert_state<double>(direct), "range and whole RHS evaluate in float");
+
+    auto precise = precision_cast<long double>(TestProblems::create_van_der_pol());
+    std::vector<long double> lv = integrate(precise, precise.initial_conditions, "rk45", 10, 0.01);
+    check(lv.size() == 2 && !precise.has_range_rhs() && precise.rhs(0.0, {2.0L, 0.0L})[1] == -2.0L,
+          "precision_cast to long double");
+}
+
+void test_compensated() {
+    std::cout << "\n=== COMPENSATED UPDATES ===" << std::endl;
+
+    // 10^6 Euler steps of y' = -2y: each increment is ~1e-6 of y, so plain
+    // float rounds a large share of it away; the compensated stepper keeps it
+    const int steps = 1000000;
+    const double dt = 1e-6;
+    auto single = TestProblems::create_exponential_decay<float>();
+    const double reference = integrate(TestProblems::create_exponential_decay(), {1.0}, "euler", steps, dt)[0];
+    const double plain = std::abs(integrate(single, single.initial_conditions, "euler", steps, dt)[0] - reference);
+    const double compensated =
+        std::abs(integrate(single, single.initial_conditions, "euler_compensated", steps, dt)[0] - reference);
+    std::cout << "   float Euler vs double after " << steps << " steps: plain " << plain << ", compensated "
+              << compensated << std::endl;
+    check(compensated < 1e-8 && plain > 1000 * compensated, "compensated float Euler drifts like double");
+
+    const double rk_reference = integrate(TestProblems::create_exponential_decay(), {1.0}, "rk45", 20000, 1e-4)[0];
+    const double rk_plain = std::abs(integrate(single, single.initial_conditions, "rk45", 20000, 1e-4)[0] - rk_reference);
+    const double rk_compensated =
+        std::abs(integrate(single, single.initial_conditions, "rk45_compensated", 20000, 1e-4)[0] - rk_reference);
+    std::cout << "   float RK45 vs double after 20000 steps: plain " << rk_plain << ", compensated "
+              << rk_compensated << std::endl;
+    check(rk_compensated < 1e-9 && rk_plain > 10 * rk_compensated, "compensated float RK45");
+
+    // The carry must not leak from one solve into the next
+    BasicCPUBackend<float> backend(create_stepper<float>("rk45_compensated"));
+    std::vector<std::vector<float>> first, second;
+    backend.solve(single, 0.0, 1.0, 1e-3, single.initial_conditions, first);
+    backend.solve(single, 0.0, 1.0, 1e-3, single.initial_conditions, second);
+    check(first == second && backend.name() == "CPU_RK45_Dormand_Prince_Compensated", "carry reset between solves");
+
+    auto decay = TestProblems::create_exponential_decay();
+    check(std::abs(integrate(decay, {1.0}, "euler_compensated", 1000, 1e-3)[0] -
+                   integrate(decay, {1.0}, "euler", 1000, 1e-3)[0]) < 1e-14,
+          "double compensated agrees with plain double");
+}
+
+int main() {
+    std::cout << "Precision Tests" << std::endl;
+
+    test_precisions();
+    test_mixed();
+    test_compensated();
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,131 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cmath>
+#include "../include/profiler.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+static bool within(double value, double expected, double rel_tol) {
+    return std::abs(value - expected) <= rel_tol * expected;
+}
+
+void test_clock() {
+    std::cout << "\n=== CLOCK (" << ProfileClock::source() << ") ===" << std::endl;
+
+    std::uint64_t previous = ProfileClock::now_ns();
+    bool monotonic = true;
+    for (int i = 0; i < 100000; ++i) {
+        std::uint64_t now = ProfileClock::now_ns();
+        if (now < previous) monotonic = false;
+        previous = now;
+    }
+    check(monotonic, "clock never goes backwards");
+
+    std::uint64_t start = ProfileClock::now_ns();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    double elapsed_ms = (ProfileClock::now_ns() - start) / 1e6;
+    std::cout << "   20 ms sleep measured as " << elapsed_ms << " ms" << std::endl;
+    check(elapsed_ms >= 19.0 && elapsed_ms < 200.0, "clock runs at nanosecond scale");
+}
+
+void test_histogram() {
+    std::cout << "\n=== LATENCY HISTOGRAM ===" << std::endl;
+
+    LatencyHistogram histogram;
+    for (std::uint64_t v = 1; v <= 100000; ++v) {
+        histogram.record(v);
+    }
+
+    std::cout << "   p50=" << histogram.percentile_ns(50) << " p99=" << histogram.percentile_ns(99)
+              << " max=" << histogram.max_ns() << std::endl;
+    check(histogram.count() == 100000, "count");
+    check(histogram.min_ns() == 1 && histogram.max_ns() == 100000, "exact min/max");
+    check(within(histogram.mean_ns(), 50000.5, 1e-9), "exact mean");
+    check(within(histogram.percentile_ns(50), 50000, 0.032), "p50 within bucket precision");
+    check(within(histogram.percentile_ns(99), 99000, 0.032), "p99 within bucket precision");
+    check(histogram.percentile_ns(100) == 100000, "p100 is max");
+
+    LatencyHistogram small;
+    for (std::uint64_t v = 0; v < 32; ++v) small.record(v);
+    check(small.percentile_ns(50) == 15, "sub-32ns values are exact");
+
+    LatencyHistogram merged;
+    merged.merge(histogram);
+    merged.merge(small);
+    check(merged.count() == 100032 && merged.min_ns() == 0, "merge combines counts and extremes");
+
+    LatencyHistogram huge;
+    huge.record(1ull << 50);
+    check(huge.percentile_ns(50) == (1ull << 50), "out-of-range values clamp to max");
+}
+
+void test_call_tree() {
+    std::cout << "\n=== CALL TREE ===" << std::endl;
+
+    Profiler::instance().reset();
+    for (int i = 0; i < 10; ++i) {
+        ScopedTimer outer("solve");
+        for (int j = 0; j < 5; ++j) {
+            ScopedTimer step("step");
+            { ScopedTimer rhs("rhs"); }
+            { ScopedTimer update("update"); }
+        }
+    }
+    { ScopedTimer other("rhs"); }  // Same name at a different path
+
+    check(Profiler::instance().histogram("solve").count() == 10, "outer scope count");
+    check(Profiler::instance().histogram("solve/step").count() == 50, "nested scope count");
+    check(Profiler::instance().histogram("solve/step/rhs").count() == 50, "leaf scope count");
+    check(Profiler::instance().histogram("rhs").count() == 1, "paths are distinct by parent");
+    check(Profiler::instance().histogram("solve").total_ns() >=
+          Profiler::instance().histogram("solve/step").total_ns(), "parent time includes children");
+
+    auto entries = Profiler::instance().report();
+    bool ordered = entries.size() >= 4 && entries[0].path == "solve" && entries[1].path == "solve/step" &&
+                   entries[1].depth == 1 && entries[2].path == "solve/step/rhs" && entries[2].depth == 2;
+    check(ordered, "report is depth-first with depths");
+}
+
+void test_threads() {
+    std::cout << "\n=== PER-THREAD TREES ===" << std::endl;
+
+    Profiler::instance().reset();
+    std::vector<std::thread> workers;
+    for (int w = 0; w < 4; ++w) {
+        workers.emplace_back([]() {
+            for (int i = 0; i < 1000; ++i) {
+                ScopedTimer work("worker_task");
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    check(Profiler::instance().histogram("worker_task").count() == 4000, "threads merged by path");
+
+    Profiler::instance().print_report(std::cout);
+}
+
+int main() {
+    std::cout << "=== PROFILER TEST ===" << std::endl;
+
+    test_clock();
+    test_histogram();
+    test_call_tree();
+    test_threads();
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,318 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../include/fft.h"
+#include "../include/pseudo_spectral.h"
+#include "../include/shader_generator.h"
+#include "../include/steppers.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+static const double kTwoPi = 2.0 * std::acos(-1.0);
+
+static Complex naive_dft(const std::vector<Complex>& x, long long k) {
+    const long long n = static_cast<long long>(x.size());
+    Complex sum(0.0, 0.0);
+    for (long long j = 0; j < n; ++j) sum += x[j] * std::polar(1.0, -kTwoPi * static_cast<double>(j * k % n) / n);
+    return sum;
+}
+
+static double max_difference(const std::vector<double>& a, const std::vector<double>& b) {
+    double error = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) error = std::max(error, std::abs(a[i] - b[i]));
+    return error;
+}
+
+template <typename Stepper>
+static std::vector<double> integrate(std::shared_ptr<const PseudoSpectral> op, std::vector<double> u, int steps,
+                                     double dt) {
+    Stepper stepper(op);
+    std::vector<Complex> u_hat(op->modes());
+    op->to_spectral(u.data(), u_hat.data());
+    for (int i = 0; i < steps; ++i) stepper.step_spectral(dt, u_hat.data());
+    op->to_physical(u_hat.data(), u.data());
+    return u;
+}
+
+void test_fft() {
+    std::cout << "\n=== FFT ===" << std::endl;
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    // 2^17 takes the four-step path; check a sample of its outputs
+    for (int n : {1, 2, 8, 32, 512, 1 << 17}) {
+        std::vector<Complex> x(n);
+        for (Complex& v : x) v = Complex(uniform(rng), uniform(rng));
+        std::vector<Complex> spectrum = x;
+        FFTPlan::get(n)->forward(spectrum.data());
+        double error = 0.0;
+        for (int s = 0; s < std::min(n, 64); ++s) {
+            const long long k = n <= 64 ? s : (s * 2053LL) % n;
+            error = std::max(error, std::abs(spectrum[k] - naive_dft(x, k)));
+        }
+        FFTPlan::get(n)->inverse(spectrum.data());
+        double round_trip = 0.0;
+        for (int j = 0; j < n; ++j) round_trip = std::max(round_trip, std::abs(spectrum[j] - x[j]));
+        check(error < 1e-12 * n + 1e-13 && round_trip < 1e-14,
+              "complex n = " + std::to_string(n) + " matches the DFT and inverts");
+    }
+
+    for (int n : {2, 64, 1 << 18}) {
+        std::vector<double> x(n), back(n);
+        for (double& v : x) v = uniform(rng);
+        std::vector<Complex> spectrum(n / 2 + 1), reference(x.begin(), x.end());
+        RealFFTPlan::get(n)->forward(x.data(), spectrum.data());
+        double error = 0.0;
+        for (int k : {0, 1, n / 4, n / 2 - 1, n / 2}) {
+            error = std::max(error, std::abs(spectrum[k] - naive_dft(reference, k)));
+        }
+        RealFFTPlan::get(n)->inverse(spectrum.data(), back.data());
+        check(error < 1e-12 * n + 1e-13 && max_difference(x, back) < 1e-14,
+              "real n = " + std::to_string(n) + " matches the DFT and inverts");
+    }
+
+    const int nx = 16, ny = 8;
+    std::vector<double> field(nx * ny), back(nx * ny);
+    for (double& v : field) v = uniform(rng);
+    RealFFT2D fft2(nx, ny);
+    std::vector<Complex> coefficients(fft2.modes());
+    fft2.forward(field.data(), coefficients.data());
+    double error = 0.0;
+    for (int ky = 0; ky < ny; ++ky) {
+        for (int kx = 0; kx <= nx / 2; ++kx) {
+            Complex sum(0.0, 0.0);
+            for (int j = 0; j < ny; ++j) {
+                for (int i = 0; i < nx; ++i) {
+                    sum += field[j * nx + i] * std::polar(1.0, -kTwoPi * (double(i * kx) / nx + double(j * ky) / ny));
+                }
+            }
+            error = std::max(error, std::abs(sum - coefficients[ky * (nx / 2 + 1) + kx]));
+        }
+    }
+    fft2.inverse(coefficients.data(), back.data());
+    check(error < 1e-12 && max_difference(field, back) < 1e-14, "2D real transform matches the DFT and inverts");
+
+    check(FFTPlan::get(256) == FFTPlan::get(256) && RealFFTPlan::get(512) == RealFFTPlan::get(512),
+          "plans are cached per size");
+    int rejected = 0;
+    for (int n : {0, 12, 3}) {
+        try {
+            FFTPlan plan(n);
+        } catch (const std::invalid_argument&) {
+            ++rejected;
+        }
+    }
+    try {
+        RealFFTPlan plan(1);
+    } catch (const std::invalid_argument&) {
+        ++rejected;
+    }
+    check(rejected == 4, "sizes that are not powers of two rejected");
+}
+
+void test_operator() {
+    std::cout << "\n=== OPERATOR ===" << std::endl;
+
+    // u = sin x + cos y: every product stays inside the kept 2/3 band
+    SpectralEquation eq;
+    eq.laplacian = 1.0;
+    eq.flux = 1.0;
+    eq.gradient_squared = 1.0;
+    PseudoSpectral op(32, 16, kTwoPi, kTwoPi, eq);
+    std::vector<double> u = op.initial_state([](double x, double y) { return std::sin(x) + std::cos(y); });
+    std::vector<double> dudt(u.size());
+    std::vector<double> expected = op.initial_state([](double x, double y) {
+        const double v = std::sin(x) + std::cos(y);
+        return -v + 2.0 * v * (std::cos(x) - std::sin(y)) + std::cos(x) * std::cos(x) + std::sin(y) * std::sin(y);
+    });
+    op.evaluate(u.data(), dudt.data());
+    check(max_difference(dudt, expected) < 1e-12, "2D diffusion, flux and |grad u|^2 terms");
+
+    ODESystem system = op.system("spectral_2d");
+    std::vector<double> via_system(u.size());
+    system.rhs_inplace(0.0, u, via_system);
+    check(system.dimension == 32 * 16 && via_system == dudt && system.rhs(0.0, u) == dudt,
+          "ODESystem wraps the same RHS");
+
+    // Nonlinear output of a broadband field is confined to the lower two
+    // thirds (k < 128 / 3)
+    PseudoSpectral burgers(128, kTwoPi, SpectralEquation::burgers(0.1));
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    std::vector<double> rough(burgers.size());
+    for (double& v : rough) v = uniform(rng);
+    std::vector<Complex> rough_hat(burgers.modes()), n_hat(burgers.modes());
+    burgers.to_spectral(rough.data(), rough_hat.data());
+    burgers.nonlinear(rough_hat.data(), n_hat.data());
+    bool dealiased = true;
+    for (int k = 43; k < burgers.modes(); ++k) dealiased = dealiased && n_hat[k] == Complex(0.0, 0.0);
+    check(dealiased && std::abs(n_hat[42]) > 0.0, "2/3-rule dealiasing");
+
+    bool threw = false;
+    try {
+        PseudoSpectral(24, 1.0, SpectralEquation::kdv());
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    check(threw, "non power-of-two grid rejected");
+}
+
+void test_linear_exact() {
+    std::cout << "\n=== LINEAR PROBLEMS ===" << std::endl;
+
+    // With N = 0 both exponential steppers are exact for any dt
+    SpectralEquation eq;
+    eq.laplacian = 0.5;
+    eq.dispersion = 1.0;
+    auto line = std::make_shared<const PseudoSpectral>(32, kTwoPi, eq);
+    std::vector<double> u0 = line->initial_state([](double x, double) { return std::sin(3 * x) + std::cos(5 * x); });
+    const double t = 2.0;
+    // u_t = u_xx / 2 + u_xxx: sin(kx) -> e^{-k^2 t / 2} sin(k (x - k^2 t))
+    std::vector<double> exact = line->initial_state([t](double x, double) {
+        return std::exp(-4.5 * t) * std::sin(3 * (x - 9 * t)) + std::exp(-12.5 * t) * std::cos(5 * (x - 25 * t));
+    });
+    check(max_difference(integrate<ETDRK4Stepper>(line, u0, 4, t / 4), exact) < 1e-12, "ETDRK4 exact on u_t = L u");
+    check(max_difference(integrate<IntegratingFactorRK4Stepper>(line, u0, 4, t / 4), exact) < 1e-12,
+          "IF-RK4 exact on u_t = L u");
+
+    SpectralEquation heat;
+    heat.laplacian = 1.0;
+    auto heat_plane = std::make_shared<const PseudoSpectral>(16, 32, kTwoPi, kTwoPi, heat);
+    std::vector<double> v0 = heat_plane->initial_state([](double x, double y) { return std::sin(x) * std::cos(2 * y); });
+    std::vector<double> v1 = v0;
+    for (double& v : v1) v *= std::exp(-5.0);
+    ETDRK4Stepper stepper(heat_plane);
+    std::vector<double> v = v0;
+    for (int i = 0; i < 3; ++i) stepper.step(heat_plane->system(), i / 3.0, 1.0 / 3.0, v);
+    check(max_difference(v, v1) < 1e-13 && heat_plane->modes() == 9 * 32, "2D heat decay through TimeStepper::step");
+}
+
+void test_nonlinear() {
+    std::cout << "\n=== NONLINEAR PROBLEMS ===" << std::endl;
+
+    // KdV soliton u = c/2 sech^2(sqrt(c)/2 (x - x0 - c t))
+    auto kdv = std::make_shared<const PseudoSpectral>(256, 60.0, SpectralEquation::kdv());
+    auto soliton = [](double t) {
+        return [t](double x, double) {
+            const double s = 1.0 / std::cosh(0.5 * (x - 30.0 - t));
+            return 0.5 * s * s;
+        };
+    };
+    std::vector<double> u0 = kdv->initial_state(soliton(0.0));
+    std::vector<double> exact = kdv->initial_state(soliton(2.0));
+    const double etd_error = max_difference(integrate<ETDRK4Stepper>(kdv, u0, 400, 0.005), exact);
+    const double if_error = max_difference(integrate<IntegratingFactorRK4Stepper>(kdv, u0, 400, 0.005), exact);
+    std::cout << "   KdV soliton error: ETDRK4 " << etd_error << ", IF-RK4 " << if_error << std::endl;
+    check(etd_error < 1e-8 && if_error < 1e-8, "KdV soliton travels at speed c");
+
+    // Viscous Burgers: the exponential steppers agree with RK45 on the
+    // ODESystem at a 10x smaller step
+    auto burgers = std::make_shared<const PseudoSpectral>(64, kTwoPi, SpectralEquation::burgers(0.1));
+    std::vector<double> b0 = burgers->initial_state([](double x, double) { return std::sin(x); });
+    ODESystem system = burgers->system("burgers");
+    auto rk45 = create_stepper("rk45");
+    std::vector<double> reference = b0;
+    for (int i = 0; i < 500; ++i) rk45->step(system, i * 1e-3, 1e-3, reference);
+    check(max_difference(integrate<ETDRK4Stepper>(burgers, b0, 50, 0.01), reference) < 1e-7 &&
+          max_difference(integrate<IntegratingFactorRK4Stepper>(burgers, b0, 50, 0.01), reference) < 1e-7,
+          "Burgers: ETDRK4 and IF-RK4 match RK45");
+
+    // Kuramoto-Sivashinsky (Kassam & Trefethen's setup): dt = 1/4 is far
+    // beyond explicit stability (|L| reaches 2e3); stays bounded, mean kept
+    auto ks = std::make_shared<const PseudoSpectral>(128, 32.0 * kTwoPi / 2.0, SpectralEquation::kuramoto_sivashinsky());
+    std::vector<double> k0 = ks->initial_state([](double x, double) {
+        return std::cos(x / 16.0) * (1.0 + std::sin(x / 16.0));
+    });
+    std::vector<double> k1 = integrate<ETDRK4Stepper>(ks, k0, 400, 0.25);
+    double mean = 0.0, peak = 0.0;
+    bool finite = true;
+    for (double v : k1) {
+        mean += v;
+        peak = std::max(peak, std::abs(v));
+        finite = finite && std::isfinite(v);
+    }
+    mean /= k1.size();
+    check(finite && peak < 5.0 && peak > 0.5 && std::abs(mean) < 1e-12, "KS chaotic state bounded, mean conserved");
+
+    auto ks2 = std::make_shared<const PseudoSpectral>(32, 32, 8.0 * kTwoPi, 8.0 * kTwoPi,
+                                                      SpectralEquation::kuramoto_sivashinsky_2d());
+    std::vector<double> s0 = ks2->initial_state([](double x, double y) {
+        return 0.1 * std::sin(x / 8.0) * std::cos(y / 4.0);
+    });
+    std::vector<double> etd = integrate<ETDRK4Stepper>(ks2, s0, 40, 0.05);
+    std::vector<double> ifrk = integrate<IntegratingFactorRK4Stepper>(ks2, s0, 40, 0.05);
+    check(max_difference(etd, ifrk) < 1e-6 && max_difference(etd, s0) > 1e-3, "2D KS: ETDRK4 and IF-RK4 agree");
+
+    bool threw = false;
+    try {
+        ETDRK4Stepper stepper(ks);
+        std::vector<double> wrong(100, 0.0);
+        stepper.step(system, 0.0, 0.1, wrong);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    check(threw, "state of the wrong size rejected");
+}
+
+void test_fft_shader() {
+    std::cout << "\n=== GLSL FFT ===" << std::endl;
+
+    ShaderGenerator generator;
+    const std::string forward = generator.generate_fft_shader(256);
+    check(forward.rfind("#version 310 es", 0) == 0 && forward.find("{{") == std::string::npos,
+          "template found and fully substituted");
+    size_t barriers = 0;
+    for (size_t pos = forward.find("    barrier();"); pos != std::string::npos;
+         pos = forward.find("    barrier();", pos + 1)) {
+        ++barriers;
+    }
+    check(barriers == 9 && forward.find("butterflies(256u, 0u, 0u, 256u);") != std::string::npos &&
+          forward.find("butterflies(2u, 7u, 256u, 0u);") != std::string::npos,
+          "one unrolled pass and barrier per radix-2 stage");
+    check(forward.find("local_size_x = 128,") != std::string::npos &&
+          forward.find("work[0u + i]") != std::string::npos, "workgroup size and result buffer");
+
+    const std::string inverse = generator.generate_fft_shader(512, true);
+    check(inverse.find("#define DIRECTION 1.0") != std::string::npos &&
+          inverse.find("#define SCALE 0.001953125") != std::string::npos &&
+          inverse.find("work[512u + i]") != std::string::npos, "inverse direction and 1/n scale");
+
+    int rejected = 0;
+    for (int n : {1, 24, 2048}) {
+        try {
+            generator.generate_fft_shader(n);
+        } catch (const std::invalid_argument&) {
+            ++rejected;
+        }
+    }
+    check(rejected == 3, "unsupported shader sizes rejected");
+}
+
+int main() {
+    std::cout << "Pseudo-Spectral Tests" << std::endl;
+
+    test_fft();
+    test_operator();
+    test_linear_exact();
+    test_nonlinear();
+    test_fft_shader();
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,214 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/request_coalescer.h"
+#include "../include/test_problems.h"
+#include "../include/threaded_cpu_backend.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+static std::vector<double> final_state(const ODESystem& system, const std::string& method,
+                                       const std::vector<double>& y0, double tf, double dt) {
+    ThreadPool pool(1);
+    ThreadedCPUBackend backend(method, pool);
+    std::vector<std::vector<double>> solution;
+    backend.solve(system, 0.0, tf, dt, y0, solution);
+    return solution.back();
+}
+
+static bool ready_within(std::future<CoalescedResult>& future, double seconds) {
+    return future.wait_for(std::chrono::duration<double>(seconds)) == std::future_status::ready;
+}
+
+void test_window() {
+    std::cout << "\n=== WINDOW ===" << std::endl;
+
+    ThreadPool pool(2);
+    CoalescerOptions options;
+    options.window_seconds = 0.05;
+    RequestCoalescer coalescer(pool, CostCalibration::defaults(), options);
+    auto system = TestProblems::create_van_der_pol();
+
+    // Ten requests well inside one window: one dispatch
+    std::vector<std::future<CoalescedResult>> futures;
+    for (int i = 0; i < 10; ++i) {
+        futures.push_back(coalescer.submit(system, "rk45", 0.0, 1.0, 0.01, {1.0 + 0.1 * i, 0.0}));
+    }
+
+    bool correct = true;
+    bool one_batch = true;
+    for (int i = 0; i < 10; ++i) {
+        CoalescedResult result = futures[i].get();
+        auto expected = final_state(system, "rk45", {1.0 + 0.1 * i, 0.0}, 1.0, 0.01);
+        for (int d = 0; d < 2; ++d) {
+            if (std::fabs(result.final_state[d] - expected[d]) > 1e-12) correct = false;
+        }
+        if (result.batch_size != 10) one_batch = false;
+    }
+    check(correct, "results split back to the right callers");
+    check(one_batch, "requests inside the window share one batch");
+
+    CoalescerMetrics metrics = coalescer.metrics();
+    check(metrics.batches == 1 && metrics.window_flushes == 1 && metrics.requests == 10,
+          "one window flush for ten requests");
+    check(metrics.wait.count() == 10 && metrics.wait.min_ns() >= 40000000ULL,
+          "held requests waited about one window");
+    std::cout << "   mean batch " << metrics.mean_batch_size() << ", wait mean "
+              << metrics.wait.mean_ns() / 1e6 << " ms, run " << metrics.run.mean_ns() / 1e6
+              << " ms" << std::endl;
+}
+
+void test_max_batch_and_keys() {
+    std::cout << "\n=== MAX BATCH / KEYS ===" << std::endl;
+
+    ThreadPool pool(2);
+    CoalescerOptions options;
+    options.window_seconds = 30.0;   // Only the batch cap can release these
+    options.max_batch = 4;
+    RequestCoalescer coalescer(pool, CostCalibration::defaults(), options);
+    auto system = TestProblems::create_exponential_decay();
+
+    std::vector<std::future<CoalescedResult>> futures;
+    for (int i = 0; i < 8; ++i) {
+        futures.push_back(coalescer.submit(system, "euler", 0.0, 1.0, 0.01, {1.0 + i}));
+    }
+    bool all_ready = true;
+    for (auto& future : futures) {
+        if (!ready_within(future, 5.0)) all_ready = false;
+    }
+    check(all_ready, "full groups dispatch without waiting for the window");
+    CoalescerMetrics metrics = coalescer.metrics();
+    check(metrics.full_flushes == 2 && metrics.largest_batch == 4, "two batches of max_batch");
+
+    check(RequestCoalescer::batch_key(system, "euler", 0.0, 1.0, 0.01) !=
+          RequestCoalescer::batch_key(system, "euler", 0.0, 1.0, 0.02), "time grid is part of the key");
+    auto custom = TestProblems::create_scalability_test(4);
+    check(RequestCoalescer::batch_key(custom, "euler", 0.0, 1.0, 0.01) !=
+          RequestCoalescer::batch_key(custom, "euler", 0.0, 1.0, 0.01), "plain callables never share a key");
+
+    // Tightening the window releases new groups promptly
+    CoalescerOptions fast = coalescer.options();
+    fast.window_seconds = 0.0;
+    coalescer.set_options(fast);
+    auto d = coalescer.submit(TestProblems::create_van_der_pol(), "euler", 0.0, 1.0, 0.01, {2.0, 0.0});
+    check(ready_within(d, 5.0) && d.get().batch_size == 1, "window retuned at runtime");
+
+    bool rejected = false;
+    try {
+        coalescer.submit(system, "euler", 0.0, 1.0, 0.01, {1.0, 2.0});
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    check(rejected, "wrong state size rejected at submit");
+
+    // Different stepper or grid: never merged. All three are held by the
+    // 30 s window, so only shutdown can dispatch them.
+    auto held = std::make_unique<RequestCoalescer>(pool, CostCalibration::defaults(), options);
+    auto a = held->submit(system, "euler", 0.0, 1.0, 0.01, {1.0});
+    auto b = held->submit(system, "rk45", 0.0, 1.0, 0.01, {1.0});
+    auto c = held->submit(system, "euler", 0.0, 1.0, 0.02, {1.0});
+    held.reset();
+    check(ready_within(a, 0.0) && ready_within(b, 0.0) && ready_within(c, 0.0),
+          "destruction dispatches held groups");
+    check(a.get().batch_size == 1 && b.get().batch_size == 1 && c.get().batch_size == 1,
+          "incompatible requests stayed apart");
+}
+
+void test_parameterizations() {
+    std::cout << "\n=== PARAMETERIZATIONS ===" << std::endl;
+
+    ThreadPool pool(2);
+    CoalescerOptions options;
+    options.window_seconds = 0.05;
+    RequestCoalescer coalescer(pool, CostCalibration::defaults(), options);
+
+    // Same builtin RHS, different lambda, one window: two batches, each
+    // solved with its own parameters
+    auto slow = TestProblems::create_exponential_decay(0.5);
+    auto fast = TestProblems::create_exponential_decay(2.0);
+    std::vector<std::future<CoalescedResult>> slow_futures, fast_futures;
+    for (int i = 0; i < 3; ++i) {
+        slow_futures.push_back(coalescer.submit(slow, "rk45", 0.0, 1.0, 0.01, {1.0 + i}));
+        fast_futures.push_back(coalescer.submit(fast, "rk45", 0.0, 1.0, 0.01, {1.0 + i}));
+    }
+    bool correct = true;
+    for (int i = 0; i < 3; ++i) {
+        CoalescedResult a = slow_futures[i].get();
+        CoalescedResult b = fast_futures[i].get();
+        correct = correct && a.batch_size == 3 && b.batch_size == 3 &&
+                  std::fabs(a.final_state[0] - final_state(slow, "rk45", {1.0 + i}, 1.0, 0.01)[0]) < 1e-12 &&
+                  std::fabs(b.final_state[0] - final_state(fast, "rk45", {1.0 + i}, 1.0, 0.01)[0]) < 1e-12;
+    }
+    check(correct, "each parameterization solved with its own parameters");
+    check(coalescer.metrics().batches == 2, "parameters split the groups");
+}
+
+void test_concurrent_producers() {
+    std::cout << "\n=== CONCURRENT PRODUCERS ===" << std::endl;
+
+    ThreadPool pool(2);
+    CoalescerOptions options;
+    options.window_seconds = 0.005;
+    RequestCoalescer coalescer(pool, CostCalibration::defaults(), options);
+    auto system = TestProblems::create_exponential_decay();
+
+    const int threads = 8;
+    const int per_thread = 50;
+    std::vector<int> wrong(threads, 0);
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads; ++t) {
+        producers.emplace_back([&, t]() {
+            for (int i = 0; i < per_thread; ++i) {
+                double y = 1.0 + t + 0.01 * i;
+                CoalescedResult result =
+                    coalescer.submit(system, "rk45", 0.0, 0.5, 0.01, {y}).get();
+                if (std::fabs(result.final_state[0] - y * std::exp(-1.0)) > 1e-6) wrong[t]++;
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    int total_wrong = 0;
+    for (int w : wrong) total_wrong += w;
+    CoalescerMetrics metrics = coalescer.metrics();
+    std::cout << "   " << metrics.requests << " requests in " << metrics.batches
+              << " batches (mean " << metrics.mean_batch_size() << ", largest "
+              << metrics.largest_batch << "), added latency p50 "
+              << metrics.wait.percentile_ns(50) / 1e3 << " us, p99 "
+              << metrics.wait.percentile_ns(99) / 1e3 << " us" << std::endl;
+    check(total_wrong == 0, "400 concurrent requests answered correctly");
+    check(metrics.requests == threads * per_thread, "every request accounted for");
+    check(metrics.mean_batch_size() > 1.5, "concurrent callers share dispatches");
+
+    coalescer.reset_metrics();
+    check(coalescer.metrics().batches == 0 && coalescer.metrics().wait.count() == 0, "reset_metrics()");
+}
+
+int main() {
+    std::cout << "Request Coalescer Tests" << std::endl;
+
+    test_window();
+    test_max_batch_and_keys();
+    test_parameterizations();
+    test_concurrent_producers();
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,312 @@
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../include/builtin_rhs_registry.h"
+#include "../include/rhs_expr.h"
+#include "../include/steppers.h"
+#include "../include/test_problems.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+static bool contains(const std::string& text, const std::string& part) {
+    return text.find(part) != std::string::npos;
+}
+
+static std::vector<double> solve_final(const ODESystem& system, const std::string& method,
+                                       std::vector<double> y, int steps, double dt) {
+    auto stepper = create_stepper(method);
+    for (int i = 0; i < steps; ++i) {
+        stepper->step(system, i * dt, dt, y);
+    }
+    return y;
+}
+
+void test_cse() {
+    std::cout << "\n=== COMMON SUBEXPRESSIONS ===" << std::endl;
+
+    RHSProgram p("cse", 2);
+    RHSExpr x = p.state(0);
+    RHSExpr y = p.state(1);
+    RHSExpr a = x * y + sin(x * y);
+    RHSExpr b = sin(y * x) + y * x;
+    check(a.id == b.id, "commuted operands share one node");
+    p.set_output(0, a);
+    p.set_output(1, 2.0 * (x * y) - 3.0 * 2.0);
+    check(p.operation_count() == 5, "x*y computed once across outputs (5 operations)");
+    check(p.nodes()[(p.constant(2.0) * 3.0).id].value == 6.0 && (1.0 * (x + 0.0)).id == x.id,
+          "constants folded, x*1 and x+0 dropped");
+
+    RHSProgram text = RHSProgram::parse("let s = y0*y1\n"
+                                        "dy0 = s + sin(y1*y0)\n"
+                                        "dy1 = 2*s - 6\n", "cse");
+    check(text.operation_count() == p.operation_count(), "text form reaches the same graph");
+}
+
+void test_tape_matches_test_problems() {
+    std::cout << "\n=== TAPE VS TESTPROBLEMS ===" << std::endl;
+
+    const double mu = 1.7;
+    ODESystem hand = TestProblems::create_van_der_pol(mu);
+    ODESystem generated = to_ode_system(RHSLibrary::vanderpol(), {{"mu", mu}});
+    check(generated.dimension == 2 && generated.parameters.at("mu") == mu, "parameters applied");
+
+    bool identical = true;
+    std::vector<double> y(2), f_hand(2), f_gen(2);
+    for (int i = 0; i < 200; ++i) {
+        y = {std::sin(0.37 * i) * 3.0, std::cos(0.11 * i) * 2.0};
+        hand.rhs_inplace(0.0, y, f_hand);
+        generated.rhs_inplace(0.0, y, f_gen);
+        if (f_hand != f_gen) identical = false;
+    }
+    check(identical, "van der Pol tape bit-identical to the lambda");
+    check(solve_final(hand, "rk45", {2.0, 0.0}, 500, 0.01) == solve_final(generated, "rk45", {2.0, 0.0}, 500, 0.01),
+          "RK45 trajectories bit-identical");
+
+    ODESystem exp_hand = TestProblems::create_exponential_decay(0.5);
+    ODESystem exp_gen = to_ode_system(RHSLibrary::exponential(), {{"lambda", 0.5}});
+    check(solve_final(exp_hand, "euler", {1.0}, 300, 0.01) == solve_final(exp_gen, "euler", {1.0}, 300, 0.01),
+          "exponential bit-identical");
+    check(generated.rhs(0.0, {1.0, 2.0}) == hand.rhs(0.0, {1.0, 2.0}), "allocating rhs agrees");
+
+    bool rejected = false;
+    try {
+        to_ode_system(RHSLibrary::vanderpol(), {{"lambda", 1.0}});
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    check(rejected, "unknown parameter rejected");
+}
+
+void test_glsl() {
+    std::cout << "\n=== GLSL ===" << std::endl;
+
+    // gen_builtin_rhs_table writes the constexpr table from the library programs
+    const RHSProgram library[] = {RHSLibrary::exponential(), RHSLibrary::vanderpol(), RHSLibrary::lorenz(),
+                                  RHSLibrary::harmonic()};
+    bool in_sync = true;
+    for (const RHSProgram& program : library) {
+        const BuiltinRHS& rhs = BuiltinRHSRegistry::get_rhs(program.name());
+        RHSDefinition emitted = to_rhs_definition(program, rhs.id, "");
+        std::vector<std::string> uniforms(rhs.uniform_names, rhs.uniform_names + rhs.uniform_count);
+        if (rhs.glsl_code != emitted.glsl_code || uniforms != emitted.uniform_names ||
+            rhs.coupling_width != emitted.coupling_width) {
+            std::cout << "   generated entry " << program.name() << " should be:" << emitted.glsl_code;
+            in_sync = false;
+        }
+    }
+    check(in_sync, "builtin table matches the library programs");
+
+    const BuiltinRHS& vdp = BuiltinRHSRegistry::get_rhs("vanderpol");
+    check(contains(std::string(vdp.glsl_code), "float evaluate_rhs(uint eq_idx, float y_val, float t)") &&
+          contains(std::string(vdp.glsl_code), "if (r_local == 0u) return r_y1;"), "block-wise evaluate_rhs");
+    check(BuiltinRHSRegistry::get_rhs("lorenz").coupling_width == 3 &&
+          BuiltinRHSRegistry::get_rhs("harmonic").coupling_width == 2, "coupling widths follow the dimension");
+
+    std::string exponential(BuiltinRHSRegistry::get_rhs("exponential").glsl_code);
+    check(contains(exponential, "-p_lambda") && !contains(exponential, "r_local"), "scalar system has no branch");
+
+    ODESystem custom = to_ode_system(RHSProgram::parse("param k = 3\ndy0 = -k * y0 + sin(t)"));
+    check(custom.has_gpu_support() && !custom.use_builtin_rhs() &&
+          contains(custom.gpu_info->glsl_rhs_code, "sin(t)") &&
+          custom.gpu_info->gpu_uniforms == std::vector<float>{3.0f} &&
+          custom.gpu_info->uniform_names == std::vector<std::string>{"k"}, "custom system carries its GLSL");
+
+    // Parameters reach the shader as prefixed macros, so GLSL and template
+    // names are fine; only GLSL's reserved double underscore is refused
+    auto rejects_name = [](const std::string& name) {
+        RHSProgram p("named", 1);
+        try {
+            p.param(name, 1.0);
+        } catch (const std::invalid_argument&) {
+            return true;
+        }
+        return false;
+    };
+    check(!rejects_name("float") && !rejects_name("sin") && !rejects_name("current_state") &&
+          !rejects_name("dydt") && !rejects_name("gl_Position") && rejects_name("_x") &&
+          rejects_name("a__b") && rejects_name("2x") && rejects_name("x-y"),
+          "only non-identifiers and double underscores rejected as parameters");
+    RHSProgram shadowing("shadowing", 1);
+    shadowing.set_output(0, shadowing.param("dydt", 2.0) * shadowing.state(0));
+    check(contains(emit_glsl(shadowing), "r_y0 * p_dydt"), "parameters emitted under their macro name");
+
+    // user_uniforms holds 16 values: more parameters cannot reach the GPU
+    RHSProgram wide("wide", 1);
+    RHSExpr sum = wide.state(0);
+    for (int k = 0; k <= kMaxGLSLParameters; ++k) {
+        sum = sum + wide.param("p" + std::to_string(k), 1.0);
+    }
+    wide.set_output(0, sum);
+    bool too_many = false;
+    try {
+        to_ode_system(wide);
+    } catch (const std::invalid_argument&) {
+        too_many = true;
+    }
+    check(too_many, "more than 16 parameters rejected for GLSL");
+}
+
+// Lookups resolve at compile time
+static_assert(BuiltinRHSRegistry::find_builtin("lorenz") == static_cast<int>(BuiltinRHSId::Lorenz) &&
+              BuiltinRHSRegistry::find_builtin("missing") == -1 &&
+              BuiltinRHSRegistry::builtin(BuiltinRHSId::VanDerPol).coupling_width == 2,
+              "constexpr builtin lookup");
+
+static BuiltinRHSRegistration duffing_registration(
+    "duffing", to_rhs_definition(RHSProgram::parse("param delta = 0.2\n"
+                                                   "dy0 = y1\n"
+                                                   "dy1 = -delta*y1 - y0 - y0*y0*y0", "duffing"),
+                                 0, "Duffing oscillator"));
+
+void test_registry() {
+    std::cout << "\n=== REGISTRY ===" << std::endl;
+
+    const BuiltinRHS& lorenz = BuiltinRHSRegistry::get_rhs("lorenz");
+    check(&lorenz == &BuiltinRHSRegistry::get_rhs(static_cast<int>(BuiltinRHSId::Lorenz)) &&
+          &lorenz == &kBuiltinRHS[2], "lookups return the table entry itself");
+
+    const BuiltinRHS& duffing = BuiltinRHSRegistry::get_rhs("duffing");
+    check(duffing.id == kBuiltinRHSCount && duffing_registration.id() == duffing.id &&
+          &BuiltinRHSRegistry::get_rhs(duffing.id) == &duffing, "static registration gets the next id");
+    check(duffing.uniform_count == 1 && duffing.uniform_names[0] == "delta" && duffing.coupling_width == 2 &&
+          contains(std::string(duffing.glsl_code), "delta"), "registered entry viewed like a builtin");
+    check(BuiltinRHSRegistry::list_available().size() == static_cast<size_t>(kBuiltinRHSCount) + 1 &&
+          BuiltinRHSRegistry::list_available().back() == "duffing", "registered entries listed after builtins");
+
+    auto rejects = [](auto lookup) {
+        try {
+            lookup();
+        } catch (const std::invalid_argument&) {
+            return true;
+        }
+        return false;
+    };
+    check(rejects([] { BuiltinRHSRegistry::get_rhs("missing"); }) &&
+          rejects([] { BuiltinRHSRegistry::get_rhs(99); }) &&
+          !BuiltinRHSRegistry::has_rhs("missing"), "unknown names and ids rejected");
+    check(rejects([] { BuiltinRHSRegistration again("lorenz", RHSDefinition{}); }), "duplicate names rejected");
+}
+
+void test_cpp() {
+    std::cout << "\n=== C++ KERNEL ===" << std::endl;
+
+    RHSProgram lorenz = RHSLibrary::lorenz();
+    std::string source = emit_cpp(lorenz, "lorenz_batch");
+    check(contains(source, "extern \"C\" void lorenz_batch(double t, const double* __restrict y"),
+          "kernel signature");
+    check(contains(source, "params[2]") && contains(source, "dydt[2 * stride + l]"), "SoA indexing");
+
+    std::vector<double> values = lorenz.param_values({{"rho", 99.5}});
+    std::string baked = emit_cpp(lorenz, "lorenz_baked", &values);
+    check(contains(baked, "99.5") && !contains(baked, "params["), "parameters baked as constants");
+
+    bool rejected = false;
+    try {
+        emit_cpp(lorenz, "not a name");
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    check(rejected, "function name validated");
+}
+
+void test_jacobian() {
+    std::cout << "\n=== JACOBIAN ===" << std::endl;
+
+    const double mu = 1.3, x = 0.7, v = -1.1;
+    RHSProgram vdp = RHSLibrary::vanderpol();
+    RHSProgram jac = vdp.jacobian();
+    check(jac.outputs().size() == 4 && jac.dimension() == 2, "dimension^2 outputs");
+    RHSTape tape(jac, {mu});
+    double y[2] = {x, v};
+    double J[4];
+    tape.evaluate(0.0, y, J);
+    check(J[0] == 0.0 && J[1] == 1.0 && std::fabs(J[2] - (-2.0 * mu * x * v - 1.0)) < 1e-15 &&
+          std::fabs(J[3] - mu * (1.0 - x * x)) < 1e-15, "van der Pol Jacobian exact");
+
+    // Every elementary function against central differences
+    RHSProgram p = RHSProgram::parse("param a = 0.8\n"
+                                     "let r = sqrt(y0*y0 + y1*y1 + 1)\n"
+                                     "dy0 = exp(-a*y0) * sin(y1) / r\n"
+                                     "dy1 = log(r) - tanh(y0 - t) * cos(y1*y0)\n"
+                                     "dy2 = y0^3 / y2 - y2^-2\n");
+    RHSTape f(p, p.param_values());
+    RHSTape df(p.jacobian(), p.param_values());
+    double point[3] = {0.4, -0.9, 1.6};
+    double analytic[9];
+    df.evaluate(0.3, point, analytic);
+    double worst = 0.0;
+    const double h = 1e-6;
+    for (int j = 0; j < 3; ++j) {
+        double plus[3] = {point[0], point[1], point[2]};
+        double minus[3] = {point[0], point[1], point[2]};
+        plus[j] += h;
+        minus[j] -= h;
+        double fp[3], fm[3];
+        f.evaluate(0.3, plus, fp);
+        f.evaluate(0.3, minus, fm);
+        for (int i = 0; i < 3; ++i) {
+            worst = std::max(worst, std::fabs((fp[i] - fm[i]) / (2 * h) - analytic[i * 3 + j]));
+        }
+    }
+    check(worst < 1e-8, "Jacobian matches central differences");
+    check(p.jacobian().operation_count() < 3 * p.operation_count() + 30, "Jacobian shares the primal subexpressions");
+}
+
+void test_parse_errors() {
+    std::cout << "\n=== TEXT FORM ===" << std::endl;
+
+    RHSProgram parsed = RHSProgram::parse("# Van der Pol\n"
+                                          "param mu = 1.0\n"
+                                          "dy[0] = y1\n"
+                                          "dy1 = mu*(1 - y0^2)*y1 - y0   # damping\n", "vanderpol");
+    RHSTape a(parsed, {2.5});
+    RHSTape b(RHSLibrary::vanderpol(), {2.5});
+    double y[2] = {0.3, 1.9}, fa[2], fb[2];
+    a.evaluate(0.0, y, fa);
+    b.evaluate(0.0, y, fb);
+    check(fa[0] == fb[0] && fa[1] == fb[1] && parsed.operation_count() == RHSLibrary::vanderpol().operation_count(),
+          "text and operator forms agree");
+
+    auto fails = [](const std::string& text, const std::string& fragment) {
+        try {
+            RHSProgram::parse(text);
+        } catch (const std::invalid_argument& e) {
+            return contains(e.what(), fragment);
+        }
+        return false;
+    };
+    check(fails("dy0 = y0 * k", "line 1: unknown name k"), "unknown name");
+    check(fails("dy1 = y0", "never assigns dy0"), "missing output");
+    check(fails("dy0 = y0\ndy0 = 1", "line 2: dy0 assigned twice"), "duplicate output");
+    check(fails("dy0 = y0^1.5", "integer exponent"), "fractional power");
+    check(fails("param t = 1\ndy0 = t", "already in use"), "reserved name");
+    check(fails("dy0 = (y0 + 1", "expected ')'"), "unbalanced parentheses");
+}
+
+int main() {
+    std::cout << "RHS Expression IR Tests" << std::endl;
+
+    test_cse();
+    test_tape_matches_test_problems();
+    test_glsl();
+    test_registry();
+    test_cpp();
+    test_jacobian();
+    test_parse_errors();
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,207 @@
+#include <unistd.h>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../include/job_file.h"
+#include "../include/rhs_jit.h"
+#include "../include/steppers.h"
+#include "../include/test_problems.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+static std::vector<double> solve_final(const ODESystem& system, std::vector<double> y, int steps, double dt) {
+    auto stepper = create_stepper("rk45");
+    for (int i = 0; i < steps; ++i) {
+        stepper->step(system, i * dt, dt, y);
+    }
+    return y;
+}
+
+static const std::string cache_dir = "/tmp/ode_jit_test_" + std::to_string(getpid());
+
+void test_compile_and_cache() {
+    std::cout << "\n=== COMPILE AND CACHE ===" << std::endl;
+
+    JitOptions options;
+    options.cache_dir = cache_dir;
+    RHSJit jit(options);
+    RHSProgram lorenz = RHSLibrary::lorenz();
+    const std::vector<double> params = lorenz.param_values({{"rho", 24.0}});
+
+    auto kernel = jit.compile(lorenz, params);
+    if (!kernel) std::cout << "   " << jit.last_error() << std::endl;
+    check(kernel != nullptr && jit.stats().compiles == 1, "compiled with the system compiler");
+    if (!kernel) return;
+    std::cout << "   compile took " << jit.stats().compile_seconds << " s" << std::endl;
+    check(kernel->parameters_baked() && std::filesystem::exists(kernel->object_path()), "object in the cache directory");
+
+    // Batched SoA evaluation against the interpreted tape
+    const int lanes = 37;
+    std::vector<double> y(3 * lanes), native(3 * lanes), member(3), expected(3);
+    for (int i = 0; i < 3 * lanes; ++i) y[i] = std::sin(0.7 * i) * 10.0;
+    kernel->evaluate_batch(0.0, y.data(), native.data(), lanes, lanes);
+    RHSTape tape(lorenz, params);
+    bool identical = true;
+    for (int l = 0; l < lanes; ++l) {
+        for (int i = 0; i < 3; ++i) member[i] = y[i * lanes + l];
+        tape.evaluate(0.0, member.data(), expected.data());
+        for (int i = 0; i < 3; ++i) {
+            if (native[i * lanes + l] != expected[i]) identical = false;
+        }
+    }
+    check(identical, "batched native kernel bit-identical to the tape");
+
+    auto again = jit.compile(lorenz, params);
+    check(again && jit.stats().memory_hits == 1 && jit.stats().compiles == 1, "second request served from memory");
+
+    RHSJit other(options);
+    auto start = std::chrono::steady_clock::now();
+    auto from_disk = other.compile(lorenz, params);
+    const double load_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    check(from_disk && other.stats().disk_hits == 1 && other.stats().compiles == 0, "new instance loads from disk");
+    std::cout << "   cached load took " << load_seconds * 1e3 << " ms" << std::endl;
+
+    // A damaged object in the cache is rebuilt, not reported forever
+    std::string damaged_path;
+    {
+        RHSJit first(options);
+        auto harmonic = first.compile(RHSLibrary::harmonic(), {1.0});
+        if (harmonic) damaged_path = harmonic->object_path();
+    }
+    std::remove(damaged_path.c_str());
+    std::ofstream(damaged_path) << "not an object";
+    RHSJit repair(options);
+    auto repaired = repair.compile(RHSLibrary::harmonic(), {1.0});
+    double position[2] = {1.0, 0.0}, velocity[2];
+    if (repaired) repaired->evaluate(0.0, position, velocity);
+    check(repaired && repair.stats().compiles == 1 && repair.stats().failures == 0 && velocity[1] == -1.0,
+          "unloadable cached object recompiled");
+
+    // Objects are only loaded from a directory nobody else can write to
+    const std::string shared_dir = cache_dir + "_shared";
+    std::filesystem::create_directories(shared_dir);
+    std::filesystem::permissions(shared_dir, std::filesystem::perms::all);
+    JitOptions shared = options;
+    shared.cache_dir = shared_dir;
+    RHSJit open_dir(shared);
+    check(open_dir.compile(lorenz, params) == nullptr &&
+          open_dir.last_error().find("writable by other users") != std::string::npos, "world-writable cache refused");
+    std::filesystem::remove_all(shared_dir);
+    std::filesystem::create_directory_symlink(cache_dir, shared_dir);
+    RHSJit linked(shared);
+    check(linked.compile(lorenz, params) == nullptr &&
+          linked.last_error().find("not a directory") != std::string::npos, "symlinked cache refused");
+    std::filesystem::remove(shared_dir);
+    std::filesystem::remove_all(cache_dir + "_fresh");
+    shared.cache_dir = cache_dir + "_fresh";
+    RHSJit fresh(shared);
+    fresh.compile(RHSLibrary::exponential(), {1.0});
+    check((std::filesystem::status(shared.cache_dir).permissions() & std::filesystem::perms::all) ==
+          std::filesystem::perms::owner_all, "new cache directory created 0700");
+    std::filesystem::remove_all(shared.cache_dir);
+
+    // Unbaked: one object, parameters at call time
+    auto generic_a = jit.compile(lorenz, lorenz.param_values({{"sigma", 1.0}}), false);
+    auto generic_b = jit.compile(lorenz, lorenz.param_values({{"sigma", 2.0}}), false);
+    double state[3] = {1.0, 2.0, 3.0}, fa[3], fb[3];
+    generic_a->evaluate(0.0, state, fa);
+    generic_b->evaluate(0.0, state, fb);
+    check(generic_a->object_path() == generic_b->object_path() && fa[0] == 1.0 && fb[0] == 2.0,
+          "unbaked kernel shares one object across parameter values");
+}
+
+void test_system_and_fallback() {
+    std::cout << "\n=== SYSTEM AND FALLBACK ===" << std::endl;
+
+    JitOptions options;
+    options.cache_dir = cache_dir;
+    RHSJit jit(options);
+    ODESystem native = jit.system(RHSLibrary::vanderpol(), {{"mu", 2.0}});
+    ODESystem hand = TestProblems::create_van_der_pol(2.0);
+    check(solve_final(native, {2.0, 0.0}, 400, 0.01) == solve_final(hand, {2.0, 0.0}, 400, 0.01),
+          "JIT system bit-identical to TestProblems over RK45");
+    check(native.gpu_info && !native.gpu_info->glsl_rhs_code.empty(), "GPU form still attached");
+    check(!native.rhs_interpreted, "compiled system not marked interpreted");
+
+    JitOptions broken = options;
+    broken.compiler = "/nonexistent/c++";
+    RHSJit missing(broken);
+    check(missing.compile(RHSLibrary::vanderpol(), {1.0}) == nullptr && missing.stats().failures == 1 &&
+          missing.last_error().find("not found") != std::string::npos, "missing compiler reported");
+    ODESystem fallback = missing.system(RHSLibrary::vanderpol(), {{"mu", 2.0}});
+    check(solve_final(fallback, {2.0, 0.0}, 400, 0.01) == solve_final(hand, {2.0, 0.0}, 400, 0.01),
+          "falls back to the tape");
+    check(fallback.rhs_interpreted && fallback.program, "fallback marked for the ensemble VM");
+
+    JitOptions bad_flags = options;
+    bad_flags.flags = "-O3 --no-such-flag";
+    RHSJit failing(bad_flags);
+    check(failing.compile(RHSLibrary::exponential(), {1.0}) == nullptr &&
+          failing.last_error().find("compile failed") != std::string::npos, "compiler errors surfaced");
+}
+
+void test_job_file_rhs() {
+    std::cout << "\n=== JOB FILE RHS ===" << std::endl;
+
+    setenv("ODE_JIT_CACHE", cache_dir.c_str(), 1);
+    std::istringstream text("rhs     param k = 1; dy0 = y1; dy1 = -k*y0 - 0.1*y1\n"
+                            "param   k 1, 4\n"
+                            "y0      1.0 0.0\n"
+                            "tf      2\n"
+                            "dt      0.01\n");
+    JobSpec spec = JobSpec::parse(text, "oscillator.job");
+    check(spec.size() == 2 && spec.dimension() == 2 && spec.problem() == "custom", "rhs key replaces problem");
+    JobInstance job = spec.job(1);
+    ODESystem system = spec.system_for(job);
+    std::vector<double> dydt(2);
+    system.rhs_inplace(0.0, {1.0, 1.0}, dydt);
+    check(job.parameters.at("k") == 4.0 && dydt[0] == 1.0 && dydt[1] == -4.0 - 0.1, "job parameters reach the kernel");
+    check(RHSJit::instance().stats().compiles + RHSJit::instance().stats().disk_hits == 1,
+          "one object for the whole parameter sweep");
+
+    std::istringstream other("rhs param k = 1; dy0 = y1; dy1 = -k*y0\nparam k 1, 4\ny0 1.0 0.0\n");
+    check(JobSpec::parse(other).fingerprint() != spec.fingerprint(), "rhs text part of the fingerprint");
+
+    auto fails = [](const std::string& job_text, const std::string& fragment) {
+        std::istringstream in(job_text);
+        try {
+            JobSpec::parse(in, "bad.job");
+        } catch (const std::invalid_argument& e) {
+            return std::string(e.what()).find(fragment) != std::string::npos;
+        }
+        return false;
+    };
+    check(fails("rhs dy0 = -q*y0\n", "unknown name q"), "rhs parse errors reported");
+    check(fails("rhs param k = 1; dy0 = -k*y0\nparam mu 2\n", "no parameter mu"), "parameter names checked");
+    check(fails("rhs dy0 = y0\ndimension 3\n", "dimension 1, not 3"), "dimension checked");
+    unsetenv("ODE_JIT_CACHE");
+}
+
+int main() {
+    std::cout << "RHS JIT Tests" << std::endl;
+
+    test_compile_and_cache();
+    test_system_and_fallback();
+    test_job_file_rhs();
+
+    std::filesystem::remove_all(cache_dir);
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,172 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../include/ensemble.h"
+#include "../include/rhs_vm.h"
+#include "../include/test_problems.h"
+#include "../include/vm_ensemble_backend.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+// Evaluates `lanes` members through the VM and compares each with the tape
+static bool matches_tape(const RHSProgram& program, const std::vector<double>& params, int width, int lanes) {
+    const int dim = program.dimension();
+    RHSBytecode code(program, params, width);
+    RHSTape tape(program, params);
+    const int stride = lanes + 3;   // Stride need not equal the lane count
+    std::vector<double> y(dim * stride), vm(dim * stride, -1.0), member(dim), expected(dim);
+    for (size_t i = 0; i < y.size(); ++i) y[i] = 0.5 + std::sin(0.37 * i);
+    code.evaluate_batch(0.25, y.data(), vm.data(), lanes, stride);
+    for (int l = 0; l < lanes; ++l) {
+        for (int i = 0; i < dim; ++i) member[i] = y[i * stride + l];
+        tape.evaluate(0.25, member.data(), expected.data());
+        for (int i = 0; i < dim; ++i) {
+            if (vm[i * stride + l] != expected[i]) return false;
+        }
+    }
+    for (int i = 0; i < dim; ++i) {
+        for (int l = lanes; l < stride; ++l) {
+            if (vm[i * stride + l] != -1.0) return false;   // Padding never stored
+        }
+    }
+    return true;
+}
+
+void test_bytecode() {
+    std::cout << "\n=== BYTECODE VS TAPE ===" << std::endl;
+
+    RHSProgram lorenz = RHSLibrary::lorenz();
+    const std::vector<double> params = lorenz.param_values({{"rho", 24.0}});
+    bool all = true;
+    for (int width : {8, 16, 32, 64}) {
+        for (int lanes : {1, 7, width, 3 * width + 5}) {
+            all = all && matches_tape(lorenz, params, width, lanes);
+        }
+    }
+    check(all, "Lorenz bit-identical for every width and lane count");
+
+    RHSProgram functions = RHSProgram::parse("param a = 0.8\n"
+                                             "let r = sqrt(y0*y0 + y1*y1 + 1)\n"
+                                             "dy0 = tanh(a*y1) - exp(-r) * cos(t)\n"
+                                             "dy1 = log(r) / (1 + y0*y0) - sin(y0 - y1)\n"
+                                             "dy2 = -y2 * y2", "functions");
+    check(matches_tape(functions, functions.param_values(), 16, 21), "every operation bit-identical");
+
+    RHSBytecode code(functions, functions.param_values(), 16);
+    std::cout << "   " << code.instructions() << " instructions, " << code.registers() << " registers for "
+              << functions.live_nodes().size() << " live nodes" << std::endl;
+    check(code.registers() < static_cast<int>(functions.live_nodes().size()), "registers reused after last use");
+
+    // Many independent terms: the register file stays bounded by the
+    // values live at once, not by the program length
+    std::string text = "dy0 = 0";
+    for (int k = 1; k <= 40; ++k) text += " + sin(" + std::to_string(k) + "*y0)";
+    RHSProgram sum = RHSProgram::parse(text, "sum");
+    RHSBytecode long_code(sum, {}, 16);
+    check(long_code.registers() < 50 && matches_tape(sum, {}, 16, 19), "long program keeps a small register file");
+
+    auto rejects = [&](int width) {
+        try {
+            RHSBytecode bad(lorenz, params, width);
+        } catch (const std::invalid_argument&) {
+            return true;
+        }
+        return false;
+    };
+    check(rejects(12) && rejects(0), "unsupported widths rejected");
+}
+
+void test_ensemble() {
+    std::cout << "\n=== VM ENSEMBLE ===" << std::endl;
+
+    ThreadPool pool(2);
+    ODESystem system = to_ode_system(RHSLibrary::vanderpol(), {{"mu", 1.5}});
+    const int members = 53;
+    std::vector<double> y0(members * 2);
+    for (int m = 0; m < members; ++m) {
+        y0[2 * m] = 2.0 + 0.01 * m;
+        y0[2 * m + 1] = -0.5 + 0.02 * m;
+    }
+
+    for (const std::string method : {"euler", "rk45"}) {
+        std::vector<double> reference, batched;
+        CPUEnsembleBackend(method, pool).solve_ensemble(system, 0.0, 2.0, 0.01, y0, members, reference);
+        VMEnsembleBackend vm(method, pool, 16);
+        vm.solve_ensemble(system, 0.0, 2.0, 0.01, y0, members, batched);
+        check(batched == reference, method + " ensemble bit-identical to CPUEnsembleBackend");
+    }
+
+    VMEnsembleBackend vm("rk45", pool);
+    ODESystem hand = TestProblems::create_van_der_pol(1.5);
+    std::vector<double> out;
+    bool threw = false;
+    try {
+        vm.solve_ensemble(hand, 0.0, 1.0, 0.01, y0, members, out);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    check(threw, "system without an RHS program rejected");
+
+    threw = false;
+    try {
+        VMEnsembleBackend implicit("bdf", pool);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    check(threw, "unsupported method rejected");
+}
+
+void test_throughput() {
+    std::cout << "\n=== THROUGHPUT ===" << std::endl;
+
+    ThreadPool pool(1);
+    ODESystem system = to_ode_system(RHSLibrary::lorenz());
+    const int members = 2048;
+    std::vector<double> y0(members * 3);
+    for (int m = 0; m < members; ++m) {
+        y0[3 * m] = 1.0 + 1e-3 * m;
+        y0[3 * m + 1] = 1.0;
+        y0[3 * m + 2] = 1.0;
+    }
+
+    auto seconds = [&](EnsembleSolverBase& backend, std::vector<double>& out) {
+        auto start = std::chrono::steady_clock::now();
+        backend.solve_ensemble(system, 0.0, 1.0, 0.01, y0, members, out);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    std::vector<double> tape_out, vm_out;
+    CPUEnsembleBackend tape("rk45", pool);
+    const double tape_s = seconds(tape, tape_out);
+    for (int width : {8, 16, 32, 64}) {
+        VMEnsembleBackend vm("rk45", pool, width);
+        const double vm_s = seconds(vm, vm_out);
+        std::cout << "   width " << width << ": " << members * 100 / vm_s / 1e6 << " M member-steps/s ("
+                  << tape_s / vm_s << "x the tape)" << std::endl;
+    }
+    check(vm_out == tape_out, "timed runs agree");
+}
+
+int main() {
+    std::cout << "RHS Bytecode VM Tests" << std::endl;
+
+    test_bytecode();
+    test_ensemble();
+    test_throughput();
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed > 0 ? 1 : 0;
+}
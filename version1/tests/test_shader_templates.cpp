@@ -0,0 +1,93 @@
+#include <unistd.h>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "../include/shader_generator.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+void test_embedded_templates() {
+    std::cout << "\n=== EMBEDDED TEMPLATES ===" << std::endl;
+
+    // No shaders/ directory anywhere near the working directory
+    check(chdir("/") == 0, "running from /");
+    unsetenv("ODE_SHADER_DIR");
+    ShaderGenerator generator;
+    std::string shader;
+    bool generated = true;
+    try {
+        shader = generator.generate_euler_shader_builtin("vanderpol");
+    } catch (const std::exception& e) {
+        std::cout << "   " << e.what() << std::endl;
+        generated = false;
+    }
+    check(generated && shader.rfind("#version 310 es", 0) == 0, "template found without the source tree");
+    check(shader.find("{{RHS_FUNCTION}}") == std::string::npos &&
+          shader.find("{{USER_UNIFORMS}}") == std::string::npos, "placeholders substituted");
+    check(shader.find("#define p_mu user_uniforms[0]") != std::string::npos, "uniform accessors generated");
+
+    std::string compensated = generator.generate_euler_shader_builtin("vanderpol", true);
+    check(shader.find("#define COMPENSATED 0") != std::string::npos &&
+          compensated.find("#define COMPENSATED 1") != std::string::npos &&
+          compensated.find("{{COMPENSATED}}") == std::string::npos &&
+          compensated.find("state_carry[]") != std::string::npos, "compensated variant selected");
+    // Coupled RHSs read neighbours, so the state must not be updated in place
+    check(shader.find("readonly buffer StateBuffer") != std::string::npos &&
+          shader.find("next_state[eq_idx] = y_new") != std::string::npos &&
+          shader.find("current_state[eq_idx] =") == std::string::npos, "state ping-pongs between buffers");
+}
+
+void test_override_directory() {
+    std::cout << "\n=== OVERRIDE DIRECTORY ===" << std::endl;
+
+    const std::string dir = "/tmp/ode_shader_override_" + std::to_string(getpid());
+    std::system(("mkdir -p " + dir).c_str());
+    {
+        std::ofstream file(dir + "/euler_template.glsl");
+        file << "#version 310 es\n// edited\n{{USER_UNIFORMS}}\n{{RHS_FUNCTION}}\n";
+    }
+
+    ShaderGenerator generator;
+    generator.set_template_override_dir(dir);
+    std::string shader = generator.generate_euler_shader_builtin("exponential");
+    check(shader.find("// edited") != std::string::npos, "override directory searched first");
+
+    setenv("ODE_SHADER_DIR", dir.c_str(), 1);
+    ShaderGenerator from_env;
+    check(from_env.generate_euler_shader_builtin("exponential").find("// edited") != std::string::npos,
+          "ODE_SHADER_DIR sets the override");
+    unsetenv("ODE_SHADER_DIR");
+
+    // Templates the override directory lacks come from the binary
+    generator.set_template_override_dir("/nonexistent");
+    check(generator.generate_euler_shader_builtin("exponential").find("// edited") == std::string::npos,
+          "missing override falls back to the embedded template");
+    generator.set_template_override_dir("");
+    check(generator.generate_euler_shader_builtin("exponential").find("EXPLICIT EULER") != std::string::npos,
+          "override cleared");
+
+    std::system(("rm -rf " + dir).c_str());
+}
+
+int main() {
+    std::cout << "Shader Template Tests" << std::endl;
+
+    test_embedded_templates();
+    test_override_directory();
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,252 @@
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/ensemble.h"
+#include "../include/profiler.h"
+#include "../include/sharded_ensemble.h"
+#include "../include/test_problems.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+// Counter visible to the forked workers, for injecting faults
+static std::atomic<int>* shared_counter(int initial) {
+    void* p = mmap(nullptr, sizeof(std::atomic<int>), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    return new (p) std::atomic<int>(initial);
+}
+
+static std::vector<double> ensemble_states(int members) {
+    std::vector<double> y0;
+    for (int m = 0; m < members; ++m) {
+        y0.push_back(0.5 + 2.0 * m / members);
+        y0.push_back(0.0);
+    }
+    return y0;
+}
+
+static bool matches(const ShardedResult& result, const std::vector<double>& expected, std::uint64_t skip_begin = 0,
+                    std::uint64_t skip_end = 0) {
+    for (std::uint64_t i = 0; i < expected.size(); ++i) {
+        const std::uint64_t m = i / 2;
+        if (m >= skip_begin && m < skip_end) continue;
+        if (result.final_states()[i] != expected[i]) return false;
+    }
+    return true;
+}
+
+void test_sharded_solve() {
+    std::cout << "\n=== SHARDED SOLVE ===" << std::endl;
+
+    const int members = 10000;
+    auto system = TestProblems::create_van_der_pol();
+    std::vector<double> y0 = ensemble_states(members);
+
+    ThreadPool pool(1);
+    CPUEnsembleBackend reference("rk45", pool);
+    std::vector<double> expected;
+    reference.solve_ensemble(system, 0.0, 1.0, 0.01, y0, members, expected);
+
+    ShardOptions options;
+    options.processes = 3;
+    options.shards = 8;
+    ShardedResult result = ShardedEnsemble("rk45", options).solve(system, 0.0, 1.0, 0.01, y0, members);
+    check(result.complete() && result.shards() == 8, "every shard done");
+    check(result.members() == members && result.dimension() == 2, "result shape");
+    check(matches(result, expected), "bit-identical to an in-process ensemble");
+    check(result.stats().forks == 8 && result.stats().retries == 0 && result.stats().crashes == 0,
+          "one worker per shard, no retries");
+    check(result.shard_begin(0) == 0 && result.shard_end(7) == members &&
+          result.shard_end(3) == result.shard_begin(4), "shards tile the member range");
+    std::cout << "   " << result.stats().forks << " workers, " << result.stats().seconds * 1e3 << " ms" << std::endl;
+
+    ShardedResult moved = std::move(result);
+    check(moved.complete() && !result.complete() && moved.member(members - 1)[0] == expected[2 * members - 2],
+          "result is movable");
+}
+
+void test_crash_retry() {
+    std::cout << "\n=== CRASH RETRY ===" << std::endl;
+
+    const int members = 2000;
+    std::vector<double> y0 = ensemble_states(members);
+    auto system = TestProblems::create_van_der_pol();
+    ThreadPool pool(1);
+    CPUEnsembleBackend reference("euler", pool);
+    std::vector<double> expected;
+    reference.solve_ensemble(system, 0.0, 1.0, 0.01, y0, members, expected);
+
+    // The first two workers to evaluate the RHS are killed mid-solve
+    std::atomic<int>* crash_budget = shared_counter(2);
+    auto flaky = system;
+    auto inner = system.rhs_inplace;
+    flaky.rhs_inplace = [crash_budget, inner](double t, const std::vector<double>& y, std::vector<double>& dydt) {
+        if (crash_budget->load() > 0 && crash_budget->fetch_sub(1) > 0) {
+            raise(SIGKILL);
+        }
+        inner(t, y, dydt);
+    };
+
+    ShardOptions options;
+    options.processes = 2;
+    options.shards = 4;
+    ShardedResult result = ShardedEnsemble("euler", options).solve(flaky, 0.0, 1.0, 0.01, y0, members);
+    check(result.stats().crashes == 2 && result.stats().retries == 2 && result.stats().forks == 6,
+          "crashed shards retried");
+    check(result.complete() && matches(result, expected), "retried shards produce the right results");
+
+    // A shard that always crashes runs out of attempts; the rest still finish
+    auto poisoned = system;
+    poisoned.rhs_inplace = [inner](double t, const std::vector<double>& y, std::vector<double>& dydt) {
+        if (y[0] > 2.4) _exit(3);   // Only the last shard's members start this high
+        inner(t, y, dydt);
+    };
+    options.max_attempts = 2;
+    result = ShardedEnsemble("euler", options).solve(poisoned, 0.0, 0.05, 0.01, y0, members);
+    std::vector<double> short_expected;
+    reference.solve_ensemble(system, 0.0, 0.05, 0.01, y0, members, short_expected);
+    check(!result.complete() && result.shard_state(3) == ShardState::Failed &&
+          result.shard_state(0) == ShardState::Done, "poisoned shard given up after max_attempts");
+    check(result.stats().crashes == 2 && std::isnan(result.member(members - 1)[0]), "failed members are NaN");
+    check(matches(result, short_expected, result.shard_begin(3), result.shard_end(3)), "other shards intact");
+}
+
+void test_timeout() {
+    std::cout << "\n=== TIMEOUT ===" << std::endl;
+
+    const int members = 400;
+    std::vector<double> y0 = ensemble_states(members);
+    auto system = TestProblems::create_van_der_pol();
+
+    // One worker hangs; the parent kills it and reruns the shard
+    std::atomic<int>* hang_budget = shared_counter(1);
+    auto hanging = system;
+    auto inner = system.rhs_inplace;
+    hanging.rhs_inplace = [hang_budget, inner](double t, const std::vector<double>& y, std::vector<double>& dydt) {
+        if (hang_budget->load() > 0 && hang_budget->fetch_sub(1) > 0) {
+            while (true) pause();
+        }
+        inner(t, y, dydt);
+    };
+
+    ShardOptions options;
+    options.processes = 2;
+    options.shards = 2;
+    options.shard_timeout_seconds = 0.5;
+    ShardedResult result = ShardedEnsemble("euler", options).solve(hanging, 0.0, 0.1, 0.01, y0, members);
+    check(result.complete() && result.stats().timeouts == 1 && result.stats().retries == 1,
+          "hung worker killed and its shard rerun");
+}
+
+void test_multithreaded_parent() {
+    std::cout << "\n=== MULTITHREADED PARENT ===" << std::endl;
+
+    // A parent thread keeps taking the profiler's lock while workers are
+    // forked; every worker takes it once and must not find it held
+    std::atomic<bool> stop{false};
+    std::thread busy([&stop] {
+        ScopedTimer timer("busy");
+        while (!stop.load()) Profiler::instance().report();
+    });
+
+    const int members = 400;
+    std::vector<double> y0 = ensemble_states(members);
+    auto system = TestProblems::create_van_der_pol();
+    auto locking = system;
+    auto inner = system.rhs_inplace;
+    locking.rhs_inplace = [inner](double t, const std::vector<double>& y, std::vector<double>& dydt) {
+        static bool first = true;   // Per worker: each has its own copy
+        if (first) {
+            first = false;
+            Profiler::instance().reset();
+        }
+        inner(t, y, dydt);
+    };
+
+    ShardOptions options;
+    options.processes = 2;
+    options.shards = 32;
+    options.max_attempts = 1;
+    options.shard_timeout_seconds = 5.0;
+    ShardedResult result = ShardedEnsemble("euler", options).solve(locking, 0.0, 0.05, 0.01, y0, members);
+    stop = true;
+    busy.join();
+    check(result.complete() && result.stats().timeouts == 0, "workers forked from a multithreaded parent finish");
+    check(ShardOptions().shard_timeout_seconds > 0.0, "finite shard timeout by default");
+}
+
+void test_named_region_and_errors() {
+    std::cout << "\n=== NAMED REGION / ERRORS ===" << std::endl;
+
+    const int members = 100;
+    std::vector<double> y0 = ensemble_states(members);
+    ShardOptions options;
+    options.processes = 2;
+    options.shm_name = "ode_test_shards_" + std::to_string(getpid());
+    {
+        ShardedResult result = ShardedEnsemble("euler", options)
+            .solve(TestProblems::create_van_der_pol(), 0.0, 0.1, 0.01, y0, members);
+
+        int fd = shm_open(("/" + options.shm_name).c_str(), O_RDONLY, 0);
+        bool attached = false;
+        if (fd >= 0) {
+            size_t bytes = static_cast<const char*>(static_cast<const void*>(result.final_states() + 2 * members)) -
+                           static_cast<const char*>(static_cast<const void*>(result.final_states())) + 4096;
+            void* view = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+            close(fd);
+            attached = view != MAP_FAILED;
+            if (attached) munmap(view, bytes);
+        }
+        check(attached, "named region attachable by other processes");
+    }
+    int gone = shm_open(("/" + options.shm_name).c_str(), O_RDONLY, 0);
+    check(gone < 0, "named region unlinked with its result");
+    if (gone >= 0) close(gone);
+
+    bool bad_size = false;
+    try {
+        ShardedEnsemble("euler").solve(TestProblems::create_van_der_pol(), 0.0, 1.0, 0.1, {1.0, 0.0, 2.0}, 2);
+    } catch (const std::invalid_argument&) {
+        bad_size = true;
+    }
+    check(bad_size, "initial state size checked");
+
+    bool bad_method = false;
+    try {
+        ShardedEnsemble("midpoint");
+    } catch (const std::exception&) {
+        bad_method = true;
+    }
+    check(bad_method, "unknown method rejected in the parent");
+}
+
+int main() {
+    std::cout << "Sharded Ensemble Tests" << std::endl;
+
+    test_sharded_solve();
+    test_crash_retry();
+    test_timeout();
+    test_multithreaded_parent();
+    test_named_region_and_errors();
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed > 0 ? 1 : 0;
+}
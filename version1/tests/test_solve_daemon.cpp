@@ -0,0 +1,206 @@
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "../include/solve_daemon.h"
+#include "../include/solve_client.h"
+#include "../include/test_problems.h"
+#include "../include/threaded_cpu_backend.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+static std::vector<std::vector<double>> reference_solve(const std::string& problem,
+                                                        const std::string& method,
+                                                        const std::vector<double>& y0,
+                                                        double tf, double dt) {
+    ThreadPool pool(1);
+    ThreadedCPUBackend backend(method, pool);
+    ODESystem system = TestProblems::create(problem, static_cast<int>(y0.size()));
+    std::vector<std::vector<double>> solution;
+    backend.solve(system, 0.0, tf, dt, y0, solution);
+    return solution;
+}
+
+void test_protocol() {
+    std::cout << "\n=== PROTOCOL ===" << std::endl;
+
+    solve_protocol::SolveRequest request;
+    request.problem = "vanderpol";
+    request.method = "euler";
+    request.backend = "cpu";
+    request.tf = 2.5;
+    request.dt = 0.125;
+    request.priority = -3;
+    request.flags = solve_protocol::kFinalStateOnly;
+    request.y0 = {1.5, -0.25};
+
+    auto decoded = solve_protocol::decode_solve_request(solve_protocol::encode(request));
+    check(decoded.problem == request.problem && decoded.method == request.method &&
+          decoded.backend == request.backend && decoded.tf == request.tf &&
+          decoded.dt == request.dt && decoded.priority == request.priority &&
+          decoded.flags == request.flags && decoded.y0 == request.y0,
+          "SolveRequest encode/decode round trip");
+
+    auto bytes = solve_protocol::encode(request);
+    bytes.resize(bytes.size() - 4);
+    bool rejected = false;
+    try {
+        solve_protocol::decode_solve_request(bytes);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    check(rejected, "truncated payload rejected");
+
+    bool unknown = false;
+    try {
+        TestProblems::create("brusselator", 2);
+    } catch (const std::invalid_argument&) {
+        unknown = true;
+    }
+    check(unknown && TestProblems::create("scalability", 64).dimension == 64,
+          "TestProblems::create() by name");
+}
+
+void test_daemon(const std::string& socket_path) {
+    std::cout << "\n=== DAEMON ===" << std::endl;
+
+    DaemonOptions options;
+    options.socket_path = socket_path;
+    options.cpu_workers = 2;
+    SolveDaemon daemon(options);
+    if (!daemon.start()) {
+        check(false, "daemon listens on " + socket_path);
+        return;
+    }
+    std::thread server([&]() { daemon.run(); });
+
+    {
+        SolveClient client(socket_path);
+
+        // Full trajectory through the service, mapped straight from the memfd
+        solve_protocol::SolveRequest request;
+        request.problem = "scalability";
+        request.method = "rk45";
+        request.backend = "cpu";
+        request.tf = 1.0;
+        request.dt = 0.01;
+        request.y0 = TestProblems::create_scalability_test(50).initial_conditions;
+
+        MappedResult result = client.solve(request);
+        auto expected = reference_solve("scalability", "rk45", request.y0, 1.0, 0.01);
+        check(result.rows() == expected.size() && result.cols() == 50, "trajectory shape");
+        check(result.to_rows() == expected, "trajectory matches the in-process solve");
+        std::cout << "   served by " << result.info().backend << std::endl;
+
+        // Errors come back as messages; the connection stays usable
+        request.problem = "no_such_problem";
+        std::string error;
+        try {
+            client.solve(request);
+        } catch (const std::runtime_error& e) {
+            error = e.what();
+        }
+        check(error.find("Unknown test problem") != std::string::npos, "daemon error reported");
+
+        // Explicit backend: final row of a service solve, not batched
+        request.problem = "exponential";
+        request.y0 = {3.0};
+        request.flags = solve_protocol::kFinalStateOnly;
+        MappedResult final_only = client.solve(request);
+        check(final_only.rows() == 1 && final_only.cols() == 1 &&
+              final_only.row(0)[0] == reference_solve("exponential", "rk45", {3.0}, 1.0, 0.01).back()[0],
+              "final-state-only reply after an error");
+
+        // Client-chosen sizes are bounded: a step count past max_steps, and
+        // a trajectory past max_trajectory_values, are refused
+        auto refused = [&](solve_protocol::SolveRequest bad, const std::string& reason) {
+            try {
+                client.solve(bad);
+            } catch (const std::runtime_error& e) {
+                return std::string(e.what()).find(reason) != std::string::npos;
+            }
+            return false;
+        };
+        solve_protocol::SolveRequest tiny_dt = request;
+        tiny_dt.dt = 1e-300;
+        solve_protocol::SolveRequest long_trajectory = request;
+        long_trajectory.flags = 0;
+        long_trajectory.problem = "scalability";
+        long_trajectory.y0.assign(1000, 1.0);
+        long_trajectory.tf = 1e5;
+        long_trajectory.dt = 0.01;
+        check(refused(tiny_dt, "Too many steps") && refused(long_trajectory, "Trajectory too large"),
+              "oversized requests refused with an error");
+    }
+
+    // Concurrent final-state requests from several connections: all go
+    // through the ensemble batcher and each gets its own member back
+    const int clients = 6;
+    const int per_client = 8;
+    std::vector<int> wrong(clients, 0);
+    std::vector<std::thread> threads;
+    for (int c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c]() {
+            SolveClient client(socket_path);
+            for (int i = 0; i < per_client; ++i) {
+                solve_protocol::SolveRequest request;
+                request.problem = "vanderpol";
+                request.method = "rk45";
+                request.tf = 2.0;
+                request.dt = 0.01;
+                request.flags = solve_protocol::kFinalStateOnly;
+                request.y0 = {0.5 + 0.1 * c, 0.01 * i};
+                MappedResult result = client.solve(request);
+                auto expected = reference_solve("vanderpol", "rk45", request.y0, 2.0, 0.01).back();
+                if (result.rows() != 1 || std::fabs(result.row(0)[0] - expected[0]) > 1e-12 ||
+                    std::fabs(result.row(0)[1] - expected[1]) > 1e-12) {
+                    wrong[c]++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    int total_wrong = 0;
+    for (int w : wrong) total_wrong += w;
+    check(total_wrong == 0, "48 batched members match individual solves");
+
+    SolveClient stats_client(socket_path);
+    solve_protocol::DaemonStats stats = stats_client.stats();
+    std::cout << "   " << stats.requests << " requests, " << stats.batched_requests << " in "
+              << stats.batches << " batches (largest " << stats.largest_batch << ")" << std::endl;
+    check(stats.requests == 5 + clients * per_client && stats.errors == 3, "request/error counts");
+    check(stats.batched_requests == clients * per_client &&
+          stats.batches >= 1 && stats.batches <= stats.batched_requests &&
+          stats.full_flushes + stats.window_flushes == stats.batches, "batch counts");
+
+    daemon.stop();
+    server.join();
+    check(access(socket_path.c_str(), F_OK) == 0, "socket present until the daemon is destroyed");
+}
+
+int main() {
+    std::cout << "Solve Daemon Tests" << std::endl;
+
+    const std::string socket_path = "/tmp/test_solve_daemon_" + std::to_string(getpid()) + ".sock";
+    test_protocol();
+    test_daemon(socket_path);
+    check(access(socket_path.c_str(), F_OK) != 0, "socket removed on shutdown");
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,193 @@
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../include/solve_service.h"
+#include "../include/test_problems.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+static SolveOptions options_for(double tf, const std::string& backend, int priority = 0) {
+    SolveOptions options;
+    options.tf = tf;
+    options.dt = 0.01;
+    options.backend = backend;
+    options.priority = priority;
+    return options;
+}
+
+// Threads of this process, from /proc/self/status
+static int process_threads() {
+    std::ifstream status("/proc/self/status");
+    std::string key;
+    int value = 0;
+    while (status >> key) {
+        if (key == "Threads:" && status >> value) return value;
+    }
+    return -1;
+}
+
+void test_cpu_only_service() {
+    std::cout << "\n=== CPU-ONLY SERVICE ===" << std::endl;
+
+    // Runs first: nothing has started the GPU executor yet
+    const int before = process_threads();
+    {
+        SolveService service(2);
+        auto system = TestProblems::create_scalability_test(50);
+        service.submit(system, options_for(0.5, "cpu")).get();
+    }
+    check(before > 0 && process_threads() == before, "no GPU executor thread left behind without GPU jobs");
+}
+
+void test_futures() {
+    std::cout << "\n=== FUTURES ===" << std::endl;
+
+    SolveService service(2);
+    auto system = TestProblems::create_scalability_test(500);
+
+    std::vector<SolveHandle> handles;
+    for (const char* backend : {"cpu", "cpu_threaded", "auto"}) {
+        handles.push_back(service.submit(system, options_for(1.0, backend)));
+    }
+
+    ThreadPool pool(1);
+    ThreadedCPUBackend reference_backend("rk45", pool);
+    std::vector<std::vector<double>> reference;
+    reference_backend.solve(system, 0.0, 1.0, 0.01, system.initial_conditions, reference);
+
+    bool all_match = true;
+    for (auto& handle : handles) {
+        SolveResult result = handle.get();
+        if (result.solution != reference) all_match = false;
+        std::cout << "   job " << handle.id() << " on " << result.backend
+                  << ", queued " << result.queue_seconds * 1e3 << " ms, ran "
+                  << result.run_seconds * 1e3 << " ms" << std::endl;
+    }
+    check(all_match, "every lane returns the blocking-solve result");
+    check(handles[0].status() == JobStatus::Done, "status Done after get");
+
+    bool rejected = false;
+    try {
+        service.submit(system, options_for(1.0, "quantum"));
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    check(rejected, "unknown backend rejected at submit");
+}
+
+void test_priorities_and_cancel() {
+    std::cout << "\n=== PRIORITIES AND CANCELLATION ===" << std::endl;
+
+    SolveService service(1);
+    auto big = TestProblems::create_scalability_test(20000);
+    auto small = TestProblems::create_scalability_test(10);
+
+    // Occupy the only worker, then queue low before high priority
+    SolveHandle blocker = service.submit(big, options_for(2.0, "cpu"));
+    while (blocker.status() == JobStatus::Queued) {
+        std::this_thread::yield();
+    }
+    SolveHandle low = service.submit(small, options_for(0.1, "cpu", 0));
+    SolveHandle high = service.submit(small, options_for(0.1, "cpu", 10));
+    SolveHandle doomed = service.submit(small, options_for(0.1, "cpu", 5));
+
+    check(doomed.cancel(), "queued job can be cancelled");
+    check(doomed.status() == JobStatus::Cancelled, "status Cancelled");
+
+    bool threw = false;
+    try {
+        doomed.get();
+    } catch (const SolveCancelled&) {
+        threw = true;
+    }
+    check(threw, "cancelled job's get() throws SolveCancelled");
+
+    blocker.wait();
+    check(!blocker.cancel(), "finished job cannot be cancelled");
+
+    SolveResult low_result = low.get();
+    SolveResult high_result = high.get();
+    check(high_result.queue_seconds < low_result.queue_seconds, "higher priority started first");
+    check(service.queued_jobs() == 0, "queue drained");
+}
+
+void test_gpu_lane() {
+    std::cout << "\n=== GPU LANE ===" << std::endl;
+
+    SolveService service(1);
+    auto system = TestProblems::create_exponential_decay();
+
+    bool rejected = false;
+    try {
+        service.submit(system, options_for(1.0, "gpu"));  // method defaults to rk45
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    check(rejected, "GPU lane requires euler");
+
+    SolveOptions options = options_for(1.0, "gpu");
+    options.method = "euler";
+    SolveHandle handle = service.submit(system, options);
+
+    // Succeeds on a machine with a GPU, reports the failure otherwise
+    try {
+        SolveResult result = handle.get();
+        check(result.backend == "GPU_Euler" && !result.solution.empty(), "GPU job completed");
+
+        // Same time grid as the CPU lane: row 0 is y0, one row per step
+        options.backend = "cpu";
+        SolveResult cpu = service.submit(system, options).get();
+        check(result.solution.size() == cpu.solution.size() && result.solution[0] == cpu.solution[0] &&
+              std::abs(result.solution.back()[0] - cpu.solution.back()[0]) < 1e-5,
+              "GPU rows on the CPU time grid");
+    } catch (const std::runtime_error& e) {
+        std::cout << "   GPU unavailable: " << e.what() << std::endl;
+        check(handle.status() == JobStatus::Done, "GPU failure delivered through the future");
+    }
+}
+
+void test_shutdown() {
+    std::cout << "\n=== SHUTDOWN ===" << std::endl;
+
+    SolveHandle pending;
+    {
+        SolveService service(1);
+        auto big = TestProblems::create_scalability_test(20000);
+        SolveHandle running = service.submit(big, options_for(1.0, "cpu"));
+        pending = service.submit(big, options_for(1.0, "cpu"));
+    }
+
+    bool cancelled = false;
+    try {
+        pending.get();
+    } catch (const SolveCancelled&) {
+        cancelled = true;
+    }
+    check(cancelled || pending.status() == JobStatus::Done, "queued jobs resolved on shutdown");
+}
+
+int main() {
+    std::cout << "=== SOLVE SERVICE TEST ===" << std::endl;
+
+    test_cpu_only_service();
+    test_futures();
+    test_priorities_and_cancel();
+    test_gpu_lane();
+    test_shutdown();
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/trace.h"
+#include "../include/steppers.h"
+#include "../include/cpu_solver.h"
+#include "../include/shader_generator.h"
+#include "../include/test_problems.h"
+#include "../src/backends/cpu_backend.cpp"
+
+// Built with ODE_ENABLE_TRACING so the spans in the solvers are compiled in.
+// Writes trace_test.json, which can be opened in ui.perfetto.dev.
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << std::endl;
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << std::endl;
+        tests_failed++;
+    }
+}
+
+static size_t count_occurrences(const std::string& text, const std::string& pattern) {
+    size_t count = 0;
+    for (size_t pos = text.find(pattern); pos != std::string::npos;
+         pos = text.find(pattern, pos + pattern.size())) {
+        count++;
+    }
+    return count;
+}
+
+void test_runtime_gate() {
+    std::cout << "\n=== RUNTIME GATE ===" << std::endl;
+
+    auto& recorder = TraceRecorder::instance();
+    recorder.set_enabled(false);
+    recorder.clear();
+
+    auto system = TestProblems::create_exponential_decay();
+    CPUBackend solver(create_stepper("euler"));
+    std::vector<std::vector<double>> solution;
+    solver.solve(system, 0.0, 1.0, 0.01, system.initial_conditions, solution);
+
+    check(recorder.event_count() == 0, "no spans recorded while disabled");
+}
+
+void test_cpu_spans() {
+    std::cout << "\n=== CPU SOLVE SPANS ===" << std::endl;
+
+    auto& recorder = TraceRecorder::instance();
+    recorder.clear();
+    recorder.set_enabled(true);
+    recorder.set_thread_name("main");
+
+    auto system = TestProblems::create_exponential_decay();
+    CPUBackend solver(create_stepper("euler"));
+    std::vector<std::vector<double>> solution;
+    solver.solve(system, 0.0, 1.0, 0.01, system.initial_conditions, solution);
+
+    // One cpu_solve span plus one span per integration step
+    uint64_t expected = 1 + (solution.size() - 1);
+    std::cout << "   events: " << recorder.event_count() << " (expected " << expected << ")" << std::endl;
+    check(recorder.event_count() == expected, "one span per solve and per step");
+}
+
+void test_threaded_spans() {
+    std::cout << "\n=== PER-THREAD BUFFERS ===" << std::endl;
+
+    auto& recorder = TraceRecorder::instance();
+    uint64_t before = recorder.event_count();
+
+    const int n_threads = 3;
+    std::vector<std::thread> workers;
+    for (int w = 0; w < n_threads; ++w) {
+        workers.emplace_back([]() {
+            TraceRecorder::instance().set_thread_name("worker");
+            auto system = TestProblems::create_van_der_pol();
+            CPUSolver solver;
+            std::vector<std::vector<double>> solution;
+            solver.solve(system, 0.0, 1.0, 0.01, system.initial_conditions, solution);
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    uint64_t recorded = recorder.event_count() - before;
+    std::cout << "   events from workers: " << recorded << std::endl;
+    check(recorded == n_threads * 101u, "all worker spans recorded without locking");
+    check(recorder.dropped_count() == 0, "no spans dropped");
+}
+
+void test_shader_spans() {
+    std::cout << "\n=== SHADER GENERATION SPANS ===" << std::endl;
+
+    auto& recorder = TraceRecorder::instance();
+    uint64_t before = recorder.event_count();
+
+    try {
+        ShaderGenerator generator;
+        generator.generate_euler_shader_builtin("exponential");
+        check(recorder.event_count() - before == 2, "shader_generate and template_load spans");
+    } catch (const std::exception& e) {
+        std::cout << "   skipped (run from the build directory): " << e.what() << std::endl;
+    }
+}
+
+void test_chrome_json() {
+    std::cout << "\n=== CHROME JSON DUMP ===" << std::endl;
+
+    auto& recorder = TraceRecorder::instance();
+    recorder.set_enabled(false);
+
+    const std::string path = "trace_test.json";
+    check(recorder.dump_chrome_json(path), "trace written to " + path);
+
+    std::ifstream file(path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string json = buffer.str();
+
+    check(json.find("\"traceEvents\"") != std::string::npos, "traceEvents array present");
+    check(count_occurrences(json, "\"ph\":\"X\"") == recorder.event_count(),
+          "every span serialized as a complete event");
+    check(count_occurrences(json, "\"thread_name\"") == 4, "thread names emitted as metadata");
+    check(json.find("\"name\":\"cpu_solve\"") != std::string::npos, "cpu_solve span present");
+}
+
+int main() {
+    std::cout << "=== TRACE EVENT TEST ===" << std::endl;
+
+    test_runtime_gate();
+    test_cpu_spans();
+    test_threaded_spans();
+    test_shader_spans();
+    test_chrome_json();
+
+    std::cout << "\nPassed: " << tests_passed << ", Failed: " << tests_failed << std::endl;
+    return tests_failed == 0 ? 0 : 1;
+}